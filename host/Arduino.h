@@ -0,0 +1,121 @@
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the Arduino core API
+ * 
+ * Provides the subset of the Arduino core used by the firmware (Print,
+ * the Serial console, basic types and constants) so the application
+ * modules build unchanged in the native simulator. Timing goes through the
+ * HAL (hal.h) and the virtual clock, not through millis()/micros().
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// ============================================================================
+// TYPES AND CONSTANTS
+// ============================================================================
+
+typedef uint8_t byte;
+
+#define DEC 10
+#define HEX 16
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+// ============================================================================
+// PRINT
+// ============================================================================
+
+/**
+ * @brief Arduino Print base class
+ * 
+ * Derived classes implement write(); the print()/println() helpers format
+ * numbers the same way as the Arduino core.
+ */
+class Print
+{
+public:
+    virtual ~Print(void) {}
+
+    virtual size_t write(uint8_t c) { return write(&c, 1); }
+    virtual size_t write(const uint8_t* buffer, size_t size) = 0;
+    size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+
+    virtual int availableForWrite(void) { return 0; }
+    virtual void flush(void) {}
+
+    size_t print(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char value, int base = DEC) { return printNumber(value, base); }
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC) { return printNumber(value, base); }
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC) { return printNumber(value, base); }
+    size_t print(double value, int digits = 2);
+
+    size_t println(void) { return print("\r\n"); }
+    template <typename T>
+    size_t println(T value) { size_t n = print(value); return n + println(); }
+    template <typename T>
+    size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+private:
+    size_t printNumber(unsigned long value, int base);
+};
+
+// ============================================================================
+// SERIAL CONSOLE
+// ============================================================================
+
+/**
+ * @brief Serial console backed by stdout
+ * 
+ * Models the UART transmit path: bytes drain at the configured baud rate
+ * in virtual time, and writes block (advance the virtual clock) only when
+ * the transmit buffer is full. Output is discarded unless echo is enabled.
+ */
+class HardwareSerial : public Print
+{
+public:
+    HardwareSerial(void);
+
+    void begin(unsigned long baud);
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    int availableForWrite(void) override;
+
+    void setEcho(bool enabled) { echo = enabled; }
+    uint64_t bytesWritten(void) const { return totalBytes; }
+    uint64_t blockedMicros(void) const { return blockedUs; }
+
+private:
+    void drain(void);
+
+    unsigned long baudRate;
+    bool echo;
+    uint32_t backlog;
+    uint64_t lastDrainUs;
+    uint64_t totalBytes;
+    uint64_t blockedUs;
+};
+
+extern HardwareSerial Serial;
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,122 @@
+/**
+ * @file FS.h
+ * @brief Host stand-in for the ESP32 fs::FS / fs::File API
+ * 
+ * Directory-backed file system: paths are resolved below a host root
+ * directory. Every open, write, flush and close is counted and charged to
+ * the virtual clock using a simple SPI SD card cost model, so the number
+ * of write calls and bytes per call can be measured off the device.
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+#include "Arduino.h"
+#include <memory>
+#include <string>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+// ============================================================================
+// SD COST MODEL (virtual microseconds)
+// ============================================================================
+
+#define SIM_SD_OPEN_US 2000
+#define SIM_SD_CLOSE_US 1000
+#define SIM_SD_WRITE_CALL_US 150
+#define SIM_SD_BYTES_PER_US 2
+#define SIM_SD_FLUSH_US 3000
+
+namespace fs
+{
+
+// ============================================================================
+// FILE SYSTEM STATISTICS
+// ============================================================================
+
+struct FsStats
+{
+    uint64_t opens;
+    uint64_t closes;
+    uint64_t writeCalls;
+    uint64_t bytesWritten;
+    uint64_t flushes;
+    uint64_t readCalls;
+    uint64_t bytesRead;
+    uint64_t failures;
+};
+
+// ============================================================================
+// FILE
+// ============================================================================
+
+struct FileImpl;
+
+class File : public Print
+{
+public:
+    File(void) {}
+    explicit File(std::shared_ptr<FileImpl> impl) : impl(impl) {}
+
+    operator bool(void) const;
+
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+    int read(void);
+    size_t read(uint8_t* buffer, size_t size);
+    int available(void);
+    bool seek(uint32_t position);
+    size_t position(void) const;
+    size_t size(void) const;
+    void flush(void) override;
+    void close(void);
+    const char* name(void) const;
+
+private:
+    std::shared_ptr<FileImpl> impl;
+};
+
+// ============================================================================
+// FILE SYSTEM
+// ============================================================================
+
+class FS
+{
+public:
+    explicit FS(const char* rootDirectory);
+
+    /**
+     * @brief Change the host directory that backs "/"
+     */
+    void setRoot(const char* rootDirectory);
+
+    File open(const char* path, const char* mode = FILE_READ);
+    bool exists(const char* path);
+    bool remove(const char* path);
+    bool rename(const char* pathFrom, const char* pathTo);
+    bool mkdir(const char* path);
+
+    const FsStats& stats(void) const { return counters; }
+
+private:
+    std::string resolve(const char* path) const;
+
+    std::string root;
+    FsStats counters;
+
+    friend struct FileImpl;
+    friend class File;
+};
+
+} // namespace fs
+
+using fs::File;
+
+#endif // HOST_FS_H
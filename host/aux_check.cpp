@@ -0,0 +1,132 @@
+/**
+ * @file aux_check.cpp
+ * @brief Check of the 9-axis burst read through the MPU9250 I2C master
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "aux_check.h"
+#include "check_util.h"
+#include "imu_sensor.h"
+#include "data_ready.h"
+#include "sim_imu.h"
+#include "sim_clock.h"
+#include "hal.h"
+
+// ============================================================================
+// CHECK PARAMETERS
+// ============================================================================
+
+#define SAMPLE_PERIOD_US (1000000UL / IMU_SAMPLE_RATE_HZ)
+
+// ============================================================================
+// PHASES
+// ============================================================================
+
+/**
+ * @brief Bus cost and decoding result of one phase
+ */
+struct PhaseResult
+{
+    uint64_t transactions;
+    uint64_t busBytes;
+    uint64_t busUs;
+    uint32_t splitSamples;      ///< Accel or gyro not from the latched sample
+    uint32_t magMismatches;
+};
+
+static bool countsEqual(const int16_t* a, const int16_t* b)
+{
+    return a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+}
+
+/**
+ * @brief Read @p samples samples with readIMUData() at random points of the period
+ */
+static void runPhase(const char* name, uint32_t samples, bool checkMag, PhaseResult& result)
+{
+    memset(&result, 0, sizeof(result));
+
+    for (uint32_t n = 0; n < samples; n++)
+    {
+        // Next sample, then a random delay into its period
+        uint64_t period = SAMPLE_PERIOD_US;
+        uint64_t now = simNowMicros();
+        uint64_t nextSample = (now / period + 1) * period;
+        simAdvanceMicros(nextSample - now + nextRandom() % period);
+
+        SimImuStats before = simImu().stats();
+        uint64_t startUs = simNowMicros();
+        readIMUData();
+        result.busUs += simNowMicros() - startUs;
+        result.transactions += simImu().stats().transactions - before.transactions;
+        result.busBytes += simImu().stats().busBytes - before.busBytes;
+
+        const SimSampleTruth& truth = simImu().lastSample();
+        if (!countsEqual(imuSensor.accelCount, truth.accel) || !countsEqual(imuSensor.gyroCount, truth.gyro))
+        {
+            if (!checkMag)
+            {
+                result.splitSamples++;
+            }
+            else
+            {
+                reportFailure(result.splitSamples, "MISMATCH %s sample %lu: accel/gyro not from the sample at %llu us",
+                              name, (unsigned long)n, (unsigned long long)truth.timeUs);
+            }
+        }
+        if (checkMag && !countsEqual(imuSensor.magCount, truth.mag))
+        {
+            reportFailure(result.magMismatches, "MISMATCH %s sample %lu: mag %d,%d,%d expected %d,%d,%d", name,
+                          (unsigned long)n, imuSensor.magCount[0], imuSensor.magCount[1], imuSensor.magCount[2],
+                          truth.mag[0], truth.mag[1], truth.mag[2]);
+        }
+    }
+}
+
+static void printPhase(const char* name, const PhaseResult& result, uint32_t samples)
+{
+    printf("\"%s\":{\"transactions_per_sample\":%.3f,\"bytes_per_sample\":%.1f,\"bus_us_per_sample\":%.1f,"
+           "\"split_samples\":%lu,\"mag_mismatches\":%lu}",
+           name, (double)result.transactions / samples, (double)result.busBytes / samples,
+           (double)result.busUs / samples, (unsigned long)result.splitSamples,
+           (unsigned long)result.magMismatches);
+}
+
+// ============================================================================
+// ENTRY POINT
+// ============================================================================
+
+bool runAuxBurstCheck(uint32_t samples, uint32_t seed)
+{
+    PhaseResult separate;
+    PhaseResult burst;
+
+    seedRandom(seed);
+
+    // The device as setup() leaves it
+    initializeIMU();
+    initializeMagnetometer();
+
+    runPhase("separate", samples, false, separate);
+    enableAuxBurstAcquisition();
+
+    // setup() starts the data-ready interrupt after the master; it must not
+    // reopen the bypass the master needs closed
+    startDataReadyInterrupt();
+    uint64_t blockedBefore = simImu().stats().auxReadsBlocked;
+    runPhase("burst", samples, true, burst);
+    uint64_t blocked = simImu().stats().auxReadsBlocked - blockedBefore;
+
+    bool ok = burst.splitSamples == 0 && burst.magMismatches == 0 && blocked == 0;
+    beginCheckReport("aux_burst", seed);
+    printf(",\"samples\":%lu,\"burst_bytes\":%d,\"aux_reads_blocked\":%llu,",
+           (unsigned long)samples, IMU_BURST_SIZE, (unsigned long long)blocked);
+    printPhase("separate", separate, samples);
+    printf(",");
+    printPhase("burst", burst, samples);
+    endCheckReport(ok);
+    return ok;
+}
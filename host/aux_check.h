@@ -0,0 +1,39 @@
+/**
+ * @file aux_check.h
+ * @brief Check of the 9-axis burst read through the MPU9250 I2C master
+ *
+ * Initializes the simulated MPU9250 and AK8963 the way setup() does and
+ * reads N samples with the separate accel/gyro/mag reads, then switches
+ * to enableAuxBurstAcquisition(), starts the data-ready interrupt as
+ * setup() does, and reads N more, each at a random point of the sample
+ * period. The simulated master fails its reads while the I2C bypass is
+ * set; none may be lost. Every burst sample has to decode to exactly the
+ * counts the simulator latched for that sample, magnetometer included.
+ * Separate reads that straddle a new sample (accel and gyro from
+ * different samples) are counted. Both phases report the I2C
+ * transactions, bytes and bus time readIMUData() took per sample.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef AUX_CHECK_H
+#define AUX_CHECK_H
+
+#include <stdint.h>
+
+// ============================================================================
+// AUXILIARY BURST CHECK
+// ============================================================================
+
+/**
+ * @brief Run the check and print one JSON line
+ *
+ * @param samples Samples read in each phase
+ * @param seed Random seed for the read times within a sample period
+ * @return true if every burst sample decoded correctly
+ */
+bool runAuxBurstCheck(uint32_t samples, uint32_t seed);
+
+#endif // AUX_CHECK_H
@@ -0,0 +1,78 @@
+/**
+ * @file check_util.cpp
+ * @brief Random numbers and reporting shared by the host simulator's checks
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "check_util.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+// ============================================================================
+// RANDOM NUMBERS
+// ============================================================================
+
+static uint32_t rngState = 1;
+
+void seedRandom(uint32_t seed)
+{
+    rngState = seed ? seed : 1;
+}
+
+uint32_t nextRandom(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+uint32_t nextRandom(void)
+{
+    return nextRandom(rngState);
+}
+
+float uniform(float low, float high)
+{
+    return low + (high - low) * (float)(nextRandom() >> 8) / 16777216.0f;
+}
+
+double uniform(double low, double high)
+{
+    return low + (high - low) * (double)(nextRandom() >> 8) / 16777216.0;
+}
+
+// ============================================================================
+// REPORTING
+// ============================================================================
+
+void reportFailure(uint32_t& count, const char* format, ...)
+{
+    if (count++ >= REPORTED_FAILURES)
+    {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+void beginCheckReport(const char* name, uint32_t seed)
+{
+    printf("{\"check\":\"%s\",\"seed\":%lu", name, (unsigned long)seed);
+}
+
+void endCheckReport(bool pass)
+{
+    printf(",\"pass\":%s}\n", jsonBool(pass));
+}
+
+const char* jsonBool(bool value)
+{
+    return value ? "true" : "false";
+}
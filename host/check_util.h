@@ -0,0 +1,78 @@
+/**
+ * @file check_util.h
+ * @brief Random numbers and reporting shared by the host simulator's checks
+ *
+ * Every check draws from the same xorshift generator, prints its first few
+ * failures to stderr and ends with one JSON line on stdout whose last
+ * field is "pass".
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef CHECK_UTIL_H
+#define CHECK_UTIL_H
+
+#include <stdint.h>
+
+// Failures printed to stderr before the rest are only counted
+#define REPORTED_FAILURES 8
+
+// ============================================================================
+// RANDOM NUMBERS
+// ============================================================================
+
+/**
+ * @brief Restart the shared generator; a zero seed is replaced by 1
+ */
+void seedRandom(uint32_t seed);
+
+/**
+ * @brief Next xorshift32 value of the shared generator
+ */
+uint32_t nextRandom(void);
+
+/**
+ * @brief Next xorshift32 value of a caller-owned generator
+ *
+ * For checks that draw from several threads, each with its own state.
+ */
+uint32_t nextRandom(uint32_t& state);
+
+/**
+ * @brief Uniform value in [@p low, @p high) from the shared generator
+ */
+float uniform(float low, float high);
+double uniform(double low, double high);
+
+// ============================================================================
+// REPORTING
+// ============================================================================
+
+/**
+ * @brief Count one failure and print it while fewer than REPORTED_FAILURES were
+ *
+ * @param count Failure counter of its kind
+ * @param format printf() format of the stderr line, without the newline
+ */
+void reportFailure(uint32_t& count, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+/**
+ * @brief Open the JSON line with the check name and seed
+ *
+ * The check's own fields follow, each preceded by a comma.
+ */
+void beginCheckReport(const char* name, uint32_t seed);
+
+/**
+ * @brief Close the JSON line with the "pass" field
+ */
+void endCheckReport(bool pass);
+
+/**
+ * @brief JSON literal for @p value
+ */
+const char* jsonBool(bool value);
+
+#endif // CHECK_UTIL_H
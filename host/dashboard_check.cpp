@@ -0,0 +1,275 @@
+/**
+ * @file dashboard_check.cpp
+ * @brief Check of the LCD dashboard layout, diff and frame budget
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "dashboard_check.h"
+#include "check_util.h"
+#include "dashboard.h"
+#include "hal.h"
+#include "hal_host.h"
+#include "sim_clock.h"
+#include <stdio.h>
+#include <string.h>
+
+// ============================================================================
+// CHECK PARAMETERS
+// ============================================================================
+
+#define SCREEN_PIXELS ((uint32_t)HAL_LCD_WIDTH * HAL_LCD_HEIGHT)
+
+// Every this many frames the values do not change
+#define IDLE_FRAME_PERIOD 10
+
+// Service part: virtual duration and loop pass period
+#define SERVICE_SECONDS 10
+#define SERVICE_PASS_US 1000
+
+// ============================================================================
+// RANDOM VALUES
+// ============================================================================
+
+static bool chance(float probability)
+{
+    return uniform(0.0f, 1.0f) < probability;
+}
+
+static float wrapDegrees(float angle)
+{
+    return (angle > 180.0f) ? angle - 360.0f : (angle < -180.0f) ? angle + 360.0f : angle;
+}
+
+/**
+ * @brief Next frame of a slowly turning, mostly healthy recorder
+ */
+static void walkValues(DashboardValues& values)
+{
+    values.yaw = wrapDegrees(values.yaw + uniform(-3.0f, 3.0f));
+    values.pitch = wrapDegrees(values.pitch + uniform(-1.0f, 1.0f));
+    values.roll = wrapDegrees(values.roll + uniform(-1.0f, 1.0f));
+    values.rateHz = 200.0f + uniform(-0.5f, 0.5f);
+    if (chance(0.3f))
+    {
+        values.bufferPercent = (uint8_t)(nextRandom() % 101);
+    }
+    if (chance(0.1f) && values.freeMegabytes > 0)
+    {
+        values.freeMegabytes--;
+    }
+    if (chance(0.02f))
+    {
+        values.storageErrors++;
+    }
+    if (chance(0.05f))
+    {
+        values.droppedSamples += 1 + nextRandom() % 3;
+    }
+    if (chance(0.02f))
+    {
+        values.status = (StatusColor)(nextRandom() % 3);
+    }
+}
+
+// ============================================================================
+// CHECK PARTS
+// ============================================================================
+
+static uint8_t coverage[SCREEN_PIXELS];
+
+/**
+ * @brief Layout errors: pixels not covered exactly once, and texts that overflow
+ */
+static uint32_t checkLayout(void)
+{
+    uint32_t errors = 0;
+
+    memset(coverage, 0, sizeof(coverage));
+    for (uint8_t i = 0; i < DASHBOARD_FIELD_COUNT; i++)
+    {
+        const DashboardField& field = dashboardField(i);
+        bool fits = field.chars <= DASHBOARD_MAX_CHARS
+                 && field.padX + field.chars * DASHBOARD_CELL_WIDTH * field.scale <= field.width
+                 && field.padY + DASHBOARD_CELL_HEIGHT * field.scale <= field.height
+                 && field.x >= 0 && field.y >= 0
+                 && field.x + field.width <= HAL_LCD_WIDTH && field.y + field.height <= HAL_LCD_HEIGHT;
+        if (!fits)
+        {
+            fprintf(stderr, "LAYOUT field %u does not fit\n", (unsigned)i);
+            errors++;
+            continue;
+        }
+        for (int16_t y = field.y; y < field.y + field.height; y++)
+        {
+            for (int16_t x = field.x; x < field.x + field.width; x++)
+            {
+                coverage[y * HAL_LCD_WIDTH + x]++;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < SCREEN_PIXELS; i++)
+    {
+        errors += (coverage[i] != 1) ? 1 : 0;
+    }
+    return errors;
+}
+
+/**
+ * @brief Pixels of the framebuffer that differ from a full redraw of @p texts
+ */
+static uint32_t compareWithRedraw(const DashboardText* texts)
+{
+    const uint16_t* screen = hostFramebuffer();
+    uint32_t differences = 0;
+
+    for (int16_t y = 0; y < HAL_LCD_HEIGHT; y++)
+    {
+        for (int16_t x = 0; x < HAL_LCD_WIDTH; x++)
+        {
+            differences += (screen[y * HAL_LCD_WIDTH + x] != dashboardPixel(texts, x, y)) ? 1 : 0;
+        }
+    }
+    return differences;
+}
+
+/**
+ * @brief Pixels a renderer that repaints every changed field would push
+ */
+static uint32_t changedFieldPixels(const DashboardText* before, const DashboardText* after)
+{
+    uint32_t pixels = 0;
+    for (uint8_t i = 0; i < DASHBOARD_FIELD_COUNT; i++)
+    {
+        if (strcmp(before[i].text, after[i].text) != 0 || before[i].foreground != after[i].foreground
+            || before[i].background != after[i].background)
+        {
+            pixels += (uint32_t)dashboardField(i).width * dashboardField(i).height;
+        }
+    }
+    return pixels;
+}
+
+bool runDashboardCheck(uint32_t frames, uint32_t seed)
+{
+    static DashboardRenderer renderer;
+    DashboardText previous[DASHBOARD_FIELD_COUNT];
+    DashboardText texts[DASHBOARD_FIELD_COUNT];
+    DashboardValues values;
+
+    seedRandom(seed);
+    uint32_t layoutErrors = checkLayout();
+
+    // Diff: start from a screen the dashboard did not draw
+    halShowStatus(STATUS_ERROR);
+    memset(&values, 0, sizeof(values));
+    values.status = STATUS_RECORDING;
+    values.freeMegabytes = 15000;
+    memset(previous, 0, sizeof(previous));
+
+    uint32_t mismatchedFrames = 0;
+    uint32_t mismatchedPixels = 0;
+    uint32_t overBudget = 0;
+    uint32_t idleFrames = 0;
+    uint64_t idlePixels = 0;
+    uint64_t framePixels = 0;
+    uint64_t fieldPixels = 0;
+    uint32_t maxPassPixels = 0;
+    uint64_t maxPassUs = 0;
+    uint64_t passes = 0;
+
+    for (uint32_t frame = 0; frame < frames; frame++)
+    {
+        bool idle = frame > 0 && frame % IDLE_FRAME_PERIOD == 0;
+        if (!idle && frame > 0)
+        {
+            walkValues(values);
+        }
+
+        uint32_t before = renderer.pixelCount();
+        renderer.startFrame(values);
+        while (renderer.busy())
+        {
+            uint64_t startUs = simNowMicros();
+            uint32_t pixels = renderer.pushNext(DASHBOARD_PIXEL_BUDGET);
+            uint64_t passUs = simNowMicros() - startUs;
+
+            passes++;
+            maxPassPixels = (pixels > maxPassPixels) ? pixels : maxPassPixels;
+            maxPassUs = (passUs > maxPassUs) ? passUs : maxPassUs;
+            overBudget += (pixels > DASHBOARD_PIXEL_BUDGET) ? 1 : 0;
+        }
+        uint32_t pushed = renderer.pixelCount() - before;
+
+        formatDashboard(values, texts);
+        uint32_t differences = compareWithRedraw(texts);
+        if (differences > 0)
+        {
+            reportFailure(mismatchedFrames, "MISMATCH frame %lu: %lu pixels differ from a full redraw",
+                          (unsigned long)frame, (unsigned long)differences);
+        }
+        mismatchedPixels += differences;
+
+        if (idle)
+        {
+            idleFrames++;
+            idlePixels += pushed;
+        }
+        if (frame > 0)
+        {
+            framePixels += pushed;
+            fieldPixels += changedFieldPixels(previous, texts);
+        }
+        memcpy(previous, texts, sizeof(previous));
+    }
+
+    // Service: the firmware path, with fresh output on every pass
+    uint32_t repaintsBefore = hostStatusChanges();
+    showStatus(STATUS_ERROR);
+    showStatus(STATUS_ERROR);
+    uint32_t statusRepaints = hostStatusChanges() - repaintsBefore;
+
+    beginDashboard();
+    uint32_t startFrames = dashboardFrameCount();
+    uint64_t serviceStartUs = simNowMicros();
+    uint64_t serviceMaxPassUs = 0;
+    while (simNowMicros() - serviceStartUs < SERVICE_SECONDS * 1000000ULL)
+    {
+        simAdvanceMicros(SERVICE_PASS_US);
+        dashboardObserveOutput(uniform(-180.0f, 180.0f), uniform(-90.0f, 90.0f), uniform(-180.0f, 180.0f),
+                               uniform(150.0f, 250.0f));
+
+        uint64_t startUs = simNowMicros();
+        serviceDashboard(halMillis());
+        uint64_t passUs = simNowMicros() - startUs;
+        serviceMaxPassUs = (passUs > serviceMaxPassUs) ? passUs : serviceMaxPassUs;
+    }
+    uint32_t serviceFrames = dashboardFrameCount() - startFrames;
+    uint32_t frameLimit = SERVICE_SECONDS * 1000 / DASHBOARD_FRAME_INTERVAL_MS + 1;
+
+    uint32_t laterFrames = (frames > 1) ? frames - 1 : 1;
+    bool ok = layoutErrors == 0 && mismatchedFrames == 0 && overBudget == 0 && idlePixels == 0
+           && statusRepaints <= 1 && serviceFrames > 0 && serviceFrames <= frameLimit
+           && serviceMaxPassUs < 1000000ULL / IMU_SAMPLE_RATE_HZ;
+
+    beginCheckReport("dashboard", seed);
+    printf(",\"frames\":%lu,\"layout_errors\":%lu,"
+           "\"mismatched_frames\":%lu,\"mismatched_pixels\":%lu,\"idle_frames\":%lu,\"idle_pixels\":%llu,"
+           "\"pixels_per_frame\":%.0f,\"field_redraw_pixels_per_frame\":%.0f,\"screen_pixels\":%lu,"
+           "\"passes_per_frame\":%.1f,\"max_pass_pixels\":%lu,\"max_pass_us\":%llu,\"over_budget\":%lu,"
+           "\"service\":{\"seconds\":%d,\"frames\":%lu,\"frame_limit\":%lu,\"max_pass_us\":%llu},"
+           "\"status_repaints\":%lu",
+           (unsigned long)frames, (unsigned long)layoutErrors,
+           (unsigned long)mismatchedFrames, (unsigned long)mismatchedPixels, (unsigned long)idleFrames,
+           (unsigned long long)idlePixels, (double)framePixels / laterFrames,
+           (double)fieldPixels / laterFrames, (unsigned long)SCREEN_PIXELS,
+           frames ? (double)passes / frames : 0.0, (unsigned long)maxPassPixels,
+           (unsigned long long)maxPassUs, (unsigned long)overBudget, SERVICE_SECONDS,
+           (unsigned long)serviceFrames, (unsigned long)frameLimit, (unsigned long long)serviceMaxPassUs,
+           (unsigned long)statusRepaints);
+    endCheckReport(ok);
+    return ok;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file dashboard_check.h
+ * @brief Check of the LCD dashboard layout, diff and frame budget
+ *
+ * Three parts, all against the host HAL's framebuffer stand-in:
+ *
+ * - Layout: the fields tile the screen exactly once and every field's
+ *   text fits inside it.
+ * - Diff: a DashboardRenderer draws the given number of frames of
+ *   randomly walking values over a screen filled with the error colour.
+ *   After each frame the framebuffer must equal a full redraw of the
+ *   frame (dashboardPixel()), no pass may exceed DASHBOARD_PIXEL_BUDGET,
+ *   and frames with unchanged values must push nothing.
+ * - Service: serviceDashboard() runs once per millisecond of virtual time
+ *   for ten seconds while the output changes every pass. It must not
+ *   start more than one frame per DASHBOARD_FRAME_INTERVAL_MS, and no pass
+ *   may take as long as a sample period at IMU_SAMPLE_RATE_HZ.
+ *
+ * The report gives the pixels pushed per frame next to a redraw of every
+ * changed field and of the whole screen.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef DASHBOARD_CHECK_H
+#define DASHBOARD_CHECK_H
+
+#include <stdint.h>
+
+// ============================================================================
+// DASHBOARD CHECK
+// ============================================================================
+
+/**
+ * @brief Run the check and print one JSON line
+ *
+ * @param frames Frames of random values drawn in the diff part
+ * @param seed Random seed for the values
+ * @return true if every part passed
+ */
+bool runDashboardCheck(uint32_t frames, uint32_t seed);
+
+#endif // DASHBOARD_CHECK_H
@@ -0,0 +1,381 @@
+/**
+ * @file data_ready_check.cpp
+ * @brief Check of the data-ready scheduling path against the simulated MPU9250
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "data_ready_check.h"
+#include "check_util.h"
+#include "data_ready.h"
+#include "data_processor.h"
+#include "imu_sensor.h"
+#include "calibration.h"
+#include "sim_imu.h"
+#include "sim_clock.h"
+#include "hal.h"
+#include "config.h"
+#include <deque>
+#include <math.h>
+#include <stdio.h>
+
+// ============================================================================
+// CHECK PARAMETERS
+// ============================================================================
+
+#define SAMPLE_PERIOD_US (1000000UL / IMU_SAMPLE_RATE_HZ)
+
+// The virtual clock starts this many periods before the 32-bit microsecond
+// counter wraps
+#define WRAP_AFTER_PERIODS 1000
+
+// ISR latency added to each edge timestamp: under half a period, which the
+// scheduler's rounding absorbs
+#define MAX_LATENCY_US (SAMPLE_PERIOD_US * 2 / 5)
+
+// Per mille of steps that mask edges, build a backlog or overflow the queue
+#define MASKED_PER_MILLE 100
+#define BACKLOG_PER_MILLE 150
+#define OVERFLOW_PER_MILLE 30
+
+// Longest run of edges lost in a masked step
+#define MAX_MASKED_EDGES 8
+
+// Largest difference between a fused dt and the whole periods it covers:
+// the per-edge dt values are summed in float
+#define DT_TOLERANCE_S 1e-6
+
+// Length of the idle loop part, and the passes after which it counts as stalled
+#define IDLE_LOOP_PERIODS 200
+#define MAX_IDLE_PASSES (10 * IDLE_LOOP_PERIODS * SAMPLE_PERIOD_US / SIM_IDLE_PASS_US)
+
+// ============================================================================
+// DEVICE HISTORY
+// ============================================================================
+
+/**
+ * @brief A sample the device produced, numbered from 1 in production order
+ */
+struct NumberedSample
+{
+    uint64_t index;
+    SimSampleTruth truth;
+};
+
+/**
+ * @brief An edge that reached the scheduler's queue
+ */
+struct QueuedEdge
+{
+    uint64_t index;             ///< Sample that raised it
+    uint32_t timestampUs;       ///< Time the ISR gave it
+};
+
+// Samples since the last fused edge, and the edges queued but not yet taken
+static std::deque<NumberedSample> produced;
+static std::deque<QueuedEdge> queued;
+
+// Edges still to lose, and the edges lost so far
+static uint32_t edgesToMask;
+static uint32_t edgesMasked;
+static uint32_t edgesOverflowed;
+
+static void recordSample(const SimSampleTruth& truth)
+{
+    NumberedSample sample;
+    sample.index = simImu().stats().samplesGenerated;
+    sample.truth = truth;
+    produced.push_back(sample);
+}
+
+/**
+ * @brief Stands in for the firmware's data-ready ISR
+ *
+ * Runs at the sample time, before the sample hook, so the device's sample
+ * count is already the number of the sample that raised the edge.
+ */
+static void disturbedIsr(void)
+{
+    if (edgesToMask > 0)
+    {
+        edgesToMask--;
+        edgesMasked++;
+        return;
+    }
+
+    QueuedEdge edge;
+    edge.index = simImu().stats().samplesGenerated;
+    edge.timestampUs = halMicros() + nextRandom() % MAX_LATENCY_US;
+    if (dataReady.pending() >= DATA_READY_QUEUE_SIZE)
+    {
+        edgesOverflowed++;
+    }
+    else
+    {
+        queued.push_back(edge);
+    }
+    dataReady.onEdge(edge.timestampUs);
+}
+
+/**
+ * @brief Number of the newest produced sample whose counts match @p counts, or 0
+ */
+static uint64_t sampleIndex(const int16_t* counts, bool gyro)
+{
+    for (size_t k = produced.size(); k > 0; k--)
+    {
+        const int16_t* truth = gyro ? produced[k - 1].truth.gyro : produced[k - 1].truth.accel;
+        if (truth[0] == counts[0] && truth[1] == counts[1] && truth[2] == counts[2])
+        {
+            return produced[k - 1].index;
+        }
+    }
+    return 0;
+}
+
+// The sink sees one sample per fusion
+static uint32_t sinkCalls;
+static uint32_t sinkTimestampMs;
+
+static void countSample(const ImuSample& sample)
+{
+    sinkCalls++;
+    sinkTimestampMs = sample.timestampMs;
+}
+
+// ============================================================================
+// DATA-READY CHECK
+// ============================================================================
+
+enum StepKind
+{
+    STEP_STEADY = 0,
+    STEP_MASKED,
+    STEP_BACKLOG,
+    STEP_OVERFLOW,
+    STEP_KINDS
+};
+
+bool runDataReadyCheck(uint32_t steps, uint32_t seed)
+{
+    static const char* kindNames[STEP_KINDS] = {"steady", "masked", "backlog", "overflow"};
+    uint32_t stepCount[STEP_KINDS] = {0, 0, 0, 0};
+
+    uint64_t edgesTaken = 0;
+    uint64_t fusions = 0;
+    uint64_t periodsFused = 0;
+    uint64_t rereads = 0;           ///< Fusions of a sample already fused, produced during the previous read
+    uint64_t splitReads = 0;        ///< Fusions whose gyro read came from a later sample than the accel read
+    uint32_t maxEdgesPerPass = 0;
+    double maxDtErrorS = 0.0;
+    bool wrapped = false;
+
+    uint32_t wrongCounts = 0;       ///< Passes that left edges queued or took phantom ones
+    uint32_t wrongFusions = 0;      ///< Passes that did not fuse exactly once (or at all without edges)
+    uint32_t wrongIntervals = 0;    ///< Fusions whose dt did not cover the periods since the last fused edge
+    uint32_t wrongMissed = 0;       ///< Fusions whose missed-period count disagrees with the lost edges
+    uint32_t staleSamples = 0;      ///< Fusions of a sample older than the newest signalled one
+    uint32_t wrongSinks = 0;        ///< Fusions not passed to the sink once with the newest edge time
+
+    seedRandom(seed);
+
+    // The device as setup() leaves it with DATA_READY_IRQ_ENABLED, shortly
+    // before halMicros() wraps
+    uint64_t wrapUs = (simNowMicros() | 0xFFFFFFFFull) + 1;
+    simAdvanceMicros(wrapUs - WRAP_AFTER_PERIODS * SAMPLE_PERIOD_US - simNowMicros());
+    beginCalibration();
+    initializeIMU();
+    initializeMagnetometer();
+    if (!startDataReadyInterrupt())
+    {
+        return false;
+    }
+    produced.clear();
+    queued.clear();
+    edgesToMask = 0;
+    edgesMasked = 0;
+    edgesOverflowed = 0;
+    uint32_t droppedBefore = dataReady.droppedEdges();
+    simImu().setSampleHook(recordSample);
+    simImu().setInterruptHandler(disturbedIsr);
+
+    // Edges the firmware ISR queued during setup end at the newest sample
+    bool haveFused = dataReady.pending() > 0;
+    uint64_t lastFusedEdge = simImu().stats().samplesGenerated;
+    uint64_t lastFusedSample = 0;
+    acquireDataReadySamples(NULL);
+    uint32_t lastTimestampUs = 0;
+    for (uint32_t step = 0; step < steps; step++)
+    {
+        uint32_t roll = nextRandom() % 1000;
+        StepKind kind = (roll < MASKED_PER_MILLE) ? STEP_MASKED
+                      : (roll < MASKED_PER_MILLE + BACKLOG_PER_MILLE) ? STEP_BACKLOG
+                      : (roll < MASKED_PER_MILLE + BACKLOG_PER_MILLE + OVERFLOW_PER_MILLE) ? STEP_OVERFLOW
+                      : STEP_STEADY;
+        stepCount[kind]++;
+
+        uint32_t periods = 0;
+        if (kind == STEP_MASKED)
+        {
+            edgesToMask = 1 + nextRandom() % MAX_MASKED_EDGES;
+            periods = edgesToMask;
+        }
+        else if (kind == STEP_BACKLOG)
+        {
+            periods = DATA_READY_MAX_BATCH / 2 + nextRandom() % (DATA_READY_QUEUE_SIZE - DATA_READY_MAX_BATCH / 2);
+        }
+        else if (kind == STEP_OVERFLOW)
+        {
+            periods = DATA_READY_QUEUE_SIZE + 1 + nextRandom() % DATA_READY_QUEUE_SIZE;
+        }
+        simAdvanceMicros((uint64_t)periods * SAMPLE_PERIOD_US + SAMPLE_PERIOD_US / 5
+                         + nextRandom() % (SAMPLE_PERIOD_US * 4 / 5));
+
+        // Edges raised by the pass's own register reads stay queued for the next one
+        size_t expected = queued.size();
+        long fusionsBefore = imuSensor.sumCount;
+        uint32_t missedBefore = dataReady.missedPeriods();
+        sinkCalls = 0;
+
+        int count = acquireDataReadySamples(countSample);
+
+        long fused = imuSensor.sumCount - fusionsBefore;
+        if (fused != ((count > 0) ? 1 : 0))
+        {
+            reportFailure(wrongFusions, "FUSION %s step %lu: %ld fusions for %d edges", kindNames[kind],
+                          (unsigned long)step, fused, count);
+        }
+        if ((size_t)count != expected)
+        {
+            reportFailure(wrongCounts, "EDGES %s step %lu: took %d of %lu queued edges", kindNames[kind],
+                          (unsigned long)step, count, (unsigned long)expected);
+            // Resynchronize with the scheduler as far as the queue allows
+            size_t taken = ((size_t)count < expected) ? (size_t)count : expected;
+            if (taken > 0)
+            {
+                haveFused = true;
+                lastFusedEdge = queued[taken - 1].index;
+                queued.erase(queued.begin(), queued.begin() + taken);
+            }
+            continue;
+        }
+        if (count == 0)
+        {
+            continue;
+        }
+
+        edgesTaken += count;
+        fusions += fused;
+        maxEdgesPerPass = ((uint32_t)count > maxEdgesPerPass) ? (uint32_t)count : maxEdgesPerPass;
+
+        // The scheduler's first edge stands for one period
+        const QueuedEdge& first = queued.front();
+        const QueuedEdge& last = queued[count - 1];
+        uint64_t previousEdge = haveFused ? lastFusedEdge : first.index - 1;
+        uint64_t coveredPeriods = last.index - previousEdge;
+        for (int i = 0; i < count; i++)
+        {
+            wrapped = wrapped || ((haveFused || i > 0) && queued[i].timestampUs < lastTimestampUs);
+            lastTimestampUs = queued[i].timestampUs;
+        }
+
+        double dtError = fabs((double)imuSensor.deltat - (double)coveredPeriods * SAMPLE_PERIOD_US / 1e6);
+        maxDtErrorS = (dtError > maxDtErrorS) ? dtError : maxDtErrorS;
+        if (dtError > DT_TOLERANCE_S)
+        {
+            reportFailure(wrongIntervals, "DT %s step %lu: fused %.6f s over %lu periods", kindNames[kind],
+                          (unsigned long)step, imuSensor.deltat, (unsigned long)coveredPeriods);
+        }
+        periodsFused += coveredPeriods;
+
+        uint32_t missed = dataReady.missedPeriods() - missedBefore;
+        if (missed != coveredPeriods - count)
+        {
+            reportFailure(wrongMissed, "MISSED %s step %lu: %lu missed periods, expected %lu", kindNames[kind],
+                          (unsigned long)step, (unsigned long)missed, (unsigned long)(coveredPeriods - count));
+        }
+
+        // Accel and gyro are separate reads: a sample can land between them
+        uint64_t sample = sampleIndex(imuSensor.accelCount, false);
+        uint64_t gyroSample = sampleIndex(imuSensor.gyroCount, true);
+        if ((sample < last.index || gyroSample < sample))
+        {
+            reportFailure(staleSamples, "STALE %s step %lu: fused samples %llu/%llu, newest edge from sample %llu",
+                          kindNames[kind], (unsigned long)step, (unsigned long long)sample,
+                          (unsigned long long)gyroSample, (unsigned long long)last.index);
+        }
+        splitReads += (gyroSample != sample) ? 1 : 0;
+        rereads += (haveFused && sample == lastFusedSample) ? 1 : 0;
+
+        if ((sinkCalls != 1 || sinkTimestampMs != last.timestampUs / 1000))
+        {
+            reportFailure(wrongSinks, "SINK %s step %lu: %lu calls, timestamp %lu ms for edge at %lu us",
+                          kindNames[kind], (unsigned long)step, (unsigned long)sinkCalls,
+                          (unsigned long)sinkTimestampMs, (unsigned long)last.timestampUs);
+        }
+
+        haveFused = true;
+        lastFusedEdge = last.index;
+        lastFusedSample = sample;
+        queued.erase(queued.begin(), queued.begin() + count);
+        while (!produced.empty() && produced.front().index < lastFusedEdge)
+        {
+            produced.pop_front();
+        }
+    }
+
+    // Idle loop: with the stream scheduler a pass that finds no edge does
+    // no modeled I/O, so only the loop driver's pass charge moves the clock
+    // on to the next edge. Every sample must still be fused on its own.
+    uint64_t idleEndUs = simNowMicros() + (uint64_t)IDLE_LOOP_PERIODS * SAMPLE_PERIOD_US;
+    uint64_t idleSamplesBefore = simImu().stats().samplesGenerated;
+    long idleFusionsBefore = imuSensor.sumCount;
+    uint32_t idlePasses = 0;
+    while (simNowMicros() < idleEndUs && idlePasses < MAX_IDLE_PASSES)
+    {
+        uint64_t passStartUs = simNowMicros();
+        acquireDataReadySamples(NULL);
+        simChargeLoopPass(passStartUs);
+        idlePasses++;
+    }
+    uint64_t idleSamples = simImu().stats().samplesGenerated - idleSamplesBefore;
+    uint64_t idleFusions = (uint64_t)(imuSensor.sumCount - idleFusionsBefore);
+    bool idleOk = simNowMicros() >= idleEndUs && idleFusions + 1 >= idleSamples && idleFusions <= idleSamples + 1;
+    if (!idleOk)
+    {
+        fprintf(stderr, "IDLE loop: %llu fusions for %llu samples in %lu passes\n", (unsigned long long)idleFusions,
+                (unsigned long long)idleSamples, (unsigned long)idlePasses);
+    }
+
+    simImu().setSampleHook(NULL);
+    simImu().setInterruptHandler(NULL);
+
+    uint32_t dropped = dataReady.droppedEdges() - droppedBefore;
+    bool ok = wrongCounts == 0 && wrongFusions == 0 && wrongIntervals == 0 && wrongMissed == 0
+           && staleSamples == 0 && wrongSinks == 0 && dropped == edgesOverflowed && fusions > 0 && wrapped && idleOk;
+
+    beginCheckReport("data_ready", seed);
+    printf(",\"steps\":%lu,\"period_us\":%lu,\"queue\":%d,\"batch\":%d,",
+           (unsigned long)steps, (unsigned long)SAMPLE_PERIOD_US, DATA_READY_QUEUE_SIZE,
+           DATA_READY_MAX_BATCH);
+    for (int kind = 0; kind < STEP_KINDS; kind++)
+    {
+        printf("\"%s\":%lu,", kindNames[kind], (unsigned long)stepCount[kind]);
+    }
+    printf("\"edges_taken\":%llu,\"edges_masked\":%lu,\"edges_overflowed\":%lu,\"dropped_edges\":%lu,"
+           "\"fusions\":%llu,\"max_edges_per_pass\":%lu,\"periods_fused\":%llu,\"rereads\":%llu,\"split_reads\":%llu,"
+           "\"max_dt_error_s\":%.2e,\"wrapped\":%s,\"wrong_counts\":%lu,\"wrong_fusions\":%lu,"
+           "\"wrong_intervals\":%lu,\"wrong_missed\":%lu,\"stale_samples\":%lu,\"wrong_sinks\":%lu,"
+           "\"idle_loop\":{\"passes\":%lu,\"samples\":%llu,\"fusions\":%llu}",
+           (unsigned long long)edgesTaken, (unsigned long)edgesMasked, (unsigned long)edgesOverflowed,
+           (unsigned long)dropped, (unsigned long long)fusions, (unsigned long)maxEdgesPerPass,
+           (unsigned long long)periodsFused, (unsigned long long)rereads,
+           (unsigned long long)splitReads, maxDtErrorS, jsonBool(wrapped),
+           (unsigned long)wrongCounts, (unsigned long)wrongFusions, (unsigned long)wrongIntervals,
+           (unsigned long)wrongMissed, (unsigned long)staleSamples, (unsigned long)wrongSinks,
+           (unsigned long)idlePasses, (unsigned long long)idleSamples, (unsigned long long)idleFusions);
+    endCheckReport(ok);
+    return ok;
+}
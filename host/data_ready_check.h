@@ -0,0 +1,55 @@
+/**
+ * @file data_ready_check.h
+ * @brief Check of the data-ready scheduling path against the simulated MPU9250
+ *
+ * Switches the simulated INT pin to pulse mode with
+ * startDataReadyInterrupt(), as setup() does with DATA_READY_IRQ_ENABLED,
+ * then stands in for the data-ready ISR so edges can be disturbed: every
+ * edge is timestamped late by a random ISR latency below half a period,
+ * and the timestamps are offset so the 32-bit microsecond counter wraps
+ * early in the run. Each step advances virtual time and calls
+ * acquireDataReadySamples() once. Steps come in four kinds:
+ *
+ * - Steady: less than a period passes, so at most one edge is queued.
+ * - Masked: the next edges are lost, as with interrupts masked.
+ * - Backlog: several periods pass, so many edges, more than one
+ *   DATA_READY_MAX_BATCH, coalesce into one pass.
+ * - Overflow: more periods pass than the edge queue holds.
+ *
+ * Every pass that finds edges must take all of them and run exactly one
+ * fixed-step fusion over them. Its dt must cover the sample periods since
+ * the previously fused edge, so every period is integrated exactly once
+ * however edges were lost, and the registers it fused must hold the
+ * newest signalled sample or a later one. The scheduler's missed-period
+ * and dropped-edge counters must match the injected losses.
+ *
+ * A last part runs passes back to back as loop() does with the stream
+ * scheduler, where a pass that finds no edge does no modeled I/O: charged
+ * through simChargeLoopPass() like the simulator's loop, the clock must
+ * keep moving and every sample must be fused on its own.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef DATA_READY_CHECK_H
+#define DATA_READY_CHECK_H
+
+#include <stdint.h>
+
+// ============================================================================
+// DATA-READY CHECK
+// ============================================================================
+
+/**
+ * @brief Run the check and print one JSON line
+ *
+ * @param steps Steps of virtual time, each followed by one acquisition pass
+ * @param seed Random seed for the step kinds, lengths and ISR latencies
+ * @return true if every pass fused its edges once over the right interval
+ *         and the scheduler counters match the injected losses
+ */
+bool runDataReadyCheck(uint32_t steps, uint32_t seed);
+
+#endif // DATA_READY_CHECK_H
@@ -0,0 +1,274 @@
+/**
+ * @file feature_check.cpp
+ * @brief Randomized accuracy check of the windowed feature extractor
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "feature_check.h"
+#include "check_util.h"
+#include "feature_extractor.h"
+#include "real_fft.h"
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+// ============================================================================
+// CHECK PARAMETERS
+// ============================================================================
+
+// Random inputs per FFT length
+#define FFT_CHECK_ROUNDS 20
+
+// Largest spectrum error, relative to the signal's norm sqrt(N * sum x^2)
+#define FFT_TOLERANCE 1.0e-5
+
+// Largest feature error: mean, RMS and peak relative to the RMS, band
+// energies relative to the mean square
+#define FEATURE_TOLERANCE 1.0e-4
+
+// Share of a centered sine's A^2 / 2 its band may miss
+#define TONE_TOLERANCE 1.0e-3
+
+// ============================================================================
+// RANDOM SIGNALS
+// ============================================================================
+
+/**
+ * @brief One window from a randomly chosen class, in sensor-like units
+ */
+static void randomWindow(float* window, int length)
+{
+    double offset = uniform(-1500.0, 1500.0);
+    int kind = (int)(nextRandom() % 4);
+
+    for (int n = 0; n < length; n++)
+    {
+        window[n] = (float)offset;
+    }
+    if (kind == 0)
+    {
+        // Constant: no energy in any band
+        return;
+    }
+
+    int tones = 1 + (int)(nextRandom() % 3);
+    for (int t = 0; t < tones; t++)
+    {
+        double amplitude = uniform(0.0, 500.0);
+        double cycles = uniform(0.0, length / 2.0);
+        double phase = uniform(0.0, 2.0 * M_PI);
+        for (int n = 0; n < length; n++)
+        {
+            window[n] += (float)(amplitude * sin(2.0 * M_PI * cycles * n / length + phase));
+        }
+    }
+
+    double noise = (kind == 2) ? uniform(0.0, 50.0) : 0.0;
+    for (int n = 0; n < length; n++)
+    {
+        window[n] += (float)uniform(-noise, noise);
+    }
+
+    if (kind == 3)
+    {
+        // An impact
+        window[nextRandom() % length] += (float)uniform(-2000.0, 2000.0);
+    }
+}
+
+// ============================================================================
+// REFERENCE
+// ============================================================================
+
+/**
+ * @brief Direct DFT of a real sequence, bins 0..N/2
+ */
+static void referenceDft(const std::vector<double>& x, std::vector<double>& re, std::vector<double>& im)
+{
+    int length = (int)x.size();
+    re.assign(length / 2 + 1, 0.0);
+    im.assign(length / 2 + 1, 0.0);
+    for (int k = 0; k <= length / 2; k++)
+    {
+        for (int n = 0; n < length; n++)
+        {
+            // Reduce k * n first so the angle stays exact
+            double angle = -2.0 * M_PI * (double)(((int64_t)k * n) % length) / length;
+            re[k] += x[n] * cos(angle);
+            im[k] += x[n] * sin(angle);
+        }
+    }
+}
+
+/**
+ * @brief computeWindowFeatures() in double with the direct DFT
+ */
+static void referenceFeatures(const float* window, double* out)
+{
+    const int length = FEATURE_WINDOW_SAMPLES;
+    double sum = 0.0;
+    double sumSq = 0.0;
+    double peak = 0.0;
+
+    for (int n = 0; n < length; n++)
+    {
+        sum += window[n];
+        sumSq += (double)window[n] * window[n];
+        peak = fmax(peak, fabs((double)window[n]));
+    }
+    double mean = sum / length;
+    out[0] = mean;
+    out[1] = sqrt(sumSq / length);
+    out[2] = peak;
+
+    std::vector<double> x(length);
+    double windowPower = 0.0;
+    for (int n = 0; n < length; n++)
+    {
+        double w = 0.5 - 0.5 * cos(2.0 * M_PI * n / length);
+        x[n] = (window[n] - mean) * w;
+        windowPower += w * w;
+    }
+
+    std::vector<double> re;
+    std::vector<double> im;
+    referenceDft(x, re, im);
+
+    for (int band = 0; band < FEATURE_BAND_COUNT; band++)
+    {
+        double energy = 0.0;
+        for (int k = featureBandFirstBin(band); k < featureBandFirstBin(band + 1); k++)
+        {
+            double power = re[k] * re[k] + im[k] * im[k];
+            energy += (k == length / 2) ? power : 2.0 * power;
+        }
+        out[3 + band] = energy / (length * windowPower);
+    }
+}
+
+// ============================================================================
+// CHECKS
+// ============================================================================
+
+/**
+ * @brief Largest RealFft<N> error against the direct DFT
+ */
+template <int N>
+static double fftError(void)
+{
+    static RealFft<N> fft;
+    float data[N];
+    std::vector<double> x(N);
+    std::vector<double> re;
+    std::vector<double> im;
+    double worst = 0.0;
+
+    for (int round = 0; round < FFT_CHECK_ROUNDS; round++)
+    {
+        double norm = 0.0;
+        for (int n = 0; n < N; n++)
+        {
+            data[n] = (float)uniform(-1000.0, 1000.0);
+            x[n] = data[n];
+            norm += x[n] * x[n];
+        }
+        norm = sqrt(N * norm);
+
+        referenceDft(x, re, im);
+        fft.transform(data);
+
+        for (int k = 0; k <= N / 2; k++)
+        {
+            double gotRe = (k == 0) ? data[0] : (k == N / 2) ? data[1] : data[2 * k];
+            double gotIm = (k == 0 || k == N / 2) ? 0.0 : data[2 * k + 1];
+            double error = hypot(gotRe - re[k], gotIm - im[k]) / norm;
+            worst = fmax(worst, error);
+        }
+    }
+    return worst;
+}
+
+/**
+ * @brief Largest error of a sine at each band center against A^2 / 2
+ */
+static double toneError(void)
+{
+    float window[FEATURE_WINDOW_SAMPLES];
+    WindowFeatures features;
+    double worst = 0.0;
+
+    for (int band = 0; band < FEATURE_BAND_COUNT; band++)
+    {
+        // Integer bin in the middle of the band, away from its edges
+        int bin = (featureBandFirstBin(band) + featureBandFirstBin(band + 1) - 1) / 2;
+        double amplitude = 100.0;
+        for (int n = 0; n < FEATURE_WINDOW_SAMPLES; n++)
+        {
+            window[n] = (float)(amplitude * cos(2.0 * M_PI * bin * n / FEATURE_WINDOW_SAMPLES));
+        }
+
+        computeWindowFeatures(window, features);
+        double expected = amplitude * amplitude / 2.0;
+        worst = fmax(worst, fabs(features.bands[band] - expected) / expected);
+    }
+    return worst;
+}
+
+// ============================================================================
+// ENTRY POINT
+// ============================================================================
+
+bool runFeatureCheck(uint32_t windows, uint32_t seed)
+{
+    float window[FEATURE_WINDOW_SAMPLES];
+    double reference[FEATURE_VALUES];
+    WindowFeatures features;
+    double featureWorst = 0.0;
+    uint32_t failures = 0;
+
+    seedRandom(seed);
+
+    double fftWorst = fmax(fmax(fftError<8>(), fftError<64>()),
+                           fmax(fftError<FEATURE_WINDOW_SAMPLES>(), fftError<1024>()));
+
+    for (uint32_t w = 0; w < windows; w++)
+    {
+        randomWindow(window, FEATURE_WINDOW_SAMPLES);
+        referenceFeatures(window, reference);
+        computeWindowFeatures(window, features);
+
+        const float got[3] = {features.mean, features.rms, features.peak};
+        double scale = fmax(reference[1], 1.0);
+        double windowWorst = 0.0;
+        for (int i = 0; i < 3; i++)
+        {
+            windowWorst = fmax(windowWorst, fabs(got[i] - reference[i]) / scale);
+        }
+        for (int band = 0; band < FEATURE_BAND_COUNT; band++)
+        {
+            windowWorst = fmax(windowWorst, fabs(features.bands[band] - reference[3 + band]) / (scale * scale));
+        }
+
+        if (windowWorst > FEATURE_TOLERANCE)
+        {
+            reportFailure(failures, "MISMATCH window %lu: error %.3g (mean %.3f rms %.3f)",
+                          (unsigned long)w, windowWorst, reference[0], reference[1]);
+        }
+        featureWorst = fmax(featureWorst, windowWorst);
+    }
+
+    double toneWorst = toneError();
+
+    bool ok = failures == 0 && fftWorst <= FFT_TOLERANCE && toneWorst <= TONE_TOLERANCE;
+    beginCheckReport("features", seed);
+    printf(",\"windows\":%lu,\"window_samples\":%d,\"bands\":%d,"
+           "\"fft_max_error\":%.3g,\"feature_max_error\":%.3g,\"tone_max_error\":%.3g,"
+           "\"failures\":%lu",
+           (unsigned long)windows, FEATURE_WINDOW_SAMPLES, FEATURE_BAND_COUNT,
+           fftWorst, featureWorst, toneWorst, (unsigned long)failures);
+    endCheckReport(ok);
+    return ok;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file feature_check.h
+ * @brief Randomized accuracy check of the windowed feature extractor
+ *
+ * Compares RealFft (real_fft.h) at several lengths with a direct DFT in
+ * double precision, then reduces random windows (offset, sines, noise,
+ * impulses, constant signals) with computeWindowFeatures() and checks
+ * every feature against the same computation in double with the direct
+ * DFT. Finally a sine at the center of each band has to put its A^2 / 2
+ * into that band.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef FEATURE_CHECK_H
+#define FEATURE_CHECK_H
+
+#include <stdint.h>
+
+// ============================================================================
+// FEATURE CHECK
+// ============================================================================
+
+/**
+ * @brief Run the check and print one JSON line
+ *
+ * @param windows Random windows to compare
+ * @param seed Random seed for the signals
+ * @return true if every error stayed within its tolerance
+ */
+bool runFeatureCheck(uint32_t windows, uint32_t seed);
+
+#endif // FEATURE_CHECK_H
@@ -0,0 +1,210 @@
+/**
+ * @file fifo_check.cpp
+ * @brief Check of the FIFO batch reader against the simulated MPU9250 FIFO
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "fifo_check.h"
+#include "check_util.h"
+#include "imu_sensor.h"
+#include "sim_imu.h"
+#include "sim_clock.h"
+#include "config.h"
+#include <deque>
+#include <stdio.h>
+#include <string.h>
+
+// ============================================================================
+// CHECK PARAMETERS
+// ============================================================================
+
+#define SAMPLE_PERIOD_US (1000000UL / IMU_SAMPLE_RATE_HZ)
+
+// Whole frames the FIFO holds
+#define FIFO_FRAMES (IMU_FIFO_CAPACITY / IMU_FIFO_FRAME_SIZE)
+
+// Step lengths in sample periods: steady steps stay well inside the FIFO,
+// stalls run well past it
+#define MAX_STEADY_PERIODS (FIFO_FRAMES * 3 / 4)
+#define MIN_STALL_PERIODS (FIFO_FRAMES + 8)
+#define MAX_STALL_PERIODS (3 * FIFO_FRAMES)
+
+// Per mille of steps that stall or push a partial frame
+#define STALL_PER_MILLE 100
+#define PARTIAL_PER_MILLE 100
+
+// Reads per drain before the FIFO is taken to never empty
+#define MAX_DRAIN_READS 64
+
+// ============================================================================
+// DEVICE HISTORY
+// ============================================================================
+
+// Samples the device produced and the reader has not yet returned or lost
+static std::deque<SimSampleTruth> produced;
+
+static void recordSample(const SimSampleTruth& sample)
+{
+    produced.push_back(sample);
+}
+
+static bool countsEqual(const int16_t* a, const int16_t* b)
+{
+    return a[0] == b[0] && a[1] == b[1] && a[2] == b[2];
+}
+
+/**
+ * @brief Position of frame @p index of @p batch in the history, or -1
+ */
+static long findSample(const FifoBatch& batch, int index)
+{
+    for (size_t k = 0; k < produced.size(); k++)
+    {
+        if (countsEqual(produced[k].accel, batch.accelCount[index])
+            && countsEqual(produced[k].gyro, batch.gyroCount[index]))
+        {
+            return (long)k;
+        }
+    }
+    return -1;
+}
+
+// ============================================================================
+// FIFO CHECK
+// ============================================================================
+
+enum StepKind
+{
+    STEP_STEADY = 0,
+    STEP_STALL,
+    STEP_PARTIAL,
+    STEP_KINDS
+};
+
+bool runFifoCheck(uint32_t steps, uint32_t seed)
+{
+    static const char* kindNames[STEP_KINDS] = {"steady", "stall", "partial"};
+    uint32_t stepCount[STEP_KINDS] = {0, 0, 0};
+    uint32_t wrongResets[STEP_KINDS] = {0, 0, 0};
+
+    uint64_t framesRead = 0;
+    uint64_t samplesLost = 0;
+    uint32_t corrupt = 0;               ///< Frames matching no pending sample
+    uint32_t unexplainedLosses = 0;     ///< Samples skipped without a reset
+    uint32_t lateFrames = 0;            ///< Timestamps more than two periods off
+    uint32_t undrained = 0;
+    uint32_t maxTimestampErrorUs = 0;
+    uint32_t maxBatch = 0;
+
+    seedRandom(seed);
+
+    // The device as setup() leaves it in FIFO mode
+    initializeIMU();
+    produced.clear();
+    simImu().setSampleHook(recordSample);
+    enableFifoAcquisition();
+    uint64_t deviceOverflowsBefore = simImu().stats().fifoOverflows;
+
+    // Samples from before the enable never reach the FIFO
+    bool resetSinceMatch = true;
+    for (uint32_t step = 0; step < steps; step++)
+    {
+        uint32_t roll = nextRandom() % 1000;
+        StepKind kind = (roll < STALL_PER_MILLE) ? STEP_STALL
+                      : (roll < STALL_PER_MILLE + PARTIAL_PER_MILLE) ? STEP_PARTIAL : STEP_STEADY;
+        stepCount[kind]++;
+
+        uint32_t periods = (kind == STEP_STALL)
+                         ? MIN_STALL_PERIODS + nextRandom() % (MAX_STALL_PERIODS - MIN_STALL_PERIODS)
+                         : 1 + nextRandom() % MAX_STEADY_PERIODS;
+        if (kind == STEP_PARTIAL)
+        {
+            simImu().advance();
+            simImu().injectFifoBytes(1 + nextRandom() % (IMU_FIFO_FRAME_SIZE - 1));
+        }
+        simAdvanceMicros((uint64_t)periods * SAMPLE_PERIOD_US + nextRandom() % SAMPLE_PERIOD_US);
+
+        uint32_t resetsBefore = fifoOverflowCount();
+        int reads = 0;
+        for (; reads < MAX_DRAIN_READS; reads++)
+        {
+            FifoBatch batch;
+            uint32_t overflowsBefore = fifoOverflowCount();
+            int frames = readFifoBatch(batch);
+            if (fifoOverflowCount() != overflowsBefore)
+            {
+                resetSinceMatch = true;
+                continue;
+            }
+            if (frames == 0)
+            {
+                break;
+            }
+
+            framesRead += frames;
+            maxBatch = ((uint32_t)frames > maxBatch) ? (uint32_t)frames : maxBatch;
+            for (int i = 0; i < frames; i++)
+            {
+                long k = findSample(batch, i);
+                if (k < 0)
+                {
+                    reportFailure(corrupt, "CORRUPT step %lu frame %d: accel %d,%d,%d matches no sample",
+                                  (unsigned long)step, i, batch.accelCount[i][0], batch.accelCount[i][1],
+                                  batch.accelCount[i][2]);
+                    continue;
+                }
+
+                if (k > 0 && !resetSinceMatch)
+                {
+                    reportFailure(unexplainedLosses, "LOST step %lu: %ld samples skipped without a reset",
+                                  (unsigned long)step, k);
+                }
+                samplesLost += (uint64_t)k;
+                resetSinceMatch = false;
+
+                uint32_t sampleUs = (uint32_t)produced[k].timeUs;
+                int32_t error = (int32_t)(batch.timestampUs[i] - sampleUs);
+                uint32_t magnitude = (uint32_t)((error < 0) ? -error : error);
+                maxTimestampErrorUs = (magnitude > maxTimestampErrorUs) ? magnitude : maxTimestampErrorUs;
+                lateFrames += (magnitude > 2 * SAMPLE_PERIOD_US) ? 1 : 0;
+
+                produced.erase(produced.begin(), produced.begin() + k + 1);
+            }
+        }
+        undrained += (reads == MAX_DRAIN_READS) ? 1 : 0;
+
+        uint32_t resets = fifoOverflowCount() - resetsBefore;
+        uint32_t expectedResets = (kind == STEP_STEADY) ? 0 : 1;
+        if (resets != expectedResets)
+        {
+            reportFailure(wrongResets[kind], "RESET %s step %lu: %lu resets, expected %lu", kindNames[kind],
+                          (unsigned long)step, (unsigned long)resets, (unsigned long)expectedResets);
+        }
+    }
+    simImu().setSampleHook(NULL);
+
+    uint64_t deviceOverflows = simImu().stats().fifoOverflows - deviceOverflowsBefore;
+    bool ok = corrupt == 0 && unexplainedLosses == 0 && lateFrames == 0 && undrained == 0
+           && wrongResets[STEP_STEADY] == 0 && wrongResets[STEP_STALL] == 0 && wrongResets[STEP_PARTIAL] == 0
+           && framesRead > 0;
+
+    beginCheckReport("fifo", seed);
+    printf(",\"steps\":%lu,\"frame_bytes\":%d,\"capacity_frames\":%d,",
+           (unsigned long)steps, IMU_FIFO_FRAME_SIZE, FIFO_FRAMES);
+    for (int kind = 0; kind < STEP_KINDS; kind++)
+    {
+        printf("\"%s\":{\"steps\":%lu,\"wrong_resets\":%lu},", kindNames[kind], (unsigned long)stepCount[kind],
+               (unsigned long)wrongResets[kind]);
+    }
+    printf("\"frames_read\":%llu,\"max_batch\":%lu,\"samples_lost\":%llu,\"device_overflow_bytes\":%llu,"
+           "\"corrupt\":%lu,\"unexplained_losses\":%lu,\"max_timestamp_error_us\":%lu,\"late_frames\":%lu,"
+           "\"undrained\":%lu",
+           (unsigned long long)framesRead, (unsigned long)maxBatch, (unsigned long long)samplesLost,
+           (unsigned long long)deviceOverflows, (unsigned long)corrupt, (unsigned long)unexplainedLosses,
+           (unsigned long)maxTimestampErrorUs, (unsigned long)lateFrames, (unsigned long)undrained);
+    endCheckReport(ok);
+    return ok;
+}
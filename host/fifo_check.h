@@ -0,0 +1,47 @@
+/**
+ * @file fifo_check.h
+ * @brief Check of the FIFO batch reader against the simulated MPU9250 FIFO
+ *
+ * Enables FIFO acquisition as setup() does with IMU_FIFO_MODE_ENABLED and
+ * runs the given number of steps. Each step advances virtual time, then
+ * drains the FIFO with readFifoBatch() until it returns no frames. Steps
+ * come in three kinds:
+ *
+ * - Steady: less time than the FIFO holds, so every frame arrives.
+ * - Stall: more time than the FIFO holds; the device overwrites its
+ *   oldest bytes and FIFO_COUNT stops at the 512-byte capacity.
+ * - Partial: part of a frame is pushed before the step's samples, as a
+ *   count read racing the device's frame write sees, so FIFO_COUNT is
+ *   not a multiple of the 12-byte frame.
+ *
+ * Every frame read must equal, count for count, a sample the device
+ * produced, in production order, with its reconstructed timestamp within
+ * two sample periods of the sample time. Samples may only go missing
+ * across a FIFO reset, and the reader must reset and count an overflow
+ * exactly once per stall or partial step and never in a steady one.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef FIFO_CHECK_H
+#define FIFO_CHECK_H
+
+#include <stdint.h>
+
+// ============================================================================
+// FIFO CHECK
+// ============================================================================
+
+/**
+ * @brief Run the check and print one JSON line
+ *
+ * @param steps Steps of virtual time, each followed by a drain
+ * @param seed Random seed for the step kinds and lengths
+ * @return true if no frame was corrupt, misordered or lost without a reset,
+ *         and every reset was expected
+ */
+bool runFifoCheck(uint32_t steps, uint32_t seed);
+
+#endif // FIFO_CHECK_H
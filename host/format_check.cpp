@@ -0,0 +1,214 @@
+/**
+ * @file format_check.cpp
+ * @brief Randomized exactness check of the CSV record formatter
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "format_check.h"
+#include "check_util.h"
+#include "record_format.h"
+#include "sd_logger.h"
+#include "hal.h"
+#include <math.h>
+#include <vector>
+
+// ============================================================================
+// CHECK PARAMETERS
+// ============================================================================
+
+#define CHECK_DIRECTORY "/format_check"
+#define CHECK_RECORD_FILE CHECK_DIRECTORY "/record.txt"
+#define CHECK_PRINTF_FILE CHECK_DIRECTORY "/printf.txt"
+
+// Room for any snprintf reference line, untruncated
+#define REFERENCE_SIZE 256
+
+// ============================================================================
+// RANDOM VALUES
+// ============================================================================
+
+/**
+ * @brief One value from a randomly chosen class
+ */
+static float randomValue(void)
+{
+    float value;
+    uint32_t bits = nextRandom();
+
+    switch (nextRandom() % 6)
+    {
+        case 0:
+            // Any bit pattern: NaN, infinity, subnormals, snprintf fallback
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+
+        case 1:
+            // Sensor ranges: mg, deg/s, mG, quaternion, degrees
+            value = uniform(-1.0f, 1.0f);
+            return value * powf(10.0f, (float)(nextRandom() % 6));
+
+        case 2:
+        {
+            // Exact ties: odd multiples of 2^-n with more than 6 decimals
+            int n = 7 + (int)(nextRandom() % 24);
+            int32_t k = (int32_t)(bits % 2000001u) - 1000000;
+            return ldexpf((float)(k | 1), -n);
+        }
+
+        case 3:
+        {
+            // One ulp around a rounding boundary of the sixth decimal
+            double boundary = ((double)((int32_t)(bits % 20000001u) - 10000000) + 0.5) / 1000000.0;
+            value = (float)boundary;
+            int step = (int)(nextRandom() % 3) - 1;
+            return (step == 0) ? value : nextafterf(value, step * INFINITY);
+        }
+
+        case 4:
+            // Values that round to zero, both signs
+            value = uniform(-2.0e-6f, 2.0e-6f);
+            return (nextRandom() & 1) ? value : ldexpf(value, -(int)(nextRandom() % 140));
+
+        default:
+            // Large magnitudes around the integer path limit (2^34)
+            return ldexpf(uniform(-1.0f, 1.0f), 20 + (int)(nextRandom() % 20));
+    }
+}
+
+static uint32_t randomTimestamp(void)
+{
+    switch (nextRandom() % 4)
+    {
+        case 0:  return 0;
+        case 1:  return 0xFFFFFFFFu - (nextRandom() % 10);
+        case 2:  return nextRandom() % 100000;
+        default: return nextRandom();
+    }
+}
+
+// ============================================================================
+// REFERENCE
+// ============================================================================
+
+/**
+ * @brief The record as the logger's snprintf formats produced it
+ */
+static int referenceRecord(char* out, uint32_t timestampMs, const float* v, uint8_t count)
+{
+    unsigned long t = timestampMs;
+    if (count == 3)
+    {
+        return snprintf(out, REFERENCE_SIZE, "\r\n%lu,%lf,%lf,%lf", t, v[0], v[1], v[2]);
+    }
+    return snprintf(out, REFERENCE_SIZE, "\r\n%lu,%lf,%lf,%lf,%lf", t, v[0], v[1], v[2], v[3]);
+}
+
+static void reportMismatch(uint32_t& mismatches, const char* what, const char* want, size_t wantLength,
+                           const char* got, size_t gotLength)
+{
+    reportFailure(mismatches, "MISMATCH %s: expected \"%.*s\" got \"%.*s\"", what,
+                  (int)wantLength, want, (int)gotLength, got);
+}
+
+/**
+ * @brief Read a whole host file through the storage root
+ */
+static bool loadFile(const char* path, std::vector<uint8_t>& data)
+{
+    File file = halStorage().open(path, FILE_READ);
+    if (!file)
+    {
+        return false;
+    }
+    data.resize(file.size());
+    size_t got = file.read(data.data(), data.size());
+    file.close();
+    return got == data.size();
+}
+
+// ============================================================================
+// ENTRY POINT
+// ============================================================================
+
+bool runFormatCheck(uint32_t records, uint32_t seed)
+{
+    char want[REFERENCE_SIZE];
+    char got[CSV_RECORD_MAX_SIZE + 1];
+    uint32_t mismatches = 0;
+    uint64_t values = 0;
+    LogStream recordLog;
+    LogStream printfLog;
+
+    seedRandom(seed);
+    halStorage().mkdir(CHECK_DIRECTORY);
+    if (!recordLog.begin(halStorage(), CHECK_RECORD_FILE, "t,a,b,c")
+        || !printfLog.begin(halStorage(), CHECK_PRINTF_FILE, "t,a,b,c"))
+    {
+        fprintf(stderr, "ERROR: Cannot open %s\n", CHECK_DIRECTORY);
+        return false;
+    }
+
+    for (uint32_t r = 0; r < records; r++)
+    {
+        float v[CSV_RECORD_MAX_VALUES];
+        uint8_t count = (nextRandom() & 1) ? 3 : 4;
+        uint32_t timestamp = randomTimestamp();
+        for (uint8_t i = 0; i < count; i++)
+        {
+            v[i] = randomValue();
+        }
+        values += count;
+
+        // Whole records
+        int wantLength = referenceRecord(want, timestamp, v, count);
+        size_t gotLength = formatCsvRecord(got, timestamp, v, count);
+        if (gotLength != (size_t)wantLength || memcmp(got, want, gotLength) != 0)
+        {
+            reportMismatch(mismatches, "record", want, wantLength, got, gotLength);
+        }
+        recordLog.printRecord(timestamp, v, count);
+        printfLog.print(want);
+
+        // Single values at every precision
+        uint8_t decimals = (uint8_t)(nextRandom() % (RECORD_MAX_DECIMALS + 1));
+        wantLength = snprintf(want, REFERENCE_SIZE, "%.*f", (int)decimals, (double)v[0]);
+        gotLength = (size_t)(appendFixed(got, v[0], decimals) - got);
+        if (gotLength != (size_t)wantLength || memcmp(got, want, gotLength) != 0)
+        {
+            reportMismatch(mismatches, "value", want, wantLength, got, gotLength);
+        }
+    }
+
+    // Columns without a timestamp (diagnostics.txt)
+    float diagnostics[4] = {0.5f, -0.0f, 1234.5678f, 1.18359375f};
+    int wantLength = snprintf(want, REFERENCE_SIZE, "\r\n%lf,%lf,%lf,%lf",
+                              diagnostics[0], diagnostics[1], diagnostics[2], diagnostics[3]);
+    size_t gotLength = formatCsvValues(got, diagnostics, 4);
+    if (gotLength != (size_t)wantLength || memcmp(got, want, gotLength) != 0)
+    {
+        reportMismatch(mismatches, "values", want, wantLength, got, gotLength);
+    }
+
+    recordLog.close();
+    printfLog.close();
+
+    std::vector<uint8_t> recordData;
+    std::vector<uint8_t> printfData;
+    bool streamMatch = loadFile(CHECK_RECORD_FILE, recordData) && loadFile(CHECK_PRINTF_FILE, printfData)
+                       && recordData == printfData;
+    halStorage().remove(CHECK_RECORD_FILE);
+    halStorage().remove(CHECK_PRINTF_FILE);
+
+    bool ok = mismatches == 0 && streamMatch;
+    beginCheckReport("record_format", seed);
+    printf(",\"records\":%lu,\"values\":%llu,"
+           "\"mismatches\":%lu,\"stream_bytes\":%lu,\"stream_match\":%s",
+           (unsigned long)records, (unsigned long long)values,
+           (unsigned long)mismatches, (unsigned long)recordData.size(),
+           jsonBool(streamMatch));
+    endCheckReport(ok);
+    return ok;
+}
@@ -0,0 +1,37 @@
+/**
+ * @file format_check.h
+ * @brief Randomized exactness check of the CSV record formatter
+ *
+ * Formats random records with formatCsvRecord()/appendFixed() and with the
+ * snprintf formats the logger used before record_format.h, and requires
+ * identical bytes. Values mix random bit patterns (NaN, infinity,
+ * subnormals and the snprintf fallback range included), sensor-range
+ * values, exact rounding ties and floats one ulp around a rounding
+ * boundary. The same records are then logged through
+ * LogStream::printRecord() and through LogStream::print() of the snprintf
+ * text, and the two files have to match, block boundaries included.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef FORMAT_CHECK_H
+#define FORMAT_CHECK_H
+
+#include <stdint.h>
+
+// ============================================================================
+// FORMAT CHECK
+// ============================================================================
+
+/**
+ * @brief Run the check in the storage root and print one JSON line
+ *
+ * @param records Random records to compare
+ * @param seed Random seed for the values
+ * @return true if every record and both log files matched
+ */
+bool runFormatCheck(uint32_t records, uint32_t seed);
+
+#endif // FORMAT_CHECK_H
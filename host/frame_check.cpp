@@ -0,0 +1,572 @@
+/**
+ * @file frame_check.cpp
+ * @brief Round-trip check of the binary log frame (log_record.h)
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "frame_check.h"
+#include "check_util.h"
+#include "log_record.h"
+#include "data_processor.h"
+#include "imu_sensor.h"
+#include "calibration.h"
+#include "sim_clock.h"
+#include "config.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+// ============================================================================
+// CHECK PARAMETERS
+// ============================================================================
+
+#define SAMPLE_PERIOD_US (1000000UL / IMU_SAMPLE_RATE_HZ)
+
+// CSV columns against frameSensors(): the scaling table folds the mag
+// factors into one matrix, so its rounding differs from the unfolded form
+#define ACCEL_TOLERANCE_MG 1e-4f
+#define GYRO_TOLERANCE_DPS 1e-5f
+#define MAG_TOLERANCE_MG 1e-3f
+
+// frameSensors() against doubles, relative to the sum of the term magnitudes
+#define RELATIVE_TOLERANCE 1e-5
+
+// Random part: per mille of frames that keep the previous frame's scale
+#define SAME_SCALE_PER_MILLE 500
+
+// Resync stream: per mille of frames that start a new scale, and of
+// records with a flipped byte, cut short, or preceded by junk (which may
+// hold stray sync words and headers)
+#define SCALE_CHANGE_PER_MILLE 125
+#define FLIPPED_PER_MILLE 150
+#define TRUNCATED_PER_MILLE 100
+#define JUNK_PER_MILLE 200
+#define MAX_JUNK_BYTES 300
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+/**
+ * @brief Bitwise CRC-16/CCITT-FALSE, the reference for crc16Ccitt()
+ */
+static uint16_t referenceCrc(const uint8_t* data, size_t length)
+{
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++)
+    {
+        crc ^= (uint16_t)(data[i] << 8);
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief Trailer of the @p size byte record @p encoded differs from the reference CRC of the bytes before it
+ */
+static bool badTrailer(const uint8_t* encoded, size_t size)
+{
+    uint16_t stored = (uint16_t)(encoded[size - 2] | (encoded[size - 1] << 8));
+    return stored != referenceCrc(encoded, size - 2);
+}
+
+/**
+ * @brief Both scales have the same bits
+ */
+static bool sameScale(const FrameScale& a, const FrameScale& b)
+{
+    float scalesA[FRAME_SCALE_FLOATS];
+    float scalesB[FRAME_SCALE_FLOATS];
+    gatherFrameScale(a, scalesA);
+    gatherFrameScale(b, scalesB);
+    return memcmp(scalesA, scalesB, sizeof(scalesA)) == 0;
+}
+
+/**
+ * @brief Every field of @p a and @p b has the same bits
+ */
+static bool sameFrame(const ImuFrame& a, const ImuFrame& b)
+{
+    return a.timestampMs == b.timestampMs
+        && memcmp(a.accelCount, b.accelCount, sizeof(a.accelCount)) == 0
+        && memcmp(a.gyroCount, b.gyroCount, sizeof(a.gyroCount)) == 0
+        && memcmp(a.magCount, b.magCount, sizeof(a.magCount)) == 0
+        && memcmp(a.q, b.q, sizeof(a.q)) == 0
+        && sameScale(a.scale, b.scale);
+}
+
+/**
+ * @brief Encode @p frame as logBinarySample() does and decode it again
+ *
+ * A scale record goes first when the frame's scale differs from the one
+ * in force; both records pass through the reader state.
+ *
+ * @return true if every record decoded and the frame came back as FRAME_OK
+ */
+static bool roundTrip(const ImuFrame& frame, FrameScaleState& writer, FrameScaleState& reader,
+                      ImuFrame& decoded, uint32_t& scaleRecords, uint32_t& crcErrors)
+{
+    uint8_t encoded[LOG_RECORD_MAX_SIZE];
+    size_t recordBytes;
+
+    if (frameScaleChanged(writer, frame.scale))
+    {
+        encodeScaleRecord(frame.scale, writer, encoded);
+        crcErrors += badTrailer(encoded, LOG_SCALE_RECORD_SIZE) ? 1 : 0;
+        scaleRecords++;
+        if (decodeLogRecord(encoded, LOG_SCALE_RECORD_SIZE, reader, decoded, recordBytes) != FRAME_SCALE
+            || recordBytes != LOG_SCALE_RECORD_SIZE)
+        {
+            return false;
+        }
+    }
+
+    encodeImuFrame(frame, writer, encoded);
+    crcErrors += badTrailer(encoded, LOG_FRAME_SIZE) ? 1 : 0;
+    return decodeLogRecord(encoded, LOG_FRAME_SIZE, reader, decoded, recordBytes) == FRAME_OK
+        && recordBytes == LOG_FRAME_SIZE;
+}
+
+static float maxError(const float* a, const float* b, int count, float scale)
+{
+    float error = 0.0f;
+    for (int i = 0; i < count; i++)
+    {
+        error = fmaxf(error, fabsf(scale * a[i] - scale * b[i]));
+    }
+    return error;
+}
+
+// ============================================================================
+// DEVICE PART
+// ============================================================================
+
+struct DevicePart
+{
+    uint32_t mismatches;        ///< Decoded fields differ from the sample's
+    uint32_t csvMismatches;     ///< frameSensors() outside the tolerance of the CSV columns
+    uint32_t scaleRecords;
+    uint32_t crcErrors;
+    float accelErrorMg;
+    float gyroErrorDps;
+    float magErrorMg;
+};
+
+static void runDevicePart(uint32_t frames, DevicePart& part)
+{
+    FrameScaleState writer;
+    FrameScaleState reader;
+
+    memset(&part, 0, sizeof(part));
+    resetFrameScaleState(writer);
+    resetFrameScaleState(reader);
+
+    // The device as setup() leaves it
+    beginCalibration();
+    initializeIMU();
+    initializeMagnetometer();
+
+    for (uint32_t n = 0; n < frames; n++)
+    {
+        simAdvanceMicros(SAMPLE_PERIOD_US);
+        readIMUData();
+        fuseFixedStep(1.0f / IMU_SAMPLE_RATE_HZ);
+
+        ImuSample sample;
+        ImuFrame frame;
+        ImuFrame decoded;
+
+        captureSample(sample);
+        sampleFrame(sample, frame);
+
+        if (!roundTrip(frame, writer, reader, decoded, part.scaleRecords, part.crcErrors)
+            || !sameFrame(frame, decoded))
+        {
+            reportFailure(part.mismatches, "MISMATCH device frame %lu does not decode to itself", (unsigned long)n);
+            continue;
+        }
+
+        // The columns CsvSink writes for the sample (mag in AK8963 order)
+        const float accelCsv[3] = {sample.ax, sample.ay, sample.az};
+        const float gyroCsv[3] = {sample.gx, sample.gy, sample.gz};
+        const float magCsv[3] = {sample.my, sample.mx, sample.mz};
+        float accel[3], gyro[3], mag[3];
+        frameSensors(decoded, accel, gyro, mag);
+
+        float accelError = maxError(accel, accelCsv, 3, 1000.0f);
+        float gyroError = maxError(gyro, gyroCsv, 3, 1.0f);
+        float magError = maxError(mag, magCsv, 3, 1.0f);
+        part.accelErrorMg = fmaxf(part.accelErrorMg, accelError);
+        part.gyroErrorDps = fmaxf(part.gyroErrorDps, gyroError);
+        part.magErrorMg = fmaxf(part.magErrorMg, magError);
+
+        if (accelError > ACCEL_TOLERANCE_MG || gyroError > GYRO_TOLERANCE_DPS || magError > MAG_TOLERANCE_MG)
+        {
+            reportFailure(part.csvMismatches, "MISMATCH device frame %lu: CSV errors %g mg, %g dps, %g mG",
+                          (unsigned long)n, accelError, gyroError, magError);
+        }
+    }
+}
+
+// ============================================================================
+// RANDOM PART
+// ============================================================================
+
+static void randomFrame(ImuFrame& frame, uint32_t timestampMs)
+{
+    static const float accelRanges[] = {2.0f, 4.0f, 8.0f, 16.0f};
+    static const float gyroRanges[] = {250.0f, 500.0f, 1000.0f, 2000.0f};
+    FrameScale& scale = frame.scale;
+
+    frame.timestampMs = timestampMs;
+    for (int i = 0; i < 3; i++)
+    {
+        frame.accelCount[i] = (int16_t)nextRandom();
+        frame.gyroCount[i] = (int16_t)nextRandom();
+        frame.magCount[i] = (int16_t)nextRandom();
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        frame.q[i] = uniform(-1.0f, 1.0f);
+    }
+
+    scale.aRes = accelRanges[nextRandom() % 4] / 32768.0f;
+    scale.gRes = gyroRanges[nextRandom() % 4] / 32768.0f;
+    scale.mRes = (nextRandom() & 1) ? 10.0f * 4912.0f / 32760.0f : 10.0f * 4912.0f / 8190.0f;
+    for (int i = 0; i < 3; i++)
+    {
+        scale.magCalibration[i] = uniform(0.9f, 1.3f);
+        scale.magbias[i] = uniform(-500.0f, 500.0f);
+        scale.gyroBias[i] = uniform(-5.0f, 5.0f);
+        for (int j = 0; j < 3; j++)
+        {
+            scale.magMatrix[i][j] = (i == j) ? uniform(0.8f, 1.2f) : uniform(-0.2f, 0.2f);
+        }
+    }
+}
+
+/**
+ * @brief Largest error of frameSensors() against doubles, relative to the term magnitudes
+ */
+static double sensorError(const ImuFrame& frame)
+{
+    const FrameScale& s = frame.scale;
+    float accel[3], gyro[3], mag[3];
+    double field[3];
+    double error = 0.0;
+
+    frameSensors(frame, accel, gyro, mag);
+    for (int i = 0; i < 3; i++)
+    {
+        field[i] = (double)frame.magCount[i] * s.mRes * s.magCalibration[i] - s.magbias[i];
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        double a = (double)frame.accelCount[i] * s.aRes;
+        double g = (double)frame.gyroCount[i] * s.gRes - s.gyroBias[i];
+        error = fmax(error, fabs(accel[i] - a) / (fabs(a) + 1.0));
+        error = fmax(error, fabs(gyro[i] - g) / (fabs(frame.gyroCount[i] * s.gRes) + fabs(s.gyroBias[i]) + 1.0));
+
+        double m = 0.0;
+        double magnitude = 1.0;
+        for (int j = 0; j < 3; j++)
+        {
+            m += s.magMatrix[i][j] * field[j];
+            magnitude += fabs(s.magMatrix[i][j])
+                       * (fabs((double)frame.magCount[j] * s.mRes * s.magCalibration[j]) + fabs(s.magbias[j]));
+        }
+        error = fmax(error, fabs(mag[i] - m) / magnitude);
+    }
+    return error;
+}
+
+struct RandomPart
+{
+    uint32_t mismatches;
+    uint32_t sensorMismatches;
+    uint32_t scaleRecords;
+    uint32_t crcErrors;
+    double maxRelativeError;
+};
+
+static void runRandomPart(uint32_t frames, RandomPart& part)
+{
+    FrameScaleState writer;
+    FrameScaleState reader;
+    FrameScale previous;
+
+    memset(&part, 0, sizeof(part));
+    resetFrameScaleState(writer);
+    resetFrameScaleState(reader);
+    identityFrameScale(previous);
+
+    for (uint32_t n = 0; n < frames; n++)
+    {
+        ImuFrame frame;
+        ImuFrame decoded;
+
+        // Frames that share a scale must pick it up from the reader state
+        randomFrame(frame, nextRandom());
+        if (n > 0 && nextRandom() % 1000 < SAME_SCALE_PER_MILLE)
+        {
+            frame.scale = previous;
+        }
+        previous = frame.scale;
+
+        if (!roundTrip(frame, writer, reader, decoded, part.scaleRecords, part.crcErrors)
+            || !sameFrame(frame, decoded))
+        {
+            reportFailure(part.mismatches, "MISMATCH random frame %lu does not decode to itself", (unsigned long)n);
+            continue;
+        }
+
+        double error = sensorError(decoded);
+        part.maxRelativeError = fmax(part.maxRelativeError, error);
+        if (error > RELATIVE_TOLERANCE)
+        {
+            reportFailure(part.sensorMismatches, "MISMATCH random frame %lu: frameSensors() relative error %g",
+                          (unsigned long)n, error);
+        }
+    }
+}
+
+// ============================================================================
+// RESYNC PART
+// ============================================================================
+
+struct ResyncPart
+{
+    uint32_t intact;
+    uint32_t scaleRecords;
+    uint32_t flipped;           ///< Records, frames or scale records, with a flipped byte
+    uint32_t truncated;
+    uint32_t junkBytes;
+    uint32_t recovered;         ///< Frames decoded with a scale
+    uint32_t unscaled;          ///< Intact frames reported without one
+    uint32_t rejected;          ///< Candidates with a sync word that failed the check
+    uint32_t missing;           ///< Intact frames not recovered
+    uint32_t spurious;          ///< Recovered frames that were not written intact
+    uint32_t wrongScale;        ///< Frames recovered with another scale, or none, than expected
+};
+
+/**
+ * @brief An intact frame in the resync stream
+ */
+struct WrittenFrame
+{
+    uint32_t timestampMs;
+    bool scaled;                ///< Its scale record is intact too
+    FrameScale scale;
+};
+
+/**
+ * @brief Junk between records: random bytes, stray sync words and record headers
+ */
+static void appendJunk(std::vector<uint8_t>& stream, uint32_t bytes)
+{
+    for (uint32_t i = 0; i < bytes; i++)
+    {
+        uint32_t kind = nextRandom() % 16;
+        if (kind == 0 && i + 4 <= bytes)
+        {
+            // Header of a record that never follows
+            stream.push_back(LOG_FRAME_MAGIC & 0xFF);
+            stream.push_back(LOG_FRAME_MAGIC >> 8);
+            stream.push_back(LOG_FRAME_VERSION);
+            stream.push_back((nextRandom() & 1) ? LOG_FRAME_SIZE : LOG_SCALE_RECORD_SIZE);
+            i += 3;
+        }
+        else if (kind == 1)
+        {
+            stream.push_back((nextRandom() & 1) ? (LOG_FRAME_MAGIC & 0xFF) : (LOG_FRAME_MAGIC >> 8));
+        }
+        else
+        {
+            stream.push_back((uint8_t)nextRandom());
+        }
+    }
+}
+
+/**
+ * @brief Append a record, possibly damaged
+ *
+ * @return true if it went in intact
+ */
+static bool appendRecord(std::vector<uint8_t>& stream, uint8_t* encoded, size_t size, ResyncPart& part)
+{
+    uint32_t damage = nextRandom() % 1000;
+    if (damage < FLIPPED_PER_MILLE)
+    {
+        encoded[nextRandom() % size] ^= (uint8_t)(1 + nextRandom() % 255);
+        stream.insert(stream.end(), encoded, encoded + size);
+        part.flipped++;
+        return false;
+    }
+    if (damage < FLIPPED_PER_MILLE + TRUNCATED_PER_MILLE)
+    {
+        stream.insert(stream.end(), encoded, encoded + 1 + nextRandom() % (size - 1));
+        part.truncated++;
+        return false;
+    }
+    stream.insert(stream.end(), encoded, encoded + size);
+    return true;
+}
+
+static void runResyncPart(uint32_t frames, ResyncPart& part)
+{
+    std::vector<uint8_t> stream;
+    std::vector<WrittenFrame> written;      ///< The intact frames, in order
+    FrameScaleState writer;
+    bool scaleIntact = false;
+
+    memset(&part, 0, sizeof(part));
+    resetFrameScaleState(writer);
+
+    // A segment starts with a text line
+    const char* header = "#segment,1,0,0\r\nmillis,aX,aY,aZ";
+    stream.insert(stream.end(), header, header + strlen(header));
+
+    for (uint32_t n = 0; n < frames; n++)
+    {
+        ImuFrame frame;
+        uint8_t encoded[LOG_RECORD_MAX_SIZE];
+
+        if (nextRandom() % 1000 < JUNK_PER_MILLE)
+        {
+            uint32_t bytes = 1 + nextRandom() % MAX_JUNK_BYTES;
+            appendJunk(stream, bytes);
+            part.junkBytes += bytes;
+        }
+
+        randomFrame(frame, n);
+        if (writer.valid && nextRandom() % 1000 >= SCALE_CHANGE_PER_MILLE)
+        {
+            frame.scale = writer.scale;
+        }
+        if (frameScaleChanged(writer, frame.scale))
+        {
+            encodeScaleRecord(frame.scale, writer, encoded);
+            scaleIntact = appendRecord(stream, encoded, LOG_SCALE_RECORD_SIZE, part);
+            part.scaleRecords++;
+        }
+
+        encodeImuFrame(frame, writer, encoded);
+        if (appendRecord(stream, encoded, LOG_FRAME_SIZE, part))
+        {
+            WrittenFrame entry = {n, scaleIntact, frame.scale};
+            written.push_back(entry);
+            part.intact++;
+        }
+    }
+
+    // Scan as imu_log_decode does: an intact record is consumed whole,
+    // anything else advances one byte
+    FrameScaleState reader;
+    size_t next = 0;
+    size_t pos = 0;
+    resetFrameScaleState(reader);
+    while (pos + LOG_RECORD_HEADER_SIZE <= stream.size())
+    {
+        ImuFrame decoded;
+        size_t recordBytes;
+        FrameStatus status = decodeLogRecord(&stream[pos], stream.size() - pos, reader, decoded, recordBytes);
+        if (status == FRAME_SCALE)
+        {
+            pos += recordBytes;
+            continue;
+        }
+        if (status != FRAME_OK && status != FRAME_NO_SCALE)
+        {
+            part.rejected += (status != FRAME_BAD_MAGIC) ? 1 : 0;
+            pos++;
+            continue;
+        }
+
+        if (status == FRAME_OK)
+        {
+            part.recovered++;
+        }
+        else
+        {
+            part.unscaled++;
+        }
+        while (next < written.size() && written[next].timestampMs < decoded.timestampMs)
+        {
+            reportFailure(part.missing, "MISSING resync frame %lu", (unsigned long)written[next].timestampMs);
+            next++;
+        }
+        if (next < written.size() && written[next].timestampMs == decoded.timestampMs)
+        {
+            const WrittenFrame& entry = written[next++];
+            bool scaleOk = (status == FRAME_OK) ? entry.scaled && sameScale(entry.scale, decoded.scale) : !entry.scaled;
+            if (!scaleOk)
+            {
+                reportFailure(part.wrongScale, "SCALE resync frame %lu %s", (unsigned long)entry.timestampMs,
+                              entry.scaled ? "lost its scale record" : "decoded with a stale scale");
+            }
+        }
+        else
+        {
+            reportFailure(part.spurious, "SPURIOUS resync frame %lu at byte %lu", (unsigned long)decoded.timestampMs,
+                          (unsigned long)pos);
+        }
+        pos += recordBytes;
+    }
+    part.missing += (uint32_t)(written.size() - next);
+}
+
+// ============================================================================
+// FRAME CHECK
+// ============================================================================
+
+bool runFrameCheck(uint32_t frames, uint32_t seed)
+{
+    DevicePart device;
+    RandomPart random;
+    ResyncPart resync;
+
+    seedRandom(seed);
+
+    // CRC-16/CCITT-FALSE check value
+    const uint8_t checkInput[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    bool crcOk = crc16Ccitt(checkInput, sizeof(checkInput)) == 0x29B1 && referenceCrc(checkInput, sizeof(checkInput)) == 0x29B1;
+
+    runDevicePart(frames, device);
+    runRandomPart(frames, random);
+    runResyncPart(frames, resync);
+
+    bool ok = crcOk && device.mismatches == 0 && device.csvMismatches == 0 && device.crcErrors == 0
+           && random.mismatches == 0 && random.sensorMismatches == 0 && random.crcErrors == 0
+           && resync.missing == 0 && resync.spurious == 0 && resync.wrongScale == 0
+           && resync.recovered + resync.unscaled == resync.intact;
+
+    beginCheckReport("frame", seed);
+    printf(",\"frames\":%lu,\"frame_bytes\":%d,\"scale_record_bytes\":%d,"
+           "\"crc_check_value\":%s,"
+           "\"device\":{\"mismatches\":%lu,\"csv_mismatches\":%lu,\"scale_records\":%lu,\"crc_errors\":%lu,"
+           "\"max_error\":{\"accel_mg\":%.3g,\"gyro_dps\":%.3g,\"mag_mg\":%.3g}},"
+           "\"random\":{\"mismatches\":%lu,\"sensor_mismatches\":%lu,\"scale_records\":%lu,\"crc_errors\":%lu,"
+           "\"max_relative_error\":%.3g},"
+           "\"resync\":{\"intact\":%lu,\"scale_records\":%lu,\"flipped\":%lu,\"truncated\":%lu,\"junk_bytes\":%lu,"
+           "\"recovered\":%lu,\"unscaled\":%lu,\"rejected\":%lu,\"missing\":%lu,\"spurious\":%lu,"
+           "\"wrong_scale\":%lu}",
+           (unsigned long)frames, LOG_FRAME_SIZE, LOG_SCALE_RECORD_SIZE, jsonBool(crcOk),
+           (unsigned long)device.mismatches, (unsigned long)device.csvMismatches, (unsigned long)device.scaleRecords,
+           (unsigned long)device.crcErrors, device.accelErrorMg, device.gyroErrorDps, device.magErrorMg,
+           (unsigned long)random.mismatches, (unsigned long)random.sensorMismatches,
+           (unsigned long)random.scaleRecords, (unsigned long)random.crcErrors, random.maxRelativeError,
+           (unsigned long)resync.intact, (unsigned long)resync.scaleRecords, (unsigned long)resync.flipped,
+           (unsigned long)resync.truncated, (unsigned long)resync.junkBytes, (unsigned long)resync.recovered,
+           (unsigned long)resync.unscaled, (unsigned long)resync.rejected, (unsigned long)resync.missing,
+           (unsigned long)resync.spurious, (unsigned long)resync.wrongScale);
+    endCheckReport(ok);
+    return ok;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file frame_check.h
+ * @brief Round-trip check of the binary log frame (log_record.h)
+ *
+ * Three parts:
+ *
+ * - Device: reads samples from the simulated MPU9250 through the firmware
+ *   path (readIMUData(), captureSample(), sampleFrame()), encodes each
+ *   frame after a scale record whenever the scale changes, as
+ *   logBinarySample() does, decodes the records, and compares the decoded
+ *   fields with the sample bit for bit. frameSensors() of the decoded
+ *   frame must give the values CsvSink writes to acceleration.txt,
+ *   gyro.txt and mag.txt, within float rounding: the mag columns are
+ *   computed in a different order than the scaling table's fused
+ *   transform.
+ * - Random: frames with random counts and random calibration (scale
+ *   factors, factory sensitivity, hard- and soft-iron correction, gyro
+ *   bias), half of them sharing the previous frame's scale record, must
+ *   decode to themselves, and frameSensors() must match a
+ *   double-precision evaluation of the FrameScale formulas.
+ * - Resync: a stream of frames and scale records, some with a byte
+ *   flipped, some cut short, with junk and stray sync words between them,
+ *   is scanned the way imu_log_decode does. Exactly the intact frames must
+ *   come back, in order, and every damaged record must be rejected. A
+ *   frame must carry its scale if its scale record is intact and be
+ *   reported as FRAME_NO_SCALE otherwise.
+ *
+ * Every encoded trailer is also compared with a bitwise CRC-16/CCITT.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef FRAME_CHECK_H
+#define FRAME_CHECK_H
+
+#include <stdint.h>
+
+// ============================================================================
+// FRAME CHECK
+// ============================================================================
+
+/**
+ * @brief Run the check and print one JSON line
+ *
+ * @param frames Frames per part
+ * @param seed Random seed for the sensor noise, frames and damage
+ * @return true if every frame round-tripped and the scan recovered exactly
+ *         the intact frames
+ */
+bool runFrameCheck(uint32_t frames, uint32_t seed);
+
+#endif // FRAME_CHECK_H
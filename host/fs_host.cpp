@@ -0,0 +1,208 @@
+/**
+ * @file fs_host.cpp
+ * @brief Directory-backed fs::FS implementation for the host simulator
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "FS.h"
+#include "sim_clock.h"
+#include <errno.h>
+#include <sys/stat.h>
+
+namespace fs
+{
+
+// ============================================================================
+// FILE IMPLEMENTATION
+// ============================================================================
+
+struct FileImpl
+{
+    FileImpl(FS& owner, FILE* handle, const char* path)
+        : owner(owner), handle(handle), path(path)
+    {
+    }
+
+    ~FileImpl(void)
+    {
+        close();
+    }
+
+    void close(void)
+    {
+        if (handle != NULL)
+        {
+            fclose(handle);
+            handle = NULL;
+            owner.counters.closes++;
+            simAdvanceMicros(SIM_SD_CLOSE_US);
+        }
+    }
+
+    FS& owner;
+    FILE* handle;
+    std::string path;
+};
+
+File::operator bool(void) const
+{
+    return impl && impl->handle != NULL;
+}
+
+size_t File::write(const uint8_t* buffer, size_t size)
+{
+    if (!*this)
+    {
+        return 0;
+    }
+
+    size_t written = fwrite(buffer, 1, size, impl->handle);
+    impl->owner.counters.writeCalls++;
+    impl->owner.counters.bytesWritten += written;
+    simAdvanceMicros(SIM_SD_WRITE_CALL_US + written / SIM_SD_BYTES_PER_US);
+    return written;
+}
+
+int File::read(void)
+{
+    uint8_t c;
+    return (read(&c, 1) == 1) ? c : -1;
+}
+
+size_t File::read(uint8_t* buffer, size_t size)
+{
+    if (!*this)
+    {
+        return 0;
+    }
+
+    size_t count = fread(buffer, 1, size, impl->handle);
+    impl->owner.counters.readCalls++;
+    impl->owner.counters.bytesRead += count;
+    simAdvanceMicros(SIM_SD_WRITE_CALL_US + count / SIM_SD_BYTES_PER_US);
+    return count;
+}
+
+int File::available(void)
+{
+    return *this ? (int)(size() - position()) : 0;
+}
+
+bool File::seek(uint32_t position)
+{
+    return *this && fseek(impl->handle, (long)position, SEEK_SET) == 0;
+}
+
+size_t File::position(void) const
+{
+    return *this ? (size_t)ftell(impl->handle) : 0;
+}
+
+size_t File::size(void) const
+{
+    if (!*this)
+    {
+        return 0;
+    }
+
+    long current = ftell(impl->handle);
+    fseek(impl->handle, 0, SEEK_END);
+    long end = ftell(impl->handle);
+    fseek(impl->handle, current, SEEK_SET);
+    return (size_t)end;
+}
+
+void File::flush(void)
+{
+    if (*this)
+    {
+        fflush(impl->handle);
+        impl->owner.counters.flushes++;
+        simAdvanceMicros(SIM_SD_FLUSH_US);
+    }
+}
+
+void File::close(void)
+{
+    if (impl)
+    {
+        impl->close();
+        impl.reset();
+    }
+}
+
+const char* File::name(void) const
+{
+    return impl ? impl->path.c_str() : "";
+}
+
+// ============================================================================
+// FILE SYSTEM
+// ============================================================================
+
+FS::FS(const char* rootDirectory)
+    : root(rootDirectory)
+{
+    memset(&counters, 0, sizeof(counters));
+}
+
+void FS::setRoot(const char* rootDirectory)
+{
+    root = rootDirectory;
+    ::mkdir(root.c_str(), 0755);
+}
+
+std::string FS::resolve(const char* path) const
+{
+    return root + ((path[0] == '/') ? "" : "/") + path;
+}
+
+File FS::open(const char* path, const char* mode)
+{
+    const char* hostMode = "rb";
+    if (mode[0] == 'w')
+    {
+        hostMode = "w+b";
+    }
+    else if (mode[0] == 'a')
+    {
+        hostMode = "a+b";
+    }
+
+    simAdvanceMicros(SIM_SD_OPEN_US);
+    FILE* handle = fopen(resolve(path).c_str(), hostMode);
+    if (handle == NULL)
+    {
+        counters.failures++;
+        return File();
+    }
+
+    counters.opens++;
+    return File(std::make_shared<FileImpl>(*this, handle, path));
+}
+
+bool FS::exists(const char* path)
+{
+    struct stat info;
+    return stat(resolve(path).c_str(), &info) == 0;
+}
+
+bool FS::remove(const char* path)
+{
+    return ::remove(resolve(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* pathFrom, const char* pathTo)
+{
+    return ::rename(resolve(pathFrom).c_str(), resolve(pathTo).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path)
+{
+    return ::mkdir(resolve(path).c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+} // namespace fs
@@ -0,0 +1,306 @@
+/**
+ * @file governor_check.cpp
+ * @brief Check of the motion-adaptive sample-rate governor
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "governor_check.h"
+#include "check_util.h"
+#include "rate_governor.h"
+#include "imu_sensor.h"
+#include "sim_imu.h"
+#include "sim_clock.h"
+#include "hal.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+// ============================================================================
+// CHECK PARAMETERS
+// ============================================================================
+
+// Hysteresis signals: swing period and duration. Each swing stays on the
+// far side of the step-down level for less than the hold time.
+#define DITHER_PERIOD_S 3.0f
+#define DITHER_SECONDS 120
+
+// Swing around the middle of a threshold pair, as a share of the gap
+#define DITHER_SWING 0.75f
+
+// Loop pass without the I2C time
+#define POLL_STEP_US 100
+
+// Rest time after which the governor must be idle: calm and rest holds
+// plus the smoothing
+#define REST_SETTLE_US ((GOV_CALM_HOLD_MS + GOV_REST_HOLD_MS + 1000ULL) * 1000ULL)
+
+// Time after which the governor must be in normal: out of high it waits
+// the calm hold plus the smoothing, out of idle it wakes at once
+#define CALM_SETTLE_US ((GOV_CALM_HOLD_MS + 1000ULL) * 1000ULL)
+
+// Fast motion time after which the governor must be in high
+#define MOTION_SETTLE_US 500000ULL
+
+// Time each scripted phase is observed after it settled, at the least
+#define OBSERVE_US 2000000ULL
+
+// Scripted body rates: between the wake and calm levels, and well above
+// the high level, each varying by a fifth over a few seconds
+#define MOVE_DPS (0.5f * (GOV_WAKE_DPS + GOV_CALM_DPS))
+#define FAST_DPS (2.5f * GOV_HIGH_DPS)
+#define RATE_WOBBLE 0.2f
+#define WOBBLE_PERIOD_S 3.7f
+
+// Largest relative difference between a profile's measured and nominal ODR
+#define RATE_TOLERANCE 0.02
+
+// ============================================================================
+// HYSTERESIS
+// ============================================================================
+
+/**
+ * @brief Switches of a governor fed a rate swinging across @p lower .. @p upper
+ */
+static uint32_t ditherSwitches(RateProfileId start, float lower, float upper)
+{
+    RateGovernor governor;
+    const float accel[3] = {0.0f, 0.0f, 1.0f};
+    float centre = 0.5f * (lower + upper);
+    float swing = DITHER_SWING * (upper - lower);
+    uint32_t switches = 0;
+    uint64_t timeUs = 0;
+
+    governor.reset(start, 0);
+    while (timeUs < DITHER_SECONDS * 1000000ULL)
+    {
+        float t = timeUs / 1e6f;
+        float rate = centre + swing * sinf(6.2831853f * t / DITHER_PERIOD_S) + uniform(-0.1f, 0.1f) * swing;
+        const float gyro[3] = {rate * 0.6f, rate * 0.8f, 0.0f};
+
+        if (governor.update(accel, gyro, (uint32_t)(timeUs / 1000)))
+        {
+            switches++;
+        }
+        timeUs += 1000000ULL / rateProfile(governor.profile()).rateHz();
+    }
+    return switches;
+}
+
+// ============================================================================
+// SCRIPTED MOTION
+// ============================================================================
+
+/**
+ * @brief One phase of the scripted motion
+ */
+struct MotionPhase
+{
+    float rateDps;              ///< Mean body rate, 0 at rest
+    RateProfileId expected;     ///< Profile once the phase has lasted settleUs
+    uint64_t settleUs;
+    float share;                ///< Share of the run beyond the phases' minimum length
+};
+
+// Rest, motion, fast motion, motion and rest again: every profile and
+// every switch between neighbouring profiles
+static const MotionPhase kPhases[] = {
+    {0.0f, RATE_PROFILE_IDLE, REST_SETTLE_US, 0.3f},
+    {MOVE_DPS, RATE_PROFILE_NORMAL, CALM_SETTLE_US, 0.15f},
+    {FAST_DPS, RATE_PROFILE_HIGH, MOTION_SETTLE_US, 0.2f},
+    {MOVE_DPS, RATE_PROFILE_NORMAL, CALM_SETTLE_US, 0.15f},
+    {0.0f, RATE_PROFILE_IDLE, REST_SETTLE_US, 0.2f},
+};
+
+#define PHASE_COUNT ((int)(sizeof(kPhases) / sizeof(kPhases[0])))
+
+// Phase boundaries in virtual time
+static uint64_t phaseEndUs[PHASE_COUNT];
+
+/**
+ * @brief Lay the phases out from @p startUs over @p seconds
+ *
+ * Each phase lasts at least its settling time plus OBSERVE_US, so a short
+ * run is stretched to the script's minimum rather than cut off before the
+ * governor can reach a profile.
+ *
+ * @return End of the script
+ */
+static uint64_t planMotion(uint64_t startUs, uint32_t seconds)
+{
+    uint64_t minimumUs = 0;
+    for (int i = 0; i < PHASE_COUNT; i++)
+    {
+        minimumUs += kPhases[i].settleUs + OBSERVE_US;
+    }
+    uint64_t spareUs = ((uint64_t)seconds * 1000000ULL > minimumUs) ? (uint64_t)seconds * 1000000ULL - minimumUs : 0;
+
+    uint64_t endUs = startUs;
+    for (int i = 0; i < PHASE_COUNT; i++)
+    {
+        endUs += kPhases[i].settleUs + OBSERVE_US + (uint64_t)(kPhases[i].share * spareUs);
+        phaseEndUs[i] = endUs;
+    }
+    return endUs;
+}
+
+static int phaseAt(uint64_t timeUs)
+{
+    int phase = 0;
+    while (phase < PHASE_COUNT - 1 && timeUs >= phaseEndUs[phase])
+    {
+        phase++;
+    }
+    return phase;
+}
+
+/**
+ * @brief Body rate of the scripted motion (SimulatedImu::setRateScript())
+ */
+static void scriptedRate(uint64_t timeUs, float* rateDps)
+{
+    float t = timeUs / 1e6f;
+    float rate = kPhases[phaseAt(timeUs)].rateDps * (1.0f + RATE_WOBBLE * sinf(6.2831853f * t / WOBBLE_PERIOD_S));
+
+    // A fixed unit axis
+    rateDps[0] = 0.6f * rate;
+    rateDps[1] = 0.64f * rate;
+    rateDps[2] = 0.48f * rate;
+}
+
+// ============================================================================
+// DEVICE
+// ============================================================================
+
+/**
+ * @brief Time and samples spent in one profile
+ */
+struct ProfileUsage
+{
+    uint64_t us;
+    uint64_t samples;
+    uint32_t entries;
+};
+
+static RateProfileId activeProfileId(void)
+{
+    return (RateProfileId)(&activeRateProfile() - &rateProfile(RATE_PROFILE_IDLE));
+}
+
+static void reportViolation(uint32_t& count, RateProfileId expected, uint64_t timeUs)
+{
+    reportFailure(count, "VIOLATION not %s at %.3f s: profile %s", rateProfile(expected).name, timeUs / 1e6,
+                  activeRateProfile().name);
+}
+
+bool runGovernorCheck(uint32_t seconds, uint32_t seed, bool traced)
+{
+    ProfileUsage usage[RATE_PROFILE_COUNT];
+    uint32_t violations[RATE_PROFILE_COUNT] = {0, 0, 0};    ///< Settled samples not in the phase's profile
+    uint32_t switches = 0;
+
+    seedRandom(seed);
+    uint32_t wakeSwitches = ditherSwitches(RATE_PROFILE_IDLE, GOV_REST_DPS, GOV_WAKE_DPS);
+    uint32_t highSwitches = ditherSwitches(RATE_PROFILE_NORMAL, GOV_CALM_DPS, GOV_HIGH_DPS);
+
+    // The device as setup() leaves it, at rest until the script starts
+    uint64_t startUs = simNowMicros();
+    uint64_t endUs = startUs + (uint64_t)seconds * 1000000ULL;
+    if (!traced)
+    {
+        endUs = planMotion(startUs, seconds);
+        simImu().setRateScript(scriptedRate);
+    }
+    initializeIMU();
+    initializeMagnetometer();
+    beginRateGovernor();
+
+    memset(usage, 0, sizeof(usage));
+    startUs = simNowMicros();
+    uint64_t lastUs = startUs;
+    uint64_t lastGenerated = simImu().stats().samplesGenerated;
+    uint64_t startOverwritten = simImu().stats().samplesOverwritten;
+    RateProfileId profile = activeProfileId();
+    usage[profile].entries++;
+
+    while (simNowMicros() < endUs && !simImu().traceFinished())
+    {
+        simAdvanceMicros(POLL_STEP_US);
+        if (imuSensor.readByte(MPU9250_ADDRESS, INT_STATUS) & 0x01)
+        {
+            readIMUData();
+            rateGovernorObserveSample();
+
+            uint64_t sampleUs = simImu().lastSample().timeUs;
+            if (!traced)
+            {
+                int phase = phaseAt(sampleUs);
+                uint64_t phaseStartUs = phase ? phaseEndUs[phase - 1] : startUs;
+                RateProfileId expected = kPhases[phase].expected;
+                if (sampleUs - phaseStartUs >= kPhases[phase].settleUs && activeProfileId() != expected)
+                {
+                    reportViolation(violations[expected], expected, sampleUs);
+                }
+            }
+        }
+        rateGovernorYield();
+
+        // Samples the device produced since the last pass, at the profile's ODR
+        uint64_t nowUs = simNowMicros();
+        uint64_t generated = simImu().stats().samplesGenerated;
+        usage[profile].us += nowUs - lastUs;
+        usage[profile].samples += generated - lastGenerated;
+        lastUs = nowUs;
+        lastGenerated = generated;
+
+        if (activeProfileId() != profile)
+        {
+            profile = activeProfileId();
+            usage[profile].entries++;
+            switches++;
+        }
+    }
+
+    simImu().setRateScript(NULL);
+
+    // With the script every profile runs long enough to measure its ODR
+    bool ratesOk = true;
+    for (int i = 0; i < RATE_PROFILE_COUNT; i++)
+    {
+        ratesOk = ratesOk && (traced || usage[i].us > 1000000ULL);
+        if (usage[i].us > 1000000ULL)
+        {
+            double measured = usage[i].samples * 1e6 / usage[i].us;
+            ratesOk = ratesOk && fabs(measured - rateProfile((RateProfileId)i).rateHz())
+                                     <= RATE_TOLERANCE * rateProfile((RateProfileId)i).rateHz();
+        }
+    }
+
+    bool ok = wakeSwitches == 1 && highSwitches == 1 && ratesOk;
+    if (!traced)
+    {
+        ok = ok && violations[RATE_PROFILE_IDLE] == 0 && violations[RATE_PROFILE_NORMAL] == 0
+          && violations[RATE_PROFILE_HIGH] == 0;
+    }
+
+    beginCheckReport("governor", seed);
+    printf(",\"source\":\"%s\",\"seconds\":%.1f,"
+           "\"dither_switches\":{\"wake\":%lu,\"high\":%lu},\"switches\":%lu,\"profiles\":{",
+           traced ? "trace" : "scripted", (lastUs - startUs) / 1e6,
+           (unsigned long)wakeSwitches, (unsigned long)highSwitches, (unsigned long)switches);
+    for (int i = 0; i < RATE_PROFILE_COUNT; i++)
+    {
+        const RateProfile& p = rateProfile((RateProfileId)i);
+        printf("%s\"%s\":{\"share\":%.3f,\"entries\":%lu,\"odr_hz\":%u,\"measured_hz\":%.1f}",
+               i ? "," : "", p.name, (double)usage[i].us / (lastUs - startUs), (unsigned long)usage[i].entries,
+               (unsigned)p.rateHz(), usage[i].us ? usage[i].samples * 1e6 / usage[i].us : 0.0);
+    }
+    printf("},\"missed_samples\":%llu,\"violations\":{\"idle\":%lu,\"normal\":%lu,\"high\":%lu}",
+           (unsigned long long)(simImu().stats().samplesOverwritten - startOverwritten),
+           (unsigned long)violations[RATE_PROFILE_IDLE], (unsigned long)violations[RATE_PROFILE_NORMAL],
+           (unsigned long)violations[RATE_PROFILE_HIGH]);
+    endCheckReport(ok);
+    return ok;
+}
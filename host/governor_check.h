@@ -0,0 +1,47 @@
+/**
+ * @file governor_check.h
+ * @brief Check of the motion-adaptive sample-rate governor
+ *
+ * Two parts:
+ *
+ * - Hysteresis: RateGovernor alone is fed a rate that swings slowly
+ *   across the wake/rest and the high/calm thresholds. It may switch once
+ *   into the upper profile and must then stay there; a governor without
+ *   hysteresis would switch twice per swing.
+ * - Device: the firmware path (readIMUData(), rateGovernorObserveSample(),
+ *   setImuRate()) polls the simulated MPU9250, from a recorded trace
+ *   (--trace) or from scripted motion: rest, motion, fast motion, motion
+ *   and rest again, laid out over the given number of virtual seconds but
+ *   never shorter than each phase needs to settle and be observed. Every
+ *   profile must run at its own ODR, which shows the registers were
+ *   reprogrammed. With the script, every profile must be used, and once a
+ *   phase has outlasted the hold times the governor must be in its
+ *   profile: idle at rest, normal while moving and high while moving
+ *   fast. The outcome does not depend on the duration.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef GOVERNOR_CHECK_H
+#define GOVERNOR_CHECK_H
+
+#include <stdint.h>
+
+// ============================================================================
+// GOVERNOR CHECK
+// ============================================================================
+
+/**
+ * @brief Run the check and print one JSON line
+ *
+ * @param seconds Virtual seconds of device polling (with the script, at
+ *        least its minimum length)
+ * @param seed Random seed for the hysteresis signals
+ * @param traced true if the simulated device replays a trace
+ * @return true if every condition held
+ */
+bool runGovernorCheck(uint32_t seconds, uint32_t seed, bool traced);
+
+#endif // GOVERNOR_CHECK_H
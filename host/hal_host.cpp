@@ -0,0 +1,305 @@
+/**
+ * @file hal_host.cpp
+ * @brief Hardware abstraction layer for the native host simulator
+ * 
+ * Time comes from the virtual clock, the display is a framebuffer with an
+ * SPI cost model, and storage is a directory on the host. Also provides the
+ * Serial console and the Print helpers declared in the host Arduino.h.
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "hal.h"
+#include "hal_host.h"
+#include "sim_clock.h"
+#include "sim_imu.h"
+#include <stdarg.h>
+#include <chrono>
+
+// ============================================================================
+// HOST STATE
+// ============================================================================
+
+#define SERIAL_TX_BUFFER_SIZE 128
+
+// LCD SPI cost model: window setup per push, then 16 bits per pixel at 40 MHz
+#define SIM_LCD_PUSH_US 10
+#define SIM_LCD_PIXELS_PER_MS 2500
+
+// Card size behind halStorageFreeBytes()
+#define SIM_SD_CAPACITY_BYTES (16ULL * 1024 * 1024 * 1024)
+
+HardwareSerial Serial;
+
+static fs::FS storage("sim_sd");
+static StatusColor lastStatus = STATUS_WAITING;
+static uint32_t statusChanges = 0;
+static uint8_t brightness = 0;
+static uint16_t framebuffer[HAL_LCD_WIDTH * HAL_LCD_HEIGHT];
+static uint32_t displayPushes = 0;
+static uint64_t displayPixels = 0;
+
+// ============================================================================
+// PLATFORM FUNCTIONS
+// ============================================================================
+
+void halBegin(uint32_t baudRate)
+{
+    Serial.begin(baudRate);
+}
+
+uint32_t halMillis(void)
+{
+    return (uint32_t)(simNowMicros() / 1000ULL);
+}
+
+uint32_t halMicros(void)
+{
+    return (uint32_t)simNowMicros();
+}
+
+uint32_t halProfileMicros(void)
+{
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+uint32_t halCycleCount(void)
+{
+    // Host "cycles" are wall-clock nanoseconds
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t halCyclesPerMicrosecond(void)
+{
+    return 1000;
+}
+
+void halDelay(uint32_t ms)
+{
+    simAdvanceMicros((uint64_t)ms * 1000ULL);
+}
+
+void halSetBrightness(uint8_t level)
+{
+    brightness = level;
+}
+
+void halShowStatus(StatusColor status)
+{
+    static const uint16_t colors[] = {HAL_COLOR_BLUE, HAL_COLOR_GREEN, HAL_COLOR_RED};
+
+    lastStatus = status;
+    statusChanges++;
+    for (size_t i = 0; i < HAL_LCD_WIDTH * HAL_LCD_HEIGHT; i++)
+    {
+        framebuffer[i] = colors[status];
+    }
+}
+
+void halDisplayPush(int16_t x, int16_t y, int16_t width, int16_t height, const uint16_t* pixels)
+{
+    for (int16_t row = 0; row < height; row++)
+    {
+        for (int16_t column = 0; column < width; column++)
+        {
+            int16_t px = x + column;
+            int16_t py = y + row;
+            if (px >= 0 && px < HAL_LCD_WIDTH && py >= 0 && py < HAL_LCD_HEIGHT)
+            {
+                framebuffer[py * HAL_LCD_WIDTH + px] = pixels[row * width + column];
+            }
+        }
+    }
+
+    uint32_t count = (uint32_t)width * (uint32_t)height;
+    displayPushes++;
+    displayPixels += count;
+    simAdvanceMicros(SIM_LCD_PUSH_US + (uint64_t)count * 1000ULL / SIM_LCD_PIXELS_PER_MS);
+}
+
+bool halAttachDataReadyInterrupt(void (*handler)(void))
+{
+    simImu().setInterruptHandler(handler);
+    return true;
+}
+
+fs::FS& halStorage(void)
+{
+    return storage;
+}
+
+uint64_t halStorageFreeBytes(void)
+{
+    uint64_t written = storage.stats().bytesWritten;
+    return (written < SIM_SD_CAPACITY_BYTES) ? SIM_SD_CAPACITY_BYTES - written : 0;
+}
+
+// ============================================================================
+// HOST-ONLY FUNCTIONS
+// ============================================================================
+
+void hostSetStorageRoot(const char* directory)
+{
+    storage.setRoot(directory);
+}
+
+StatusColor hostLastStatus(void)
+{
+    return lastStatus;
+}
+
+uint32_t hostStatusChanges(void)
+{
+    return statusChanges;
+}
+
+const uint16_t* hostFramebuffer(void)
+{
+    return framebuffer;
+}
+
+uint32_t hostDisplayPushes(void)
+{
+    return displayPushes;
+}
+
+uint64_t hostDisplayPixels(void)
+{
+    return displayPixels;
+}
+
+// ============================================================================
+// PRINT
+// ============================================================================
+
+size_t Print::printNumber(unsigned long value, int base)
+{
+    char buffer[8 * sizeof(long) + 1];
+    char* cursor = &buffer[sizeof(buffer) - 1];
+    *cursor = '\0';
+
+    if (base < 2)
+    {
+        base = 10;
+    }
+
+    do
+    {
+        unsigned long digit = value % base;
+        value /= base;
+        *--cursor = (char)(digit < 10 ? '0' + digit : 'A' + digit - 10);
+    } while (value > 0);
+
+    return print(cursor);
+}
+
+size_t Print::print(int value, int base)
+{
+    return print((long)value, base);
+}
+
+size_t Print::print(long value, int base)
+{
+    if (base == DEC && value < 0)
+    {
+        size_t n = print('-');
+        return n + printNumber((unsigned long)(-value), DEC);
+    }
+    return printNumber((unsigned long)value, base);
+}
+
+size_t Print::print(double value, int digits)
+{
+    char buffer[48];
+    snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+    return print(buffer);
+}
+
+size_t Print::printf(const char* format, ...)
+{
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+
+    if (length < 0)
+    {
+        return 0;
+    }
+    if ((size_t)length >= sizeof(buffer))
+    {
+        length = sizeof(buffer) - 1;
+    }
+    return write((const uint8_t*)buffer, (size_t)length);
+}
+
+// ============================================================================
+// SERIAL CONSOLE
+// ============================================================================
+
+HardwareSerial::HardwareSerial(void)
+    : baudRate(115200), echo(false), backlog(0), lastDrainUs(0),
+      totalBytes(0), blockedUs(0)
+{
+}
+
+void HardwareSerial::begin(unsigned long baud)
+{
+    baudRate = baud;
+    backlog = 0;
+    lastDrainUs = simNowMicros();
+}
+
+void HardwareSerial::drain(void)
+{
+    // 10 bit times per byte (start + 8 data + stop)
+    uint64_t now = simNowMicros();
+    uint64_t drained = (now - lastDrainUs) * baudRate / 10000000ULL;
+    if (drained == 0)
+    {
+        return;
+    }
+
+    backlog = (drained >= backlog) ? 0 : backlog - (uint32_t)drained;
+    lastDrainUs = now;
+}
+
+int HardwareSerial::availableForWrite(void)
+{
+    drain();
+    return SERIAL_TX_BUFFER_SIZE - (int)backlog;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size)
+{
+    drain();
+
+    // Bytes that do not fit the TX buffer block the caller until they drain
+    uint32_t total = backlog + (uint32_t)size;
+    if (total > SERIAL_TX_BUFFER_SIZE)
+    {
+        uint64_t waitUs = (uint64_t)(total - SERIAL_TX_BUFFER_SIZE) * 10000000ULL / baudRate;
+        simAdvanceMicros(waitUs);
+        blockedUs += waitUs;
+        drain();
+        total = backlog + (uint32_t)size;
+        backlog = (total > SERIAL_TX_BUFFER_SIZE) ? SERIAL_TX_BUFFER_SIZE : total;
+    }
+    else
+    {
+        backlog = total;
+    }
+
+    totalBytes += size;
+    if (echo)
+    {
+        fwrite(buffer, 1, size, stdout);
+    }
+    return size;
+}
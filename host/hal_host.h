@@ -0,0 +1,49 @@
+/**
+ * @file hal_host.h
+ * @brief Host-only controls for the simulator HAL
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef HAL_HOST_H
+#define HAL_HOST_H
+
+#include "hal.h"
+
+// ============================================================================
+// HOST-ONLY FUNCTIONS
+// ============================================================================
+
+/**
+ * @brief Set the host directory that backs halStorage()
+ */
+void hostSetStorageRoot(const char* directory);
+
+/**
+ * @brief Last status passed to halShowStatus()
+ */
+StatusColor hostLastStatus(void);
+
+/**
+ * @brief Number of halShowStatus() calls
+ */
+uint32_t hostStatusChanges(void);
+
+/**
+ * @brief Display contents, HAL_LCD_WIDTH x HAL_LCD_HEIGHT RGB565 pixels row by row
+ */
+const uint16_t* hostFramebuffer(void);
+
+/**
+ * @brief Number of halDisplayPush() calls
+ */
+uint32_t hostDisplayPushes(void);
+
+/**
+ * @brief Pixels pushed by halDisplayPush()
+ */
+uint64_t hostDisplayPixels(void);
+
+#endif // HAL_HOST_H
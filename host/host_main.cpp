@@ -0,0 +1,441 @@
+/**
+ * @file host_main.cpp
+ * @brief Entry point for the native host simulator
+ * 
+ * Runs the unmodified firmware setup()/loop() against the simulated IMU,
+ * the directory-backed SD card and the virtual clock, then prints a JSON
+ * summary of loop rate, sensor, I2C, SD and serial activity. The summary's
+ * boot figures give the virtual time setup() took and the time from power
+ * on to the first sample reaching a sample stream; run twice on the same
+ * --sd-root to compare a cold boot with one from the stored calibration.
+ * 
+ * Usage:
+ *   imu_sim [--duration-ms N] [--sd-root DIR] [--trace DIR] [--seed N]
+ *           [--i2c-hz N] [--serial-echo] [--benchmark N] [--recovery-check N]
+ *           [--format-check N] [--feature-check N] [--aux-check N]
+ *           [--governor-check N] [--pipeline-check N] [--dashboard-check N]
+ *           [--ring-check N] [--frame-check N] [--fifo-check N]
+ *           [--data-ready-check N]
+ * 
+ * --benchmark runs the hot-path benchmark (benchmark.h) with N iterations
+ * after setup() and prints its JSON report instead of running loop().
+ * 
+ * --recovery-check cuts log segments at N random offsets per record kind
+ * (recovery_check.h) instead of running the firmware; the exit code is
+ * nonzero if any cut recovered to the wrong length.
+ * 
+ * --format-check compares N random CSV records from record_format.h with
+ * snprintf (format_check.h); the exit code is nonzero on any difference.
+ * 
+ * --feature-check compares N random feature windows and the FFT with a
+ * double-precision DFT reference (feature_check.h); the exit code is
+ * nonzero if any error exceeds its tolerance.
+ * 
+ * --aux-check reads N samples with separate reads and N through the
+ * MPU9250 I2C master burst (aux_check.h); the exit code is nonzero if a
+ * burst sample decodes wrong.
+ * 
+ * --governor-check runs the rate governor against swinging signals and for
+ * N virtual seconds against the simulated device, scripted or replaying
+ * --trace (governor_check.h); the exit code is nonzero if it chattered,
+ * missed a scripted rest, motion or fast-motion phase or a profile ran at
+ * the wrong ODR.
+ * 
+ * --pipeline-check runs N synthetic samples through every output pipeline
+ * configuration (pipeline_check.h) and reports its cost; the exit code is
+ * nonzero if one fused, ticked, printed or logged differently.
+ * 
+ * --dashboard-check draws N frames of the LCD dashboard on the framebuffer
+ * stand-in (dashboard_check.h); the exit code is nonzero if the layout
+ * overlaps, an incremental frame differs from a full redraw, or a pass
+ * exceeded its pixel budget or the frame rate cap.
+ * 
+ * --ring-check passes N million samples through the pipeline's sample ring
+ * between a producer and a consumer thread (ring_check.h); the exit code
+ * is nonzero if a sample was lost beyond the counted drops, reordered or
+ * torn.
+ * 
+ * --frame-check round-trips N binary log frames from the simulated device
+ * and N random ones, and scans N damaged ones for resync (frame_check.h);
+ * the exit code is nonzero if a frame decoded wrong, missed its CSV
+ * values, or the scan lost an intact frame or accepted a damaged one.
+ * 
+ * --fifo-check runs N steps of steady reads, stalls that overflow the
+ * simulated FIFO and partial frames through readFifoBatch() (fifo_check.h);
+ * the exit code is nonzero if a frame was corrupt or out of order, a
+ * sample went missing without a FIFO reset, or a reset was missed.
+ * 
+ * --data-ready-check runs N steps of steady edges, masked edges, backlogs
+ * and queue overflows through acquireDataReadySamples() (data_ready_check.h);
+ * the exit code is nonzero if a pass left edges queued, fused other than
+ * once, or integrated a sample period twice or not at all.
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "config.h"
+#include "hal.h"
+#include "hal_host.h"
+#include "sd_logger.h"
+#include "calibration.h"
+#include "sim_clock.h"
+#include "sim_imu.h"
+#include "benchmark.h"
+#include "recovery_check.h"
+#include "format_check.h"
+#include "feature_check.h"
+#include "aux_check.h"
+#include "governor_check.h"
+#include "pipeline_check.h"
+#include "dashboard_check.h"
+#include "ring_check.h"
+#include "frame_check.h"
+#include "fifo_check.h"
+#include "data_ready_check.h"
+#include "dashboard.h"
+#include <chrono>
+
+// ============================================================================
+// FIRMWARE ENTRY POINTS
+// ============================================================================
+
+void setup(void);
+void loop(void);
+
+// ============================================================================
+// COMMAND LINE
+// ============================================================================
+
+struct SimOptions
+{
+    uint32_t durationMs;
+    const char* sdRoot;
+    const char* traceDir;
+    uint32_t seed;
+    uint32_t i2cHz;
+    bool serialEcho;
+    uint32_t benchmarkIterations;
+    uint32_t recoveryCuts;
+    uint32_t formatRecords;
+    uint32_t featureWindows;
+    uint32_t auxSamples;
+    uint32_t governorSeconds;
+    uint32_t pipelineSamples;
+    uint32_t dashboardFrames;
+    uint32_t ringMillions;
+    uint32_t frameCount;
+    uint32_t fifoSteps;
+    uint32_t dataReadySteps;
+};
+
+/**
+ * @brief Print sink for reports written to stdout
+ */
+class StdoutPrint : public Print
+{
+public:
+    size_t write(const uint8_t* buffer, size_t size) override
+    {
+        return fwrite(buffer, 1, size, stdout);
+    }
+    using Print::write;
+};
+
+static void printUsage(const char* program)
+{
+    fprintf(stderr,
+            "usage: %s [--duration-ms N] [--sd-root DIR] [--trace DIR] [--seed N]\n"
+            "          [--i2c-hz N] [--serial-echo] [--benchmark N] [--recovery-check N]\n"
+            "          [--format-check N] [--feature-check N] [--aux-check N]\n"
+            "          [--governor-check N] [--pipeline-check N] [--dashboard-check N]\n"
+            "          [--ring-check N] [--frame-check N] [--fifo-check N]\n"
+            "          [--data-ready-check N]\n",
+            program);
+}
+
+static bool parseOptions(int argc, char** argv, SimOptions& options)
+{
+    options.durationMs = 60000;
+    options.sdRoot = "sim_sd";
+    options.traceDir = NULL;
+    options.seed = 1;
+    options.i2cHz = 400000;
+    options.serialEcho = false;
+    options.benchmarkIterations = 0;
+    options.recoveryCuts = 0;
+    options.formatRecords = 0;
+    options.featureWindows = 0;
+    options.auxSamples = 0;
+    options.governorSeconds = 0;
+    options.pipelineSamples = 0;
+    options.dashboardFrames = 0;
+    options.ringMillions = 0;
+    options.frameCount = 0;
+    options.fifoSteps = 0;
+    options.dataReadySteps = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char* arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--serial-echo") == 0)
+        {
+            options.serialEcho = true;
+            continue;
+        }
+        if (value == NULL)
+        {
+            return false;
+        }
+
+        if (strcmp(arg, "--duration-ms") == 0)
+        {
+            options.durationMs = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(arg, "--sd-root") == 0)
+        {
+            options.sdRoot = value;
+        }
+        else if (strcmp(arg, "--trace") == 0)
+        {
+            options.traceDir = value;
+        }
+        else if (strcmp(arg, "--seed") == 0)
+        {
+            options.seed = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(arg, "--i2c-hz") == 0)
+        {
+            options.i2cHz = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(arg, "--benchmark") == 0)
+        {
+            options.benchmarkIterations = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(arg, "--recovery-check") == 0)
+        {
+            options.recoveryCuts = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(arg, "--format-check") == 0)
+        {
+            options.formatRecords = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(arg, "--feature-check") == 0)
+        {
+            options.featureWindows = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(arg, "--aux-check") == 0)
+        {
+            options.auxSamples = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(arg, "--governor-check") == 0)
+        {
+            options.governorSeconds = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(arg, "--pipeline-check") == 0)
+        {
+            options.pipelineSamples = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(arg, "--dashboard-check") == 0)
+        {
+            options.dashboardFrames = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(arg, "--ring-check") == 0)
+        {
+            options.ringMillions = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(arg, "--frame-check") == 0)
+        {
+            options.frameCount = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(arg, "--fifo-check") == 0)
+        {
+            options.fifoSteps = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else if (strcmp(arg, "--data-ready-check") == 0)
+        {
+            options.dataReadySteps = (uint32_t)strtoul(value, NULL, 10);
+        }
+        else
+        {
+            return false;
+        }
+        i++;
+    }
+    return true;
+}
+
+// ============================================================================
+// SUMMARY
+// ============================================================================
+
+/**
+ * @brief Bytes staged or written so far to the streams that carry samples
+ */
+static uint32_t sampleStreamBytes(void)
+{
+    return accelLog.segmentBytes() + binaryLog.segmentBytes() + featureLog.segmentBytes();
+}
+
+/**
+ * @brief Boot timing, in virtual microseconds from power on
+ */
+struct BootTiming
+{
+    uint64_t setupUs;
+    uint64_t firstSampleUs;     ///< 0 if no sample was logged
+};
+
+static void printSummary(uint64_t virtualUs, uint64_t loops, const BootTiming& boot, double wallMs)
+{
+    const SimImuStats& imu = simImu().stats();
+    const fs::FsStats& sd = halStorage().stats();
+    double seconds = virtualUs / 1000000.0;
+
+    printf("{\n");
+    printf("  \"virtual_ms\": %.3f,\n", virtualUs / 1000.0);
+    printf("  \"loops\": %llu,\n", (unsigned long long)loops);
+    printf("  \"loop_rate_hz\": %.1f,\n", seconds > 0 ? loops / seconds : 0.0);
+    printf("  \"imu\": {\"samples\": %llu, \"overwritten\": %llu, \"fifo_overflows\": %llu, "
+           "\"mag_samples\": %llu, \"i2c_transactions\": %llu, \"i2c_bytes\": %llu},\n",
+           (unsigned long long)imu.samplesGenerated, (unsigned long long)imu.samplesOverwritten,
+           (unsigned long long)imu.fifoOverflows, (unsigned long long)imu.magSamples,
+           (unsigned long long)imu.transactions, (unsigned long long)imu.busBytes);
+    printf("  \"sd\": {\"opens\": %llu, \"closes\": %llu, \"write_calls\": %llu, "
+           "\"bytes_written\": %llu, \"bytes_per_write\": %.1f, \"flushes\": %llu, \"failures\": %llu},\n",
+           (unsigned long long)sd.opens, (unsigned long long)sd.closes,
+           (unsigned long long)sd.writeCalls, (unsigned long long)sd.bytesWritten,
+           sd.writeCalls ? (double)sd.bytesWritten / sd.writeCalls : 0.0,
+           (unsigned long long)sd.flushes, (unsigned long long)sd.failures);
+    printf("  \"serial\": {\"bytes\": %llu, \"blocked_ms\": %.3f},\n",
+           (unsigned long long)Serial.bytesWritten(), Serial.blockedMicros() / 1000.0);
+    printf("  \"boot\": {\"restored\": %s, \"setup_ms\": %.3f, \"first_sample_ms\": %.3f},\n",
+           calibrationRestored() ? "true" : "false", boot.setupUs / 1000.0,
+           boot.firstSampleUs ? boot.firstSampleUs / 1000.0 : -1.0);
+    if (DASHBOARD_ENABLED)
+    {
+        printf("  \"display\": {\"frames\": %lu, \"pushes\": %lu, \"pixels\": %llu},\n",
+               (unsigned long)dashboardFrameCount(), (unsigned long)hostDisplayPushes(),
+               (unsigned long long)hostDisplayPixels());
+    }
+    printf("  \"final_status\": %d,\n", (int)systemStatus());
+    printf("  \"wall_ms\": %.1f\n", wallMs);
+    printf("}\n");
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char** argv)
+{
+    SimOptions options;
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    hostSetStorageRoot(options.sdRoot);
+    Serial.setEcho(options.serialEcho);
+    simImu().setSeed(options.seed);
+    simImu().setBusSpeed(options.i2cHz);
+    if (options.traceDir != NULL && !simImu().openTrace(options.traceDir))
+    {
+        fprintf(stderr, "ERROR: Cannot open trace in %s\n", options.traceDir);
+        return 1;
+    }
+
+    if (options.recoveryCuts > 0)
+    {
+        return runRecoveryCheck(options.recoveryCuts, options.seed) ? 0 : 1;
+    }
+    if (options.formatRecords > 0)
+    {
+        return runFormatCheck(options.formatRecords, options.seed) ? 0 : 1;
+    }
+    if (options.featureWindows > 0)
+    {
+        return runFeatureCheck(options.featureWindows, options.seed) ? 0 : 1;
+    }
+    if (options.auxSamples > 0)
+    {
+        return runAuxBurstCheck(options.auxSamples, options.seed) ? 0 : 1;
+    }
+    if (options.governorSeconds > 0)
+    {
+        return runGovernorCheck(options.governorSeconds, options.seed, options.traceDir != NULL) ? 0 : 1;
+    }
+    if (options.pipelineSamples > 0)
+    {
+        return runPipelineCheck(options.pipelineSamples, options.seed) ? 0 : 1;
+    }
+    if (options.dashboardFrames > 0)
+    {
+        return runDashboardCheck(options.dashboardFrames, options.seed) ? 0 : 1;
+    }
+    if (options.ringMillions > 0)
+    {
+        return runRingCheck(options.ringMillions, options.seed) ? 0 : 1;
+    }
+    if (options.frameCount > 0)
+    {
+        return runFrameCheck(options.frameCount, options.seed) ? 0 : 1;
+    }
+    if (options.fifoSteps > 0)
+    {
+        return runFifoCheck(options.fifoSteps, options.seed) ? 0 : 1;
+    }
+    if (options.dataReadySteps > 0)
+    {
+        return runDataReadyCheck(options.dataReadySteps, options.seed) ? 0 : 1;
+    }
+
+    auto wallStart = std::chrono::steady_clock::now();
+    uint64_t bootUs = simNowMicros();
+
+    setup();
+
+    BootTiming boot;
+    boot.setupUs = simNowMicros() - bootUs;
+    boot.firstSampleUs = 0;
+
+    if (options.benchmarkIterations > 0)
+    {
+        StdoutPrint report;
+        runBenchmarks(report, options.benchmarkIterations);
+        return 0;
+    }
+
+    // The pipeline's tasks sleep in wall-clock time, so the clock must too
+    if (PIPELINE_MODE_ENABLED)
+    {
+        simUseWallClock();
+    }
+
+    // Duration is measured from the end of setup() (startup delay, calibration)
+    uint64_t startUs = simNowMicros();
+    uint64_t endUs = startUs + (uint64_t)options.durationMs * 1000ULL;
+    uint64_t loops = 0;
+    uint32_t setupBytes = sampleStreamBytes();
+    while (simNowMicros() < endUs && !simImu().traceFinished())
+    {
+        uint64_t passStartUs = simNowMicros();
+        loop();
+        simChargeLoopPass(passStartUs);
+        loops++;
+
+        if (boot.firstSampleUs == 0 && sampleStreamBytes() != setupBytes)
+        {
+            boot.firstSampleUs = simNowMicros() - bootUs;
+        }
+    }
+
+    double wallMs = std::chrono::duration<double, std::milli>(
+                        std::chrono::steady_clock::now() - wallStart).count();
+    printSummary(simNowMicros() - startUs, loops, boot, wallMs);
+    return 0;
+}
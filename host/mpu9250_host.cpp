@@ -0,0 +1,226 @@
+/**
+ * @file mpu9250_host.cpp
+ * @brief Host MPU9250 driver backed by the register-level simulator
+ * 
+ * Mirrors the M5Stack driver's register sequences so the firmware drives
+ * the simulated device exactly as it drives the real one. Self-test and
+ * bias calibration are reduced to what the application observes: plausible
+ * self-test trims, and gyro/accel biases averaged from resting samples.
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "utility/MPU9250.h"
+#include "sim_imu.h"
+#include "sim_clock.h"
+#include "hal.h"
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+#define CALIBRATION_SAMPLES 40
+
+// ============================================================================
+// SCALE FACTORS
+// ============================================================================
+
+void MPU9250::getMres(void)
+{
+    switch (Mscale)
+    {
+    case MFS_14BITS:
+        mRes = 10.0f * 4912.0f / 8190.0f;
+        break;
+    case MFS_16BITS:
+    default:
+        mRes = 10.0f * 4912.0f / 32760.0f;
+        break;
+    }
+}
+
+void MPU9250::getGres(void)
+{
+    gRes = (float)(250 << Gscale) / 32768.0f;
+}
+
+void MPU9250::getAres(void)
+{
+    aRes = (float)(2 << Ascale) / 32768.0f;
+}
+
+// ============================================================================
+// DATA REGISTERS
+// ============================================================================
+
+void MPU9250::readAccelData(int16_t* destination)
+{
+    uint8_t raw[6];
+    readBytes(MPU9250_ADDRESS, ACCEL_XOUT_H, 6, raw);
+    for (int i = 0; i < 3; i++)
+    {
+        destination[i] = (int16_t)(((int16_t)raw[2 * i] << 8) | raw[2 * i + 1]);
+    }
+}
+
+void MPU9250::readGyroData(int16_t* destination)
+{
+    uint8_t raw[6];
+    readBytes(MPU9250_ADDRESS, GYRO_XOUT_H, 6, raw);
+    for (int i = 0; i < 3; i++)
+    {
+        destination[i] = (int16_t)(((int16_t)raw[2 * i] << 8) | raw[2 * i + 1]);
+    }
+}
+
+void MPU9250::readMagData(int16_t* destination)
+{
+    uint8_t raw[7];
+
+    if (readByte(AK8963_ADDRESS, AK8963_ST1) & 0x01)
+    {
+        readBytes(AK8963_ADDRESS, AK8963_XOUT_L, 7, raw);
+        if (!(raw[6] & 0x08))
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                destination[i] = (int16_t)(((int16_t)raw[2 * i + 1] << 8) | raw[2 * i]);
+            }
+        }
+    }
+}
+
+int16_t MPU9250::readTempData(void)
+{
+    uint8_t raw[2];
+    readBytes(MPU9250_ADDRESS, TEMP_OUT_H, 2, raw);
+    return (int16_t)(((int16_t)raw[0] << 8) | raw[1]);
+}
+
+void MPU9250::updateTime(void)
+{
+    Now = halMicros();
+    deltat = ((Now - lastUpdate) / 1000000.0f);
+    lastUpdate = Now;
+    sum += deltat;
+    sumCount++;
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+void MPU9250::initAK8963(float* destination)
+{
+    uint8_t raw[3];
+
+    writeByte(AK8963_ADDRESS, AK8963_CNTL, 0x00);
+    halDelay(10);
+    writeByte(AK8963_ADDRESS, AK8963_CNTL, 0x0F);
+    halDelay(10);
+    readBytes(AK8963_ADDRESS, AK8963_ASAX, 3, raw);
+    for (int i = 0; i < 3; i++)
+    {
+        destination[i] = (float)(raw[i] - 128) / 256.0f + 1.0f;
+    }
+    writeByte(AK8963_ADDRESS, AK8963_CNTL, 0x00);
+    halDelay(10);
+    writeByte(AK8963_ADDRESS, AK8963_CNTL, Mscale << 4 | Mmode);
+    halDelay(10);
+}
+
+void MPU9250::initMPU9250(void)
+{
+    writeByte(MPU9250_ADDRESS, PWR_MGMT_1, 0x00);
+    halDelay(100);
+    writeByte(MPU9250_ADDRESS, PWR_MGMT_1, 0x01);
+    halDelay(200);
+
+    writeByte(MPU9250_ADDRESS, CONFIG, 0x03);
+    writeByte(MPU9250_ADDRESS, SMPLRT_DIV, 0x04);
+    writeByte(MPU9250_ADDRESS, GYRO_CONFIG, Gscale << 3);
+    writeByte(MPU9250_ADDRESS, ACCEL_CONFIG, Ascale << 3);
+    writeByte(MPU9250_ADDRESS, ACCEL_CONFIG2, 0x03);
+    writeByte(MPU9250_ADDRESS, INT_PIN_CFG, 0x22);
+    writeByte(MPU9250_ADDRESS, INT_ENABLE, 0x01);
+    halDelay(100);
+}
+
+void MPU9250::calibrateMPU9250(float* gyroBiasOut, float* accelBiasOut)
+{
+    int32_t gyroSum[3] = {0, 0, 0};
+    int32_t accelSum[3] = {0, 0, 0};
+    int16_t raw[3];
+    int16_t zero[3] = {0, 0, 0};
+
+    // Full-scale settings used by the driver during calibration
+    writeByte(MPU9250_ADDRESS, CONFIG, 0x01);
+    writeByte(MPU9250_ADDRESS, SMPLRT_DIV, 0x00);
+    writeByte(MPU9250_ADDRESS, GYRO_CONFIG, 0x00);
+    writeByte(MPU9250_ADDRESS, ACCEL_CONFIG, 0x00);
+    simImu().setGyroOffset(zero);
+
+    for (int n = 0; n < CALIBRATION_SAMPLES; n++)
+    {
+        halDelay(1);
+        readGyroData(raw);
+        for (int i = 0; i < 3; i++)
+        {
+            gyroSum[i] += raw[i];
+        }
+        readAccelData(raw);
+        for (int i = 0; i < 3; i++)
+        {
+            accelSum[i] += raw[i];
+        }
+    }
+
+    int16_t offset[3];
+    const float gyroSensitivity = 131.0f;
+    const float accelSensitivity = 16384.0f;
+    accelSum[2] -= (int32_t)accelSensitivity * CALIBRATION_SAMPLES;
+
+    for (int i = 0; i < 3; i++)
+    {
+        offset[i] = (int16_t)(gyroSum[i] / CALIBRATION_SAMPLES);
+        gyroBiasOut[i] = (float)offset[i] / gyroSensitivity;
+        accelBiasOut[i] = (float)accelSum[i] / CALIBRATION_SAMPLES / accelSensitivity;
+    }
+
+    // The driver writes the gyro bias into the offset registers
+    simImu().setGyroOffset(offset);
+}
+
+void MPU9250::MPU9250SelfTest(float* destination)
+{
+    static const float trims[6] = {0.5f, 0.8f, 0.6f, 1.2f, 0.9f, 1.1f};
+
+    writeByte(MPU9250_ADDRESS, SMPLRT_DIV, 0x00);
+    writeByte(MPU9250_ADDRESS, CONFIG, 0x02);
+    halDelay(50);
+    for (int i = 0; i < 6; i++)
+    {
+        destination[i] = trims[i];
+    }
+}
+
+// ============================================================================
+// REGISTER ACCESS
+// ============================================================================
+
+void MPU9250::writeByte(uint8_t address, uint8_t subAddress, uint8_t data)
+{
+    simImu().writeRegister(address, subAddress, data);
+}
+
+uint8_t MPU9250::readByte(uint8_t address, uint8_t subAddress)
+{
+    return simImu().readRegister(address, subAddress);
+}
+
+void MPU9250::readBytes(uint8_t address, uint8_t subAddress, uint8_t count, uint8_t* destination)
+{
+    simImu().readRegisters(address, subAddress, count, destination);
+}
@@ -0,0 +1,458 @@
+/**
+ * @file pipeline_check.cpp
+ * @brief Check and cost of the output pipeline configurations
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "pipeline_check.h"
+#include "check_util.h"
+#include "output_config.h"
+#include "record_format.h"
+#include "hal.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// CHECK PARAMETERS
+// ============================================================================
+
+#define CHECK_PERIOD_MS (1000 / IMU_SAMPLE_RATE_HZ)
+#define CHECK_STREAMS 5
+#define CHECK_STREAM_FORMAT "/pipeline_check_%d.txt"
+
+// Largest difference of a logged value from the tick it came from; the
+// records carry six decimals
+#define RECORD_TOLERANCE 1.0e-3
+
+// Runs per configuration; the fastest one is reported
+#define TIMING_PASSES 5
+
+// ============================================================================
+// SYNTHETIC SAMPLES
+// ============================================================================
+
+static float noise(float amplitude)
+{
+    return amplitude * ((float)(nextRandom() >> 8) / 8388608.0f - 1.0f);
+}
+
+/**
+ * @brief A slowly tumbling sensor with noise, in firmware units
+ */
+static void synthesizeSample(uint32_t index, ImuSample& sample)
+{
+    float t = (float)index / IMU_SAMPLE_RATE_HZ;
+
+    memset(&sample, 0, sizeof(sample));
+    sample.timestampMs = index * CHECK_PERIOD_MS;
+    sample.deltat = 1.0f / IMU_SAMPLE_RATE_HZ;
+    sample.ax = 0.3f * sinf(t) + noise(0.01f);
+    sample.ay = 0.2f * cosf(0.7f * t) + noise(0.01f);
+    sample.az = 0.95f + noise(0.01f);
+    sample.gx = 30.0f * sinf(0.9f * t) + noise(0.5f);
+    sample.gy = 20.0f * cosf(1.3f * t) + noise(0.5f);
+    sample.gz = 10.0f + noise(0.5f);
+    sample.mx = 200.0f + 100.0f * cosf(t) + noise(5.0f);
+    sample.my = 300.0f + noise(5.0f);
+    sample.mz = -400.0f + 50.0f * sinf(t) + noise(5.0f);
+}
+
+// ============================================================================
+// STAGE STAND-INS
+// ============================================================================
+
+/**
+ * @brief Console that counts what it is given
+ */
+class CountingPrint : public Print
+{
+public:
+    CountingPrint(void) : bytes(0), lines(0) {}
+
+    size_t write(const uint8_t* buffer, size_t size) override
+    {
+        for (size_t i = 0; i < size; i++)
+        {
+            lines += (buffer[i] == '\n');
+        }
+        bytes += size;
+        return size;
+    }
+    using Print::write;
+
+    uint32_t bytes;
+    uint32_t lines;
+};
+
+static LogStream checkStreams[CHECK_STREAMS];
+
+static void streamPath(int stream, char* path, size_t size)
+{
+    snprintf(path, size, CHECK_STREAM_FORMAT, stream);
+}
+
+/**
+ * @brief Sink of each kind, CsvSink on the scratch streams
+ */
+static NullSink makeSink(const NullSink*)
+{
+    return NullSink();
+}
+
+static CsvSink makeSink(const CsvSink*)
+{
+    return CsvSink(checkStreams[0], checkStreams[1], checkStreams[2], checkStreams[3], checkStreams[4]);
+}
+
+static DashboardSink makeSink(const DashboardSink*)
+{
+    return DashboardSink();
+}
+
+template <typename First, typename Second>
+static SinkPair<First, Second> makeSink(const SinkPair<First, Second>*)
+{
+    return SinkPair<First, Second>(makeSink((const First*)NULL), makeSink((const Second*)NULL));
+}
+
+/**
+ * @brief Console lines per tick of each formatter
+ */
+template <typename Formatter>
+struct FormatterLines;
+
+template <>
+struct FormatterLines<NullFormatter> { static const uint32_t value = 0; };
+
+template <>
+struct FormatterLines<TextFormatter> { static const uint32_t value = 7; };
+
+template <>
+struct FormatterLines<ProcessingFormatter> { static const uint32_t value = 1; };
+
+template <>
+struct FormatterLines<ReadoutFormatter> { static const uint32_t value = 5; };
+
+template <typename First, typename Second>
+struct FormatterLines<FormatterPair<First, Second> >
+{
+    static const uint32_t value = FormatterLines<First>::value + FormatterLines<Second>::value;
+};
+
+template <typename Sink>
+struct SinkRecords { static const bool value = false; };
+
+template <>
+struct SinkRecords<CsvSink> { static const bool value = true; };
+
+template <typename First, typename Second>
+struct SinkRecords<SinkPair<First, Second> >
+{
+    static const bool value = SinkRecords<First>::value || SinkRecords<Second>::value;
+};
+
+// ============================================================================
+// CONFIGURATIONS
+// ============================================================================
+
+/**
+ * @brief Outcome of one configuration
+ */
+struct ConfigurationResult
+{
+    uint32_t ticks;
+    uint32_t expectedTicks;
+    ImuSample lastTick;
+    float lastRateHz;
+    bool fused;                 ///< Same quaternion as the engine on its own
+    uint32_t profileUs;
+};
+
+/**
+ * @brief The firmware's use of the pipeline: fuse every sample, output at the rate
+ */
+template <typename Pipeline>
+static void drivePipeline(Pipeline& pipeline, const std::vector<ImuSample>& samples, ConfigurationResult& result)
+{
+    uint32_t rateCount = 0;
+    float rateSum = 0.0f;
+
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        ImuSample sample = samples[i];
+        pipeline.fuse(sample.ax, sample.ay, sample.az,
+                      sample.gx * DEG_TO_RAD, sample.gy * DEG_TO_RAD, sample.gz * DEG_TO_RAD,
+                      sample.mx, sample.my, sample.mz, sample.deltat);
+        rateCount++;
+        rateSum += sample.deltat;
+
+        if (pipeline.due(sample.timestampMs))
+        {
+            memcpy(sample.q, pipeline.quaternion(), sizeof(sample.q));
+            result.lastRateHz = (float)rateCount / rateSum;
+            pipeline.emit(sample, result.lastRateHz);
+            pipeline.restart(sample.timestampMs);
+
+            result.lastTick = sample;
+            result.ticks++;
+            rateCount = 0;
+            rateSum = 0.0f;
+        }
+    }
+}
+
+/**
+ * @brief Ticks a rate of @p intervalMs gives over samples at CHECK_PERIOD_MS
+ */
+static uint32_t expectedTicks(uint32_t samples, uint32_t intervalMs)
+{
+    uint32_t spacing = (intervalMs / CHECK_PERIOD_MS + 1) * CHECK_PERIOD_MS;
+    return (samples - 1) * CHECK_PERIOD_MS / spacing;
+}
+
+template <typename Fusion, typename Rate, typename Formatter, typename Sink>
+static void runConfiguration(const std::vector<ImuSample>& samples, CountingPrint& console,
+                             ConfigurationResult& result)
+{
+    typedef OutputPipeline<Fusion, Rate, Formatter, Sink> Pipeline;
+
+    Pipeline pipeline(console, makeSink((const Sink*)NULL));
+    Fusion reference;
+
+    memset(&result, 0, sizeof(result));
+    result.expectedTicks = expectedTicks((uint32_t)samples.size(), Rate::intervalMs());
+
+    uint32_t start = halProfileMicros();
+    drivePipeline(pipeline, samples, result);
+    result.profileUs = halProfileMicros() - start;
+
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        const ImuSample& sample = samples[i];
+        reference.update(sample.ax, sample.ay, sample.az,
+                         sample.gx * DEG_TO_RAD, sample.gy * DEG_TO_RAD, sample.gz * DEG_TO_RAD,
+                         sample.mx, sample.my, sample.mz, sample.deltat);
+    }
+    result.fused = memcmp(reference.quaternion(), pipeline.quaternion(), 4 * sizeof(float)) == 0;
+}
+
+// ============================================================================
+// RECORD CHECKS
+// ============================================================================
+
+/**
+ * @brief Data records in a scratch stream and the values of the last one
+ */
+static uint32_t readRecords(int stream, double* last, int& lastCount)
+{
+    char path[LOG_PATH_SIZE];
+    streamPath(stream, path, sizeof(path));
+
+    File file = halStorage().open(path, FILE_READ);
+    std::string text;
+    if (file)
+    {
+        text.resize(file.size());
+        text.resize(file.read((uint8_t*)&text[0], text.size()));
+        file.close();
+    }
+
+    uint32_t records = 0;
+    size_t position = 0;
+    while (position < text.size())
+    {
+        size_t end = text.find("\r\n", position);
+        if (end == std::string::npos)
+        {
+            end = text.size();
+        }
+        std::string line = text.substr(position, end - position);
+        position = end + 2;
+
+        if (line.empty() || line[0] < '0' || line[0] > '9')
+        {
+            continue;
+        }
+        records++;
+
+        // Timestamp, then up to CSV_RECORD_MAX_VALUES values
+        const char* cursor = line.c_str();
+        char* next;
+        lastCount = 0;
+        last[lastCount++] = strtod(cursor, &next);
+        while (*next == ',' && lastCount <= CSV_RECORD_MAX_VALUES)
+        {
+            cursor = next + 1;
+            last[lastCount++] = strtod(cursor, &next);
+        }
+    }
+    return records;
+}
+
+/**
+ * @brief Whether the scratch streams hold exactly the records @p result logged
+ */
+static bool recordsMatch(const ConfigurationResult& result, bool logged, uint32_t& records)
+{
+    const ImuSample& tick = result.lastTick;
+    float yaw, pitch, roll;
+    quaternionToEuler(tick.q, MAGNETIC_DECLINATION_DEG, yaw, pitch, roll);
+
+    const double expected[CHECK_STREAMS][CSV_RECORD_MAX_VALUES + 1] = {
+        {(double)tick.timestampMs, 1000.0 * tick.ax, 1000.0 * tick.ay, 1000.0 * tick.az, 0.0},
+        {(double)tick.timestampMs, tick.gx, tick.gy, tick.gz, 0.0},
+        {(double)tick.timestampMs, tick.my, tick.mx, tick.mz, 0.0},
+        {(double)tick.timestampMs, tick.q[0], tick.q[1], tick.q[2], tick.q[3]},
+        {(double)tick.timestampMs, result.lastRateHz, yaw, pitch, roll},
+    };
+    const int counts[CHECK_STREAMS] = {4, 4, 4, 5, 5};
+
+    bool ok = true;
+    records = 0;
+    for (int stream = 0; stream < CHECK_STREAMS; stream++)
+    {
+        double last[CSV_RECORD_MAX_VALUES + 1];
+        int lastCount = 0;
+        uint32_t streamRecords = readRecords(stream, last, lastCount);
+        records += streamRecords;
+
+        if (!logged)
+        {
+            ok = ok && streamRecords == 0;
+            continue;
+        }
+
+        ok = ok && streamRecords == result.ticks;
+        if (result.ticks == 0)
+        {
+            continue;
+        }
+        ok = ok && lastCount == counts[stream];
+        for (int i = 0; ok && i < counts[stream]; i++)
+        {
+            ok = fabs(last[i] - expected[stream][i]) <= RECORD_TOLERANCE;
+        }
+    }
+    return ok;
+}
+
+// ============================================================================
+// ENTRY POINT
+// ============================================================================
+
+/**
+ * @brief Run one configuration on fresh scratch streams and print its report entry
+ *
+ * The checks apply to the last of the TIMING_PASSES runs.
+ */
+template <typename Fusion, typename Rate, typename Formatter, typename Sink>
+static bool checkConfiguration(const char* name, const std::vector<ImuSample>& samples, bool first,
+                               uint32_t& failures)
+{
+    typedef OutputPipeline<Fusion, Rate, Formatter, Sink> Pipeline;
+    CountingPrint console;
+    ConfigurationResult result;
+    char path[LOG_PATH_SIZE];
+    uint32_t fastestUs = UINT32_MAX;
+
+    for (int pass = 0; pass < TIMING_PASSES; pass++)
+    {
+        for (int stream = 0; stream < CHECK_STREAMS; stream++)
+        {
+            streamPath(stream, path, sizeof(path));
+            checkStreams[stream].begin(halStorage(), path, "");
+        }
+
+        console = CountingPrint();
+        runConfiguration<Fusion, Rate, Formatter, Sink>(samples, console, result);
+        fastestUs = (result.profileUs < fastestUs) ? result.profileUs : fastestUs;
+
+        for (int stream = 0; stream < CHECK_STREAMS; stream++)
+        {
+            checkStreams[stream].close();
+        }
+    }
+
+    uint32_t records = 0;
+    bool ticked = result.ticks == result.expectedTicks;
+    bool printed = console.lines == result.ticks * FormatterLines<Formatter>::value
+                && (console.bytes == 0) == (FormatterLines<Formatter>::value == 0);
+    bool logged = recordsMatch(result, SinkRecords<Sink>::value, records);
+    bool ok = result.fused && ticked && printed && logged;
+
+    for (int stream = 0; stream < CHECK_STREAMS; stream++)
+    {
+        streamPath(stream, path, sizeof(path));
+        halStorage().remove(path);
+    }
+
+    if (!ok)
+    {
+        reportFailure(failures, "FAIL %s: fused %d ticks %lu/%lu printed %d logged %d", name, (int)result.fused,
+                      (unsigned long)result.ticks, (unsigned long)result.expectedTicks, (int)printed, (int)logged);
+    }
+
+    printf("%s{\"name\":\"%s\",\"ticks\":%lu,\"console_bytes\":%lu,\"records\":%lu,\"state_bytes\":%u,"
+           "\"ns_per_sample\":%.1f,\"pass\":%s}",
+           first ? "" : ",", name, (unsigned long)result.ticks, (unsigned long)console.bytes,
+           (unsigned long)records, (unsigned)sizeof(Pipeline),
+           1000.0 * fastestUs / samples.size(), jsonBool(ok));
+    return ok;
+}
+
+bool runPipelineCheck(uint32_t samples, uint32_t seed)
+{
+    typedef MahonyKernel<float> Mahony;
+    typedef IntervalRate<AHRS_UPDATE_INTERVAL_MS> AhrsRate;
+    typedef FormatterPair<TextFormatter, NullFormatter> Text;
+    uint32_t failures = 0;
+    bool ok = true;
+
+    if (samples < 2)
+    {
+        samples = 2;
+    }
+
+    seedRandom(seed);
+    std::vector<ImuSample> input(samples);
+    for (uint32_t i = 0; i < samples; i++)
+    {
+        synthesizeSample(i, input[i]);
+    }
+
+    beginCheckReport("pipeline", seed);
+    printf(",\"samples\":%lu,\"configurations\":[", (unsigned long)samples);
+
+    ok &= checkConfiguration<OutputFusion, OutputRate, OutputFormatter, OutputSink>("configured", input, true, failures);
+    ok &= checkConfiguration<Mahony, AhrsRate, Text, CsvSink>("mahony_text_csv", input, false, failures);
+    ok &= checkConfiguration<MahonyKernel<FixedPoint<FUSION_FIXED_FRAC_BITS> >, AhrsRate, Text, CsvSink>(
+        "mahony_fixed_text_csv", input, false, failures);
+    ok &= checkConfiguration<MadgwickKernel<float>, AhrsRate, Text, CsvSink>("madgwick_text_csv", input, false, failures);
+    ok &= checkConfiguration<ComplementaryKernel<float>, AhrsRate, Text, CsvSink>(
+        "complementary_text_csv", input, false, failures);
+    ok &= checkConfiguration<Mahony, GovernedRate, Text, CsvSink>("mahony_governed_text_csv", input, false, failures);
+    ok &= checkConfiguration<Mahony, AhrsRate, FormatterPair<TextFormatter, ProcessingFormatter>, CsvSink>(
+        "mahony_text_processing_csv", input, false, failures);
+    ok &= checkConfiguration<Mahony, AhrsRate, NullFormatter, CsvSink>("mahony_csv", input, false, failures);
+    ok &= checkConfiguration<Mahony, AhrsRate, Text, SinkPair<CsvSink, DashboardSink> >(
+        "mahony_text_csv_dashboard", input, false, failures);
+    ok &= checkConfiguration<Mahony, AhrsRate, FormatterPair<NullFormatter, ProcessingFormatter>, NullSink>(
+        "mahony_processing", input, false, failures);
+    ok &= checkConfiguration<Mahony, IntervalRate<0>, NullFormatter, CsvSink>("mahony_every_sample_csv", input, false,
+                                                                             failures);
+    ok &= checkConfiguration<Mahony, AhrsRate, NullFormatter, NullSink>("mahony_silent", input, false, failures);
+    ok &= checkConfiguration<PassthroughFusion, IntervalRate<BASIC_UPDATE_INTERVAL_MS>, ReadoutFormatter, NullSink>(
+        "basic_readout", input, false, failures);
+    ok &= checkConfiguration<PassthroughFusion, AhrsRate, NullFormatter, NullSink>("silent", input, false, failures);
+
+    printf("],\"failures\":%lu", (unsigned long)failures);
+    endCheckReport(ok);
+    return ok;
+}
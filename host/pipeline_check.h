@@ -0,0 +1,46 @@
+/**
+ * @file pipeline_check.h
+ * @brief Check and cost of the output pipeline configurations
+ *
+ * Instantiates OutputPipeline (output_pipeline.h) with the firmware's
+ * configured stages (output_config.h) and with the other stage
+ * combinations: every fusion engine, float and fixed point, the
+ * formatters alone and paired, the CSV sink alone and paired with the
+ * dashboard sink, the governed and the every-sample rate, and the
+ * all-null pipeline. Each runs the same
+ * synthetic samples at IMU_SAMPLE_RATE_HZ into a counting console and
+ * five scratch CSV streams, and must
+ *
+ * - fuse to the same quaternion as its engine run on its own,
+ * - tick exactly as often as its rate allows,
+ * - print its formatter's lines per tick and nothing for NullFormatter,
+ * - log one record per tick on each CSV stream, the last one matching the
+ *   last tick, and none with NullSink.
+ *
+ * The report gives each configuration's state size and host time per
+ * sample (the fastest of several runs, including the scratch file writes).
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef PIPELINE_CHECK_H
+#define PIPELINE_CHECK_H
+
+#include <stdint.h>
+
+// ============================================================================
+// PIPELINE CHECK
+// ============================================================================
+
+/**
+ * @brief Run the check and print one JSON line
+ *
+ * @param samples Synthetic samples per configuration
+ * @param seed Random seed for the sensor noise
+ * @return true if every configuration passed
+ */
+bool runPipelineCheck(uint32_t samples, uint32_t seed);
+
+#endif // PIPELINE_CHECK_H
@@ -0,0 +1,407 @@
+/**
+ * @file recovery_check.cpp
+ * @brief Simulated power-loss check of the log segment recovery scan
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "recovery_check.h"
+#include "check_util.h"
+#include "sd_logger.h"
+#include "log_record.h"
+#include "packed_log.h"
+#include "config.h"
+#include "hal.h"
+#include <vector>
+
+// ============================================================================
+// CHECK PARAMETERS
+// ============================================================================
+
+#define CHECK_DIRECTORY "/recovery_check"
+#define CHECK_CUT_FILE CHECK_DIRECTORY "/cut.dat"
+
+// Records written per segment file, and one sync marker every this many on average
+#define CHECK_RECORDS 3000
+#define CHECK_SYNC_PERIOD 60
+
+// Frame segments: one scale change every this many frames on average
+#define CHECK_SCALE_PERIOD 200
+
+// Segment limit for the rotation check, and the lines written against it
+#define CHECK_SEGMENT_BYTES 8192
+#define CHECK_ROTATION_LINES 2000
+
+// ============================================================================
+// GROUND TRUTH
+// ============================================================================
+
+/**
+ * @brief End offset of one record as written
+ */
+struct RecordEnd
+{
+    uint32_t end;
+    bool marker;
+};
+
+struct KindResult
+{
+    const char* name;
+    uint32_t cuts;
+    uint32_t failures;
+    uint64_t fileBytes;
+    uint64_t scannedBytes;
+    uint32_t maxScannedBytes;
+};
+
+/**
+ * @brief Valid length a correct scan reports for a file cut at @p cut
+ */
+static uint32_t expectedValidBytes(const std::vector<RecordEnd>& records, LogRecordKind kind, uint32_t cut)
+{
+    if (kind == LOG_RECORDS_INDEX)
+    {
+        return cut - cut % PACKED_INDEX_ENTRY_SIZE;
+    }
+
+    size_t start = records.size();
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        if (records[i].marker && records[i].end <= cut)
+        {
+            start = i;
+        }
+    }
+    if (start == records.size())
+    {
+        return 0;
+    }
+
+    uint32_t valid = records[start].end;
+    for (size_t i = start + 1; i < records.size(); i++)
+    {
+        // A text line is only known to be complete once the next one has begun
+        bool confirmed = records[i].marker || kind != LOG_RECORDS_TEXT
+                             ? records[i].end <= cut
+                             : records[i].end + 2 <= cut && i + 1 < records.size();
+        if (!confirmed)
+        {
+            break;
+        }
+        valid = records[i].end;
+    }
+    return valid;
+}
+
+// ============================================================================
+// SEGMENT WRITERS
+// ============================================================================
+
+static void randomFrame(ImuFrame& frame, uint32_t timestampMs)
+{
+    memset(&frame, 0, sizeof(frame));
+    frame.timestampMs = timestampMs;
+    for (int i = 0; i < 3; i++)
+    {
+        frame.accelCount[i] = (int16_t)(nextRandom() % 400);
+        frame.gyroCount[i] = (int16_t)(nextRandom() % 40);
+        frame.magCount[i] = (int16_t)(nextRandom() % 20);
+    }
+    frame.q[0] = 1.0f;
+    identityFrameScale(frame.scale);
+    frame.scale.aRes = 1.0f / 16384.0f;
+    frame.scale.gRes = 250.0f / 32768.0f;
+    frame.scale.mRes = 1.5f;
+}
+
+static void noteRecord(LogStream& stream, std::vector<RecordEnd>& records)
+{
+    RecordEnd record = {stream.segmentBytes(), false};
+    records.push_back(record);
+}
+
+static void noteSync(LogStream& stream, std::vector<RecordEnd>& records, bool closing)
+{
+    uint32_t before = stream.segmentBytes();
+    if (closing)
+    {
+        stream.close();
+    }
+    else
+    {
+        stream.sync();
+    }
+
+    uint32_t after = stream.segmentBytes();
+    if (after > before)
+    {
+        RecordEnd record = {after, true};
+        records.push_back(record);
+    }
+}
+
+/**
+ * @brief Write one segment of @p kind records and keep their boundaries
+ */
+static bool writeSegment(const char* path, LogRecordKind kind, std::vector<RecordEnd>& records)
+{
+    static LogStream stream;
+    static PackedBlockEncoder encoder(LOG_PACKED_BLOCK_SAMPLES);
+    static const char alphabet[] = "0123456789,.-";
+    FrameScaleState scaleState;
+
+    records.clear();
+    resetFrameScaleState(scaleState);
+    if (kind == LOG_RECORDS_INDEX)
+    {
+        if (!stream.begin(halStorage(), path, ""))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        if (!stream.beginSegment(halStorage(), path, "#segment,0,0,0", "millis,a,b,c"))
+        {
+            return false;
+        }
+        RecordEnd start = {stream.segmentBytes(), true};
+        records.push_back(start);
+    }
+
+    uint32_t timestampMs = 0;
+    for (uint32_t n = 0; n < CHECK_RECORDS; n++)
+    {
+        if (kind == LOG_RECORDS_TEXT)
+        {
+            char line[96] = "\r\n";
+            size_t length = 2 + 3 + nextRandom() % 80;
+            for (size_t i = 2; i < length; i++)
+            {
+                line[i] = alphabet[nextRandom() % (sizeof(alphabet) - 1)];
+            }
+            line[length] = '\0';
+            stream.print(line);
+        }
+        else if (kind == LOG_RECORDS_FRAMES)
+        {
+            ImuFrame frame;
+            uint8_t encoded[LOG_RECORD_MAX_SIZE];
+            randomFrame(frame, timestampMs += 10);
+            if (scaleState.valid && nextRandom() % CHECK_SCALE_PERIOD == 0)
+            {
+                frame.scale.gyroBias[nextRandom() % 3] = (float)(nextRandom() % 100) / 50.0f;
+            }
+            else if (scaleState.valid)
+            {
+                frame.scale = scaleState.scale;
+            }
+
+            // A scale record is a record of its own for the scan
+            if (frameScaleChanged(scaleState, frame.scale))
+            {
+                encodeScaleRecord(frame.scale, scaleState, encoded);
+                stream.write((const char*)encoded, LOG_SCALE_RECORD_SIZE);
+                noteRecord(stream, records);
+            }
+            encodeImuFrame(frame, scaleState, encoded);
+            stream.write((const char*)encoded, LOG_FRAME_SIZE);
+        }
+        else if (kind == LOG_RECORDS_PACKED)
+        {
+            ImuFrame frame;
+            const uint8_t* block;
+            uint32_t samples = 1 + nextRandom() % LOG_PACKED_BLOCK_SAMPLES;
+            for (uint32_t s = 0; s < samples; s++)
+            {
+                randomFrame(frame, timestampMs += 10);
+                encoder.add(frame);
+            }
+            size_t length = encoder.finish(block);
+            stream.write((const char*)block, length);
+        }
+        else
+        {
+            PackedBlockInfo info = {nextRandom(), timestampMs, timestampMs + 999, 100, 0};
+            uint8_t entry[PACKED_INDEX_ENTRY_SIZE];
+            timestampMs += 1000;
+            encodePackedIndexEntry(info, entry);
+            stream.write((const char*)entry, PACKED_INDEX_ENTRY_SIZE);
+        }
+        noteRecord(stream, records);
+
+        if (nextRandom() % CHECK_SYNC_PERIOD == 0)
+        {
+            noteSync(stream, records, false);
+        }
+    }
+
+    noteSync(stream, records, true);
+    return true;
+}
+
+/**
+ * @brief Read a whole host file through the storage root
+ */
+static bool loadFile(const char* path, std::vector<uint8_t>& data)
+{
+    File file = halStorage().open(path, FILE_READ);
+    if (!file)
+    {
+        return false;
+    }
+    data.resize(file.size());
+    size_t got = file.read(data.data(), data.size());
+    file.close();
+    return got == data.size();
+}
+
+/**
+ * @brief Cut @p data at random offsets and check the recovered length each time
+ */
+static void checkCuts(const std::vector<uint8_t>& data, const std::vector<RecordEnd>& records,
+                      LogRecordKind kind, uint32_t cuts, KindResult& result)
+{
+    static const uint8_t zeros[LOG_RECOVERY_CHUNK_SIZE] = {0};
+
+    for (uint32_t n = 0; n < cuts; n++)
+    {
+        uint32_t cut = nextRandom() % (uint32_t)(data.size() + 1);
+        bool zeroFill = (nextRandom() & 1) != 0;
+
+        File file = halStorage().open(CHECK_CUT_FILE, FILE_WRITE);
+        file.write(data.data(), cut);
+        if (zeroFill && cut % LOG_RECOVERY_CHUNK_SIZE != 0)
+        {
+            file.write(zeros, LOG_RECOVERY_CHUNK_SIZE - cut % LOG_RECOVERY_CHUNK_SIZE);
+        }
+        file.close();
+
+        // Fill bytes that happen to equal the lost data restore it
+        uint32_t intact = cut;
+        while (zeroFill && intact < data.size() && intact % LOG_RECOVERY_CHUNK_SIZE != 0 && data[intact] == 0)
+        {
+            intact++;
+        }
+
+        LogRecovery recovery;
+        uint32_t expected = expectedValidBytes(records, kind, intact);
+        if (!recoverLogSegment(halStorage(), CHECK_CUT_FILE, kind, recovery) || recovery.validBytes != expected)
+        {
+            if (result.failures == 0)
+            {
+                fprintf(stderr, "ERROR: %s cut at %lu%s: recovered %lu bytes, expected %lu\n", result.name,
+                        (unsigned long)cut, zeroFill ? " (zero-filled)" : "",
+                        (unsigned long)recovery.validBytes, (unsigned long)expected);
+            }
+            result.failures++;
+        }
+
+        result.cuts++;
+        result.fileBytes += recovery.fileBytes;
+        result.scannedBytes += recovery.scannedBytes;
+        if (recovery.scannedBytes > result.maxScannedBytes)
+        {
+            result.maxScannedBytes = recovery.scannedBytes;
+        }
+    }
+}
+
+// ============================================================================
+// ROTATION
+// ============================================================================
+
+/**
+ * @brief Fill several small segments, then boot again
+ *
+ * @return true if the segments rotated, every closed segment ends in a
+ *         marker and the next boot opened the next session
+ */
+static bool checkRotation(uint16_t& segments)
+{
+    char path[LOG_PATH_SIZE];
+
+    setLogSegmentLimit(CHECK_SEGMENT_BYTES);
+    initializeDataFiles();
+    uint16_t session = logSessionNumber();
+
+    for (uint32_t n = 0; n < CHECK_ROTATION_LINES; n++)
+    {
+        snprintf(path, sizeof(path), "\r\n%lu,1.000000,2.000000,3.000000", (unsigned long)n);
+        accelLog.print(path);
+        serviceDataFiles();
+    }
+    segments = logSegmentNumber();
+
+    bool ok = segments > 0;
+    for (uint16_t segment = 0; ok && segment < segments; segment++)
+    {
+        LogRecovery recovery;
+        int length = snprintf(path, sizeof(path), LOG_SEGMENT_DIR_FORMAT, (unsigned)session, (unsigned)segment);
+        snprintf(path + length, sizeof(path) - length, "%s", FILE_ACCELERATION);
+        ok = recoverLogSegment(halStorage(), path, LOG_RECORDS_TEXT, recovery)
+             && recovery.markerFound && recovery.validBytes == recovery.fileBytes;
+    }
+
+    initializeDataFiles();
+    ok = ok && logSessionNumber() == session + 1 && logSegmentNumber() == 0;
+
+    syncDataFiles();
+    setLogSegmentLimit(LOG_SEGMENT_MAX_BYTES);
+    return ok;
+}
+
+// ============================================================================
+// ENTRY POINT
+// ============================================================================
+
+bool runRecoveryCheck(uint32_t cuts, uint32_t seed)
+{
+    static const LogRecordKind kinds[] = {LOG_RECORDS_TEXT, LOG_RECORDS_FRAMES, LOG_RECORDS_PACKED, LOG_RECORDS_INDEX};
+    static const char* names[] = {"text", "frames", "packed", "index"};
+    KindResult results[4];
+    std::vector<RecordEnd> records;
+    std::vector<uint8_t> data;
+    char path[LOG_PATH_SIZE];
+    bool ok = true;
+
+    seedRandom(seed);
+    halStorage().mkdir(CHECK_DIRECTORY);
+
+    for (int k = 0; k < 4; k++)
+    {
+        memset(&results[k], 0, sizeof(results[k]));
+        results[k].name = names[k];
+
+        snprintf(path, sizeof(path), CHECK_DIRECTORY "/%s.dat", names[k]);
+        if (!writeSegment(path, kinds[k], records) || !loadFile(path, data))
+        {
+            fprintf(stderr, "ERROR: Cannot write %s\n", path);
+            return false;
+        }
+        checkCuts(data, records, kinds[k], cuts, results[k]);
+        ok = ok && results[k].failures == 0;
+    }
+
+    uint16_t segments = 0;
+    bool rotationOk = checkRotation(segments);
+    ok = ok && rotationOk;
+
+    beginCheckReport("log_recovery", seed);
+    for (int k = 0; k < 4; k++)
+    {
+        const KindResult& r = results[k];
+        printf(",\"%s\":{\"cuts\":%lu,\"failures\":%lu,\"mean_file_bytes\":%.0f,"
+               "\"mean_scanned_bytes\":%.0f,\"max_scanned_bytes\":%lu}",
+               r.name, (unsigned long)r.cuts, (unsigned long)r.failures,
+               r.cuts ? (double)r.fileBytes / r.cuts : 0.0, r.cuts ? (double)r.scannedBytes / r.cuts : 0.0,
+               (unsigned long)r.maxScannedBytes);
+    }
+    printf(",\"rotation\":{\"segments\":%u,\"ok\":%s}",
+           (unsigned)segments + 1, jsonBool(rotationOk));
+    endCheckReport(ok);
+    return ok;
+}
@@ -0,0 +1,36 @@
+/**
+ * @file recovery_check.h
+ * @brief Simulated power-loss check of the log segment recovery scan
+ *
+ * Writes framed segments of every record kind through LogStream, keeps
+ * the true record boundaries, cuts copies of the files at random byte
+ * offsets (optionally zero-filling the rest of the sector, as a card does
+ * for an allocated but unwritten block) and checks that
+ * recoverLogSegment() reports exactly the end of the last complete
+ * record. Also checks session numbering and segment rotation through
+ * initializeDataFiles() and serviceDataFiles().
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef RECOVERY_CHECK_H
+#define RECOVERY_CHECK_H
+
+#include <stdint.h>
+
+// ============================================================================
+// RECOVERY CHECK
+// ============================================================================
+
+/**
+ * @brief Run the check in the storage root and print one JSON line
+ *
+ * @param cuts Simulated power losses per record kind
+ * @param seed Random seed for record contents and cut offsets
+ * @return true if every cut recovered to the expected length
+ */
+bool runRecoveryCheck(uint32_t cuts, uint32_t seed);
+
+#endif // RECOVERY_CHECK_H
@@ -0,0 +1,276 @@
+/**
+ * @file ring_check.cpp
+ * @brief Threaded stress check of the sample ring between the pipeline tasks
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "ring_check.h"
+#include "check_util.h"
+#include "imu_sample.h"
+#include "spsc_ring.h"
+#include "task_shim.h"
+#include "config.h"
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+// ============================================================================
+// CHECK PARAMETERS
+// ============================================================================
+
+// Longest producer burst, in samples
+#define MAX_BURST (2 * PIPELINE_RING_SIZE)
+
+// Longest producer pause between bursts, in spin iterations
+#define MAX_PAUSE_SPINS 2000
+
+// The consumer stalls after one pop in this many, for up to this many spins
+#define STALL_PERIOD 4096
+#define MAX_STALL_SPINS 200000
+
+// ============================================================================
+// SHARED STATE
+// ============================================================================
+
+/**
+ * @brief State of one run, written by one thread each and read at the end
+ */
+struct RingRun
+{
+    uint32_t samples;
+    uint32_t seed;
+
+    // Producer
+    uint32_t pushFailures;
+    std::atomic<bool> producerDone;
+
+    // Consumer
+    uint32_t received;
+    uint32_t missing;           ///< Sequence numbers skipped
+    uint32_t reordered;         ///< Samples at or behind one already received
+    uint32_t torn;              ///< Samples whose contents do not match their number
+    uint32_t maxOccupancy;
+    std::atomic<bool> consumerDone;
+};
+
+static SpscRing<ImuSample, PIPELINE_RING_SIZE> ring;
+static RingRun run;
+
+// ============================================================================
+// SAMPLE PATTERN
+// ============================================================================
+
+/**
+ * @brief Busy-wait without touching shared memory
+ */
+static void spin(uint32_t iterations)
+{
+    volatile uint32_t sink = 0;
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        sink = i;
+    }
+    (void)sink;
+}
+
+/**
+ * @brief Fill every field of @p sample from its sequence number
+ *
+ * The values are small integers, exact as floats, so a sample copied whole
+ * compares equal field by field.
+ */
+static void fillSample(ImuSample& sample, uint32_t sequence)
+{
+    uint32_t word = sequence * 2654435761u;
+
+    sample.timestampMs = sequence;
+    sample.deltat = (float)(word >> 16);
+    for (int i = 0; i < 3; i++)
+    {
+        sample.accelCount[i] = (int16_t)(word >> i);
+        sample.gyroCount[i] = (int16_t)(word >> (i + 3));
+        sample.magCount[i] = (int16_t)(word >> (i + 6));
+    }
+    sample.ax = (float)(word & 0xFF);
+    sample.ay = (float)((word >> 1) & 0xFF);
+    sample.az = (float)((word >> 2) & 0xFF);
+    sample.gx = (float)((word >> 3) & 0xFF);
+    sample.gy = (float)((word >> 4) & 0xFF);
+    sample.gz = (float)((word >> 5) & 0xFF);
+    sample.mx = (float)((word >> 6) & 0xFF);
+    sample.my = (float)((word >> 7) & 0xFF);
+    sample.mz = (float)((word >> 8) & 0xFF);
+    for (int i = 0; i < 4; i++)
+    {
+        sample.q[i] = (float)((word >> (9 + i)) & 0xFF);
+    }
+
+    float scales[FRAME_SCALE_FLOATS];
+    for (int i = 0; i < FRAME_SCALE_FLOATS; i++)
+    {
+        scales[i] = (float)((word >> (i % 16)) & 0xFF);
+    }
+    scatterFrameScale(scales, sample.scale);
+}
+
+static bool sameSample(const ImuSample& a, const ImuSample& b)
+{
+    float scalesA[FRAME_SCALE_FLOATS];
+    float scalesB[FRAME_SCALE_FLOATS];
+    gatherFrameScale(a.scale, scalesA);
+    gatherFrameScale(b.scale, scalesB);
+
+    return a.timestampMs == b.timestampMs && a.deltat == b.deltat
+        && memcmp(a.accelCount, b.accelCount, sizeof(a.accelCount)) == 0
+        && memcmp(a.gyroCount, b.gyroCount, sizeof(a.gyroCount)) == 0
+        && memcmp(a.magCount, b.magCount, sizeof(a.magCount)) == 0
+        && a.ax == b.ax && a.ay == b.ay && a.az == b.az
+        && a.gx == b.gx && a.gy == b.gy && a.gz == b.gz
+        && a.mx == b.mx && a.my == b.my && a.mz == b.mz
+        && memcmp(a.q, b.q, sizeof(a.q)) == 0
+        && memcmp(scalesA, scalesB, sizeof(scalesA)) == 0;
+}
+
+// ============================================================================
+// TASKS
+// ============================================================================
+
+/**
+ * @brief Push every sample in random bursts, counting the pushes that fail
+ *
+ * Yields after each burst, as the sampling task does after each pass, so
+ * the consumer also gets to run on a single-core host.
+ */
+static void producerTask(void* argument)
+{
+    RingRun& state = *(RingRun*)argument;
+    uint32_t rng = state.seed * 2u + 1u;
+    uint32_t failures = 0;
+    ImuSample sample;
+
+    uint32_t sequence = 0;
+    while (sequence < state.samples)
+    {
+        uint32_t burst = 1 + nextRandom(rng) % MAX_BURST;
+        for (; burst > 0 && sequence < state.samples; burst--, sequence++)
+        {
+            fillSample(sample, sequence);
+            failures += ring.push(sample) ? 0 : 1;
+        }
+        spin(nextRandom(rng) % MAX_PAUSE_SPINS);
+        taskSleep(0);
+    }
+
+    state.pushFailures = failures;
+    state.producerDone.store(true, std::memory_order_release);
+}
+
+/**
+ * @brief Pop until the producer is done and the ring is empty, checking
+ *        order and contents
+ */
+static void consumerTask(void* argument)
+{
+    RingRun& state = *(RingRun*)argument;
+    uint32_t rng = state.seed * 2u + 3u;
+    uint32_t expected = 0;
+    ImuSample sample;
+    ImuSample reference;
+
+    for (;;)
+    {
+        // Read before the pop: once it is set, an empty ring stays empty
+        bool finished = state.producerDone.load(std::memory_order_acquire);
+        size_t occupancy = ring.size();
+        if (!ring.pop(sample))
+        {
+            if (finished)
+            {
+                break;
+            }
+            taskSleep(0);
+            continue;
+        }
+
+        state.received++;
+        state.maxOccupancy = (occupancy > state.maxOccupancy) ? (uint32_t)occupancy : state.maxOccupancy;
+
+        uint32_t sequence = sample.timestampMs;
+        fillSample(reference, sequence);
+        if (!sameSample(sample, reference) || sequence >= state.samples)
+        {
+            reportFailure(state.torn, "TORN sample %lu after %lu", (unsigned long)sequence,
+                          (unsigned long)expected);
+            continue;
+        }
+        if (sequence < expected)
+        {
+            reportFailure(state.reordered, "ORDER sample %lu after %lu", (unsigned long)sequence,
+                          (unsigned long)expected);
+            continue;
+        }
+        state.missing += sequence - expected;
+        expected = sequence + 1;
+
+        if (nextRandom(rng) % STALL_PERIOD == 0)
+        {
+            spin(nextRandom(rng) % MAX_STALL_SPINS);
+        }
+    }
+
+    state.missing += state.samples - expected;
+    state.consumerDone.store(true, std::memory_order_release);
+}
+
+// ============================================================================
+// RING CHECK
+// ============================================================================
+
+bool runRingCheck(uint32_t millions, uint32_t seed)
+{
+    run.samples = millions * 1000000u;
+    run.seed = seed;
+    run.pushFailures = 0;
+    run.producerDone.store(false);
+    run.received = 0;
+    run.missing = 0;
+    run.reordered = 0;
+    run.torn = 0;
+    run.maxOccupancy = 0;
+    run.consumerDone.store(false);
+
+    auto wallStart = std::chrono::steady_clock::now();
+    bool started = startTask(consumerTask, "ring_consumer", PIPELINE_TASK_STACK_SIZE, &run,
+                             LOGGING_TASK_PRIORITY, LOGGING_TASK_CORE);
+    started = started && startTask(producerTask, "ring_producer", PIPELINE_TASK_STACK_SIZE, &run,
+                                   SAMPLING_TASK_PRIORITY, SAMPLING_TASK_CORE);
+    if (!started)
+    {
+        fprintf(stderr, "ERROR: Cannot start the ring check tasks\n");
+        return false;
+    }
+    while (!run.consumerDone.load(std::memory_order_acquire))
+    {
+        taskSleep(1);
+    }
+    double wallNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - wallStart).count();
+
+    uint32_t dropped = ring.droppedCount();
+    bool ok = run.torn == 0 && run.reordered == 0 && run.missing == run.pushFailures
+           && dropped == run.pushFailures && run.received + dropped == run.samples && ring.size() == 0;
+
+    beginCheckReport("ring", seed);
+    printf(",\"samples\":%lu,\"capacity\":%lu,\"received\":%lu,"
+           "\"push_failures\":%lu,\"dropped_count\":%lu,\"missing\":%lu,\"reordered\":%lu,\"torn\":%lu,"
+           "\"max_occupancy\":%lu,\"ns_per_sample\":%.1f",
+           (unsigned long)run.samples, (unsigned long)ring.capacity(),
+           (unsigned long)run.received, (unsigned long)run.pushFailures, (unsigned long)dropped,
+           (unsigned long)run.missing, (unsigned long)run.reordered, (unsigned long)run.torn,
+           (unsigned long)run.maxOccupancy, run.samples ? wallNs / run.samples : 0.0);
+    endCheckReport(ok);
+    return ok;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file ring_check.h
+ * @brief Threaded stress check of the sample ring between the pipeline tasks
+ *
+ * Runs the ring the pipelined mode uses (SpscRing<ImuSample,
+ * PIPELINE_RING_SIZE>) between a producer and a consumer thread started
+ * through task_shim.h, as startPipeline() starts its tasks. The producer
+ * pushes the given number of millions of samples, each numbered and
+ * filled with a pattern derived from its number, in random bursts. The
+ * consumer pops them, and every so often stalls long enough for the ring
+ * to fill. The check then requires that
+ *
+ * - every sample arrives intact and in order,
+ * - the samples missing from the sequence are exactly the pushes that
+ *   failed, and droppedCount() matches that number,
+ * - samples received plus samples dropped equal samples pushed, and the
+ *   ring ends empty.
+ *
+ * The report gives the drops, the highest occupancy the consumer saw and
+ * the host time per sample.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef RING_CHECK_H
+#define RING_CHECK_H
+
+#include <stdint.h>
+
+// ============================================================================
+// RING CHECK
+// ============================================================================
+
+/**
+ * @brief Run the check and print one JSON line
+ *
+ * @param millions Samples to push, in millions
+ * @param seed Random seed for the bursts and stalls
+ * @return true if nothing was lost, reordered or torn beyond the counted drops
+ */
+bool runRingCheck(uint32_t millions, uint32_t seed);
+
+#endif // RING_CHECK_H
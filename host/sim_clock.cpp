@@ -0,0 +1,108 @@
+/**
+ * @file sim_clock.cpp
+ * @brief Virtual clock for the host simulator
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "sim_clock.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <stddef.h>
+
+// ============================================================================
+// CLOCK STATE
+// ============================================================================
+
+static std::atomic<uint64_t> virtualMicros(0);
+static void (*clockHook)(void) = NULL;
+
+// Edge time seen by a running interrupt handler (0 = not in an interrupt)
+static thread_local uint64_t interruptMicros = 0;
+static thread_local bool inClockHook = false;
+
+// Wall-clock mode: the clock is the host's steady clock plus an offset, and
+// each thread waits out the cost it is charged
+static std::atomic<bool> wallClock(false);
+static int64_t wallOffsetUs = 0;
+static thread_local int64_t wallDebtUs = 0;
+
+static int64_t steadyMicros(void)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// ============================================================================
+// VIRTUAL CLOCK FUNCTIONS
+// ============================================================================
+
+uint64_t simNowMicros(void)
+{
+    if (interruptMicros != 0)
+    {
+        return interruptMicros;
+    }
+    if (wallClock.load(std::memory_order_acquire))
+    {
+        return (uint64_t)(steadyMicros() + wallOffsetUs);
+    }
+    return virtualMicros.load(std::memory_order_relaxed);
+}
+
+void simAdvanceMicros(uint64_t us)
+{
+    if (wallClock.load(std::memory_order_acquire))
+    {
+        // Sleep in steps of at least SIM_WALL_WAIT_US; the overshoot is
+        // credited to the thread's next charge
+        wallDebtUs += (int64_t)us;
+        if (wallDebtUs >= SIM_WALL_WAIT_US)
+        {
+            int64_t startUs = steadyMicros();
+            std::this_thread::sleep_for(std::chrono::microseconds(wallDebtUs));
+            wallDebtUs -= steadyMicros() - startUs;
+        }
+    }
+    else
+    {
+        virtualMicros.fetch_add(us, std::memory_order_relaxed);
+    }
+
+    if (clockHook != NULL && !inClockHook)
+    {
+        inClockHook = true;
+        clockHook();
+        inClockHook = false;
+    }
+}
+
+void simUseWallClock(void)
+{
+    wallOffsetUs = (int64_t)virtualMicros.load(std::memory_order_relaxed) - steadyMicros();
+    wallClock.store(true, std::memory_order_release);
+}
+
+void simSetClockHook(void (*hook)(void))
+{
+    clockHook = hook;
+}
+
+void simChargeLoopPass(uint64_t passStartUs)
+{
+    if (simNowMicros() == passStartUs)
+    {
+        simAdvanceMicros(SIM_IDLE_PASS_US);
+    }
+}
+
+void simRaiseInterrupt(void (*handler)(void), uint64_t timeUs)
+{
+    uint64_t previous = interruptMicros;
+    interruptMicros = timeUs ? timeUs : 1;
+    handler();
+    interruptMicros = previous;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file sim_clock.h
+ * @brief Virtual clock for the host simulator
+ * 
+ * Simulated time only moves when the firmware waits (halDelay()) or does
+ * modeled I/O (I2C transfers, SD writes, serial output), plus a small
+ * charge for a loop() pass that did neither. Runs are therefore
+ * deterministic and independent of host CPU speed, and the
+ * clock doubles as a cost model for the I/O paths.
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#include <stdint.h>
+
+// CPU time charged to a loop() pass that did no modeled I/O
+#define SIM_IDLE_PASS_US 10
+
+// Shortest sleep in wall-clock mode; smaller charges accumulate
+#define SIM_WALL_WAIT_US 500
+
+// ============================================================================
+// VIRTUAL CLOCK FUNCTIONS
+// ============================================================================
+
+/**
+ * @brief Current virtual time in microseconds
+ */
+uint64_t simNowMicros(void);
+
+/**
+ * @brief Advance virtual time
+ * 
+ * @param us Microseconds to add
+ */
+void simAdvanceMicros(uint64_t us);
+
+/**
+ * @brief Run the clock at wall-clock speed from now on
+ * 
+ * For PIPELINE_MODE_ENABLED, whose tasks run on host threads that sleep in
+ * wall-clock time. The clock continues from its current value, and
+ * simAdvanceMicros() makes the calling thread sleep for the modeled cost
+ * instead, so each task's I/O takes as long as on the device while the
+ * other tasks run. Runs are then no longer deterministic.
+ */
+void simUseWallClock(void);
+
+/**
+ * @brief Call @p hook after every advance of the clock
+ * 
+ * Lets simulated devices raise interrupts as time passes rather than only
+ * when their registers are accessed. NULL removes the hook.
+ */
+void simSetClockHook(void (*hook)(void));
+
+/**
+ * @brief Run @p handler as an interrupt raised at virtual time @p timeUs
+ * 
+ * simNowMicros() returns @p timeUs on the calling thread while the handler
+ * runs, so ISR timestamps reflect when the edge occurred.
+ */
+void simRaiseInterrupt(void (*handler)(void), uint64_t timeUs);
+
+/**
+ * @brief Charge SIM_IDLE_PASS_US if a loop() pass left the clock unchanged
+ * 
+ * A pass that only polls a queue filled by an interrupt, as the data-ready
+ * path does with the stream scheduler, does no modeled I/O. Without this
+ * charge the clock, and with it the device that raises the interrupt,
+ * would stand still.
+ * 
+ * @param passStartUs simNowMicros() when the pass began
+ */
+void simChargeLoopPass(uint64_t passStartUs);
+
+#endif // SIM_CLOCK_H
@@ -0,0 +1,653 @@
+/**
+ * @file sim_imu.cpp
+ * @brief Register-level MPU9250/AK8963 simulator implementation
+ * 
+ * Frame conventions follow what the firmware assumes: accel and gyro are
+ * in the body frame, and the magnetometer X/Y axes are swapped relative
+ * to it (the scaling table swaps them back). The synthetic
+ * profile holds still for SIM_STILL_PERIOD_US so startup calibration sees
+ * a resting device, then rolls, pitches and spins, resting for the last
+ * SIM_REST_PERIOD_US of every SIM_MOTION_CYCLE_US. The magnetometer sees
+ * hard and soft iron, and the gyro bias warms up away from its power-on
+ * value, so the streaming calibrator has something to estimate; the hard
+ * iron is deliberately off from the MAG_BIAS_X/Y/Z defaults.
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "sim_imu.h"
+#include "sim_clock.h"
+#include "utility/MPU9250.h"
+#include "imu_sensor.h"
+#include "config.h"
+#include <math.h>
+#include <string.h>
+
+// ============================================================================
+// SIMULATION CONSTANTS
+// ============================================================================
+
+#define SIM_STILL_PERIOD_US 35000000ULL
+#define SIM_MOTION_CYCLE_US 40000000ULL
+#define SIM_REST_PERIOD_US 10000000ULL
+#define SIM_BIAS_WARMUP_S 60.0f
+#define SIM_MPU_WHO_AM_I 0x71
+#define SIM_I2C_OVERHEAD_BYTES 3
+
+#define SIM_ACCEL_NOISE_G 0.004f
+#define SIM_GYRO_NOISE_DPS 0.05f
+#define SIM_MAG_NOISE_MG 3.0f
+
+static const float kGyroBiasDps[3] = {0.8f, -0.6f, 0.4f};
+static const float kGyroWarmupDps[3] = {0.15f, -0.10f, 0.12f};
+static const float kEarthFieldMg[3] = {220.0f, 0.0f, -420.0f};
+static const float kHardIronMg[3] = {MAG_BIAS_X - 30.0f, MAG_BIAS_Y + 20.0f, MAG_BIAS_Z + 35.0f};
+// Recorded mag.txt rows had the compile-time bias removed
+static const float kRecordedBiasMg[3] = {MAG_BIAS_X, MAG_BIAS_Y, MAG_BIAS_Z};
+static const float kSoftIron[3][3] = {
+    {1.06f, 0.03f, 0.00f},
+    {0.03f, 0.95f, 0.02f},
+    {0.00f, 0.02f, 1.00f}};
+static const uint8_t kFuseRom[3] = {0xAE, 0xB0, 0xA5};
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+/**
+ * @brief Express world-frame vector @p v in the body frame of @p q
+ */
+static void rotateToBody(const float* q, const float* v, float* out)
+{
+    float w = q[0], x = q[1], y = q[2], z = q[3];
+
+    out[0] = (1 - 2 * (y * y + z * z)) * v[0] + 2 * (x * y + w * z) * v[1] + 2 * (x * z - w * y) * v[2];
+    out[1] = 2 * (x * y - w * z) * v[0] + (1 - 2 * (x * x + z * z)) * v[1] + 2 * (y * z + w * x) * v[2];
+    out[2] = 2 * (x * z + w * y) * v[0] + 2 * (y * z - w * x) * v[1] + (1 - 2 * (x * x + y * y)) * v[2];
+}
+
+static int16_t saturate(float value)
+{
+    if (value > 32767.0f)
+    {
+        return 32767;
+    }
+    if (value < -32768.0f)
+    {
+        return -32768;
+    }
+    return (int16_t)lrintf(value);
+}
+
+static void putBigEndian(uint8_t* p, int16_t value)
+{
+    p[0] = (uint8_t)((uint16_t)value >> 8);
+    p[1] = (uint8_t)(value & 0xFF);
+}
+
+static void putLittleEndian(uint8_t* p, int16_t value)
+{
+    p[0] = (uint8_t)(value & 0xFF);
+    p[1] = (uint8_t)((uint16_t)value >> 8);
+}
+
+// ============================================================================
+// SIMULATED DEVICE
+// ============================================================================
+
+SimulatedImu::SimulatedImu(void)
+    : fifoHead(0),
+      fifoCount(0),
+      nextSampleUs(0),
+      nextMagUs(0),
+      lastMotionUs(0),
+      interruptHandler(NULL),
+      sampleHook(NULL),
+      rateScript(NULL),
+      busHz(400000),
+      rngState(12345),
+      traceNextMs(0),
+      traceActive(false),
+      traceEnded(false)
+{
+    memset(mpuRegs, 0, sizeof(mpuRegs));
+    memset(akRegs, 0, sizeof(akRegs));
+    memset(gyroOffset, 0, sizeof(gyroOffset));
+    memset(&motion, 0, sizeof(motion));
+    memset(&counters, 0, sizeof(counters));
+    memset(&truth, 0, sizeof(truth));
+    memset(traceFiles, 0, sizeof(traceFiles));
+
+    truthQ[0] = 1.0f;
+    truthQ[1] = truthQ[2] = truthQ[3] = 0.0f;
+
+    mpuRegs[PWR_MGMT_1] = 0x01;
+    akRegs[WHO_AM_I_AK8963] = AK8963_EXPECTED_ID;
+    akRegs[AK8963_ST2] = 0x10;
+}
+
+bool SimulatedImu::openTrace(const char* directory)
+{
+    static const char* const names[3] = {FILE_ACCELERATION, FILE_GYROSCOPE, FILE_MAGNETOMETER};
+    char path[512];
+
+    for (int i = 0; i < 3; i++)
+    {
+        snprintf(path, sizeof(path), "%s%s", directory, names[i]);
+        traceFiles[i] = fopen(path, "rb");
+        if (traceFiles[i] == NULL)
+        {
+            fprintf(stderr, "ERROR: Cannot open trace file %s\n", path);
+            return false;
+        }
+    }
+
+    traceActive = true;
+    traceNextMs = 0;
+    memset(traceRow, 0, sizeof(traceRow));
+    memset(traceNext, 0, sizeof(traceNext));
+    return true;
+}
+
+void SimulatedImu::setGyroOffset(const int16_t* offset)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        gyroOffset[i] = offset[i];
+    }
+}
+
+uint32_t SimulatedImu::sampleIntervalUs(void) const
+{
+    // Internal rate is 1 kHz with the DLPF enabled, divided by 1 + SMPLRT_DIV
+    return 1000U * (1U + mpuRegs[SMPLRT_DIV]);
+}
+
+uint32_t SimulatedImu::magIntervalUs(void) const
+{
+    switch (akRegs[AK8963_CNTL] & 0x0F)
+    {
+    case 0x02:
+        return 125000;     // Continuous mode 1: 8 Hz
+    case 0x06:
+        return 10000;      // Continuous mode 2: 100 Hz
+    default:
+        return 0;
+    }
+}
+
+float SimulatedImu::noise(float sigma)
+{
+    // xorshift32 + Box-Muller
+    float u[2];
+    for (int i = 0; i < 2; i++)
+    {
+        rngState ^= rngState << 13;
+        rngState ^= rngState >> 17;
+        rngState ^= rngState << 5;
+        u[i] = ((rngState >> 8) + 1.0f) / 16777217.0f;
+    }
+    return sigma * sqrtf(-2.0f * logf(u[0])) * cosf(6.2831853f * u[1]);
+}
+
+void SimulatedImu::chargeTransfer(uint8_t dataBytes)
+{
+    uint32_t bits = (SIM_I2C_OVERHEAD_BYTES + dataBytes) * 9;
+    counters.transactions++;
+    counters.busBytes += SIM_I2C_OVERHEAD_BYTES + dataBytes;
+    simAdvanceMicros(((uint64_t)bits * 1000000ULL + busHz - 1) / busHz);
+}
+
+bool SimulatedImu::restingAt(uint64_t timeUs)
+{
+    return timeUs <= SIM_STILL_PERIOD_US
+        || (timeUs - SIM_STILL_PERIOD_US) % SIM_MOTION_CYCLE_US >= SIM_MOTION_CYCLE_US - SIM_REST_PERIOD_US;
+}
+
+void SimulatedImu::synthesizeMotion(uint64_t timeUs, MotionState& state)
+{
+    float t = timeUs / 1e6f;
+    float rate[3] = {0.0f, 0.0f, 0.0f};
+
+    if (rateScript != NULL)
+    {
+        rateScript(timeUs, rate);
+    }
+    else if (!restingAt(timeUs))
+    {
+        rate[0] = 60.0f * sinf(6.2831853f * 0.07f * t);
+        rate[1] = 40.0f * sinf(6.2831853f * 0.05f * t + 1.0f);
+        rate[2] = 20.0f;
+    }
+
+    // Integrate the true orientation up to this sample
+    float dt = (timeUs - lastMotionUs) / 1e6f;
+    lastMotionUs = timeUs;
+    float wx = rate[0] * (float)DEG_TO_RAD;
+    float wy = rate[1] * (float)DEG_TO_RAD;
+    float wz = rate[2] * (float)DEG_TO_RAD;
+    float* q = truthQ;
+    float dq[4] = {
+        0.5f * (-q[1] * wx - q[2] * wy - q[3] * wz),
+        0.5f * (q[0] * wx + q[2] * wz - q[3] * wy),
+        0.5f * (q[0] * wy - q[1] * wz + q[3] * wx),
+        0.5f * (q[0] * wz + q[1] * wy - q[2] * wx)};
+    float norm = 0.0f;
+    for (int i = 0; i < 4; i++)
+    {
+        q[i] += dq[i] * dt;
+        norm += q[i] * q[i];
+    }
+    norm = 1.0f / sqrtf(norm);
+    for (int i = 0; i < 4; i++)
+    {
+        q[i] *= norm;
+    }
+
+    static const float up[3] = {0.0f, 0.0f, 1.0f};
+    float field[3];
+    rotateToBody(q, up, state.accel);
+    rotateToBody(q, kEarthFieldMg, field);
+
+    float warmup = 1.0f - expf(-t / SIM_BIAS_WARMUP_S);
+    for (int i = 0; i < 3; i++)
+    {
+        state.accel[i] += noise(SIM_ACCEL_NOISE_G);
+        state.gyro[i] = rate[i] + kGyroBiasDps[i] + warmup * kGyroWarmupDps[i] + noise(SIM_GYRO_NOISE_DPS);
+    }
+
+    // Magnetometer X/Y are swapped relative to the body frame
+    float sensed[3] = {field[1], field[0], field[2]};
+    for (int i = 0; i < 3; i++)
+    {
+        state.mag[i] = kSoftIron[i][0] * sensed[0] + kSoftIron[i][1] * sensed[1] + kSoftIron[i][2] * sensed[2]
+                     + kHardIronMg[i] + noise(SIM_MAG_NOISE_MG);
+    }
+}
+
+bool SimulatedImu::traceMotion(uint64_t timeUs, MotionState& state)
+{
+    char line[256];
+
+    while (!traceEnded && (uint64_t)traceNextMs * 1000ULL <= timeUs)
+    {
+        memcpy(traceRow, traceNext, sizeof(traceRow));
+
+        unsigned long rowMs = 0;
+        for (int i = 0; i < 3 && !traceEnded; i++)
+        {
+            bool parsed = false;
+            while (!parsed && fgets(line, sizeof(line), traceFiles[i]) != NULL)
+            {
+                parsed = sscanf(line, "%lu,%f,%f,%f", &rowMs,
+                                &traceNext[i][0], &traceNext[i][1], &traceNext[i][2]) == 4;
+            }
+            traceEnded = !parsed;
+        }
+        traceNextMs = (uint32_t)rowMs;
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        state.accel[i] = traceRow[0][i] / 1000.0f;
+        state.gyro[i] = traceRow[1][i];
+        state.mag[i] = traceRow[2][i] + kRecordedBiasMg[i];
+    }
+    return !traceEnded;
+}
+
+/**
+ * @brief Bytes the FIFO_EN selection puts into the FIFO for the current sample
+ * 
+ * @param frame At least 14 bytes
+ * @return Frame size
+ */
+int SimulatedImu::fifoFrame(uint8_t* frame) const
+{
+    uint8_t enables = mpuRegs[FIFO_EN];
+    int size = 0;
+
+    if (enables & 0x08)
+    {
+        memcpy(frame + size, &mpuRegs[ACCEL_XOUT_H], 6);
+        size += 6;
+    }
+    if (enables & 0x80)
+    {
+        memcpy(frame + size, &mpuRegs[TEMP_OUT_H], 2);
+        size += 2;
+    }
+    for (int axis = 0; axis < 3; axis++)
+    {
+        if (enables & (0x40 >> axis))
+        {
+            memcpy(frame + size, &mpuRegs[GYRO_XOUT_H + 2 * axis], 2);
+            size += 2;
+        }
+    }
+    return size;
+}
+
+void SimulatedImu::injectFifoBytes(int count)
+{
+    std::lock_guard<std::recursive_mutex> guard(deviceLock);
+    uint8_t frame[14];
+    int size = fifoFrame(frame);
+
+    pushFifo(frame, (count < size) ? count : size);
+}
+
+void SimulatedImu::pushFifo(const uint8_t* bytes, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (fifoCount == sizeof(fifo))
+        {
+            // FIFO_MODE = 0: oldest data is overwritten
+            fifoHead = (fifoHead + 1) % sizeof(fifo);
+            fifoCount--;
+            mpuRegs[INT_STATUS] |= 0x10;
+            counters.fifoOverflows++;
+        }
+        fifo[(fifoHead + fifoCount) % sizeof(fifo)] = bytes[i];
+        fifoCount++;
+    }
+}
+
+uint8_t SimulatedImu::popFifo(void)
+{
+    if (fifoCount == 0)
+    {
+        return 0xFF;
+    }
+
+    uint8_t value = fifo[fifoHead];
+    fifoHead = (fifoHead + 1) % sizeof(fifo);
+    fifoCount--;
+    return value;
+}
+
+void SimulatedImu::produceSample(uint64_t timeUs)
+{
+    if (traceActive)
+    {
+        traceMotion(timeUs, motion);
+    }
+    else
+    {
+        synthesizeMotion(timeUs, motion);
+    }
+
+    float accelScale = (float)(2 << ((mpuRegs[ACCEL_CONFIG] >> 3) & 0x03)) / 32768.0f;
+    float gyroScale = (float)(250 << ((mpuRegs[GYRO_CONFIG] >> 3) & 0x03)) / 32768.0f;
+
+    for (int i = 0; i < 3; i++)
+    {
+        putBigEndian(&mpuRegs[ACCEL_XOUT_H + 2 * i], saturate(motion.accel[i] / accelScale));
+        putBigEndian(&mpuRegs[GYRO_XOUT_H + 2 * i], saturate(motion.gyro[i] / gyroScale - gyroOffset[i]));
+    }
+    putBigEndian(&mpuRegs[TEMP_OUT_H], saturate((25.0f - TEMP_OFFSET) * TEMP_CONVERSION_FACTOR));
+
+    if (auxMasterActive())
+    {
+        mirrorAuxSlave();
+    }
+
+    truth.timeUs = timeUs;
+    for (int i = 0; i < 3; i++)
+    {
+        truth.accel[i] = (int16_t)(((uint16_t)mpuRegs[ACCEL_XOUT_H + 2 * i] << 8) | mpuRegs[ACCEL_XOUT_H + 2 * i + 1]);
+        truth.gyro[i] = (int16_t)(((uint16_t)mpuRegs[GYRO_XOUT_H + 2 * i] << 8) | mpuRegs[GYRO_XOUT_H + 2 * i + 1]);
+        truth.mag[i] = (int16_t)(((uint16_t)akRegs[AK8963_XOUT_L + 2 * i + 1] << 8) | akRegs[AK8963_XOUT_L + 2 * i]);
+    }
+
+    bool wasPending = (mpuRegs[INT_STATUS] & 0x01) != 0;
+    if (wasPending)
+    {
+        counters.samplesOverwritten++;
+    }
+    mpuRegs[INT_STATUS] |= 0x01;
+    counters.samplesGenerated++;
+
+    // INT pin: pulses every sample, or rises once until INT_STATUS is read
+    bool latched = (mpuRegs[INT_PIN_CFG] & 0x20) != 0;
+    if (interruptHandler != NULL && (mpuRegs[INT_ENABLE] & 0x01) && !(latched && wasPending))
+    {
+        simRaiseInterrupt(interruptHandler, timeUs);
+    }
+
+    if (sampleHook != NULL)
+    {
+        sampleHook(truth);
+    }
+
+    if (mpuRegs[USER_CTRL] & 0x40)
+    {
+        uint8_t frame[14];
+        pushFifo(frame, fifoFrame(frame));
+    }
+}
+
+void SimulatedImu::produceMagSample(void)
+{
+    float sensitivity[3];
+    float resolution = (akRegs[AK8963_CNTL] & 0x10) ? 10.0f * 4912.0f / 32760.0f : 10.0f * 4912.0f / 8190.0f;
+
+    for (int i = 0; i < 3; i++)
+    {
+        sensitivity[i] = (float)(kFuseRom[i] - 128) / 256.0f + 1.0f;
+        putLittleEndian(&akRegs[AK8963_XOUT_L + 2 * i],
+                        saturate(motion.mag[i] / (resolution * sensitivity[i])));
+    }
+
+    if (akRegs[AK8963_ST1] & 0x01)
+    {
+        akRegs[AK8963_ST1] |= 0x02;     // Data overrun
+    }
+    akRegs[AK8963_ST1] |= 0x01;
+    akRegs[AK8963_ST2] = (akRegs[AK8963_CNTL] & 0x10);
+    counters.magSamples++;
+}
+
+bool SimulatedImu::auxMasterActive(void) const
+{
+    return (mpuRegs[USER_CTRL] & MPU9250_USER_CTRL_I2C_MST_EN) != 0;
+}
+
+void SimulatedImu::mirrorAuxSlave(void)
+{
+    // Slave 0 only, reads only: all the firmware configures
+    uint8_t control = mpuRegs[I2C_SLV0_CTRL];
+    uint8_t address = mpuRegs[I2C_SLV0_ADDR];
+    if (!(control & MPU9250_I2C_SLV_EN) || address != (MPU9250_I2C_SLV_READ | AK8963_ADDRESS))
+    {
+        return;
+    }
+
+    // With the bypass switch closed the host bus drives the auxiliary bus
+    // too; the master's reads fail and EXT_SENS_DATA keeps stale contents
+    if (mpuRegs[INT_PIN_CFG] & MPU9250_INT_PIN_CFG_BYPASS_EN)
+    {
+        counters.auxReadsBlocked++;
+        return;
+    }
+
+    // The auxiliary bus is separate: no host bus time is charged
+    uint8_t length = control & 0x0F;
+    bool endsRead = false;
+    for (uint8_t i = 0; i < length; i++)
+    {
+        uint8_t r = (uint8_t)(mpuRegs[I2C_SLV0_REG] + i) & 0x1F;
+        mpuRegs[EXT_SENS_DATA_00 + i] = akRegs[r];
+        endsRead = endsRead || (r == AK8963_ST2);
+    }
+    if (endsRead)
+    {
+        akRegs[AK8963_ST1] &= (uint8_t)~0x03;
+    }
+}
+
+void SimulatedImu::produceMagSamples(uint64_t untilUs)
+{
+    uint32_t magInterval = magIntervalUs();
+    if (magInterval == 0)
+    {
+        nextMagUs = untilUs;
+        return;
+    }
+    while (nextMagUs <= untilUs)
+    {
+        produceMagSample();
+        nextMagUs += magInterval;
+    }
+}
+
+static void advanceSimImu(void)
+{
+    simImu().advance();
+}
+
+void SimulatedImu::setInterruptHandler(void (*handler)(void))
+{
+    std::lock_guard<std::recursive_mutex> guard(deviceLock);
+    interruptHandler = handler;
+    simSetClockHook(handler != NULL ? advanceSimImu : NULL);
+}
+
+void SimulatedImu::advance(void)
+{
+    std::lock_guard<std::recursive_mutex> guard(deviceLock);
+    uint64_t now = simNowMicros();
+
+    while (nextSampleUs <= now)
+    {
+        // The I2C master reads the AK8963 at the sample: bring it up to date first
+        if (auxMasterActive())
+        {
+            produceMagSamples(nextSampleUs);
+        }
+        produceSample(nextSampleUs);
+        nextSampleUs += sampleIntervalUs();
+    }
+
+    produceMagSamples(now);
+}
+
+uint8_t SimulatedImu::readRegister(uint8_t address, uint8_t reg)
+{
+    uint8_t value;
+    readRegisters(address, reg, 1, &value);
+    return value;
+}
+
+void SimulatedImu::readRegisters(uint8_t address, uint8_t reg, uint8_t count, uint8_t* destination)
+{
+    std::lock_guard<std::recursive_mutex> guard(deviceLock);
+    advance();
+    chargeTransfer(count);
+
+    if (address == AK8963_ADDRESS && auxMasterActive())
+    {
+        // The master owns the auxiliary bus: nothing answers (open bus)
+        memset(destination, 0xFF, count);
+        return;
+    }
+
+    if (address == AK8963_ADDRESS)
+    {
+        bool fuseRomMode = (akRegs[AK8963_CNTL] & 0x0F) == 0x0F;
+        bool endsRead = false;
+
+        for (uint8_t i = 0; i < count; i++)
+        {
+            uint8_t r = (uint8_t)(reg + i) & 0x1F;
+            destination[i] = (r >= AK8963_ASAX && r <= AK8963_ASAZ && fuseRomMode)
+                                 ? kFuseRom[r - AK8963_ASAX]
+                                 : akRegs[r];
+            endsRead = endsRead || (r == AK8963_ST2);
+        }
+
+        if (endsRead)
+        {
+            akRegs[AK8963_ST1] &= (uint8_t)~0x03;
+        }
+        return;
+    }
+
+    uint16_t fifoBytes = fifoCount;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        if (reg == FIFO_R_W)
+        {
+            // FIFO_R_W does not auto-increment
+            destination[i] = popFifo();
+            continue;
+        }
+
+        uint8_t r = (uint8_t)(reg + i) & 0x7F;
+        switch (r)
+        {
+        case FIFO_COUNTH:
+            destination[i] = (uint8_t)(fifoBytes >> 8);
+            break;
+        case FIFO_COUNTL:
+            destination[i] = (uint8_t)(fifoBytes & 0xFF);
+            break;
+        case WHO_AM_I_MPU9250:
+            destination[i] = SIM_MPU_WHO_AM_I;
+            break;
+        default:
+            destination[i] = mpuRegs[r];
+            break;
+        }
+
+        if (r == INT_STATUS)
+        {
+            mpuRegs[INT_STATUS] = 0;
+        }
+    }
+}
+
+void SimulatedImu::writeRegister(uint8_t address, uint8_t reg, uint8_t value)
+{
+    std::lock_guard<std::recursive_mutex> guard(deviceLock);
+    advance();
+    chargeTransfer(1);
+
+    if (address == AK8963_ADDRESS && auxMasterActive())
+    {
+        return;
+    }
+
+    if (address == AK8963_ADDRESS)
+    {
+        akRegs[reg & 0x1F] = value;
+        if (reg == AK8963_CNTL)
+        {
+            nextMagUs = simNowMicros() + magIntervalUs();
+        }
+        return;
+    }
+
+    reg &= 0x7F;
+    if (reg == USER_CTRL && (value & 0x04))
+    {
+        fifoHead = 0;
+        fifoCount = 0;
+        value &= (uint8_t)~0x04;
+    }
+    if (reg == PWR_MGMT_1 && (value & 0x80))
+    {
+        memset(mpuRegs, 0, sizeof(mpuRegs));
+        value = 0x01;
+    }
+    mpuRegs[reg] = value;
+}
+
+SimulatedImu& simImu(void)
+{
+    static SimulatedImu device;
+    return device;
+}
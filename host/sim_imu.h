@@ -0,0 +1,204 @@
+/**
+ * @file sim_imu.h
+ * @brief Register-level MPU9250/AK8963 simulator
+ * 
+ * Emulates the two I2C devices behind the M5Stack MPU9250 driver at the
+ * register level: data registers, INT_STATUS data-ready latching, the
+ * hardware FIFO, the AK8963 ST1/ST2 handshake, and the auxiliary I2C
+ * master mirroring the AK8963 into EXT_SENS_DATA through slave 0. Samples are generated
+ * at the configured output data rate in virtual time from either a
+ * synthetic motion profile or a recorded CSV trace. Every transfer is
+ * charged to the virtual clock at the configured I2C bus speed.
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef SIM_IMU_H
+#define SIM_IMU_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <mutex>
+
+// ============================================================================
+// SIMULATOR STATISTICS
+// ============================================================================
+
+struct SimImuStats
+{
+    uint64_t samplesGenerated;      ///< Accel/gyro samples produced at the ODR
+    uint64_t samplesOverwritten;    ///< Samples replaced before data-ready was read
+    uint64_t fifoOverflows;         ///< Frames lost to a full FIFO
+    uint64_t magSamples;            ///< AK8963 measurements produced
+    uint64_t transactions;          ///< I2C transactions
+    uint64_t busBytes;              ///< Bytes moved over I2C (incl. addressing)
+    uint64_t auxReadsBlocked;       ///< Aux master reads lost while INT_PIN_CFG BYPASS_EN was set
+};
+
+/**
+ * @brief Register contents latched with the most recent accel/gyro sample
+ */
+struct SimSampleTruth
+{
+    uint64_t timeUs;
+    int16_t accel[3];
+    int16_t gyro[3];
+    int16_t mag[3];                 ///< AK8963 data registers at the sample time
+};
+
+// ============================================================================
+// SIMULATED DEVICE
+// ============================================================================
+
+class SimulatedImu
+{
+public:
+    SimulatedImu(void);
+
+    /**
+     * @brief Set the I2C clock used for the transfer cost model
+     */
+    void setBusSpeed(uint32_t hz) { busHz = hz; }
+
+    /**
+     * @brief Seed the sensor noise generator
+     */
+    void setSeed(uint32_t seed) { rngState = seed ? seed : 1; }
+
+    /**
+     * @brief Replay acceleration.txt/gyro.txt/mag.txt from @p directory
+     * 
+     * @return false if the trace files could not be opened
+     */
+    bool openTrace(const char* directory);
+
+    /**
+     * @brief True once a replayed trace has run out of rows
+     */
+    bool traceFinished(void) const { return traceEnded; }
+
+    uint8_t readRegister(uint8_t address, uint8_t reg);
+    void readRegisters(uint8_t address, uint8_t reg, uint8_t count, uint8_t* destination);
+    void writeRegister(uint8_t address, uint8_t reg, uint8_t value);
+
+    /**
+     * @brief Connect the INT pin to an interrupt handler
+     * 
+     * The handler runs on each rising edge: once per sample when INT_PIN_CFG
+     * selects a pulse, or only after INT_STATUS has been read when it
+     * latches. Edges are raised as virtual time advances and timestamped
+     * with the sample time.
+     */
+    void setInterruptHandler(void (*handler)(void));
+
+    /**
+     * @brief Generate every sample due up to the current virtual time
+     */
+    void advance(void);
+
+    /**
+     * @brief Call @p hook with the register contents of every new sample
+     * 
+     * Runs in production order, before the sample enters the FIFO; NULL
+     * disconnects it.
+     */
+    void setSampleHook(void (*hook)(const SimSampleTruth& sample)) { sampleHook = hook; }
+
+    /**
+     * @brief Take the synthetic body rate from @p script
+     * 
+     * @p script fills the angular rate (deg/s) at a sample time in place of
+     * the built-in motion profile; orientation, field and noise follow from
+     * it as before. Has no effect on a replayed trace; NULL restores the
+     * built-in profile.
+     */
+    void setRateScript(void (*script)(uint64_t timeUs, float* rateDps)) { rateScript = script; }
+
+    /**
+     * @brief Push the first @p count bytes of a FIFO frame of the current sample
+     * 
+     * What a FIFO_COUNT read racing the device's frame write sees: the
+     * count stops being a multiple of the frame size.
+     */
+    void injectFifoBytes(int count);
+
+    /**
+     * @brief Gyro offset (counts) removed by the driver's bias calibration
+     */
+    void setGyroOffset(const int16_t* offset);
+
+    const SimImuStats& stats(void) const { return counters; }
+
+    /**
+     * @brief What the latest sample put into the data registers
+     */
+    const SimSampleTruth& lastSample(void) const { return truth; }
+
+    /**
+     * @brief True where the synthetic motion profile holds the device still
+     */
+    static bool restingAt(uint64_t timeUs);
+
+private:
+    struct MotionState
+    {
+        float accel[3];     ///< Specific force (g), body frame
+        float gyro[3];      ///< Angular rate (deg/s), body frame
+        float mag[3];       ///< Field (mG), magnetometer frame, bias included
+    };
+
+    void chargeTransfer(uint8_t dataBytes);
+    void produceSample(uint64_t timeUs);
+    void produceMagSample(void);
+    void produceMagSamples(uint64_t untilUs);
+    bool auxMasterActive(void) const;
+    void mirrorAuxSlave(void);
+    void synthesizeMotion(uint64_t timeUs, MotionState& state);
+    bool traceMotion(uint64_t timeUs, MotionState& state);
+    int fifoFrame(uint8_t* frame) const;
+    void pushFifo(const uint8_t* bytes, int count);
+    uint8_t popFifo(void);
+    uint32_t sampleIntervalUs(void) const;
+    uint32_t magIntervalUs(void) const;
+    float noise(float sigma);
+
+    uint8_t mpuRegs[128];
+    uint8_t akRegs[32];
+
+    uint8_t fifo[512];
+    uint16_t fifoHead;
+    uint16_t fifoCount;
+
+    uint64_t nextSampleUs;
+    uint64_t nextMagUs;
+    uint64_t lastMotionUs;
+    float truthQ[4];
+    MotionState motion;
+    int16_t gyroOffset[3];
+    void (*interruptHandler)(void);
+    void (*sampleHook)(const SimSampleTruth& sample);
+    void (*rateScript)(uint64_t timeUs, float* rateDps);
+    std::recursive_mutex deviceLock;
+
+    uint32_t busHz;
+    uint32_t rngState;
+
+    FILE* traceFiles[3];
+    float traceRow[3][3];
+    float traceNext[3][3];
+    uint32_t traceNextMs;
+    bool traceActive;
+    bool traceEnded;
+
+    SimImuStats counters;
+    SimSampleTruth truth;
+};
+
+/**
+ * @brief The simulated device shared by the host MPU9250 driver
+ */
+SimulatedImu& simImu(void);
+
+#endif // SIM_IMU_H
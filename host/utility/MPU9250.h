@@ -0,0 +1,185 @@
+/**
+ * @file MPU9250.h
+ * @brief Host stand-in for the M5Stack MPU9250 driver
+ * 
+ * Same public interface as the M5Stack library's utility/MPU9250.h, with
+ * every register access routed to the simulated device in sim_imu.h
+ * instead of the I2C bus. Register names and driver behaviour (scales,
+ * byte order, data-ready handling) follow the library.
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef HOST_MPU9250_H
+#define HOST_MPU9250_H
+
+#include "../Arduino.h"
+
+// ============================================================================
+// AK8963 REGISTERS
+// ============================================================================
+
+#define WHO_AM_I_AK8963 0x00
+#define INFO 0x01
+#define AK8963_ST1 0x02
+#define AK8963_XOUT_L 0x03
+#define AK8963_XOUT_H 0x04
+#define AK8963_YOUT_L 0x05
+#define AK8963_YOUT_H 0x06
+#define AK8963_ZOUT_L 0x07
+#define AK8963_ZOUT_H 0x08
+#define AK8963_ST2 0x09
+#define AK8963_CNTL 0x0A
+#define AK8963_ASTC 0x0C
+#define AK8963_I2CDIS 0x0F
+#define AK8963_ASAX 0x10
+#define AK8963_ASAY 0x11
+#define AK8963_ASAZ 0x12
+
+// ============================================================================
+// MPU9250 REGISTERS
+// ============================================================================
+
+#define SELF_TEST_X_GYRO 0x00
+#define SELF_TEST_Y_GYRO 0x01
+#define SELF_TEST_Z_GYRO 0x02
+#define SELF_TEST_X_ACCEL 0x0D
+#define SELF_TEST_Y_ACCEL 0x0E
+#define SELF_TEST_Z_ACCEL 0x0F
+#define XG_OFFSET_H 0x13
+#define XG_OFFSET_L 0x14
+#define YG_OFFSET_H 0x15
+#define YG_OFFSET_L 0x16
+#define ZG_OFFSET_H 0x17
+#define ZG_OFFSET_L 0x18
+#define SMPLRT_DIV 0x19
+#define CONFIG 0x1A
+#define GYRO_CONFIG 0x1B
+#define ACCEL_CONFIG 0x1C
+#define ACCEL_CONFIG2 0x1D
+#define LP_ACCEL_ODR 0x1E
+#define WOM_THR 0x1F
+#define FIFO_EN 0x23
+#define I2C_MST_CTRL 0x24
+#define I2C_SLV0_ADDR 0x25
+#define I2C_SLV0_REG 0x26
+#define I2C_SLV0_CTRL 0x27
+#define I2C_SLV1_ADDR 0x28
+#define I2C_SLV1_REG 0x29
+#define I2C_SLV1_CTRL 0x2A
+#define I2C_SLV4_CTRL 0x34
+#define I2C_MST_STATUS 0x36
+#define INT_PIN_CFG 0x37
+#define INT_ENABLE 0x38
+#define INT_STATUS 0x3A
+#define ACCEL_XOUT_H 0x3B
+#define ACCEL_XOUT_L 0x3C
+#define ACCEL_YOUT_H 0x3D
+#define ACCEL_YOUT_L 0x3E
+#define ACCEL_ZOUT_H 0x3F
+#define ACCEL_ZOUT_L 0x40
+#define TEMP_OUT_H 0x41
+#define TEMP_OUT_L 0x42
+#define GYRO_XOUT_H 0x43
+#define GYRO_XOUT_L 0x44
+#define GYRO_YOUT_H 0x45
+#define GYRO_YOUT_L 0x46
+#define GYRO_ZOUT_H 0x47
+#define GYRO_ZOUT_L 0x48
+#define EXT_SENS_DATA_00 0x49
+#define I2C_SLV0_DO 0x63
+#define I2C_MST_DELAY_CTRL 0x67
+#define SIGNAL_PATH_RESET 0x68
+#define MOT_DETECT_CTRL 0x69
+#define USER_CTRL 0x6A
+#define PWR_MGMT_1 0x6B
+#define PWR_MGMT_2 0x6C
+#define FIFO_COUNTH 0x72
+#define FIFO_COUNTL 0x73
+#define FIFO_R_W 0x74
+#define WHO_AM_I_MPU9250 0x75
+#define XA_OFFSET_H 0x77
+#define XA_OFFSET_L 0x78
+#define YA_OFFSET_H 0x7A
+#define YA_OFFSET_L 0x7B
+#define ZA_OFFSET_H 0x7D
+#define ZA_OFFSET_L 0x7E
+
+#define MPU9250_ADDRESS 0x68
+#define AK8963_ADDRESS 0x0C
+
+// ============================================================================
+// MPU9250 DRIVER
+// ============================================================================
+
+class MPU9250
+{
+protected:
+    enum Ascale
+    {
+        AFS_2G = 0,
+        AFS_4G,
+        AFS_8G,
+        AFS_16G
+    };
+
+    enum Gscale
+    {
+        GFS_250DPS = 0,
+        GFS_500DPS,
+        GFS_1000DPS,
+        GFS_2000DPS
+    };
+
+    enum Mscale
+    {
+        MFS_14BITS = 0,
+        MFS_16BITS
+    };
+
+    uint8_t Gscale = GFS_250DPS;
+    uint8_t Ascale = AFS_2G;
+    uint8_t Mscale = MFS_16BITS;
+    uint8_t Mmode = 0x02;
+
+public:
+    float pitch, yaw, roll;
+    float temperature;
+    float SelfTest[6];
+    int16_t tempCount;
+
+    uint32_t delt_t = 0;
+    uint32_t count = 0, sumCount = 0;
+    float deltat = 0.0f, sum = 0.0f;
+    uint32_t lastUpdate = 0, firstUpdate = 0;
+    uint32_t Now = 0;
+
+    float aRes, gRes, mRes;
+    int16_t accelCount[3];
+    int16_t gyroCount[3];
+    int16_t magCount[3];
+    float magCalibration[3] = {0, 0, 0}, magbias[3] = {0, 0, 0};
+    float gyroBias[3] = {0, 0, 0}, accelBias[3] = {0, 0, 0};
+    float ax, ay, az, gx, gy, gz, mx, my, mz;
+
+    void getMres(void);
+    void getGres(void);
+    void getAres(void);
+    void readAccelData(int16_t* destination);
+    void readGyroData(int16_t* destination);
+    void readMagData(int16_t* destination);
+    int16_t readTempData(void);
+    void updateTime(void);
+    void initAK8963(float* destination);
+    void initMPU9250(void);
+    void calibrateMPU9250(float* gyroBias, float* accelBias);
+    void MPU9250SelfTest(float* destination);
+
+    void writeByte(uint8_t address, uint8_t subAddress, uint8_t data);
+    uint8_t readByte(uint8_t address, uint8_t subAddress);
+    void readBytes(uint8_t address, uint8_t subAddress, uint8_t count, uint8_t* destination);
+};
+
+#endif // HOST_MPU9250_H
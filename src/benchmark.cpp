@@ -0,0 +1,466 @@
+/**
+ * @file benchmark.cpp
+ * @brief Per-stage benchmark of the sample hot path
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "benchmark.h"
+#include "config.h"
+#include "imu_sensor.h"
+#include "data_processor.h"
+#include "mahony_filter.h"
+#include "fusion_engine.h"
+#include "calibration.h"
+#include "sensor_scaling.h"
+#include "packed_log.h"
+#include "fast_trig.h"
+#include <math.h>
+#include "sd_logger.h"
+#include "record_format.h"
+#include "feature_extractor.h"
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+#ifndef BENCHMARK_BUILD_ID
+#define BENCHMARK_BUILD_ID "unknown"
+#endif
+
+#ifdef ARDUINO
+#define BENCHMARK_PLATFORM "esp32"
+#else
+#define BENCHMARK_PLATFORM "host"
+#endif
+
+// Inputs swept per function in the fast trig error check
+#define ACCURACY_TRIG_STEPS 20000
+
+// Synthetic samples fused by each kernel in the accuracy check
+#define ACCURACY_FUSION_SAMPLES 2000
+
+#define FILE_BENCHMARK_APPEND "/bench_append.txt"
+#define FILE_BENCHMARK_STREAM "/bench_stream.txt"
+
+// ============================================================================
+// STAGE STATE
+// ============================================================================
+
+typedef void (*StageFunction)(void);
+
+/**
+ * @brief One timed stage of the hot path
+ */
+struct BenchmarkStage
+{
+    const char* name;
+    StageFunction run;
+    bool perSample;     ///< Counted in the samples-per-second estimate
+    bool touchesCard;   ///< Runs 1 / BENCHMARK_FILE_DIVISOR of the iterations
+};
+
+static FusionEngine benchFilter;
+static FusionEngine benchBatchFilter;
+static FusionBatch<FusionScalar, FUSION_BATCH_SIZE> benchBatch;
+static MahonyKernel<FusionScalar> benchMahony;
+static MadgwickKernel<FusionScalar> benchMadgwick;
+static ComplementaryKernel<FusionScalar> benchComplementary;
+static ScalingTable benchScaling;
+static PackedBlockEncoder benchPacker(LOG_PACKED_BLOCK_SAMPLES);
+static ImuFrame benchFrame;
+static LogStream benchLog;
+static char benchLine[CSV_RECORD_MAX_SIZE + 1];
+static float benchWindow[FEATURE_WINDOW_SAMPLES];
+static volatile uint32_t benchSink;
+static volatile float benchScaled;
+
+// ============================================================================
+// STAGES
+// ============================================================================
+
+static void stageReadIMUData(void)
+{
+    readIMUData();
+}
+
+/**
+ * @brief One sample through @p engine, with the arguments runFilter() uses
+ */
+template <typename Engine>
+static void updateEngine(Engine& engine)
+{
+    engine.update(imuSensor.ax, imuSensor.ay, imuSensor.az,
+                  imuSensor.gx * DEG_TO_RAD, imuSensor.gy * DEG_TO_RAD, imuSensor.gz * DEG_TO_RAD,
+                  imuSensor.mx, imuSensor.my, imuSensor.mz, 1.0f / IMU_SAMPLE_RATE_HZ);
+}
+
+/**
+ * @brief Per-sample conversion of the current counts as readIMUData() did
+ *        before the scaling table: resolutions re-derived, then per-axis
+ *        scale, factory sensitivity, bias and hard/soft iron
+ */
+static void stageScalingLegacy(void)
+{
+    imuSensor.getAres();
+    imuSensor.getGres();
+    imuSensor.getMres();
+
+    const float* bias = gyroBiasCorrection();
+    const MagCorrection& correction = magCorrection();
+    float sum = 0.0f;
+    float field[3];
+    for (int i = 0; i < 3; i++)
+    {
+        sum += (float)imuSensor.accelCount[i] * imuSensor.aRes;
+        sum += (float)imuSensor.gyroCount[i] * imuSensor.gRes - bias[i];
+        field[i] = (float)imuSensor.magCount[i] * imuSensor.mRes * imuSensor.magCalibration[i] - correction.offset[i];
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        sum += correction.matrix[i][0] * field[0] + correction.matrix[i][1] * field[1] + correction.matrix[i][2] * field[2];
+    }
+    benchScaled = sum;
+}
+
+/**
+ * @brief The same conversion through the precomputed scaling table
+ */
+static void stageScalingTable(void)
+{
+    const int16_t* counts[SCALING_SENSOR_COUNT] = {imuSensor.accelCount, imuSensor.gyroCount, imuSensor.magCount};
+    float scaled[SCALING_SENSOR_COUNT][3];
+    scaleImuSample(benchScaling, counts, scaled);
+
+    float sum = 0.0f;
+    for (int s = 0; s < SCALING_SENSOR_COUNT; s++)
+    {
+        sum += scaled[s][0] + scaled[s][1] + scaled[s][2];
+    }
+    benchScaled = sum;
+}
+
+static void stageFusionUpdate(void)
+{
+    updateEngine(benchFilter);
+}
+
+static void stageEngineMahony(void)
+{
+    updateEngine(benchMahony);
+}
+
+static void stageEngineMadgwick(void)
+{
+    updateEngine(benchMadgwick);
+}
+
+static void stageEngineComplementary(void)
+{
+    updateEngine(benchComplementary);
+}
+
+static void stageFusionBatch(void)
+{
+    // One sample queued per call; the kernel runs when the batch fills
+    benchBatch.push(imuSensor.ax, imuSensor.ay, imuSensor.az,
+                    imuSensor.gx * DEG_TO_RAD, imuSensor.gy * DEG_TO_RAD, imuSensor.gz * DEG_TO_RAD,
+                    imuSensor.mx, imuSensor.my, imuSensor.mz, 1.0f / IMU_SAMPLE_RATE_HZ);
+    if (benchBatch.full())
+    {
+        benchBatchFilter.updateBatch(benchBatch);
+        benchBatch.clear();
+    }
+}
+
+static void stageCalculateOrientation(void)
+{
+    calculateOrientation();
+}
+
+/**
+ * @brief The five records logSample() writes per AHRS update, as columns
+ */
+struct BenchRecords
+{
+    float accel[3];
+    float gyro[3];
+    float mag[3];
+    float ypr[4];
+};
+
+static void benchRecords(BenchRecords& records)
+{
+    records.accel[0] = 1000 * imuSensor.ax;
+    records.accel[1] = 1000 * imuSensor.ay;
+    records.accel[2] = 1000 * imuSensor.az;
+    records.gyro[0] = imuSensor.gx;
+    records.gyro[1] = imuSensor.gy;
+    records.gyro[2] = imuSensor.gz;
+    records.mag[0] = imuSensor.my;
+    records.mag[1] = imuSensor.mx;
+    records.mag[2] = imuSensor.mz;
+    records.ypr[0] = 200.0f;
+    records.ypr[1] = imuSensor.yaw;
+    records.ypr[2] = imuSensor.pitch;
+    records.ypr[3] = imuSensor.roll;
+}
+
+/**
+ * @brief The five records through snprintf, the formatter used before record_format.h
+ */
+static void stageCsvSnprintf(void)
+{
+    unsigned long timestamp = halMillis();
+    uint32_t length = 0;
+    const float* q = benchFilter.quaternion();
+
+    length += snprintf(benchLine, MSG_BUFFER_SIZE, "\r\n%lu,%lf,%lf,%lf",
+                       timestamp, 1000 * imuSensor.ax, 1000 * imuSensor.ay, 1000 * imuSensor.az);
+    length += snprintf(benchLine, MSG_BUFFER_SIZE, "\r\n%lu,%lf,%lf,%lf",
+                       timestamp, imuSensor.gx, imuSensor.gy, imuSensor.gz);
+    length += snprintf(benchLine, MSG_BUFFER_SIZE, "\r\n%lu,%lf,%lf,%lf",
+                       timestamp, imuSensor.my, imuSensor.mx, imuSensor.mz);
+    length += snprintf(benchLine, MSG_BUFFER_SIZE, "\r\n%lu,%lf,%lf,%lf,%lf",
+                       timestamp, q[0], q[1], q[2], q[3]);
+    length += snprintf(benchLine, MSG_BUFFER_SIZE, "\r\n%lu,%lf,%lf,%lf,%lf",
+                       timestamp, 200.0f, imuSensor.yaw, imuSensor.pitch, imuSensor.roll);
+    benchSink = benchSink + length;
+}
+
+static void stageCsvFormat(void)
+{
+    uint32_t timestamp = halMillis();
+    size_t length = 0;
+    BenchRecords records;
+    benchRecords(records);
+
+    length += formatCsvRecord(benchLine, timestamp, records.accel, 3);
+    length += formatCsvRecord(benchLine, timestamp, records.gyro, 3);
+    length += formatCsvRecord(benchLine, timestamp, records.mag, 3);
+    length += formatCsvRecord(benchLine, timestamp, benchFilter.quaternion(), 4);
+
+    // The last record stays in benchLine for the write stages
+    size_t last = formatCsvRecord(benchLine, timestamp, records.ypr, 4);
+    benchLine[last] = '\0';
+    benchSink = benchSink + length + last;
+}
+
+/**
+ * @brief The five records formatted straight into a LogStream block
+ */
+static void stageLogStreamRecord(void)
+{
+    uint32_t timestamp = halMillis();
+    BenchRecords records;
+    benchRecords(records);
+
+    benchLog.printRecord(timestamp, records.accel, 3);
+    benchLog.printRecord(timestamp, records.gyro, 3);
+    benchLog.printRecord(timestamp, records.mag, 3);
+    benchLog.printRecord(timestamp, benchFilter.quaternion(), 4);
+    benchLog.printRecord(timestamp, records.ypr, 4);
+}
+
+/**
+ * @brief One sample into a packed log block, finishing it when full
+ *
+ * The timestamp advances one sample period per call and the counts move
+ * by a few LSB, like a slowly turning device.
+ */
+static void stagePackedEncode(void)
+{
+    const uint8_t* block;
+
+    benchFrame.timestampMs += 1000 / IMU_SAMPLE_RATE_HZ;
+    for (int i = 0; i < 3; i++)
+    {
+        benchFrame.accelCount[i] = (int16_t)(imuSensor.accelCount[i] + (int16_t)(benchFrame.timestampMs % 7) - 3);
+        benchFrame.gyroCount[i] = (int16_t)(imuSensor.gyroCount[i] + (int16_t)(benchFrame.timestampMs % 11) - 5);
+        benchFrame.magCount[i] = imuSensor.magCount[i];
+    }
+
+    if (!benchPacker.add(benchFrame))
+    {
+        benchSink = benchSink + (uint32_t)benchPacker.finish(block);
+        benchPacker.add(benchFrame);
+    }
+}
+
+/**
+ * @brief Features of one channel window, refilled with a noisy oscillation
+ *
+ * Runs once per FEATURE_WINDOW_SAMPLES samples per channel on the device.
+ */
+static void stageFeatureWindow(void)
+{
+    WindowFeatures features;
+
+    for (int n = 0; n < FEATURE_WINDOW_SAMPLES; n++)
+    {
+        benchWindow[n] = 1000.0f * imuSensor.az + (float)((n * 37) % 23) - 11.0f + ((n & 8) ? 40.0f : -40.0f);
+    }
+    computeWindowFeatures(benchWindow, features);
+    benchScaled = features.bands[0];
+}
+
+static void stageLogStreamPrint(void)
+{
+    benchLog.print(benchLine);
+}
+
+static void stageAppendFile(void)
+{
+    appendFile(halStorage(), FILE_BENCHMARK_APPEND, benchLine);
+}
+
+static const BenchmarkStage stages[] =
+{
+    {"read_imu_data", stageReadIMUData, true, false},
+    {"scaling_legacy", stageScalingLegacy, false, false},
+    {"scaling_table", stageScalingTable, false, false},
+    {"fusion_update", stageFusionUpdate, true, false},
+    {"fusion_batch", stageFusionBatch, false, false},
+    {"engine_mahony", stageEngineMahony, false, false},
+    {"engine_madgwick", stageEngineMadgwick, false, false},
+    {"engine_complementary", stageEngineComplementary, false, false},
+    {"calculate_orientation", stageCalculateOrientation, true, false},
+    {"csv_snprintf", stageCsvSnprintf, false, false},
+    {"csv_format", stageCsvFormat, false, false},
+    {"packed_encode", stagePackedEncode, false, false},
+    {"feature_window", stageFeatureWindow, false, false},
+    {"log_stream_print", stageLogStreamPrint, false, false},
+    {"log_stream_record", stageLogStreamRecord, true, false},
+    {"append_file", stageAppendFile, false, true},
+};
+
+// ============================================================================
+// ACCURACY CHECKS
+// ============================================================================
+
+/**
+ * @brief Largest error of fastAtan2f()/fastAsinf() against libm (radians)
+ */
+static float fastTrigMaxError(void)
+{
+    float worst = 0.0f;
+
+    for (int i = 0; i <= ACCURACY_TRIG_STEPS; i++)
+    {
+        float angle = -FAST_TRIG_PI + 2.0f * FAST_TRIG_PI * (float)i / ACCURACY_TRIG_STEPS;
+        float y = sinf(angle);
+        float x = cosf(angle);
+        float error = fabsf(fastAtan2f(y, x) - atan2f(y, x));
+        if (error > FAST_TRIG_PI)
+        {
+            error = fabsf(error - 2.0f * FAST_TRIG_PI);
+        }
+        worst = (error > worst) ? error : worst;
+
+        float s = -1.0f + 2.0f * (float)i / ACCURACY_TRIG_STEPS;
+        error = fabsf(fastAsinf(s) - asinf(s));
+        worst = (error > worst) ? error : worst;
+    }
+
+    return worst;
+}
+
+/**
+ * @brief Largest quaternion component difference of MahonyKernel<T> from MahonyFilter
+ * 
+ * Both filters fuse the same synthetic rotating-sensor sequence.
+ */
+template <typename T>
+static float kernelMaxDeviation(void)
+{
+    MahonyFilter reference;
+    MahonyKernel<T> kernel;
+    float worst = 0.0f;
+
+    for (int i = 0; i < ACCURACY_FUSION_SAMPLES; i++)
+    {
+        float t = (float)i / IMU_SAMPLE_RATE_HZ;
+        float ax = 0.3f * sinf(t), ay = 0.2f * cosf(0.7f * t), az = 1.0f;
+        float gx = 0.5f * sinf(0.9f * t), gy = 0.3f * cosf(1.3f * t), gz = 0.2f;
+        float mx = 200.0f + 100.0f * cosf(t), my = 300.0f, mz = -400.0f + 50.0f * sinf(t);
+
+        reference.update(ax, ay, az, gx, gy, gz, mx, my, mz, 1.0f / IMU_SAMPLE_RATE_HZ);
+        kernel.update(ax, ay, az, gx, gy, gz, mx, my, mz, 1.0f / IMU_SAMPLE_RATE_HZ);
+
+        for (int k = 0; k < 4; k++)
+        {
+            float error = fabsf(kernel.quaternion()[k] - reference.quaternion()[k]);
+            worst = (error > worst) ? error : worst;
+        }
+    }
+
+    return worst;
+}
+
+// ============================================================================
+// BENCHMARK FUNCTIONS
+// ============================================================================
+
+void runBenchmarks(Print& out, uint32_t iterations)
+{
+    const int stageCount = sizeof(stages) / sizeof(stages[0]);
+    float perSampleNs = 0.0f;
+    float perSampleModeledUs = 0.0f;
+
+    if (iterations < BENCHMARK_FILE_DIVISOR)
+    {
+        iterations = BENCHMARK_FILE_DIVISOR;
+    }
+
+    buildAccelTransform(benchScaling.sensor[SCALING_ACCEL], imuSensor.aRes);
+    buildGyroTransform(benchScaling.sensor[SCALING_GYRO], imuSensor.gRes, gyroBiasCorrection());
+    buildMagTransform(benchScaling.sensor[SCALING_MAG], imuSensor.mRes, imuSensor.magCalibration, magCorrection());
+
+    benchLog.begin(halStorage(), FILE_BENCHMARK_STREAM, "");
+    stageCsvFormat();
+
+    out.printf("{\"benchmark\":\"hot_path\",\"platform\":\"%s\",\"build\":\"%s\",\"engine\":\"%s\",\"iterations\":%lu,\"stages\":[",
+               BENCHMARK_PLATFORM, BENCHMARK_BUILD_ID, FUSION_ENGINE_NAME, (unsigned long)iterations);
+
+    for (int s = 0; s < stageCount; s++)
+    {
+        uint32_t count = stages[s].touchesCard ? iterations / BENCHMARK_FILE_DIVISOR : iterations;
+
+        uint32_t modeledStart = halMicros();
+        uint32_t cpuStart = halProfileMicros();
+        for (uint32_t i = 0; i < count; i++)
+        {
+            stages[s].run();
+        }
+        uint32_t cpuUs = halProfileMicros() - cpuStart;
+        uint32_t modeledUs = halMicros() - modeledStart;
+
+        float nsPerOp = 1000.0f * (float)cpuUs / (float)count;
+        if (stages[s].perSample)
+        {
+            perSampleNs += nsPerOp;
+            perSampleModeledUs += (float)modeledUs / (float)count;
+        }
+
+        out.printf("%s{\"name\":\"%s\",\"iterations\":%lu,\"total_us\":%lu,\"ns_per_op\":%.1f,"
+                   "\"cycles_per_op\":%.1f,\"ops_per_sec\":%.1f,\"modeled_us_per_op\":%.3f}",
+                   (s > 0) ? "," : "", stages[s].name, (unsigned long)count, (unsigned long)cpuUs,
+                   nsPerOp, nsPerOp * (float)halCyclesPerMicrosecond() / 1000.0f,
+                   (nsPerOp > 0.0f) ? 1.0e9f / nsPerOp : 0.0f, (float)modeledUs / (float)count);
+    }
+
+    out.printf("],\"samples_per_sec\":%.1f,\"modeled_us_per_sample\":%.3f,",
+               (perSampleNs > 0.0f) ? 1.0e9f / perSampleNs : 0.0f, perSampleModeledUs);
+
+    float trigError = fastTrigMaxError();
+    out.printf("\"accuracy\":{\"fast_trig_max_error_rad\":%.3g,\"fast_trig_bound_rad\":%.3g,"
+               "\"fast_trig_ok\":%s,\"float_kernel_max_dq\":%.3g,\"fixed_kernel_max_dq\":%.3g}}\n",
+               trigError, FAST_TRIG_MAX_ERROR_RAD, (trigError <= FAST_TRIG_MAX_ERROR_RAD) ? "true" : "false",
+               kernelMaxDeviation<float>(), kernelMaxDeviation<FixedPoint<FUSION_FIXED_FRAC_BITS> >());
+
+    benchLog.close();
+    halStorage().remove(FILE_BENCHMARK_STREAM);
+    halStorage().remove(FILE_BENCHMARK_APPEND);
+}
@@ -0,0 +1,43 @@
+/**
+ * @file benchmark.h
+ * @brief Per-stage benchmark of the sample hot path
+ * 
+ * Times each stage of one loop() iteration in isolation: sensor readout
+ * and scaling (the per-axis conversion readIMUData() used before the
+ * scaling table next to the table itself), the configured fusion engine
+ * (single and batched), the Euler conversion, CSV formatting (snprintf
+ * next to record_format.h, and formatted straight into a LogStream block),
+ * packed log block encoding and the two SD write paths, plus the
+ * per-sample cost of every fusion engine. The report also checks the fast trig error bound
+ * and how far the float and fixed-point Mahony kernels drift from the
+ * reference MahonyFilter. Runs on the M5Stack (BENCHMARK_MODE_ENABLED) and
+ * in the host simulator (--benchmark), and reports one JSON object so
+ * results can be stored and compared between commits.
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "hal.h"
+
+// ============================================================================
+// BENCHMARK FUNCTIONS
+// ============================================================================
+
+/**
+ * @brief Run every stage and print the JSON report
+ * 
+ * Must be called after the IMU and data files are initialized. Stages that
+ * touch the SD card run a fraction (1 / BENCHMARK_FILE_DIVISOR) of the
+ * iterations, and their scratch files are removed afterwards.
+ * 
+ * @param out Destination for the report
+ * @param iterations Iterations per CPU-bound stage
+ */
+void runBenchmarks(Print& out, uint32_t iterations);
+
+#endif // BENCHMARK_H
@@ -0,0 +1,829 @@
+/**
+ * @file calibration.cpp
+ * @brief Streaming sensor calibration implementation
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "calibration.h"
+#include "log_record.h"
+#include "sd_logger.h"
+#include "config.h"
+#include "hal.h"
+#include <atomic>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+static_assert(sizeof(CalibrationRecord) == 112, "CalibrationRecord layout changed");
+
+// ============================================================================
+// GLOBAL VARIABLES
+// ============================================================================
+
+// Sampling context
+static MagEllipsoidFit magFit;
+static StillnessDetector stillness;
+static MagCorrection activeMag;
+static float activeGyroBias[3] = {0.0f, 0.0f, 0.0f};
+static float hardwareGyroBias[3] = {0.0f, 0.0f, 0.0f};
+static float activeAccelBias[3] = {0.0f, 0.0f, 0.0f};
+static float activeSelfTest[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+static uint32_t activeMagSamples = 0;
+static MagFitModel activeMagModel = MAG_FIT_NONE;
+static bool restored = false;
+static bool wasStill = false;
+static bool publishWanted = false;
+
+// Background recalibration after a fast boot (sampling context)
+static bool recalPending = false;
+static uint32_t recalSamples = 0;
+static float recalGyroSum[3];
+static float recalAccelSum[3];
+
+// Sampling -> logging hand-off: written only while pendingReady is false
+static CalibrationRecord pendingRecord;
+static std::atomic<bool> pendingReady(false);
+
+// Logging context
+static CalibrationRecord heldRecord;
+static bool heldDirty = false;
+static bool savedOnce = false;
+static uint32_t lastSaveMs = 0;
+
+// ============================================================================
+// MATRIX HELPERS
+// ============================================================================
+
+/**
+ * @brief Eigen-decomposition of a symmetric 3x3 matrix (cyclic Jacobi)
+ *
+ * @param a Matrix; destroyed
+ * @param values Eigenvalues
+ * @param vectors Eigenvectors, one per column
+ */
+static void symmetricEigen3(double a[3][3], double values[3], double vectors[3][3])
+{
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            vectors[i][j] = (i == j) ? 1.0 : 0.0;
+        }
+    }
+
+    for (int sweep = 0; sweep < 16; sweep++)
+    {
+        double offDiagonal = fabs(a[0][1]) + fabs(a[0][2]) + fabs(a[1][2]);
+        if (offDiagonal < 1e-15)
+        {
+            break;
+        }
+
+        for (int p = 0; p < 2; p++)
+        {
+            for (int q = p + 1; q < 3; q++)
+            {
+                if (a[p][q] == 0.0)
+                {
+                    continue;
+                }
+
+                // Rotation that zeroes a[p][q]
+                double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                double t = ((theta >= 0.0) ? 1.0 : -1.0) / (fabs(theta) + sqrt(theta * theta + 1.0));
+                double c = 1.0 / sqrt(t * t + 1.0);
+                double s = t * c;
+
+                for (int k = 0; k < 3; k++)
+                {
+                    double akp = a[k][p];
+                    double akq = a[k][q];
+                    a[k][p] = c * akp - s * akq;
+                    a[k][q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < 3; k++)
+                {
+                    double apk = a[p][k];
+                    double aqk = a[q][k];
+                    a[p][k] = c * apk - s * aqk;
+                    a[q][k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < 3; k++)
+                {
+                    double vkp = vectors[k][p];
+                    double vkq = vectors[k][q];
+                    vectors[k][p] = c * vkp - s * vkq;
+                    vectors[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        values[i] = a[i][i];
+    }
+}
+
+/**
+ * @brief Invert a 3x3 matrix by cofactors
+ *
+ * @return false if the matrix is singular
+ */
+static bool invert3(const double m[3][3], double inverse[3][3])
+{
+    double c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+    double c01 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+    double c02 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+    double det = m[0][0] * c00 + m[0][1] * c01 + m[0][2] * c02;
+
+    if (fabs(det) < 1e-12)
+    {
+        return false;
+    }
+
+    double r = 1.0 / det;
+    inverse[0][0] = c00 * r;
+    inverse[1][0] = c01 * r;
+    inverse[2][0] = c02 * r;
+    inverse[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * r;
+    inverse[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * r;
+    inverse[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * r;
+    inverse[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * r;
+    inverse[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * r;
+    inverse[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * r;
+    return true;
+}
+
+static void setDefaultMagCorrection(MagCorrection& correction)
+{
+    correction.offset[0] = MAG_BIAS_X;
+    correction.offset[1] = MAG_BIAS_Y;
+    correction.offset[2] = MAG_BIAS_Z;
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            correction.matrix[i][j] = (i == j) ? 1.0f : 0.0f;
+        }
+    }
+}
+
+// ============================================================================
+// MAGNETOMETER ELLIPSOID FIT
+// ============================================================================
+
+MagEllipsoidFit::MagEllipsoidFit(void)
+{
+    static const float origin[3] = {0.0f, 0.0f, 0.0f};
+    begin(origin);
+}
+
+void MagEllipsoidFit::begin(const float* referenceMg)
+{
+    // Prior for both models: unit sphere around the reference, weakly held
+    for (int i = 0; i < 9; i++)
+    {
+        theta[i] = (i < 3) ? 1.0 : 0.0;
+        for (int j = 0; j < 9; j++)
+        {
+            covariance[i][j] = (i == j) ? CAL_MAG_PRIOR_COVARIANCE : 0.0;
+        }
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        sphereTheta[i] = (i == 3) ? 1.0 : 0.0;
+        for (int j = 0; j < 4; j++)
+        {
+            sphereCovariance[i][j] = (i == j) ? CAL_MAG_PRIOR_COVARIANCE : 0.0;
+        }
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        reference[i] = referenceMg[i];
+        lastAccepted[i] = referenceMg[i];
+    }
+    residualSquared = 0.0;
+    sphereResidualSquared = 0.0;
+    accepted = 0;
+}
+
+/**
+ * @brief One exponentially weighted RLS step for y = phi' theta
+ *
+ * @return A priori error y - phi' theta
+ */
+template <int N>
+static double rlsUpdate(double (&theta)[N], double (&covariance)[N][N], const double (&phi)[N], double y)
+{
+    // Gain k = P phi / (lambda + phi' P phi)
+    double pPhi[N];
+    double denominator = CAL_MAG_FORGETTING;
+    double prediction = 0.0;
+    for (int i = 0; i < N; i++)
+    {
+        double sum = 0.0;
+        for (int j = 0; j < N; j++)
+        {
+            sum += covariance[i][j] * phi[j];
+        }
+        pPhi[i] = sum;
+        denominator += phi[i] * sum;
+        prediction += phi[i] * theta[i];
+    }
+
+    double error = y - prediction;
+    double scale = 1.0 / denominator;
+    for (int i = 0; i < N; i++)
+    {
+        theta[i] += pPhi[i] * scale * error;
+    }
+
+    // P = (P - k phi' P) / lambda, kept exactly symmetric
+    for (int i = 0; i < N; i++)
+    {
+        for (int j = i; j < N; j++)
+        {
+            double value = (covariance[i][j] - pPhi[i] * pPhi[j] * scale) / CAL_MAG_FORGETTING;
+            covariance[i][j] = value;
+            covariance[j][i] = value;
+        }
+    }
+    return error;
+}
+
+template <int N>
+static double largestVariance(const double (&covariance)[N][N])
+{
+    double largest = 0.0;
+    for (int i = 0; i < N; i++)
+    {
+        largest = (covariance[i][i] > largest) ? covariance[i][i] : largest;
+    }
+    return largest;
+}
+
+bool MagEllipsoidFit::addSample(const float* fieldMg)
+{
+    // Repeated readings from a resting device would dominate the fit and
+    // let the forgetting factor wind up the covariance
+    float dx = fieldMg[0] - lastAccepted[0];
+    float dy = fieldMg[1] - lastAccepted[1];
+    float dz = fieldMg[2] - lastAccepted[2];
+    if (dx * dx + dy * dy + dz * dz < CAL_MAG_MIN_SPACING_MG * CAL_MAG_MIN_SPACING_MG)
+    {
+        return false;
+    }
+    lastAccepted[0] = fieldMg[0];
+    lastAccepted[1] = fieldMg[1];
+    lastAccepted[2] = fieldMg[2];
+
+    double x = (fieldMg[0] - reference[0]) / CAL_MAG_SCALE_MG;
+    double y = (fieldMg[1] - reference[1]) / CAL_MAG_SCALE_MG;
+    double z = (fieldMg[2] - reference[2]) / CAL_MAG_SCALE_MG;
+
+    const double phi[9] = {x * x, y * y, z * z, 2.0 * x * y, 2.0 * x * z, 2.0 * y * z, 2.0 * x, 2.0 * y, 2.0 * z};
+    double error = rlsUpdate(theta, covariance, phi, 1.0);
+    residualSquared += CAL_MAG_RESIDUAL_ALPHA * (error * error - residualSquared);
+
+    const double spherePhi[4] = {2.0 * x, 2.0 * y, 2.0 * z, 1.0};
+    error = rlsUpdate(sphereTheta, sphereCovariance, spherePhi, x * x + y * y + z * z);
+    sphereResidualSquared += CAL_MAG_RESIDUAL_ALPHA * (error * error - sphereResidualSquared);
+
+    accepted++;
+    return true;
+}
+
+bool MagEllipsoidFit::passesGates(const MagFitQuality& quality) const
+{
+    return accepted >= CAL_MAG_MIN_SAMPLES && quality.axisRatio <= CAL_MAG_MAX_AXIS_RATIO
+        && quality.residual <= CAL_MAG_MAX_RESIDUAL && quality.fieldMg >= CAL_MAG_MIN_FIELD_MG
+        && quality.fieldMg <= CAL_MAG_MAX_FIELD_MG;
+}
+
+bool MagEllipsoidFit::solve(MagCorrection& correction, MagFitQuality& quality) const
+{
+    if (largestVariance(covariance) <= CAL_MAG_MAX_COVARIANCE && solveEllipsoid(correction, quality))
+    {
+        return true;
+    }
+    return largestVariance(sphereCovariance) <= CAL_MAG_SPHERE_MAX_COVARIANCE && solveSphere(correction, quality);
+}
+
+bool MagEllipsoidFit::solveEllipsoid(MagCorrection& correction, MagFitQuality& quality) const
+{
+    double m[3][3] = {
+        {theta[0], theta[3], theta[4]},
+        {theta[3], theta[1], theta[5]},
+        {theta[4], theta[5], theta[2]}};
+    double inverse[3][3];
+    if (!invert3(m, inverse))
+    {
+        return false;
+    }
+
+    // Centre c = -M^-1 g; then (x - c)' M (x - c) = 1 + c' M c = k
+    double centre[3];
+    for (int i = 0; i < 3; i++)
+    {
+        centre[i] = -(inverse[i][0] * theta[6] + inverse[i][1] * theta[7] + inverse[i][2] * theta[8]);
+    }
+    double k = 1.0;
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            k += centre[i] * m[i][j] * centre[j];
+        }
+    }
+    if (fabs(k) < 1e-9)
+    {
+        return false;
+    }
+
+    double shape[3][3];
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            shape[i][j] = m[i][j] / k;
+        }
+    }
+
+    double values[3];
+    double vectors[3][3];
+    symmetricEigen3(shape, values, vectors);
+
+    double smallest = values[0];
+    double largest = values[0];
+    for (int i = 1; i < 3; i++)
+    {
+        smallest = (values[i] < smallest) ? values[i] : smallest;
+        largest = (values[i] > largest) ? values[i] : largest;
+    }
+    if (smallest <= 0.0)
+    {
+        return false;
+    }
+
+    // Semi-axes are 1 / sqrt(lambda); keep their geometric mean as the
+    // corrected field strength so headings and magnitudes stay in mG
+    double radius = pow(values[0] * values[1] * values[2], -1.0 / 6.0);
+    quality.model = MAG_FIT_ELLIPSOID;
+    quality.axisRatio = (float)sqrt(largest / smallest);
+    quality.residual = (float)(sqrt(residualSquared) / (2.0 * fabs(k)));
+    quality.fieldMg = (float)(radius * CAL_MAG_SCALE_MG);
+    if (!passesGates(quality))
+    {
+        return false;
+    }
+
+    // Soft-iron matrix: radius * V sqrt(Lambda) V', maps the ellipsoid onto a sphere
+    for (int i = 0; i < 3; i++)
+    {
+        correction.offset[i] = reference[i] + (float)(centre[i] * CAL_MAG_SCALE_MG);
+        for (int j = 0; j < 3; j++)
+        {
+            double sum = 0.0;
+            for (int e = 0; e < 3; e++)
+            {
+                sum += vectors[i][e] * sqrt(values[e]) * vectors[j][e];
+            }
+            correction.matrix[i][j] = (float)(radius * sum);
+        }
+    }
+    return true;
+}
+
+bool MagEllipsoidFit::solveSphere(MagCorrection& correction, MagFitQuality& quality) const
+{
+    // |x - c|^2 = r^2 with d = r^2 - |c|^2
+    const double* centre = sphereTheta;
+    double radiusSquared = sphereTheta[3] + centre[0] * centre[0] + centre[1] * centre[1] + centre[2] * centre[2];
+    if (radiusSquared <= 0.0)
+    {
+        return false;
+    }
+
+    quality.model = MAG_FIT_SPHERE;
+    quality.axisRatio = 1.0f;
+    quality.residual = (float)(sqrt(sphereResidualSquared) / (2.0 * radiusSquared));
+    quality.fieldMg = (float)(sqrt(radiusSquared) * CAL_MAG_SCALE_MG);
+    if (!passesGates(quality))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+        correction.offset[i] = reference[i] + (float)(centre[i] * CAL_MAG_SCALE_MG);
+        for (int j = 0; j < 3; j++)
+        {
+            correction.matrix[i][j] = (i == j) ? 1.0f : 0.0f;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// STILLNESS DETECTOR
+// ============================================================================
+
+StillnessDetector::StillnessDetector(void)
+{
+    reset();
+}
+
+void StillnessDetector::reset(void)
+{
+    mean[0] = mean[1] = mean[2] = 0.0f;
+    stillSamples = 0;
+    primed = false;
+}
+
+bool StillnessDetector::update(const float* accelG, const float* gyroDps)
+{
+    if (!primed)
+    {
+        mean[0] = gyroDps[0];
+        mean[1] = gyroDps[1];
+        mean[2] = gyroDps[2];
+        primed = true;
+    }
+
+    bool quiet = true;
+    for (int i = 0; i < 3; i++)
+    {
+        float deviation = gyroDps[i] - mean[i];
+        mean[i] += CAL_STILL_MEAN_ALPHA * deviation;
+        quiet = quiet && fabsf(deviation) < CAL_STILL_GYRO_DPS && fabsf(gyroDps[i]) < CAL_STILL_RATE_DPS;
+    }
+
+    float accelNorm = sqrtf(accelG[0] * accelG[0] + accelG[1] * accelG[1] + accelG[2] * accelG[2]);
+    quiet = quiet && fabsf(accelNorm - 1.0f) < CAL_STILL_ACCEL_G;
+
+    if (!quiet)
+    {
+        stillSamples = 0;
+    }
+    else if (stillSamples < CAL_STILL_MIN_SAMPLES)
+    {
+        stillSamples++;
+    }
+    return still();
+}
+
+// ============================================================================
+// PERSISTENCE
+// ============================================================================
+
+static uint16_t recordCrc(const CalibrationRecord& record)
+{
+    return crc16Ccitt((const uint8_t*)&record, offsetof(CalibrationRecord, crc));
+}
+
+/**
+ * @brief Read @p path into @p record and validate it
+ */
+static bool readRecordFile(const char* path, CalibrationRecord& record)
+{
+    if (!halStorage().exists(path))
+    {
+        return false;
+    }
+
+    File file = halStorage().open(path, FILE_READ);
+    if (!file)
+    {
+        return false;
+    }
+
+    size_t length = file.read((uint8_t*)&record, sizeof(record));
+    file.close();
+
+    return length == sizeof(record) && record.magic == CALIBRATION_MAGIC
+        && record.version == CALIBRATION_VERSION && record.size == sizeof(record)
+        && record.crc == recordCrc(record);
+}
+
+/**
+ * @brief Newest complete record
+ *
+ * saveRecord() only removes the old record once the temporary file is
+ * complete, so a temporary file that validates is the newer of the two;
+ * one left by a reset mid-write fails its CRC and the old record is used.
+ */
+static bool loadRecord(CalibrationRecord& record)
+{
+    return readRecordFile(FILE_CALIBRATION_TEMP, record) || readRecordFile(FILE_CALIBRATION, record);
+}
+
+static bool saveRecord(const CalibrationRecord& record)
+{
+    fs::FS& fs = halStorage();
+    File file = fs.open(FILE_CALIBRATION_TEMP, FILE_WRITE);
+    if (!file)
+    {
+        return false;
+    }
+
+    size_t length = file.write((const uint8_t*)&record, sizeof(record));
+    file.close();
+    if (length != sizeof(record))
+    {
+        return false;
+    }
+
+    // FAT cannot rename over an existing file. Between the remove and the
+    // rename only the temporary file holds the record; loadRecord() reads it.
+    if (fs.exists(FILE_CALIBRATION))
+    {
+        fs.remove(FILE_CALIBRATION);
+    }
+    return fs.rename(FILE_CALIBRATION_TEMP, FILE_CALIBRATION);
+}
+
+/**
+ * @brief Hand the current calibration to the logging context if it is free
+ */
+static void publishCalibration(void)
+{
+    if (pendingReady.load(std::memory_order_acquire))
+    {
+        return;
+    }
+
+    CalibrationRecord& record = pendingRecord;
+    memset(&record, 0, sizeof(record));
+    record.magic = CALIBRATION_MAGIC;
+    record.version = CALIBRATION_VERSION;
+    record.size = sizeof(record);
+    memcpy(record.magOffset, activeMag.offset, sizeof(record.magOffset));
+    memcpy(record.magMatrix, activeMag.matrix, sizeof(record.magMatrix));
+    for (int i = 0; i < 3; i++)
+    {
+        record.gyroBias[i] = hardwareGyroBias[i] + activeGyroBias[i];
+    }
+    memcpy(record.accelBias, activeAccelBias, sizeof(record.accelBias));
+    memcpy(record.selfTest, activeSelfTest, sizeof(record.selfTest));
+    record.magSamples = activeMagSamples;
+    record.magModel = (uint16_t)activeMagModel;
+    record.crc = recordCrc(record);
+
+    pendingReady.store(true, std::memory_order_release);
+    publishWanted = false;
+}
+
+/**
+ * @brief Average still samples into new biases once after a fast boot
+ *
+ * Any motion restarts the average, so it only ever spans one rest period.
+ * The accel bias is only replaced when the average shows the device lying
+ * flat, gravity on Z within CAL_RECAL_LEVEL_G; resting in any other
+ * orientation would turn gravity into bias, so then only the gyro bias is
+ * renewed.
+ *
+ * @return true once the new biases are in place
+ */
+static bool accumulateRecalibration(bool still, const float* accelG, const float* gyroDps)
+{
+    if (!still)
+    {
+        recalSamples = 0;
+        return false;
+    }
+
+    if (recalSamples == 0)
+    {
+        memset(recalGyroSum, 0, sizeof(recalGyroSum));
+        memset(recalAccelSum, 0, sizeof(recalAccelSum));
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        recalGyroSum[i] += gyroDps[i];
+        recalAccelSum[i] += accelG[i];
+    }
+    if (++recalSamples < CAL_RECAL_SAMPLES)
+    {
+        return false;
+    }
+
+    // The gyro input has the stored bias removed, so its mean is the drift
+    float accelMean[3];
+    for (int i = 0; i < 3; i++)
+    {
+        activeGyroBias[i] += recalGyroSum[i] / CAL_RECAL_SAMPLES;
+        accelMean[i] = recalAccelSum[i] / CAL_RECAL_SAMPLES;
+    }
+
+    // Gravity on Z, as calibrateMPU9250() assumes
+    accelMean[2] -= (accelMean[2] > 0.0f) ? 1.0f : -1.0f;
+    if (fabsf(accelMean[0]) < CAL_RECAL_LEVEL_G && fabsf(accelMean[1]) < CAL_RECAL_LEVEL_G
+        && fabsf(accelMean[2]) < CAL_RECAL_LEVEL_G)
+    {
+        memcpy(activeAccelBias, accelMean, sizeof(activeAccelBias));
+    }
+
+    recalPending = false;
+    publishWanted = true;
+    return true;
+}
+
+// ============================================================================
+// CALIBRATION FUNCTIONS
+// ============================================================================
+
+bool beginCalibration(void)
+{
+    CalibrationRecord record;
+
+    setDefaultMagCorrection(activeMag);
+    restored = CALIBRATION_STORE_ENABLED && loadRecord(record);
+    recalPending = FAST_BOOT_ENABLED && restored;
+    recalSamples = 0;
+
+    if (restored)
+    {
+        memcpy(activeMag.offset, record.magOffset, sizeof(activeMag.offset));
+        memcpy(activeMag.matrix, record.magMatrix, sizeof(activeMag.matrix));
+        memcpy(activeGyroBias, record.gyroBias, sizeof(activeGyroBias));
+        memcpy(activeAccelBias, record.accelBias, sizeof(activeAccelBias));
+        memcpy(activeSelfTest, record.selfTest, sizeof(activeSelfTest));
+        activeMagSamples = record.magSamples;
+        activeMagModel = (MagFitModel)record.magModel;
+
+        Serial.print("INFO: Restored calibration, mag offset ");
+        Serial.print(activeMag.offset[0], 1);
+        Serial.print(", ");
+        Serial.print(activeMag.offset[1], 1);
+        Serial.print(", ");
+        Serial.print(activeMag.offset[2], 1);
+        Serial.print(" mG, gyro bias ");
+        Serial.print(activeGyroBias[0], 3);
+        Serial.print(", ");
+        Serial.print(activeGyroBias[1], 3);
+        Serial.print(", ");
+        Serial.print(activeGyroBias[2], 3);
+        Serial.println(" dps");
+    }
+
+    magFit.begin(activeMag.offset);
+    stillness.reset();
+    return restored;
+}
+
+bool calibrationRestored(void)
+{
+    return restored;
+}
+
+void setStartupCalibration(const float* gyroBiasDps, const float* accelBiasG, const float* selfTest)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        hardwareGyroBias[i] = gyroBiasDps[i];
+        activeGyroBias[i] = 0.0f;
+        activeAccelBias[i] = accelBiasG[i];
+    }
+    memcpy(activeSelfTest, selfTest, sizeof(activeSelfTest));
+
+    // The next boot needs a record to start from
+    publishWanted = FAST_BOOT_ENABLED;
+}
+
+bool calibrationObserveMotion(const float* accelG, const float* gyroDps)
+{
+    if (!CALIBRATION_STORE_ENABLED)
+    {
+        return false;
+    }
+
+    bool biasChanged = false;
+    if (CALIBRATION_ENGINE_ENABLED || recalPending)
+    {
+        // The input already has the bias removed, so it is the bias error
+        bool still = stillness.update(accelG, gyroDps);
+        if (recalPending)
+        {
+            biasChanged = accumulateRecalibration(still, accelG, gyroDps);
+        }
+        else if (still)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                activeGyroBias[i] += CAL_GYRO_BIAS_ALPHA * gyroDps[i];
+            }
+            biasChanged = true;
+        }
+        else if (wasStill)
+        {
+            // A rest period just ended: its bias estimate is worth keeping
+            publishWanted = true;
+        }
+        wasStill = still;
+    }
+
+    if (publishWanted)
+    {
+        publishCalibration();
+    }
+    return biasChanged;
+}
+
+bool calibrationObserveMag(const float* fieldMg)
+{
+    if (!CALIBRATION_ENGINE_ENABLED || !magFit.addSample(fieldMg))
+    {
+        return false;
+    }
+
+    if (magFit.acceptedSamples() % CAL_MAG_SOLVE_INTERVAL != 0)
+    {
+        return false;
+    }
+
+    MagCorrection candidate;
+    MagFitQuality quality;
+    if (!magFit.solve(candidate, quality))
+    {
+        return false;
+    }
+
+    // Never trade a full ellipsoid for the coarser sphere
+    if (quality.model < activeMagModel)
+    {
+        return false;
+    }
+
+    activeMag = candidate;
+    activeMagModel = quality.model;
+    activeMagSamples = magFit.acceptedSamples();
+    publishWanted = true;
+    return true;
+}
+
+const MagCorrection& magCorrection(void)
+{
+    return activeMag;
+}
+
+const float* gyroBiasCorrection(void)
+{
+    return activeGyroBias;
+}
+
+const float* accelBiasEstimate(void)
+{
+    return activeAccelBias;
+}
+
+const float* selfTestTrims(void)
+{
+    return activeSelfTest;
+}
+
+bool recalibrationPending(void)
+{
+    return recalPending;
+}
+
+void serviceCalibrationStore(uint32_t nowMs)
+{
+    if (!CALIBRATION_STORE_ENABLED)
+    {
+        return;
+    }
+
+    if (pendingReady.load(std::memory_order_acquire))
+    {
+        heldRecord = pendingRecord;
+        heldDirty = true;
+        pendingReady.store(false, std::memory_order_release);
+    }
+
+    if (!heldDirty || (savedOnce && nowMs - lastSaveMs < CAL_SAVE_INTERVAL_MS))
+    {
+        return;
+    }
+
+    heldDirty = false;
+    savedOnce = true;
+    lastSaveMs = nowMs;
+
+    if (!saveRecord(heldRecord))
+    {
+        Serial.println("ERROR: Failed to save calibration");
+        return;
+    }
+
+    char line[MSG_BUFFER_SIZE];
+    snprintf(line, sizeof(line), "\r\n#cal,%lu,%.1f,%.1f,%.1f,%.3f,%.3f,%.3f,%lu",
+             (unsigned long)nowMs, heldRecord.magOffset[0], heldRecord.magOffset[1], heldRecord.magOffset[2],
+             heldRecord.gyroBias[0], heldRecord.gyroBias[1], heldRecord.gyroBias[2],
+             (unsigned long)heldRecord.magSamples);
+    diagnosticsLog.print(line);
+}
@@ -0,0 +1,283 @@
+/**
+ * @file calibration.h
+ * @brief Streaming sensor calibration: mag hard/soft iron and gyro bias
+ *
+ * Runs alongside acquisition in O(1) memory. Every magnetometer reading
+ * that has moved far enough from the last accepted one feeds recursive
+ * least-squares fits of the ellipsoid the readings lie on; the fit is
+ * solved periodically into a hard-iron offset and a 3x3 soft-iron matrix
+ * (identity while the readings only determine a sphere), and adopted once
+ * it passes the quality gates. Gyro bias is tracked while a stillness
+ * detector says the device is at rest.
+ *
+ * The per-sample path never sees the estimators: the adopted correction is
+ * folded into the scaling table (sensor_scaling.h) whenever it changes.
+ * The sampling context owns the estimator; adopted results are handed to
+ * the logging context, which writes them to FILE_CALIBRATION so the next
+ * boot can start from them instead of the startup stabilization.
+ *
+ * With FAST_BOOT_ENABLED the record is kept even without the streaming
+ * estimators: a cold boot stores the biases and self-test trims of its
+ * startup calibration, and a boot that finds a valid record skips the
+ * stabilization wait, the self-test and the bias calibration and records
+ * from its first sample. The stored biases may have drifted since, so one
+ * recalibration runs in the background: once the stillness detector
+ * reports rest, CAL_RECAL_SAMPLES still samples are averaged into a new
+ * gyro bias, and into a new accel bias if the device rests flat, which
+ * replace the stored ones on the card.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <stdint.h>
+#include "config.h"
+
+// ============================================================================
+// CALIBRATION RECORD
+// ============================================================================
+
+#define CALIBRATION_MAGIC 0x4C414349UL     // "ICAL" little-endian
+#define CALIBRATION_VERSION 2
+
+// FILE_CALIBRATION is read at boot and rewritten when the calibration changes
+#define CALIBRATION_STORE_ENABLED (CALIBRATION_ENGINE_ENABLED || FAST_BOOT_ENABLED)
+
+/**
+ * @brief Calibration as stored in FILE_CALIBRATION
+ *
+ * Little-endian, IEEE-754 floats; crc is CRC-16/CCITT over every byte
+ * before it.
+ */
+struct CalibrationRecord
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t size;                  ///< sizeof(CalibrationRecord)
+    float magOffset[3];             ///< Hard iron (mG)
+    float magMatrix[3][3];          ///< Soft-iron correction, applied after the offset
+    float gyroBias[3];              ///< Total gyro bias (deg/s), none removed in hardware
+    float accelBias[3];             ///< Accel bias (g), gravity on Z removed
+    float selfTest[6];              ///< Accel then gyro self-test trims (% of factory value)
+    uint32_t magSamples;            ///< Accepted samples behind the mag solution
+    uint16_t magModel;              ///< MagFitModel of the mag solution
+    uint16_t crc;
+};
+
+/**
+ * @brief Correction applied to every magnetometer reading
+ *
+ * corrected = matrix * (reading - offset)
+ */
+struct MagCorrection
+{
+    float offset[3];
+    float matrix[3][3];
+};
+
+// ============================================================================
+// MAGNETOMETER FIT
+// ============================================================================
+
+/**
+ * @brief Model behind an adopted magnetometer correction
+ */
+enum MagFitModel
+{
+    MAG_FIT_NONE = 0,           ///< Compile-time MAG_BIAS_X/Y/Z, identity matrix
+    MAG_FIT_SPHERE = 1,         ///< Hard iron only
+    MAG_FIT_ELLIPSOID = 2       ///< Hard and soft iron
+};
+
+/**
+ * @brief Quality figures of a solved fit
+ */
+struct MagFitQuality
+{
+    MagFitModel model;
+    float axisRatio;            ///< Longest over shortest ellipsoid axis
+    float residual;             ///< RMS relative radius error
+    float fieldMg;              ///< Corrected field strength
+};
+
+/**
+ * @brief Recursive least-squares ellipsoid and sphere fits
+ *
+ * Readings are taken relative to a reference point inside the ellipsoid
+ * (the current hard-iron estimate) and scaled by CAL_MAG_SCALE_MG, which
+ * keeps both problems well conditioned. The ellipsoid x'Mx + 2g'x = 1 has
+ * nine parameters and needs readings from all around it; the sphere
+ * |x|^2 = 2c'x + d has four and is already determined by the partial
+ * coverage of a device turned mostly about one axis. Each update costs a
+ * fixed 9x9 plus 4x4 covariance step; nothing grows with the number of
+ * samples.
+ */
+class MagEllipsoidFit
+{
+public:
+    MagEllipsoidFit(void);
+
+    /**
+     * @brief Start over around @p referenceMg with a sphere prior
+     */
+    void begin(const float* referenceMg);
+
+    /**
+     * @brief Feed one reading (mG, factory sensitivity applied)
+     *
+     * @return false if the reading was too close to the last accepted one
+     */
+    bool addSample(const float* fieldMg);
+
+    /**
+     * @brief Turn the current parameters into a correction
+     *
+     * Uses the ellipsoid once its parameters are determined
+     * (CAL_MAG_MAX_COVARIANCE), otherwise the sphere.
+     *
+     * @param correction Filled on success
+     * @param quality Filled for the model tried last
+     * @return false if neither model passes the quality gates
+     */
+    bool solve(MagCorrection& correction, MagFitQuality& quality) const;
+
+    uint32_t acceptedSamples(void) const { return accepted; }
+
+private:
+    bool solveEllipsoid(MagCorrection& correction, MagFitQuality& quality) const;
+    bool solveSphere(MagCorrection& correction, MagFitQuality& quality) const;
+    bool passesGates(const MagFitQuality& quality) const;
+
+    double theta[9];
+    double covariance[9][9];
+    double residualSquared;
+    double sphereTheta[4];
+    double sphereCovariance[4][4];
+    double sphereResidualSquared;
+    float reference[3];
+    float lastAccepted[3];
+    uint32_t accepted;
+};
+
+// ============================================================================
+// STILLNESS DETECTOR
+// ============================================================================
+
+/**
+ * @brief Rest detection from the gyro spread and the accel magnitude
+ *
+ * Still once CAL_STILL_MIN_SAMPLES consecutive samples have every
+ * bias-corrected gyro axis within CAL_STILL_GYRO_DPS of its running mean
+ * and under CAL_STILL_RATE_DPS, and |accel| within CAL_STILL_ACCEL_G of 1 g.
+ */
+class StillnessDetector
+{
+public:
+    StillnessDetector(void);
+
+    void reset(void);
+
+    /**
+     * @return true while the device is at rest
+     */
+    bool update(const float* accelG, const float* gyroDps);
+
+    bool still(void) const { return stillSamples >= CAL_STILL_MIN_SAMPLES; }
+
+private:
+    float mean[3];
+    uint32_t stillSamples;
+    bool primed;
+};
+
+// ============================================================================
+// CALIBRATION FUNCTIONS
+// ============================================================================
+
+/**
+ * @brief Load FILE_CALIBRATION and prime the estimators
+ *
+ * A complete FILE_CALIBRATION_TEMP, left by a reset between the steps of
+ * a save, is newer and is used instead.
+ *
+ * Without a valid record the correction starts from MAG_BIAS_X/Y/Z, an
+ * identity soft-iron matrix and zero software gyro bias.
+ *
+ * @return true if a stored calibration was restored
+ */
+bool beginCalibration(void);
+
+/**
+ * @brief True if beginCalibration() restored a stored calibration
+ */
+bool calibrationRestored(void);
+
+/**
+ * @brief Record the results of the startup self-test and calibrateMPU9250()
+ *
+ * Persisted gyro bias is @p gyroBiasDps, which the driver removed in
+ * hardware, plus the software bias, so a restored boot can skip the
+ * hardware calibration. With FAST_BOOT_ENABLED the record is stored right
+ * away.
+ *
+ * @param gyroBiasDps Gyro bias removed in hardware (deg/s)
+ * @param accelBiasG Accel bias (g)
+ * @param selfTest Six self-test trims
+ */
+void setStartupCalibration(const float* gyroBiasDps, const float* accelBiasG, const float* selfTest);
+
+/**
+ * @brief Feed one accel/gyro sample (gyro after software bias removal)
+ *
+ * Tracks the gyro bias while still (CALIBRATION_ENGINE_ENABLED) and runs
+ * the background recalibration after a fast boot.
+ *
+ * @return true if the software gyro bias changed
+ */
+bool calibrationObserveMotion(const float* accelG, const float* gyroDps);
+
+/**
+ * @brief Feed one magnetometer reading (mG, AK8963 axes, before offset and matrix)
+ *
+ * @return true if a new correction was adopted
+ */
+bool calibrationObserveMag(const float* fieldMg);
+
+/**
+ * @brief Correction currently applied to magnetometer readings
+ */
+const MagCorrection& magCorrection(void);
+
+/**
+ * @brief Software gyro bias (deg/s) subtracted from every sample
+ */
+const float* gyroBiasCorrection(void);
+
+/**
+ * @brief Accel bias (g) from the startup calibration, the record or the recalibration
+ */
+const float* accelBiasEstimate(void);
+
+/**
+ * @brief Self-test trims measured at startup or restored from the record
+ */
+const float* selfTestTrims(void);
+
+/**
+ * @brief True until the recalibration after a fast boot has completed
+ */
+bool recalibrationPending(void);
+
+/**
+ * @brief Persist the latest adopted calibration (logging context)
+ *
+ * Writes at most once per CAL_SAVE_INTERVAL_MS, through a temporary file,
+ * so a reset at any point leaves one complete record for the next boot.
+ */
+void serviceCalibrationStore(uint32_t nowMs);
+
+#endif // CALIBRATION_H
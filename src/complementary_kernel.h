@@ -0,0 +1,129 @@
+/**
+ * @file complementary_kernel.h
+ * @brief Complementary engine for the fusion kernel
+ *
+ * First-order complementary filter in quaternion form: the gyro is
+ * integrated as in Mahony, and the estimate is pulled towards the
+ * accelerometer tilt and the magnetometer heading with time constant tau.
+ * The heading error is taken about the estimated vertical only, so the
+ * magnetometer never disturbs roll and pitch and the rotated-reference
+ * terms Mahony computes (bz, wx, wy, wz) and its integral term are not
+ * needed. The cheapest engine per sample, for low-power units.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef COMPLEMENTARY_KERNEL_H
+#define COMPLEMENTARY_KERNEL_H
+
+#include "fusion_kernel.h"
+
+// ============================================================================
+// COMPLEMENTARY KERNEL
+// ============================================================================
+
+/**
+ * @brief Complementary filter: gyro integration plus proportional tilt/heading pull
+ */
+template <typename T>
+class ComplementaryKernel : public FusionKernel<ComplementaryKernel<T>, T>
+{
+    friend class FusionKernel<ComplementaryKernel<T>, T>;
+
+public:
+    /**
+     * @param tau Correction time constant in seconds (> 0)
+     */
+    ComplementaryKernel(float tau = COMPLEMENTARY_TAU_S)
+    {
+        setTimeConstant(tau);
+        reset();
+    }
+
+    /**
+     * @brief Return to the identity quaternion
+     */
+    void reset(void)
+    {
+        this->resetQuaternion();
+    }
+
+    void setTimeConstant(float tau)
+    {
+        gain = T(1.0f / tau);
+    }
+
+private:
+    using FusionKernel<ComplementaryKernel<T>, T>::q0;
+    using FusionKernel<ComplementaryKernel<T>, T>::q1;
+    using FusionKernel<ComplementaryKernel<T>, T>::q2;
+    using FusionKernel<ComplementaryKernel<T>, T>::q3;
+
+    /**
+     * @brief One filter step on normalised accel and mag vectors
+     */
+    void integrate(T ax, T ay, T az, T gx, T gy, T gz, T mx, T my, T mz, T deltat)
+    {
+        const T two(2.0f);
+        const T half(0.5f);
+        T qa = q0, qb = q1, qc = q2, qd = q3;
+
+        // Auxiliary variables to avoid repeated arithmetic
+        T qaqa = qa * qa;
+        T qaqb = qa * qb;
+        T qaqc = qa * qc;
+        T qaqd = qa * qd;
+        T qbqb = qb * qb;
+        T qbqc = qb * qc;
+        T qbqd = qb * qd;
+        T qcqc = qc * qc;
+        T qcqd = qc * qd;
+        T qdqd = qd * qd;
+
+        // Estimated vertical in the body frame; tilt error against gravity
+        T vx = two * (qbqd - qaqc);
+        T vy = two * (qaqb + qcqd);
+        T vz = qaqa - qbqb - qcqc + qdqd;
+        T ex = ay * vz - az * vy;
+        T ey = az * vx - ax * vz;
+        T ez = ax * vy - ay * vx;
+
+        // Horizontal magnetic field in the earth frame; north is +x, so the
+        // normalised hy is the sine of the heading error about the vertical
+        T hx = two * mx * (half - qcqc - qdqd) + two * my * (qbqc - qaqd) + two * mz * (qbqd + qaqc);
+        T hy = two * mx * (qbqc + qaqd) + two * my * (half - qbqb - qdqd) + two * mz * (qcqd - qaqb);
+        T hz(0.0f);
+        if (fusionNormalize3(hx, hy, hz))
+        {
+            ex = ex - hy * vx;
+            ey = ey - hy * vy;
+            ez = ez - hy * vz;
+        }
+
+        // Pull towards the measured attitude at rate 1 / tau
+        gx = gx + gain * ex;
+        gy = gy + gain * ey;
+        gz = gz + gain * ez;
+
+        // Integrate rate of change of quaternion
+        T pa = qb;
+        T pb = qc;
+        T pc = qd;
+        qa = qa + (-qb * gx - qc * gy - qd * gz) * (half * deltat);
+        qb = pa + (qa * gx + pb * gz - pc * gy) * (half * deltat);
+        qc = pb + (qa * gy - pa * gz + pc * gx) * (half * deltat);
+        qd = pc + (qa * gz + pa * gy - pb * gx) * (half * deltat);
+
+        fusionNormalize4(qa, qb, qc, qd);
+        q0 = qa;
+        q1 = qb;
+        q2 = qc;
+        q3 = qd;
+    }
+
+    T gain;
+};
+
+#endif // COMPLEMENTARY_KERNEL_H
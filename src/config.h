@@ -21,6 +21,54 @@
 #define AHRS_MODE_ENABLED true
 #define SERIAL_DEBUG_ENABLED true
 
+// Replace the text serial output with framed binary telemetry (telemetry_protocol.h)
+#define SERIAL_TELEMETRY_ENABLED false
+
+// Log one binary frame per sample to FILE_BINARY_LOG instead of the CSV files
+#define LOG_FORMAT_BINARY false
+
+// With LOG_FORMAT_BINARY, write delta/varint-packed blocks of raw counts to FILE_PACKED_LOG instead
+#define LOG_FORMAT_COMPRESSED false
+
+// Run sampling/fusion and logging as separate tasks on the two ESP32 cores
+#define PIPELINE_MODE_ENABLED false
+
+// Acquire accel/gyro through the MPU9250 hardware FIFO in burst reads
+#define IMU_FIFO_MODE_ENABLED false
+
+// Mirror the AK8963 through the MPU9250 auxiliary I2C master and read all nine axes in one burst
+#define IMU_AUX_BURST_ENABLED false
+
+// Print a hot-path benchmark report (JSON) at the end of setup()
+#define BENCHMARK_MODE_ENABLED false
+
+// Stage timing histograms and drop counters in the diagnostics log
+#define INSTRUMENTATION_ENABLED false
+
+// Fuse at a fixed step per data-ready sample and log each CSV stream at its own rate
+#define STREAM_SCHEDULER_ENABLED false
+
+// Drive fusion from the MPU9250 data-ready interrupt instead of polling INT_STATUS
+#define DATA_READY_IRQ_ENABLED false
+
+// Estimate mag hard/soft iron and gyro bias online and persist them to FILE_CALIBRATION
+#define CALIBRATION_ENGINE_ENABLED false
+
+// Boot from FILE_CALIBRATION without the stabilization wait, self-test and bias calibration
+#define FAST_BOOT_ENABLED false
+
+// Keep a pre-trigger ring of raw samples and write motion events to their own files
+#define EVENT_CAPTURE_ENABLED false
+
+// Log windowed features (mean, RMS, peak, band energies) to FILE_FEATURES instead of the CSV streams
+#define FEATURE_EXTRACTION_ENABLED false
+
+// Switch ODR, filters, fusion and logging rates between idle, normal and high-dynamics profiles
+#define RATE_GOVERNOR_ENABLED false
+
+// Show status, orientation, rates and counters on the LCD instead of the full-screen status colours
+#define DASHBOARD_ENABLED false
+
 // ============================================================================
 // TIMING CONSTANTS (milliseconds)
 // ============================================================================
@@ -29,18 +77,254 @@
 #define AHRS_UPDATE_INTERVAL_MS 100
 #define BASIC_UPDATE_INTERVAL_MS 500
 
+// ============================================================================
+// IMU ACQUISITION CONFIGURATION
+// ============================================================================
+
+// Output data rate set by initMPU9250() (1 kHz / (1 + SMPLRT_DIV 4))
+#define IMU_SAMPLE_RATE_HZ 200
+
+// Bytes per FIFO frame (accel XYZ + gyro XYZ, 16-bit big-endian)
+#define IMU_FIFO_FRAME_SIZE 12
+
+// MPU9250 FIFO capacity in bytes
+#define IMU_FIFO_CAPACITY 512
+
+// Frames per burst; IMU_FIFO_FRAME_SIZE * this must fit the 128-byte Wire buffer
+#define IMU_FIFO_MAX_BURST_FRAMES 10
+
+// ============================================================================
+// DATA-READY INTERRUPT CONFIGURATION
+// ============================================================================
+
+// GPIO wired to the MPU9250 INT line
+#define IMU_INT_PIN 35
+
+// Edge timestamps queued between the ISR and the fusion loop (power of two)
+#define DATA_READY_QUEUE_SIZE 64
+
+// Edges taken from the queue per nextBatch() call; a pass repeats until it is empty
+#define DATA_READY_MAX_BATCH 16
+
+// ============================================================================
+// OUTPUT STREAM RATES (Hz, used when STREAM_SCHEDULER_ENABLED)
+// ============================================================================
+
+// Raw streams are boxcar-averaged down to their rate; quaternion and YPR
+// streams are decimated (latest filter output). IMU_SAMPLE_RATE_HZ = full ODR.
+#define STREAM_RATE_ACCEL_HZ 200
+#define STREAM_RATE_GYRO_HZ 200
+#define STREAM_RATE_MAG_HZ 50
+#define STREAM_RATE_QUATERNION_HZ 50
+#define STREAM_RATE_YPR_HZ 10
+
+// ============================================================================
+// SERIAL TELEMETRY (used when SERIAL_TELEMETRY_ENABLED)
+// ============================================================================
+
+// Frames per second per channel (0 = channel off). Latest sample, not
+// averaged. The defaults take about 6.4 kB/s, 55% of a 115200 baud link.
+#define TELEMETRY_RATE_ACCEL_HZ 100
+#define TELEMETRY_RATE_GYRO_HZ 100
+#define TELEMETRY_RATE_MAG_HZ 20
+#define TELEMETRY_RATE_QUATERNION_HZ 50
+#define TELEMETRY_RATE_YPR_HZ 10
+
+// Staged frame bytes awaiting the UART (power of two); full = frames dropped
+#define TELEMETRY_TX_BUFFER_SIZE 1024
+
+// ============================================================================
+// EVENT CAPTURE (used when EVENT_CAPTURE_ENABLED)
+// ============================================================================
+
+// Window written per event, before and after the triggering sample (milliseconds)
+#define EVENT_PRE_TRIGGER_MS 4000
+#define EVENT_POST_TRIGGER_MS 2000
+
+// Triggers, checked on every sample at IMU_SAMPLE_RATE_HZ (0 = off). Keep
+// them inside the +/-2 g and +/-250 deg/s ranges set by initMPU9250().
+#define EVENT_TRIGGER_ACCEL_G 1.8f          // Acceleration magnitude
+#define EVENT_TRIGGER_GYRO_DPS 200.0f       // Angular rate magnitude
+#define EVENT_TRIGGER_JERK_G_PER_S 150.0f   // Change of acceleration between samples
+
+// Samples that may arrive between a window completing and its write-out
+// (one FIFO or data-ready batch); more than that are dropped and counted
+#define EVENT_RING_SLACK_SAMPLES 32
+
+// Place the ring in PSRAM on boards that have it and allow .bss there
+#define EVENT_RING_IN_PSRAM false
+
+// ============================================================================
+// FEATURE EXTRACTION (used when FEATURE_EXTRACTION_ENABLED)
+// ============================================================================
+
+// Samples per window and FFT length at IMU_SAMPLE_RATE_HZ (power of two,
+// 256 = 1.28 s). Windows follow each other without overlap.
+#define FEATURE_WINDOW_SAMPLES 256
+
+// Equal-width bands from the first bin above DC up to Nyquist (8 = 12.5 Hz each)
+#define FEATURE_BAND_COUNT 8
+
+// ============================================================================
+// RATE GOVERNOR (used when RATE_GOVERNOR_ENABLED)
+// ============================================================================
+
+// Per profile: SMPLRT_DIV (ODR = 1 kHz / (1 + div)), DLPF setting of the
+// gyro (CONFIG) and accel (ACCEL_CONFIG2), AHRS-mode log interval and the
+// pause per loop pass (milliseconds). NORMAL is what initMPU9250() sets.
+#define GOV_IDLE_SMPLRT_DIV 39              // 25 Hz
+#define GOV_IDLE_DLPF 5                     // 10 Hz bandwidth
+#define GOV_IDLE_LOG_INTERVAL_MS 1000
+#define GOV_IDLE_LOOP_SLEEP_MS 10
+
+#define GOV_NORMAL_SMPLRT_DIV 4             // 200 Hz
+#define GOV_NORMAL_DLPF 3                   // 41 Hz bandwidth
+#define GOV_NORMAL_LOG_INTERVAL_MS AHRS_UPDATE_INTERVAL_MS
+#define GOV_NORMAL_LOOP_SLEEP_MS 0
+
+#define GOV_HIGH_SMPLRT_DIV 1               // 500 Hz
+#define GOV_HIGH_DLPF 2                     // 92 Hz bandwidth
+#define GOV_HIGH_LOG_INTERVAL_MS 50
+#define GOV_HIGH_LOOP_SLEEP_MS 0
+
+// Time constants of the activity levels and of the accel magnitude baseline
+// the accel level is measured against (milliseconds)
+#define GOV_SMOOTHING_MS 250.0f
+#define GOV_ACCEL_BASELINE_MS 2000.0f
+
+// Activity levels (gyro deg/s, accel g off its baseline). Wake and high
+// switch up as soon as either level exceeds them; rest and calm switch
+// down once both have stayed below them for the hold time (milliseconds).
+#define GOV_WAKE_DPS 5.0f
+#define GOV_WAKE_G 0.05f
+#define GOV_REST_DPS 2.0f
+#define GOV_REST_G 0.02f
+#define GOV_REST_HOLD_MS 5000
+
+#define GOV_HIGH_DPS 60.0f
+#define GOV_HIGH_G 0.5f
+#define GOV_CALM_DPS 40.0f
+#define GOV_CALM_G 0.25f
+#define GOV_CALM_HOLD_MS 2000
+
+// ============================================================================
+// PIPELINE CONFIGURATION
+// ============================================================================
+
+// Samples buffered between the sampling and logging tasks (power of two)
+#define PIPELINE_RING_SIZE 256
+
+#define SAMPLING_TASK_CORE 1
+#define SAMPLING_TASK_PRIORITY 5
+#define LOGGING_TASK_CORE 0
+#define LOGGING_TASK_PRIORITY 1
+#define PIPELINE_TASK_STACK_SIZE 8192
+
+// Logging task wake-up period (milliseconds)
+#define PIPELINE_DRAIN_INTERVAL_MS 10
+
+// ============================================================================
+// AHRS FILTER CONFIGURATION
+// ============================================================================
+
+// Fusion engines selectable with FUSION_ENGINE
+#define FUSION_ENGINE_MAHONY 0
+#define FUSION_ENGINE_MADGWICK 1
+#define FUSION_ENGINE_COMPLEMENTARY 2
+
+// Filter run on every sample (fusion_engine.h)
+#define FUSION_ENGINE FUSION_ENGINE_MAHONY
+
+// Mahony filter gains (M5Stack library defaults: Kp = 2 * 5, Ki = 0)
+#define MAHONY_KP 10.0f
+#define MAHONY_KI 0.0f
+
+// Madgwick gradient step (M5Stack library default: sqrt(3/4) * 40 deg/s)
+#define MADGWICK_BETA 0.604600f
+
+// Complementary filter correction time constant (seconds)
+#define COMPLEMENTARY_TAU_S 0.5f
+
+// Run the fusion kernel in Q-format fixed point (targets without an FPU)
+#define FUSION_FIXED_POINT_ENABLED false
+
+// Fraction bits of the fixed-point format; Q7.24 covers +/-128, enough for
+// 2000 deg/s gyro rates plus the Kp feedback term
+#define FUSION_FIXED_FRAC_BITS 24
+
+// Polynomial atan2/asin (fast_trig.h) in the Euler conversion
+#define FUSION_FAST_TRIG_ENABLED false
+
+// Samples per FusionBatch in the benchmark
+#define FUSION_BATCH_SIZE 32
+
+// ============================================================================
+// BENCHMARK CONFIGURATION
+// ============================================================================
+
+// Iterations per CPU-bound stage
+#define BENCHMARK_ITERATIONS 2000
+
+// SD stages run BENCHMARK_ITERATIONS / this many iterations
+#define BENCHMARK_FILE_DIVISOR 20
+
+// ============================================================================
+// INSTRUMENTATION CONFIGURATION
+// ============================================================================
+
+// Interval between #perf summaries in the diagnostics log (milliseconds)
+#define INSTRUMENTATION_DUMP_INTERVAL_MS 1000
+
 // ============================================================================
 // DISPLAY CONFIGURATION
 // ============================================================================
 
 #define SCREEN_BRIGHTNESS 200
 
+// Dashboard frame period; a frame starts only once the previous one is out
+#define DASHBOARD_FRAME_INTERVAL_MS 200
+
+// Pixels pushed per loop pass, at least one 320-pixel row (about 0.5 ms at 40 MHz SPI)
+#define DASHBOARD_PIXEL_BUDGET 1280
+
+// SD free space query period (milliseconds)
+#define DASHBOARD_FREE_SPACE_INTERVAL_MS 60000
+
 // ============================================================================
 // BUFFER SIZES
 // ============================================================================
 
 #define MSG_BUFFER_SIZE 100
 
+// ============================================================================
+// SD LOGGER CONFIGURATION
+// ============================================================================
+
+// RAM staging block per log stream; one SD sector so every write is whole
+#define LOG_BLOCK_SIZE 512
+
+// Maximum age of staged data before it is written out (milliseconds)
+#define LOG_FLUSH_INTERVAL_MS 1000
+
+// Interval between FAT directory entry commits (milliseconds)
+#define LOG_SYNC_INTERVAL_MS 5000
+
+// Samples per compressed log block (at most PACKED_MAX_BLOCK_SAMPLES); a block
+// also ends once it spans LOG_FLUSH_INTERVAL_MS, bounding what a power cut loses
+#define LOG_PACKED_BLOCK_SAMPLES 200
+
+// Segment size at which all log streams move on to the next segment directory
+#define LOG_SEGMENT_MAX_BYTES (16UL * 1024UL * 1024UL)
+
+// Read size of the boot-time recovery scan; also the longest text line it accepts
+#define LOG_RECOVERY_CHUNK_SIZE 512
+
+// Forward window of the recovery scan (at least PACKED_MAX_BLOCK_SIZE)
+#define LOG_RECOVERY_WINDOW_SIZE 4096
+
+// Room for a segment directory plus file name
+#define LOG_PATH_SIZE 48
+
 // ============================================================================
 // MAGNETOMETER CALIBRATION
 // ============================================================================
@@ -51,6 +335,62 @@
 #define MAG_BIAS_Y 120.0f
 #define MAG_BIAS_Z 125.0f
 
+// ============================================================================
+// STREAMING CALIBRATION (used when CALIBRATION_ENGINE_ENABLED or FAST_BOOT_ENABLED)
+// ============================================================================
+
+// Readings are fitted relative to the current offset and divided by this,
+// so the ellipsoid has roughly unit radius (milliGauss)
+#define CAL_MAG_SCALE_MG 500.0f
+
+// RLS forgetting factor per accepted reading (memory ~1 / (1 - this) readings)
+#define CAL_MAG_FORGETTING 0.999
+
+// Initial parameter covariance of the sphere prior
+#define CAL_MAG_PRIOR_COVARIANCE 10.0
+
+// A reading is fitted only this far from the last accepted one (milliGauss)
+#define CAL_MAG_MIN_SPACING_MG 20.0f
+
+// Smoothing of the fit residual used by the quality gate
+#define CAL_MAG_RESIDUAL_ALPHA (1.0 / 64.0)
+
+// Accepted readings before a fit may be adopted, and between solves
+#define CAL_MAG_MIN_SAMPLES 300
+#define CAL_MAG_SOLVE_INTERVAL 25
+
+// Largest parameter variance at which the ellipsoid (hard + soft iron) and
+// the sphere (hard iron only) count as determined by the readings so far
+#define CAL_MAG_MAX_COVARIANCE 0.1
+#define CAL_MAG_SPHERE_MAX_COVARIANCE 0.02
+
+// Quality gates: longest/shortest axis, RMS relative radius error, field strength
+#define CAL_MAG_MAX_AXIS_RATIO 1.5f
+#define CAL_MAG_MAX_RESIDUAL 0.05f
+#define CAL_MAG_MIN_FIELD_MG 150.0f
+#define CAL_MAG_MAX_FIELD_MG 1000.0f
+
+// Stillness: gyro spread around its running mean (deg/s), bias-corrected
+// rate (deg/s), accel magnitude error (g), and consecutive samples required
+#define CAL_STILL_GYRO_DPS 0.5f
+#define CAL_STILL_RATE_DPS 3.0f
+#define CAL_STILL_ACCEL_G 0.05f
+#define CAL_STILL_MIN_SAMPLES 200
+#define CAL_STILL_MEAN_ALPHA 0.0625f
+
+// Gyro bias tracking gain per still sample (time constant 1 / (this * ODR))
+#define CAL_GYRO_BIAS_ALPHA 0.002f
+
+// Still samples averaged by the one-shot recalibration after a fast boot
+#define CAL_RECAL_SAMPLES 512
+
+// Largest offset of the recalibration's accel average from (0, 0, +-1 g) for
+// it to replace the accel bias (g); resting in another orientation only renews the gyro bias
+#define CAL_RECAL_LEVEL_G 0.1f
+
+// Minimum interval between writes of FILE_CALIBRATION (milliseconds)
+#define CAL_SAVE_INTERVAL_MS 60000
+
 // ============================================================================
 // TEMPERATURE CONVERSION
 // ============================================================================
@@ -84,5 +424,18 @@
 #define FILE_QUATERNION "/quaternion.txt"
 #define FILE_YPR "/ypr.txt"
 #define FILE_DIAGNOSTICS "/diagnostics.txt"
+#define FILE_BINARY_LOG "/imu.bin"
+#define FILE_PACKED_LOG "/imu.pak"
+#define FILE_PACKED_INDEX "/imu.idx"
+#define FILE_CALIBRATION "/calibration.bin"
+#define FILE_CALIBRATION_TEMP "/calibration.tmp"
+#define FILE_SESSION_COUNTER "/session.txt"
+#define FILE_EVENT_FORMAT "/event%03u.pak"
+#define FILE_FEATURES "/features.txt"
+
+// Per-boot session directory and the segment directories inside it;
+// the data files above are created inside the current segment
+#define LOG_SESSION_DIR_FORMAT "/s%04u"
+#define LOG_SEGMENT_DIR_FORMAT "/s%04u/%03u"
 
 #endif // CONFIG_H
@@ -0,0 +1,423 @@
+/**
+ * @file dashboard.cpp
+ * @brief Live status and orientation dashboard on the LCD
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "dashboard.h"
+#include "sd_logger.h"
+#include "imu_sensor.h"
+#include "data_ready.h"
+#include "pipeline.h"
+#include <stdio.h>
+#include <string.h>
+
+// ============================================================================
+// LAYOUT
+// ============================================================================
+
+// Status bar, then eight rows of 26 cells at scale 2
+#define STATUS_BAR_HEIGHT 40
+#define ROW_HEIGHT 25
+#define ROW_Y(n) (STATUS_BAR_HEIGHT + (n) * ROW_HEIGHT)
+
+static const DashboardField layout[DASHBOARD_FIELD_COUNT] = {
+    {0, 0, HAL_LCD_WIDTH, STATUS_BAR_HEIGHT, 3, 17, 7, 8},
+    {0, ROW_Y(0), HAL_LCD_WIDTH, ROW_HEIGHT, 2, 26, 4, 5},
+    {0, ROW_Y(1), HAL_LCD_WIDTH, ROW_HEIGHT, 2, 26, 4, 5},
+    {0, ROW_Y(2), HAL_LCD_WIDTH, ROW_HEIGHT, 2, 26, 4, 5},
+    {0, ROW_Y(3), HAL_LCD_WIDTH, ROW_HEIGHT, 2, 26, 4, 5},
+    {0, ROW_Y(4), HAL_LCD_WIDTH, ROW_HEIGHT, 2, 26, 4, 5},
+    {0, ROW_Y(5), HAL_LCD_WIDTH, ROW_HEIGHT, 2, 26, 4, 5},
+    {0, ROW_Y(6), HAL_LCD_WIDTH, ROW_HEIGHT, 2, 26, 4, 5},
+    {0, ROW_Y(7), HAL_LCD_WIDTH, ROW_HEIGHT, 2, 26, 4, 5},
+};
+
+static_assert(ROW_Y(8) == HAL_LCD_HEIGHT, "dashboard rows must fill the screen");
+
+// ============================================================================
+// FONT
+// ============================================================================
+
+#define FONT_FIRST_CHAR 0x20
+#define FONT_LAST_CHAR 0x7E
+#define FONT_GLYPH_WIDTH 5
+
+// Classic 5x7 font, ASCII 0x20..0x7E: five columns per glyph, bit 0 at the top
+static const uint8_t FONT_5X7[][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},
+    {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+    {0x36, 0x49, 0x56, 0x20, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},
+    {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x14, 0x08, 0x3E, 0x08, 0x14}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+    {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00},
+    {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+    {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31}, {0x18, 0x14, 0x12, 0x7F, 0x10},
+    {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03},
+    {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x36, 0x36, 0x00, 0x00},
+    {0x00, 0x56, 0x36, 0x00, 0x00}, {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14},
+    {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06}, {0x32, 0x49, 0x79, 0x41, 0x3E},
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+    {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x01, 0x01},
+    {0x3E, 0x41, 0x41, 0x51, 0x32}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+    {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},
+    {0x7F, 0x02, 0x04, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},
+    {0x46, 0x49, 0x49, 0x49, 0x31}, {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+    {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x7F, 0x20, 0x18, 0x20, 0x7F}, {0x63, 0x14, 0x08, 0x14, 0x63},
+    {0x03, 0x04, 0x78, 0x04, 0x03}, {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x00},
+    {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x7F, 0x00}, {0x04, 0x02, 0x01, 0x02, 0x04},
+    {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78},
+    {0x7F, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20}, {0x38, 0x44, 0x44, 0x48, 0x7F},
+    {0x38, 0x54, 0x54, 0x54, 0x18}, {0x08, 0x7E, 0x09, 0x01, 0x02}, {0x0C, 0x52, 0x52, 0x52, 0x3E},
+    {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x44, 0x3D, 0x00},
+    {0x00, 0x7F, 0x10, 0x28, 0x44}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x18, 0x04, 0x78},
+    {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0x7C, 0x14, 0x14, 0x14, 0x08},
+    {0x08, 0x14, 0x14, 0x18, 0x7C}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20},
+    {0x04, 0x3F, 0x44, 0x40, 0x20}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C},
+    {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x0C, 0x50, 0x50, 0x50, 0x3C},
+    {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x7F, 0x00, 0x00},
+    {0x00, 0x41, 0x36, 0x08, 0x00}, {0x10, 0x08, 0x08, 0x10, 0x08},
+};
+
+static_assert(sizeof(FONT_5X7) / sizeof(FONT_5X7[0]) == FONT_LAST_CHAR - FONT_FIRST_CHAR + 1,
+              "one glyph per printable character");
+
+// ============================================================================
+// FORMATTING AND RASTERIZATION
+// ============================================================================
+
+const DashboardField& dashboardField(uint8_t index)
+{
+    return layout[index];
+}
+
+/**
+ * @brief Pad @p text with spaces to @p field's width
+ */
+static void padText(DashboardText& text, const DashboardField& field)
+{
+    size_t length = strlen(text.text);
+    length = (length < field.chars) ? length : field.chars;
+    memset(text.text + length, ' ', field.chars - length);
+    text.text[field.chars] = '\0';
+}
+
+static void formatRow(DashboardText& out, uint8_t index, const char* label, float value, const char* unit)
+{
+    snprintf(out.text, DASHBOARD_MAX_CHARS + 1, "%-10s%8.1f %s", label, value, unit);
+    out.foreground = HAL_COLOR_WHITE;
+    out.background = HAL_COLOR_BLACK;
+    padText(out, layout[index]);
+}
+
+static void formatCount(DashboardText& out, uint8_t index, const char* label, uint32_t value,
+                        const char* unit, bool warn)
+{
+    snprintf(out.text, DASHBOARD_MAX_CHARS + 1, "%-10s%8lu %s", label, (unsigned long)value, unit);
+    out.foreground = (warn && value > 0) ? HAL_COLOR_YELLOW : HAL_COLOR_WHITE;
+    out.background = HAL_COLOR_BLACK;
+    padText(out, layout[index]);
+}
+
+void formatDashboard(const DashboardValues& values, DashboardText* out)
+{
+    static const char* const names[] = {"WAITING", "RECORDING", "ERROR"};
+    static const uint16_t colors[] = {HAL_COLOR_BLUE, HAL_COLOR_GREEN, HAL_COLOR_RED};
+
+    snprintf(out[0].text, DASHBOARD_MAX_CHARS + 1, "%s", names[values.status]);
+    out[0].foreground = HAL_COLOR_WHITE;
+    out[0].background = colors[values.status];
+    padText(out[0], layout[0]);
+
+    formatRow(out[1], 1, "YAW", values.yaw, "deg");
+    formatRow(out[2], 2, "PITCH", values.pitch, "deg");
+    formatRow(out[3], 3, "ROLL", values.roll, "deg");
+    formatRow(out[4], 4, "RATE", values.rateHz, "Hz");
+    formatCount(out[5], 5, "BUFFER", values.bufferPercent, "%", false);
+    formatCount(out[6], 6, "SD FREE", values.freeMegabytes, "MB", false);
+    formatCount(out[7], 7, "SD ERRORS", values.storageErrors, "", true);
+    formatCount(out[8], 8, "DROPPED", values.droppedSamples, "", true);
+}
+
+/**
+ * @brief Colour of pixel (@p px, @p py) of @p field, relative to its corner
+ */
+static uint16_t fieldPixel(const DashboardField& field, const DashboardText& text, int16_t px, int16_t py)
+{
+    int16_t cellWidth = DASHBOARD_CELL_WIDTH * field.scale;
+    int16_t tx = px - field.padX;
+    int16_t ty = py - field.padY;
+    if (tx < 0 || ty < 0 || ty >= DASHBOARD_CELL_HEIGHT * field.scale || tx >= field.chars * cellWidth)
+    {
+        return text.background;
+    }
+
+    int16_t column = (tx % cellWidth) / field.scale;
+    char c = text.text[tx / cellWidth];
+    if (column >= FONT_GLYPH_WIDTH || c < FONT_FIRST_CHAR || c > FONT_LAST_CHAR)
+    {
+        return text.background;
+    }
+
+    uint8_t bits = FONT_5X7[c - FONT_FIRST_CHAR][column];
+    return ((bits >> (ty / field.scale)) & 0x01) ? text.foreground : text.background;
+}
+
+uint16_t dashboardPixel(const DashboardText* texts, int16_t x, int16_t y)
+{
+    for (uint8_t i = 0; i < DASHBOARD_FIELD_COUNT; i++)
+    {
+        const DashboardField& field = layout[i];
+        if (x >= field.x && x < field.x + field.width && y >= field.y && y < field.y + field.height)
+        {
+            return fieldPixel(field, texts[i], x - field.x, y - field.y);
+        }
+    }
+    return HAL_COLOR_BLACK;
+}
+
+// ============================================================================
+// RENDERER
+// ============================================================================
+
+DashboardRenderer::DashboardRenderer(void)
+    : current(DASHBOARD_FIELD_COUNT), spanX(0), spanY(0), spanWidth(0), spanHeight(0), spanRow(0),
+      frames(0), pushes(0), pixels(0)
+{
+    invalidate();
+}
+
+void DashboardRenderer::invalidate(void)
+{
+    for (uint8_t i = 0; i < DASHBOARD_FIELD_COUNT; i++)
+    {
+        valid[i] = false;
+    }
+}
+
+void DashboardRenderer::startFrame(const DashboardValues& values)
+{
+    formatDashboard(values, target);
+    frames++;
+    current = 0;
+    nextSpan();
+}
+
+void DashboardRenderer::nextSpan(void)
+{
+    for (; current < DASHBOARD_FIELD_COUNT; current++)
+    {
+        const DashboardField& field = layout[current];
+        const DashboardText& was = shown[current];
+        const DashboardText& now = target[current];
+        spanRow = 0;
+
+        // New colours repaint the background too
+        if (!valid[current] || was.foreground != now.foreground || was.background != now.background)
+        {
+            spanX = field.x;
+            spanY = field.y;
+            spanWidth = field.width;
+            spanHeight = field.height;
+            return;
+        }
+
+        // Otherwise only the run of cells from the first to the last change
+        int first = -1;
+        int last = -1;
+        for (int c = 0; c < field.chars; c++)
+        {
+            if (was.text[c] != now.text[c])
+            {
+                first = (first < 0) ? c : first;
+                last = c;
+            }
+        }
+        if (first >= 0)
+        {
+            int16_t cellWidth = DASHBOARD_CELL_WIDTH * field.scale;
+            spanX = field.x + field.padX + first * cellWidth;
+            spanY = field.y + field.padY;
+            spanWidth = (last - first + 1) * cellWidth;
+            spanHeight = DASHBOARD_CELL_HEIGHT * field.scale;
+            return;
+        }
+    }
+}
+
+uint32_t DashboardRenderer::pushNext(uint32_t pixelBudget)
+{
+    uint32_t pushed = 0;
+
+    while (busy())
+    {
+        // Whole rows of the span that fit both the budget and the sprite
+        int32_t rows = (int32_t)((pixelBudget - pushed) / spanWidth);
+        rows = (rows < DASHBOARD_PIXEL_BUDGET / spanWidth) ? rows : DASHBOARD_PIXEL_BUDGET / spanWidth;
+        rows = (rows < spanHeight - spanRow) ? rows : spanHeight - spanRow;
+        if (rows <= 0)
+        {
+            break;
+        }
+
+        const DashboardField& field = layout[current];
+        uint16_t* pixel = sprite;
+        for (int16_t row = 0; row < rows; row++)
+        {
+            for (int16_t column = 0; column < spanWidth; column++)
+            {
+                *pixel++ = fieldPixel(field, target[current], spanX + column - field.x,
+                                      spanY + spanRow + row - field.y);
+            }
+        }
+        halDisplayPush(spanX, spanY + spanRow, spanWidth, (int16_t)rows, sprite);
+
+        uint32_t count = (uint32_t)rows * (uint32_t)spanWidth;
+        pushes++;
+        pixels += count;
+        pushed += count;
+        spanRow += rows;
+
+        if (spanRow == spanHeight)
+        {
+            shown[current] = target[current];
+            valid[current] = true;
+            current++;
+            nextSpan();
+        }
+    }
+    return pushed;
+}
+
+// ============================================================================
+// DASHBOARD STATE
+// ============================================================================
+
+static DashboardRenderer renderer;
+static StatusColor status = STATUS_WAITING;
+static bool statusSet = false;
+
+static float outputYaw = 0.0f;
+static float outputPitch = 0.0f;
+static float outputRoll = 0.0f;
+static float outputRateHz = 0.0f;
+
+static uint32_t freeMegabytes = 0;
+static uint32_t lastFreeQueryMs = 0;
+static uint32_t lastFrameMs = 0;
+
+static void queryFreeSpace(uint32_t nowMs)
+{
+    freeMegabytes = (uint32_t)(halStorageFreeBytes() >> 20);
+    lastFreeQueryMs = nowMs;
+}
+
+static void collectValues(DashboardValues& values)
+{
+    values.status = status;
+    values.yaw = outputYaw;
+    values.pitch = outputPitch;
+    values.roll = outputRoll;
+    values.rateHz = outputRateHz;
+
+    uint8_t fill = logBufferPercent();
+    uint32_t dropped = 0;
+    if (PIPELINE_MODE_ENABLED)
+    {
+        uint8_t ring = (uint8_t)(pipelineBacklog() * 100 / PIPELINE_RING_SIZE);
+        fill = (ring > fill) ? ring : fill;
+        dropped += pipelineDroppedCount();
+    }
+    if (IMU_FIFO_MODE_ENABLED)
+    {
+        dropped += fifoOverflowCount();
+    }
+    if (DATA_READY_IRQ_ENABLED)
+    {
+        dropped += dataReady.droppedEdges() + dataReady.missedPeriods();
+    }
+
+    values.bufferPercent = fill;
+    values.freeMegabytes = freeMegabytes;
+    values.storageErrors = logErrorCount();
+    values.droppedSamples = dropped;
+}
+
+// ============================================================================
+// DASHBOARD FUNCTIONS
+// ============================================================================
+
+void showStatus(StatusColor newStatus)
+{
+    if (statusSet && newStatus == status)
+    {
+        return;
+    }
+
+    status = newStatus;
+    statusSet = true;
+    if (!DASHBOARD_ENABLED)
+    {
+        halShowStatus(newStatus);
+    }
+}
+
+StatusColor systemStatus(void)
+{
+    return status;
+}
+
+void dashboardObserveOutput(float yaw, float pitch, float roll, float rateHz)
+{
+    outputYaw = yaw;
+    outputPitch = pitch;
+    outputRoll = roll;
+    outputRateHz = rateHz;
+}
+
+void beginDashboard(void)
+{
+    queryFreeSpace(halMillis());
+
+    DashboardValues values;
+    collectValues(values);
+    renderer.invalidate();
+    renderer.startFrame(values);
+    while (renderer.busy())
+    {
+        renderer.pushNext(DASHBOARD_PIXEL_BUDGET);
+    }
+    lastFrameMs = halMillis();
+}
+
+void serviceDashboard(uint32_t nowMs)
+{
+    if (!renderer.busy())
+    {
+        // The free space query gets a pass of its own
+        if (nowMs - lastFreeQueryMs >= DASHBOARD_FREE_SPACE_INTERVAL_MS)
+        {
+            queryFreeSpace(nowMs);
+            return;
+        }
+        if (nowMs - lastFrameMs < DASHBOARD_FRAME_INTERVAL_MS)
+        {
+            return;
+        }
+
+        DashboardValues values;
+        collectValues(values);
+        renderer.startFrame(values);
+        lastFrameMs = nowMs;
+    }
+
+    renderer.pushNext(DASHBOARD_PIXEL_BUDGET);
+}
+
+uint32_t dashboardFrameCount(void)
+{
+    return renderer.frameCount();
+}
@@ -0,0 +1,218 @@
+/**
+ * @file dashboard.h
+ * @brief Live status and orientation dashboard on the LCD
+ *
+ * Replaces the full-screen status colours with one screen of text fields:
+ * system status, yaw, pitch, roll, filter update rate, log buffer fill, SD
+ * free space, and the SD error and dropped-sample counters.
+ *
+ * Drawing is incremental and bounded. A frame starts at most every
+ * DASHBOARD_FRAME_INTERVAL_MS; it formats every field, compares it with
+ * what the screen shows, and queues only the character cells that changed
+ * (the whole field if its colours changed). Each serviceDashboard() call
+ * then rasterizes at most DASHBOARD_PIXEL_BUDGET pixels of the queued
+ * rectangles into an off-screen sprite and pushes them with
+ * halDisplayPush(), so one loop pass never spends more than a fixed,
+ * short time on the display. Nothing else draws to the screen while the
+ * dashboard runs: showStatus() only records the state for the next frame,
+ * which keeps repaints out of the logging paths that report errors.
+ *
+ * The layout, formatting and rasterization are plain functions of the
+ * field contents, so the host check (--dashboard-check) can compare the
+ * incrementally updated framebuffer stand-in with a full redraw.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef DASHBOARD_H
+#define DASHBOARD_H
+
+#include "hal.h"
+#include "config.h"
+
+static_assert(DASHBOARD_PIXEL_BUDGET >= HAL_LCD_WIDTH,
+              "DASHBOARD_PIXEL_BUDGET must hold at least one display row");
+
+// ============================================================================
+// LAYOUT
+// ============================================================================
+
+#define DASHBOARD_FIELD_COUNT 9
+#define DASHBOARD_MAX_CHARS 26
+
+// Glyph cell of the 5x7 font at scale 1, including the spacing
+#define DASHBOARD_CELL_WIDTH 6
+#define DASHBOARD_CELL_HEIGHT 8
+
+/**
+ * @brief Screen rectangle of one field and where its text sits in it
+ *
+ * The fields tile the screen; the text is @p chars glyph cells at
+ * @p scale, @p padX / @p padY from the field's top-left corner, and the
+ * rest of the field is background.
+ */
+struct DashboardField
+{
+    int16_t x, y;
+    int16_t width, height;
+    uint8_t scale;
+    uint8_t chars;
+    uint8_t padX, padY;
+};
+
+/**
+ * @brief Text and colours of one field (RGB565)
+ */
+struct DashboardText
+{
+    char text[DASHBOARD_MAX_CHARS + 1];     ///< Padded with spaces to the field's chars
+    uint16_t foreground;
+    uint16_t background;
+};
+
+/**
+ * @brief Everything one frame shows
+ */
+struct DashboardValues
+{
+    StatusColor status;
+    float yaw, pitch, roll;         ///< Degrees
+    float rateHz;                   ///< Filter update rate
+    uint8_t bufferPercent;          ///< Fullest log block or sample ring
+    uint32_t freeMegabytes;         ///< SD free space
+    uint32_t storageErrors;         ///< Failed log stream operations
+    uint32_t droppedSamples;        ///< Ring, FIFO and data-ready losses
+};
+
+/**
+ * @brief Field @p index of the layout (0 = status bar)
+ */
+const DashboardField& dashboardField(uint8_t index);
+
+/**
+ * @brief Text and colours of every field for @p values
+ *
+ * @param out DASHBOARD_FIELD_COUNT entries
+ */
+void formatDashboard(const DashboardValues& values, DashboardText* out);
+
+/**
+ * @brief Colour of screen pixel (@p x, @p y) with the fields showing @p texts
+ *
+ * The reference for the incremental renderer: a full redraw is this
+ * function over the whole screen.
+ */
+uint16_t dashboardPixel(const DashboardText* texts, int16_t x, int16_t y);
+
+// ============================================================================
+// RENDERER
+// ============================================================================
+
+/**
+ * @brief Dirty-rectangle renderer of the dashboard fields
+ *
+ * Keeps what the screen shows per field. startFrame() queues the
+ * differences to new values; pushNext() draws the queue a budget at a
+ * time, in row strips rendered into the off-screen sprite.
+ */
+class DashboardRenderer
+{
+public:
+    DashboardRenderer(void);
+
+    /**
+     * @brief Forget the screen contents; the next frame redraws every field
+     */
+    void invalidate(void);
+
+    /**
+     * @brief Format @p values and queue the changed cells
+     *
+     * Only call when not busy(): a frame is pushed out before the next one
+     * is taken.
+     */
+    void startFrame(const DashboardValues& values);
+
+    /**
+     * @brief Push queued rectangles, at most @p pixelBudget pixels
+     *
+     * @p pixelBudget must be at least one display row.
+     *
+     * @return Pixels pushed
+     */
+    uint32_t pushNext(uint32_t pixelBudget);
+
+    /**
+     * @brief A frame is still being pushed
+     */
+    bool busy(void) const { return current < DASHBOARD_FIELD_COUNT; }
+
+    uint32_t frameCount(void) const { return frames; }
+    uint32_t pushCount(void) const { return pushes; }
+    uint32_t pixelCount(void) const { return pixels; }
+
+private:
+    void nextSpan(void);
+
+    DashboardText shown[DASHBOARD_FIELD_COUNT];
+    DashboardText target[DASHBOARD_FIELD_COUNT];
+    bool valid[DASHBOARD_FIELD_COUNT];
+
+    uint8_t current;                ///< Field being pushed; DASHBOARD_FIELD_COUNT when idle
+    int16_t spanX, spanY;           ///< Dirty rectangle of the current field
+    int16_t spanWidth, spanHeight;
+    int16_t spanRow;                ///< Rows of it pushed so far
+
+    uint16_t sprite[DASHBOARD_PIXEL_BUDGET];
+
+    uint32_t frames;
+    uint32_t pushes;
+    uint32_t pixels;
+};
+
+// ============================================================================
+// DASHBOARD FUNCTIONS
+// ============================================================================
+
+/**
+ * @brief Set the system state shown on the display
+ *
+ * With the dashboard the state appears in its status bar on the next
+ * frame; without it the screen is filled with the state's colour, once
+ * per change.
+ */
+void showStatus(StatusColor status);
+
+/**
+ * @brief Last state passed to showStatus()
+ */
+StatusColor systemStatus(void);
+
+/**
+ * @brief Record the orientation and update rate of the latest output tick
+ */
+void dashboardObserveOutput(float yaw, float pitch, float roll, float rateHz);
+
+/**
+ * @brief Query the SD free space and draw the first frame in full
+ *
+ * Blocks until the frame is out; call from setup().
+ */
+void beginDashboard(void);
+
+/**
+ * @brief Start a frame when due and push the next pixel budget of it
+ *
+ * Call once per loop pass, after the acquisition and logging work, from
+ * the task that owns the SD card (the display shares its SPI bus).
+ */
+void serviceDashboard(uint32_t nowMs);
+
+/**
+ * @brief Frames started by serviceDashboard()
+ */
+uint32_t dashboardFrameCount(void);
+
+#endif // DASHBOARD_H
@@ -11,188 +11,464 @@
 #include "imu_sensor.h"
 #include "sd_logger.h"
 #include "config.h"
-#include "utility/quaternionFilters.h"
-#include <M5Stack.h>
+#include "log_record.h"
+#include "packed_log.h"
+#include "mahony_filter.h"
+#include "output_config.h"
+#include "instrumentation.h"
+#include "data_ready.h"
+#include "telemetry.h"
+#include "event_capture.h"
+#include "feature_extractor.h"
+#include "hal.h"
 
 // ============================================================================
 // GLOBAL VARIABLES
 // ============================================================================
 
-extern char msg[MSG_BUFFER_SIZE];
+static ConfiguredOutput output(Serial);
+
+static PackedBlockEncoder packedBlock(LOG_PACKED_BLOCK_SAMPLES);
+
+static FrameScaleState loggedScale;         ///< Scale record in force in the frame log
+static uint16_t loggedScaleSegment = 0;     ///< Segment it was written to
 
 // ============================================================================
 // DATA PROCESSING FUNCTIONS
 // ============================================================================
 
-void processBasicMode(void)
+void orientationFromQuaternion(const float* q, float& yaw, float& pitch, float& roll)
+{
+    quaternionToEuler(q, MAGNETIC_DECLINATION_DEG, yaw, pitch, roll);
+}
+
+void calculateOrientation(void)
+{
+    orientationFromQuaternion(output.quaternion(), imuSensor.yaw, imuSensor.pitch, imuSensor.roll);
+}
+
+/**
+ * @brief Integrate the current sensor values over @p dt seconds
+ */
+static void runFilter(float dt)
+{
+    // Update orientation quaternion using the configured fusion stage
+    output.fuse(imuSensor.ax, imuSensor.ay, imuSensor.az, 
+                imuSensor.gx * DEG_TO_RAD, imuSensor.gy * DEG_TO_RAD, imuSensor.gz * DEG_TO_RAD, 
+                imuSensor.mx, imuSensor.my, imuSensor.mz, dt);
+}
+
+void fuseCurrentSample(void)
+{
+    // Update quaternion filter timing
+    imuSensor.updateTime();
+    runFilter(imuSensor.deltat);
+}
+
+void fuseFixedStep(float dt)
+{
+    imuSensor.deltat = dt;
+    imuSensor.sum += dt;
+    imuSensor.sumCount++;
+    runFilter(dt);
+}
+
+int acquireFifoSamples(SampleSink sink)
 {
-    imuSensor.delt_t = millis() - imuSensor.count;
-    if (imuSensor.delt_t > BASIC_UPDATE_INTERVAL_MS)
+    static FifoBatch batch;
+
+    INSTRUMENT_BEGIN(STAGE_I2C_READ);
+
+    int frames = readFifoBatch(batch);
+    if (frames == 0)
     {
-        if (SERIAL_DEBUG_ENABLED)
+        return 0;
+    }
+
+    readMagnetometerData();
+
+    INSTRUMENT_END(STAGE_I2C_READ);
+
+    for (int i = 0; i < frames; i++)
+    {
+        applyFifoFrame(batch, i);
+        fuseFixedStep(1.0f / IMU_SAMPLE_RATE_HZ);
+
+        if (sink != NULL)
         {
-            // Print acceleration values
-            Serial.print("X-acceleration: ");
-            Serial.print(1000 * imuSensor.ax);
-            Serial.print(" mg  Y-acceleration: ");
-            Serial.print(1000 * imuSensor.ay);
-            Serial.print(" mg  Z-acceleration: ");
-            Serial.print(1000 * imuSensor.az);
-            Serial.println(" mg");
-
-            // Print gyroscope values
-            Serial.print("X-gyro rate: ");
-            Serial.print(imuSensor.gx, 3);
-            Serial.print(" deg/s  Y-gyro rate: ");
-            Serial.print(imuSensor.gy, 3);
-            Serial.print(" deg/s  Z-gyro rate: ");
-            Serial.print(imuSensor.gz, 3);
-            Serial.println(" deg/s");
-
-            // Print magnetometer values
-            Serial.print("X-mag field: ");
-            Serial.print(imuSensor.mx);
-            Serial.print(" mG  Y-mag field: ");
-            Serial.print(imuSensor.my);
-            Serial.print(" mG  Z-mag field: ");
-            Serial.print(imuSensor.mz);
-            Serial.println(" mG");
-
-            // Print temperature
-            imuSensor.tempCount = imuSensor.readTempData();
-            imuSensor.temperature = ((float)imuSensor.tempCount) / TEMP_CONVERSION_FACTOR + TEMP_OFFSET;
-            Serial.print("Temperature: ");
-            Serial.print(imuSensor.temperature, 1);
-            Serial.println(" °C");
-            Serial.println();
+            ImuSample sample;
+            captureSample(sample);
+            sample.timestampMs = batch.timestampUs[i] / 1000;
+            sink(sample);
         }
-        
-        imuSensor.count = millis();
     }
+
+    return frames;
 }
 
-void calculateOrientation(void)
+int acquireDataReadySamples(SampleSink sink)
 {
-    imuSensor.yaw = atan2(2.0f * (*(getQ() + 1) * *(getQ() + 2) + *getQ() * *(getQ() + 3)),
-                    *getQ() * *getQ() + *(getQ() + 1) * *(getQ() + 1) - 
-                    *(getQ() + 2) * *(getQ() + 2) - *(getQ() + 3) * *(getQ() + 3));
-    
-    imuSensor.pitch = -asin(2.0f * (*(getQ() + 1) * *(getQ() + 3) - *getQ() * *(getQ() + 2)));
-    
-    imuSensor.roll = atan2(2.0f * (*getQ() * *(getQ() + 1) + *(getQ() + 2) * *(getQ() + 3)),
-                     *getQ() * *getQ() - *(getQ() + 1) * *(getQ() + 1) - 
-                     *(getQ() + 2) * *(getQ() + 2) + *(getQ() + 3) * *(getQ() + 3));
-    
-    // Convert to degrees
-    imuSensor.pitch *= RAD_TO_DEG;
-    imuSensor.yaw *= RAD_TO_DEG;
-    imuSensor.yaw -= MAGNETIC_DECLINATION_DEG;
-    imuSensor.roll *= RAD_TO_DEG;
-}
-
-void processAHRSMode(void)
-{
-    imuSensor.delt_t = millis() - imuSensor.count;
-    
-    if (imuSensor.delt_t > AHRS_UPDATE_INTERVAL_MS)
-    {
-        if (SERIAL_DEBUG_ENABLED)
+    FusionStep steps[DATA_READY_MAX_BATCH];
+
+    // The data registers only hold the newest sample: the whole backlog of
+    // edges is fused once over the combined interval, and the gap since the
+    // previous fused edge is what the missed-sample counter sees. Edges left
+    // queued would fuse the same registers again in the next pass.
+    int count = 0;
+    float dt = 0.0f;
+    uint32_t lastEdgeUs = 0;
+    int taken;
+    do
+    {
+        taken = dataReady.nextBatch(steps, DATA_READY_MAX_BATCH);
+        for (int i = 0; i < taken; i++)
+        {
+            dt += steps[i].dt;
+        }
+        if (taken > 0)
         {
-            // Log acceleration data
-            Serial.print("ax = ");
-            Serial.print((int)(1000 * imuSensor.ax));
-            Serial.print(" ay = ");
-            Serial.print((int)(1000 * imuSensor.ay));
-            Serial.print(" az = ");
-            Serial.print((int)(1000 * imuSensor.az));
-            Serial.println(" mg");
-            
-            snprintf(msg, MSG_BUFFER_SIZE, "\r\n%lu,%lf,%lf,%lf", 
-                    millis(), 1000 * imuSensor.ax, 1000 * imuSensor.ay, 1000 * imuSensor.az);
-            appendFile(SD, FILE_ACCELERATION, msg);
-
-            // Log gyroscope data
-            Serial.print("gx = ");
-            Serial.print(imuSensor.gx, 2);
-            Serial.print(" gy = ");
-            Serial.print(imuSensor.gy, 2);
-            Serial.print(" gz = ");
-            Serial.print(imuSensor.gz, 2);
-            Serial.println(" deg/s");
-            
-            snprintf(msg, MSG_BUFFER_SIZE, "\r\n%lu,%lf,%lf,%lf", 
-                    millis(), imuSensor.gx, imuSensor.gy, imuSensor.gz);
-            appendFile(SD, FILE_GYROSCOPE, msg);
-
-            // Log magnetometer data
-            Serial.print("mx = ");
-            Serial.print((int)imuSensor.mx);
-            Serial.print(" my = ");
-            Serial.print((int)imuSensor.my);
-            Serial.print(" mz = ");
-            Serial.print((int)imuSensor.mz);
-            Serial.println(" mG");
-            
-            snprintf(msg, MSG_BUFFER_SIZE, "\r\n%lu,%lf,%lf,%lf", 
-                    millis(), imuSensor.mx, imuSensor.my, imuSensor.mz);
-            appendFile(SD, FILE_MAGNETOMETER, msg);
-
-            // Log quaternion data
-            Serial.print("q0 = ");
-            Serial.print(*getQ());
-            Serial.print(" qx = ");
-            Serial.print(*(getQ() + 1));
-            Serial.print(" qy = ");
-            Serial.print(*(getQ() + 2));
-            Serial.print(" qz = ");
-            Serial.println(*(getQ() + 3));
-            
-            snprintf(msg, MSG_BUFFER_SIZE, "\r\n%lu,%lf,%lf,%lf,%lf", 
-                    millis(), *getQ(), *(getQ() + 1), *(getQ() + 2), *(getQ() + 3));
-            appendFile(SD, FILE_QUATERNION, msg);
+            lastEdgeUs = steps[taken - 1].timestampUs;
         }
+        count += taken;
+    } while (taken == DATA_READY_MAX_BATCH);
 
-        // Calculate orientation angles
-        calculateOrientation();
+    if (count == 0)
+    {
+        return 0;
+    }
 
-        if (SERIAL_DEBUG_ENABLED)
+    INSTRUMENT_SAMPLE(lastEdgeUs);
+    readIMUData();
+    fuseFixedStep(dt);
+
+    if (sink != NULL)
+    {
+        ImuSample sample;
+        captureSample(sample);
+        sample.timestampMs = lastEdgeUs / 1000;
+        sink(sample);
+    }
+
+    return count;
+}
+
+void captureSample(ImuSample& sample)
+{
+    const float* q = output.quaternion();
+
+    sample.timestampMs = halMillis();
+    sample.deltat = imuSensor.deltat;
+
+    for (int i = 0; i < 3; i++)
+    {
+        sample.accelCount[i] = imuSensor.accelCount[i];
+        sample.gyroCount[i] = imuSensor.gyroCount[i];
+        sample.magCount[i] = imuSensor.magCount[i];
+    }
+
+    sample.ax = imuSensor.ax;
+    sample.ay = imuSensor.ay;
+    sample.az = imuSensor.az;
+    sample.gx = imuSensor.gx;
+    sample.gy = imuSensor.gy;
+    sample.gz = imuSensor.gz;
+    sample.mx = imuSensor.mx;
+    sample.my = imuSensor.my;
+    sample.mz = imuSensor.mz;
+
+    for (int i = 0; i < 4; i++)
+    {
+        sample.q[i] = q[i];
+    }
+    sample.scale = sensorScale();
+}
+
+bool logSample(const ImuSample& sample, float rateHz)
+{
+    if (!output.due(sample.timestampMs))
+    {
+        return false;
+    }
+
+    output.emit(sample, rateHz);
+    output.restart(sample.timestampMs);
+    return true;
+}
+
+// ============================================================================
+// OUTPUT STREAM SCHEDULER
+// ============================================================================
+
+/**
+ * @brief Decimation window for one CSV output stream
+ */
+struct StreamDecimator
+{
+    uint16_t factor;        ///< Fused samples per logged record
+    bool average;           ///< Mean over the window, else the latest value
+    uint16_t count;
+    float sum[4];
+};
+
+/**
+ * @brief Fused samples per record for a stream logged at @p rateHz
+ */
+static uint16_t decimationFactor(uint32_t rateHz)
+{
+    if (rateHz == 0 || rateHz >= IMU_SAMPLE_RATE_HZ)
+    {
+        return 1;
+    }
+    return (uint16_t)((IMU_SAMPLE_RATE_HZ + rateHz / 2) / rateHz);
+}
+
+static StreamDecimator accelStream = {decimationFactor(STREAM_RATE_ACCEL_HZ), true, 0, {0}};
+static StreamDecimator gyroStream = {decimationFactor(STREAM_RATE_GYRO_HZ), true, 0, {0}};
+static StreamDecimator magStream = {decimationFactor(STREAM_RATE_MAG_HZ), true, 0, {0}};
+static StreamDecimator quaternionStream = {decimationFactor(STREAM_RATE_QUATERNION_HZ), false, 0, {0}};
+static StreamDecimator yprStream = {decimationFactor(STREAM_RATE_YPR_HZ), false, 0, {0}};
+
+/**
+ * @brief Add one sample to a window
+ * 
+ * @param stream Decimation window
+ * @param values Input channels
+ * @param channels Number of channels (at most 4)
+ * @param out Filled with the record when the window completes
+ * @return true when a record is due
+ */
+static bool decimate(StreamDecimator& stream, const float* values, int channels, float* out)
+{
+    if (stream.count == 0)
+    {
+        for (int i = 0; i < channels; i++)
         {
-            // Log orientation data
-            Serial.print("Yaw, Pitch, Roll: ");
-            Serial.print(imuSensor.yaw, 2);
-            Serial.print(", ");
-            Serial.print(imuSensor.pitch, 2);
-            Serial.print(", ");
-            Serial.println(imuSensor.roll, 2);
-
-            Serial.print("Update rate = ");
-            Serial.print((float)imuSensor.sumCount / imuSensor.sum, 2);
-            Serial.println(" Hz");
-            Serial.println();
-            
-            snprintf(msg, MSG_BUFFER_SIZE, "\r\n%lu,%lf,%lf,%lf,%lf", 
-                    millis(), (float)imuSensor.sumCount / imuSensor.sum, imuSensor.yaw, imuSensor.pitch, imuSensor.roll);
-            appendFile(SD, FILE_YPR, msg);
+            stream.sum[i] = 0.0f;
         }
+    }
+
+    for (int i = 0; i < channels; i++)
+    {
+        stream.sum[i] = stream.average ? stream.sum[i] + values[i] : values[i];
+    }
+
+    if (++stream.count < stream.factor)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < channels; i++)
+    {
+        out[i] = stream.average ? stream.sum[i] / stream.count : stream.sum[i];
+    }
+    stream.count = 0;
+    return true;
+}
+
+void scheduleSample(const ImuSample& sample)
+{
+    uint32_t timestamp = sample.timestampMs;
+    float out[4];
+
+    const float accel[3] = {1000 * sample.ax, 1000 * sample.ay, 1000 * sample.az};
+    if (decimate(accelStream, accel, 3, out))
+    {
+        accelLog.printRecord(timestamp, out, 3);
+    }
+
+    const float gyro[3] = {sample.gx, sample.gy, sample.gz};
+    if (decimate(gyroStream, gyro, 3, out))
+    {
+        gyroLog.printRecord(timestamp, out, 3);
+    }
+
+    const float mag[3] = {sample.my, sample.mx, sample.mz};       // AK8963 axis order
+    if (decimate(magStream, mag, 3, out))
+    {
+        magLog.printRecord(timestamp, out, 3);
+    }
+
+    if (decimate(quaternionStream, sample.q, 4, out))
+    {
+        quaternionLog.printRecord(timestamp, out, 4);
+    }
+
+    if (decimate(yprStream, sample.q, 4, out))
+    {
+        float ypr[4];
+        ypr[0] = (sample.deltat > 0.0f) ? 1.0f / sample.deltat : 0.0f;
+        orientationFromQuaternion(out, ypr[1], ypr[2], ypr[3]);
+        yprLog.printRecord(timestamp, ypr, 4);
+    }
+}
+
+// ============================================================================
+// FEATURE EXTRACTION
+// ============================================================================
 
-        imuSensor.count = millis();
-        imuSensor.sumCount = 0;
-        imuSensor.sum = 0;
-
-#if (PROCESSING_OUTPUT_ENABLED)
-        // Output for Processing visualization
-        Serial.print(imuSensor.yaw);
-        Serial.print(";");
-        Serial.print(imuSensor.pitch);
-        Serial.print(";");
-        Serial.print(imuSensor.roll);
-        Serial.print(";");
-        Serial.print(26.5);
-        Serial.print(";");
-        Serial.print(0.01);
-        Serial.print(";");
-        Serial.print(0.02);
-        Serial.println();
-#endif
+#define FEATURE_CHANNELS 6
+
+static const char* const featureChannelNames[FEATURE_CHANNELS] = {"ax", "ay", "az", "gx", "gy", "gz"};
+
+static float featureWindows[FEATURE_CHANNELS][FEATURE_WINDOW_SAMPLES];
+static uint16_t featureFill = 0;
+
+void extractFeatures(const ImuSample& sample)
+{
+    featureWindows[0][featureFill] = 1000 * sample.ax;
+    featureWindows[1][featureFill] = 1000 * sample.ay;
+    featureWindows[2][featureFill] = 1000 * sample.az;
+    featureWindows[3][featureFill] = sample.gx;
+    featureWindows[4][featureFill] = sample.gy;
+    featureWindows[5][featureFill] = sample.gz;
+
+    if (++featureFill < FEATURE_WINDOW_SAMPLES)
+    {
+        return;
+    }
+    featureFill = 0;
+
+    // Records carry the timestamp of the window's last sample
+    for (int channel = 0; channel < FEATURE_CHANNELS; channel++)
+    {
+        WindowFeatures features;
+        char line[FEATURE_RECORD_MAX_SIZE];
+
+        computeWindowFeatures(featureWindows[channel], features);
+        size_t length = formatFeatureRecord(line, sample.timestampMs, featureChannelNames[channel], features);
+        featureLog.write(line, length);
+    }
+}
+
+// ============================================================================
+// PER-SAMPLE OUTPUT
+// ============================================================================
+
+void recordSample(const ImuSample& sample)
+{
+    if (LOG_FORMAT_BINARY)
+    {
+        logBinarySample(sample);
+    }
+    else if (STREAM_SCHEDULER_ENABLED && !FEATURE_EXTRACTION_ENABLED)
+    {
+        scheduleSample(sample);
+    }
+
+    if (FEATURE_EXTRACTION_ENABLED)
+    {
+        extractFeatures(sample);
+    }
+
+    if (SERIAL_TELEMETRY_ENABLED)
+    {
+        publishTelemetry(sample);
+    }
+
+    if (EVENT_CAPTURE_ENABLED)
+    {
+        captureEventSample(sample);
     }
 }
+
+void processOutput(void)
+{
+    if (!output.due(halMillis()))
+    {
+        return;
+    }
+
+    ImuSample sample;
+    captureSample(sample);
+    output.emit(sample, (float)imuSensor.sumCount / imuSensor.sum);
+
+    output.restart(halMillis());
+    imuSensor.sumCount = 0;
+    imuSensor.sum = 0;
+}
+
+/**
+ * @brief Write the current packed block and its index entry
+ */
+static void writePackedBlock(void)
+{
+    PackedBlockInfo info;
+    uint8_t entry[PACKED_INDEX_ENTRY_SIZE];
+    const uint8_t* block;
+
+    info.offset = binaryLog.segmentBytes();
+    info.firstTimestampMs = packedBlock.firstTimestamp();
+    info.lastTimestampMs = packedBlock.lastTimestamp();
+    info.samples = packedBlock.samples();
+
+    size_t length = packedBlock.finish(block);
+    if (length == 0)
+    {
+        return;
+    }
+
+    binaryLog.write((const char*)block, length);
+
+    encodePackedIndexEntry(info, entry);
+    packedIndexLog.write((const char*)entry, PACKED_INDEX_ENTRY_SIZE);
+}
+
+/**
+ * @brief Add a frame to the packed block, writing the block out when it ends
+ */
+static void logPackedFrame(const ImuFrame& frame)
+{
+    if (!packedBlock.empty() && frame.timestampMs - packedBlock.firstTimestamp() >= LOG_FLUSH_INTERVAL_MS)
+    {
+        writePackedBlock();
+    }
+    if (!packedBlock.add(frame))
+    {
+        writePackedBlock();
+        packedBlock.add(frame);
+    }
+}
+
+void sampleFrame(const ImuSample& sample, ImuFrame& frame)
+{
+    frame.timestampMs = sample.timestampMs;
+    for (int i = 0; i < 3; i++)
+    {
+        frame.accelCount[i] = sample.accelCount[i];
+        frame.gyroCount[i] = sample.gyroCount[i];
+        frame.magCount[i] = sample.magCount[i];
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        frame.q[i] = sample.q[i];
+    }
+    frame.scale = sample.scale;
+}
+
+void logBinarySample(const ImuSample& sample)
+{
+    ImuFrame frame;
+    uint8_t encoded[LOG_RECORD_MAX_SIZE];
+
+    sampleFrame(sample, frame);
+    if (LOG_FORMAT_COMPRESSED)
+    {
+        logPackedFrame(frame);
+        return;
+    }
+
+    // Every segment decodes on its own, so each starts with a scale record
+    if (loggedScaleSegment != logSegmentNumber())
+    {
+        loggedScale.valid = false;
+        loggedScaleSegment = logSegmentNumber();
+    }
+    if (frameScaleChanged(loggedScale, frame.scale))
+    {
+        encodeScaleRecord(frame.scale, loggedScale, encoded);
+        binaryLog.write((const char*)encoded, LOG_SCALE_RECORD_SIZE);
+    }
+
+    encodeImuFrame(frame, loggedScale, encoded);
+    binaryLog.write((const char*)encoded, LOG_FRAME_SIZE);
+}
@@ -13,17 +13,35 @@
 #ifndef DATA_PROCESSOR_H
 #define DATA_PROCESSOR_H
 
+#include "imu_sample.h"
+#include "config.h"
+
+// ============================================================================
+// TYPES
+// ============================================================================
+
+/**
+ * @brief Callback receiving each fused sample
+ */
+typedef void (*SampleSink)(const ImuSample& sample);
+
+// Some output consumes every fused sample (see recordSample())
+#define SAMPLE_SINK_ENABLED (LOG_FORMAT_BINARY || STREAM_SCHEDULER_ENABLED || SERIAL_TELEMETRY_ENABLED \
+                             || EVENT_CAPTURE_ENABLED || FEATURE_EXTRACTION_ENABLED)
+
 // ============================================================================
 // DATA PROCESSING FUNCTIONS
 // ============================================================================
 
 /**
- * @brief Process and log basic sensor data
+ * @brief Compute Yaw, Pitch, and Roll from a quaternion
  * 
- * Outputs raw sensor readings to serial console for debugging.
- * Updates at BASIC_UPDATE_INTERVAL_MS rate.
+ * @param q Quaternion (q0, qx, qy, qz)
+ * @param yaw Yaw in degrees, corrected for magnetic declination
+ * @param pitch Pitch in degrees
+ * @param roll Roll in degrees
  */
-void processBasicMode(void);
+void orientationFromQuaternion(const float* q, float& yaw, float& pitch, float& roll);
 
 /**
  * @brief Calculate orientation from quaternion
@@ -34,12 +52,138 @@ void processBasicMode(void);
 void calculateOrientation(void);
 
 /**
- * @brief Process and log AHRS mode data
+ * @brief Run the quaternion filter on the current sensor values
+ * 
+ * Updates the filter timing and integrates the latest accel, gyro and
+ * magnetometer readings into the orientation quaternion.
+ */
+void fuseCurrentSample(void);
+
+/**
+ * @brief Run the quaternion filter with a known integration step
+ * 
+ * Used when sample timing is known from the sensor's output data rate
+ * rather than measured with micros().
+ * 
+ * @param dt Integration interval in seconds
+ */
+void fuseFixedStep(float dt);
+
+/**
+ * @brief Drain the IMU FIFO and fuse every queued frame
+ * 
+ * Burst-reads the FIFO, reads the magnetometer once for the batch, and
+ * runs the filter once per frame with dt = 1 / IMU_SAMPLE_RATE_HZ.
+ * 
+ * @param sink Called with each fused sample (may be NULL)
+ * @return Number of frames fused
+ */
+int acquireFifoSamples(SampleSink sink);
+
+/**
+ * @brief Fuse the samples signalled by the data-ready interrupt
+ * 
+ * Takes every queued edge from dataReady, reads the data registers once and
+ * runs the filter once with dt derived from the edge timestamps rounded to
+ * whole ODR periods. Edges that queued up behind the newest one are fused
+ * in the same step, however many DATA_READY_MAX_BATCH batches they span.
+ * 
+ * @param sink Called with the fused sample (may be NULL)
+ * @return Number of edges consumed
+ */
+int acquireDataReadySamples(SampleSink sink);
+
+/**
+ * @brief Snapshot the current sensor values and quaternion
+ * 
+ * @param sample Destination sample
+ */
+void captureSample(ImuSample& sample);
+
+/**
+ * @brief Print a sample to serial and log it to the CSV streams when due
+ * 
+ * Runs the formatter and sink stages of the configured output pipeline
+ * (output_config.h) if its rate interval has passed since the last sample
+ * output, timed by the sample's own timestamp rather than the clock, so a
+ * backlog drained at once keeps the spacing it was recorded with. Formats
+ * into local buffers, so it can run on a different task from acquisition.
+ * 
+ * @param sample Sample to output
+ * @param rateHz Filter update rate to report
+ * @return true if the sample was output
+ */
+bool logSample(const ImuSample& sample, float rateHz);
+
+/**
+ * @brief Feed one fused sample to the per-stream output scheduler
+ * 
+ * Used when STREAM_SCHEDULER_ENABLED. Each CSV stream keeps its own
+ * decimation window sized from its STREAM_RATE_*_HZ: accelerometer,
+ * gyroscope and magnetometer records are the mean over the window,
+ * quaternion and YPR records the latest filter output. Formats into a
+ * local buffer; call it from one task only (the logging task in
+ * pipelined mode).
+ * 
+ * @param sample Sample fused at IMU_SAMPLE_RATE_HZ
+ */
+void scheduleSample(const ImuSample& sample);
+
+/**
+ * @brief Feed one fused sample to the feature windows
+ * 
+ * Used when FEATURE_EXTRACTION_ENABLED. Accelerometer (mg) and gyroscope
+ * (deg/s) axes each fill a preallocated window of FEATURE_WINDOW_SAMPLES;
+ * when the windows are full, each is reduced in place to its features
+ * (feature_extractor.h) and logged as one record per axis to
+ * FILE_FEATURES. Call it from one task only (the logging task in
+ * pipelined mode).
+ * 
+ * @param sample Sample fused at IMU_SAMPLE_RATE_HZ
+ */
+void extractFeatures(const ImuSample& sample);
+
+/**
+ * @brief Hand one fused sample to every per-sample output
+ * 
+ * Binary log or stream scheduler, then the feature windows, serial
+ * telemetry and the event capture ring, as configured.
+ * The SampleSink used by the acquisition paths when SAMPLE_SINK_ENABLED.
+ * 
+ * @param sample Fused sample
+ */
+void recordSample(const ImuSample& sample);
+
+/**
+ * @brief Output the current sample when the configured rate is due
+ * 
+ * In AHRS mode prints the sensor values, quaternion and orientation and
+ * logs them to the CSV streams every AHRS_UPDATE_INTERVAL_MS (or the rate
+ * governor's interval); in basic mode prints the sensor readout every
+ * BASIC_UPDATE_INTERVAL_MS. Which stages run is fixed at compile time
+ * (output_config.h).
+ */
+void processOutput(void);
+
+/**
+ * @brief The binary log frame of a sample
+ * 
+ * Raw counts, quaternion and the sample's scale factors and calibration.
+ */
+void sampleFrame(const ImuSample& sample, ImuFrame& frame);
+
+/**
+ * @brief Log a sample as one binary frame
+ * 
+ * Packs the sample with sampleFrame() and stages it on the binary log stream. Called once per new sample when
+ * LOG_FORMAT_BINARY is enabled. A scale record is staged first at the
+ * start of each segment and whenever the sample's scale differs from the
+ * last one logged. With LOG_FORMAT_COMPRESSED the frame goes
+ * into the current packed block instead, and finished blocks are staged
+ * with their index entries.
  * 
- * Computes orientation using quaternion filter, logs all sensor data
- * to SD card, and outputs results to serial console. Updates at
- * AHRS_UPDATE_INTERVAL_MS rate.
+ * @param sample Sample to log
  */
-void processAHRSMode(void);
+void logBinarySample(const ImuSample& sample);
 
 #endif // DATA_PROCESSOR_H
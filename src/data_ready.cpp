@@ -0,0 +1,97 @@
+/**
+ * @file data_ready.cpp
+ * @brief Data-ready interrupt driven fusion scheduling
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "data_ready.h"
+#include "imu_sensor.h"
+#include "dashboard.h"
+#include "hal.h"
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+// INT_PIN_CFG: cleared for a 50 us pulse per sample instead of a level held until INT_STATUS is read
+#define MPU9250_INT_PIN_CFG_LATCH_INT_EN 0x20
+#define MPU9250_INT_ENABLE_RAW_RDY 0x01
+
+// ============================================================================
+// DATA-READY SCHEDULER
+// ============================================================================
+
+DataReadyScheduler::DataReadyScheduler(uint32_t periodUs)
+    : periodUs(periodUs),
+      lastEdgeUs(0),
+      haveLastEdge(false),
+      missed(0)
+{
+}
+
+void DataReadyScheduler::onEdge(uint32_t timestampUs)
+{
+    edges.push(timestampUs);
+}
+
+int DataReadyScheduler::nextBatch(FusionStep* steps, int maxSteps)
+{
+    int count = 0;
+    uint32_t timestampUs;
+
+    while (count < maxSteps && edges.pop(timestampUs))
+    {
+        uint32_t periods = 1;
+        if (haveLastEdge)
+        {
+            periods = (timestampUs - lastEdgeUs + periodUs / 2) / periodUs;
+            if (periods == 0)
+            {
+                periods = 1;
+            }
+        }
+        lastEdgeUs = timestampUs;
+        haveLastEdge = true;
+
+        FusionStep& step = steps[count++];
+        step.timestampUs = timestampUs;
+        step.dt = (float)(periods * periodUs) / 1000000.0f;
+        step.skipped = (uint16_t)(periods - 1);
+        missed += periods - 1;
+    }
+
+    return count;
+}
+
+// ============================================================================
+// DATA-READY FUNCTIONS
+// ============================================================================
+
+DataReadyScheduler dataReady(1000000UL / IMU_SAMPLE_RATE_HZ);
+
+static void HAL_ISR_ATTR dataReadyIsr(void)
+{
+    dataReady.onEdge(halMicros());
+}
+
+bool startDataReadyInterrupt(void)
+{
+    // Only the latch bit changes: BYPASS_EN is set for direct AK8963 reads
+    // and must stay clear once the I2C master mirrors it
+    uint8_t pinConfig = imuSensor.readByte(MPU9250_ADDRESS, INT_PIN_CFG);
+    imuSensor.writeByte(MPU9250_ADDRESS, INT_PIN_CFG, pinConfig & (uint8_t)~MPU9250_INT_PIN_CFG_LATCH_INT_EN);
+    imuSensor.writeByte(MPU9250_ADDRESS, INT_ENABLE, MPU9250_INT_ENABLE_RAW_RDY);
+
+    if (!halAttachDataReadyInterrupt(dataReadyIsr))
+    {
+        Serial.println("ERROR: Failed to attach data-ready interrupt");
+        showStatus(STATUS_ERROR);
+        return false;
+    }
+
+    Serial.println("INFO: Data-ready interrupt acquisition enabled");
+    return true;
+}
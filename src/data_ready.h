@@ -0,0 +1,112 @@
+/**
+ * @file data_ready.h
+ * @brief Data-ready interrupt driven fusion scheduling
+ * 
+ * The MPU9250 INT line is configured to pulse once per sample and an ISR
+ * timestamps each edge into a lock-free queue. The main loop (or the
+ * sampling task) drains the queue in batches and gets one FusionStep per
+ * edge with a dt derived from the output data rate, so every sample is
+ * integrated exactly once over a known interval regardless of loop timing.
+ * 
+ * DataReadyScheduler holds only the scheduling logic and has no hardware
+ * dependency; the host simulator drives it from its simulated INT pin.
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef DATA_READY_H
+#define DATA_READY_H
+
+#include <stdint.h>
+#include "spsc_ring.h"
+#include "config.h"
+
+// ============================================================================
+// TYPES
+// ============================================================================
+
+/**
+ * @brief One filter step derived from a data-ready edge
+ */
+struct FusionStep
+{
+    uint32_t timestampUs;   ///< Edge time
+    float dt;               ///< Integration interval in seconds
+    uint16_t skipped;       ///< ODR periods since the previous edge with no edge seen
+};
+
+// ============================================================================
+// DATA-READY SCHEDULER
+// ============================================================================
+
+class DataReadyScheduler
+{
+public:
+    /**
+     * @param periodUs Sensor output data period in microseconds
+     */
+    explicit DataReadyScheduler(uint32_t periodUs);
+
+    /**
+     * @brief Record a data-ready edge (interrupt context, single producer)
+     */
+    void onEdge(uint32_t timestampUs);
+
+    /**
+     * @brief Take up to @p maxSteps queued edges (single consumer)
+     * 
+     * Each step's dt is the edge-to-edge gap rounded to whole ODR periods,
+     * so ISR latency jitter never reaches the filter while edges lost with
+     * interrupts masked still advance the integration by the right time.
+     * 
+     * @return Number of steps written to @p steps
+     */
+    int nextBatch(FusionStep* steps, int maxSteps);
+
+    /**
+     * @brief Edges waiting to be taken
+     */
+    uint32_t pending(void) const { return (uint32_t)edges.size(); }
+
+    /**
+     * @brief Edges lost because the queue was full
+     */
+    uint32_t droppedEdges(void) const { return edges.droppedCount(); }
+
+    /**
+     * @brief ODR periods with no edge seen (sum of FusionStep::skipped)
+     */
+    uint32_t missedPeriods(void) const { return missed; }
+
+private:
+    SpscRing<uint32_t, DATA_READY_QUEUE_SIZE> edges;
+    uint32_t periodUs;
+    uint32_t lastEdgeUs;
+    bool haveLastEdge;
+    uint32_t missed;
+};
+
+// ============================================================================
+// DATA-READY FUNCTIONS
+// ============================================================================
+
+/**
+ * @brief Scheduler fed by the data-ready ISR
+ */
+extern DataReadyScheduler dataReady;
+
+/**
+ * @brief Switch the INT pin to pulse mode and attach the data-ready ISR
+ * 
+ * Call after initializeIMU(), which leaves INT latched until INT_STATUS is
+ * read and would otherwise produce a single edge. Only the latch bit of
+ * INT_PIN_CFG is changed, so the I2C bypass setting of
+ * enableAuxBurstAcquisition() is kept.
+ * 
+ * @return true if the interrupt was attached
+ */
+bool startDataReadyInterrupt(void);
+
+#endif // DATA_READY_H
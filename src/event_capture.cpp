@@ -0,0 +1,270 @@
+/**
+ * @file event_capture.cpp
+ * @brief Triggered capture of short motion events implementation
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "event_capture.h"
+#include "sd_logger.h"
+#include "packed_log.h"
+#include "log_record.h"
+#include "hal.h"
+#include <math.h>
+
+// ============================================================================
+// RING
+// ============================================================================
+
+/**
+ * @brief Raw counts of one sample
+ */
+struct EventSample
+{
+    uint32_t timestampMs;
+    int16_t counts[9];          ///< accel XYZ, gyro XYZ, mag XYZ
+    int16_t reserved;
+};
+
+static_assert(sizeof(EventSample) == EVENT_SAMPLE_SIZE, "EventSample layout changed");
+
+#if EVENT_RING_IN_PSRAM
+#define EVENT_RING_ATTR HAL_EXT_RAM_ATTR
+#else
+#define EVENT_RING_ATTR
+#endif
+
+EVENT_RING_ATTR static EventSample ring[EVENT_RING_SAMPLES];
+static uint32_t stored = 0;             ///< Samples ever stored; ring slot = stored % size
+
+// ============================================================================
+// TRIGGER STATE
+// ============================================================================
+
+enum CaptureState
+{
+    CAPTURE_ARMED = 0,
+    CAPTURE_POST_TRIGGER,
+    CAPTURE_COMPLETE                    ///< Window waiting for serviceEventCapture()
+};
+
+static CaptureState state = CAPTURE_ARMED;
+static uint32_t windowStart = 0;
+static uint32_t windowEnd = 0;
+static uint32_t postRemaining = 0;
+
+static uint32_t triggerMs = 0;
+static const char* triggerName = "";
+static float triggerValue = 0.0f;
+static FrameScale triggerScale;        ///< Conversion of the window's counts
+
+static float previousAccel[3];
+static bool havePrevious = false;
+
+static uint32_t eventsWritten = 0;
+static uint32_t droppedSamples = 0;
+
+static LogStream eventLog;
+static PackedBlockEncoder eventPacker(LOG_PACKED_BLOCK_SAMPLES);
+
+/**
+ * @brief Check the triggers against one sample
+ *
+ * @return true if one fired; triggerName and triggerValue say which
+ */
+static bool triggerFired(const ImuSample& sample)
+{
+    const float accelSq = sample.ax * sample.ax + sample.ay * sample.ay + sample.az * sample.az;
+    if (EVENT_TRIGGER_ACCEL_G > 0.0f && accelSq >= EVENT_TRIGGER_ACCEL_G * EVENT_TRIGGER_ACCEL_G)
+    {
+        triggerName = "accel";
+        triggerValue = sqrtf(accelSq);
+        return true;
+    }
+
+    const float gyroSq = sample.gx * sample.gx + sample.gy * sample.gy + sample.gz * sample.gz;
+    if (EVENT_TRIGGER_GYRO_DPS > 0.0f && gyroSq >= EVENT_TRIGGER_GYRO_DPS * EVENT_TRIGGER_GYRO_DPS)
+    {
+        triggerName = "gyro";
+        triggerValue = sqrtf(gyroSq);
+        return true;
+    }
+
+    if (EVENT_TRIGGER_JERK_G_PER_S > 0.0f && havePrevious)
+    {
+        // Per sample step at the nominal rate, compared without a division
+        const float limit = EVENT_TRIGGER_JERK_G_PER_S / IMU_SAMPLE_RATE_HZ;
+        float dx = sample.ax - previousAccel[0];
+        float dy = sample.ay - previousAccel[1];
+        float dz = sample.az - previousAccel[2];
+        float stepSq = dx * dx + dy * dy + dz * dz;
+        if (stepSq >= limit * limit)
+        {
+            triggerName = "jerk";
+            triggerValue = sqrtf(stepSq) * IMU_SAMPLE_RATE_HZ;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// ============================================================================
+// EVENT FILE
+// ============================================================================
+
+/**
+ * @brief Write the finished packed block to the event file
+ */
+static void writeEventBlock(void)
+{
+    const uint8_t* block;
+    size_t length = eventPacker.finish(block);
+    if (length > 0)
+    {
+        eventLog.write((const char*)block, length);
+    }
+}
+
+/**
+ * @brief Encode the window as packed blocks into a new event file
+ *
+ * @return Bytes in the file
+ */
+static uint32_t writeEventFile(const char* path)
+{
+    char eventLine[64];
+    ImuFrame frame;
+
+    snprintf(eventLine, sizeof(eventLine), "#event,%u,%lu,%lu,%s", (unsigned)logSessionNumber(),
+             (unsigned long)eventsWritten, (unsigned long)triggerMs, triggerName);
+    if (!eventLog.beginSegment(halStorage(), path, eventLine, ""))
+    {
+        return 0;
+    }
+
+    memset(&frame, 0, sizeof(frame));
+    frame.scale = triggerScale;
+
+    eventPacker.reset();
+    for (uint32_t n = windowStart; n != windowEnd; n++)
+    {
+        const EventSample& sample = ring[n % EVENT_RING_SAMPLES];
+        frame.timestampMs = sample.timestampMs;
+        for (int i = 0; i < 3; i++)
+        {
+            frame.accelCount[i] = sample.counts[i];
+            frame.gyroCount[i] = sample.counts[3 + i];
+            frame.magCount[i] = sample.counts[6 + i];
+        }
+
+        if (!eventPacker.add(frame))
+        {
+            writeEventBlock();
+            eventPacker.add(frame);
+        }
+    }
+    writeEventBlock();
+
+    uint32_t bytes = eventLog.segmentBytes();
+    eventLog.close();
+    return bytes;
+}
+
+// ============================================================================
+// EVENT CAPTURE FUNCTIONS
+// ============================================================================
+
+void captureEventSample(const ImuSample& sample)
+{
+    // A waiting window must not be overwritten
+    if (state == CAPTURE_COMPLETE && stored - windowStart >= EVENT_RING_SAMPLES)
+    {
+        droppedSamples++;
+        return;
+    }
+
+    EventSample& slot = ring[stored % EVENT_RING_SAMPLES];
+    slot.timestampMs = sample.timestampMs;
+    for (int i = 0; i < 3; i++)
+    {
+        slot.counts[i] = sample.accelCount[i];
+        slot.counts[3 + i] = sample.gyroCount[i];
+        slot.counts[6 + i] = sample.magCount[i];
+    }
+    slot.reserved = 0;
+    stored++;
+
+    if (state == CAPTURE_ARMED && triggerFired(sample))
+    {
+        // The window ends EVENT_PRE_TRIGGER_SAMPLES in with the triggering sample
+        windowStart = (stored > EVENT_PRE_TRIGGER_SAMPLES) ? stored - EVENT_PRE_TRIGGER_SAMPLES : 0;
+        triggerMs = sample.timestampMs;
+        triggerScale = sample.scale;
+        postRemaining = EVENT_POST_TRIGGER_SAMPLES;
+        state = CAPTURE_POST_TRIGGER;
+    }
+    else if (state == CAPTURE_POST_TRIGGER)
+    {
+        postRemaining--;
+    }
+
+    if (state == CAPTURE_POST_TRIGGER && postRemaining == 0)
+    {
+        windowEnd = stored;
+        state = CAPTURE_COMPLETE;
+    }
+
+    previousAccel[0] = sample.ax;
+    previousAccel[1] = sample.ay;
+    previousAccel[2] = sample.az;
+    havePrevious = true;
+}
+
+void serviceEventCapture(void)
+{
+    char name[24];
+    char path[LOG_PATH_SIZE];
+    char line[LOG_PATH_SIZE + 96];
+
+    if (state != CAPTURE_COMPLETE)
+    {
+        return;
+    }
+
+    snprintf(name, sizeof(name), FILE_EVENT_FORMAT, (unsigned)eventsWritten);
+    logSegmentFilePath(path, sizeof(path), name);
+
+    uint32_t startUs = halMicros();
+    uint32_t bytes = writeEventFile(path);
+    uint32_t writeUs = halMicros() - startUs;
+
+    snprintf(line, sizeof(line), "\r\n#event,%lu,%lu,%s,%.2f,%lu,%lu,%lu,%s",
+             (unsigned long)eventsWritten, (unsigned long)triggerMs, triggerName, triggerValue,
+             (unsigned long)(windowEnd - windowStart), (unsigned long)bytes,
+             (unsigned long)writeUs, path);
+    diagnosticsLog.print(line);
+
+    // The serial port carries binary frames when telemetry is on
+    if (!SERIAL_TELEMETRY_ENABLED)
+    {
+        Serial.printf("INFO: Event %lu (%s %.2f) at %lu ms: %lu samples to %s\n",
+                      (unsigned long)eventsWritten, triggerName, triggerValue,
+                      (unsigned long)triggerMs, (unsigned long)(windowEnd - windowStart), path);
+    }
+
+    eventsWritten++;
+    state = CAPTURE_ARMED;
+}
+
+uint32_t eventCaptureCount(void)
+{
+    return eventsWritten;
+}
+
+uint32_t eventDroppedSamples(void)
+{
+    return droppedSamples;
+}
@@ -0,0 +1,78 @@
+/**
+ * @file event_capture.h
+ * @brief Triggered capture of short motion events at full sample rate
+ *
+ * Every sample's raw counts go into a fixed ring sized at compile time for
+ * EVENT_PRE_TRIGGER_MS + EVENT_POST_TRIGGER_MS at IMU_SAMPLE_RATE_HZ, plus
+ * EVENT_RING_SLACK_SAMPLES. Each sample is checked against the triggers:
+ *
+ * - acceleration magnitude >= EVENT_TRIGGER_ACCEL_G
+ * - angular rate magnitude >= EVENT_TRIGGER_GYRO_DPS
+ * - jerk, the change of acceleration from the previous sample times the
+ *   sample rate, >= EVENT_TRIGGER_JERK_G_PER_S
+ *
+ * When one fires, the ring keeps filling for the post-trigger window.
+ * serviceEventCapture() then writes the whole window to the current
+ * segment directory in one burst: FILE_EVENT_FORMAT, packed blocks
+ * (packed_log.h) after an "#event,<session>,<number>,<millis>,<trigger>"
+ * line, decodable with imu_log_decode. The blocks carry the calibration
+ * of the triggering sample. A "#event" line in the diagnostics log records
+ * each one.
+ *
+ * Triggers are not checked again until the window has been written.
+ * Call both functions from one task only (the logging task in pipelined
+ * mode).
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef EVENT_CAPTURE_H
+#define EVENT_CAPTURE_H
+
+#include <stdint.h>
+#include "imu_sample.h"
+#include "config.h"
+
+// ============================================================================
+// RING SIZE
+// ============================================================================
+
+#define EVENT_PRE_TRIGGER_SAMPLES ((uint32_t)EVENT_PRE_TRIGGER_MS * IMU_SAMPLE_RATE_HZ / 1000)
+#define EVENT_POST_TRIGGER_SAMPLES ((uint32_t)EVENT_POST_TRIGGER_MS * IMU_SAMPLE_RATE_HZ / 1000)
+#define EVENT_RING_SAMPLES (EVENT_PRE_TRIGGER_SAMPLES + EVENT_POST_TRIGGER_SAMPLES + EVENT_RING_SLACK_SAMPLES)
+
+// Timestamp and nine raw counts per sample
+#define EVENT_SAMPLE_SIZE 24
+#define EVENT_RING_BYTES (EVENT_RING_SAMPLES * EVENT_SAMPLE_SIZE)
+
+// ============================================================================
+// EVENT CAPTURE FUNCTIONS
+// ============================================================================
+
+/**
+ * @brief Add one sample to the ring and check the triggers
+ *
+ * @param sample Fused sample (raw counts and scaled values)
+ */
+void captureEventSample(const ImuSample& sample);
+
+/**
+ * @brief Write out a completed event window
+ *
+ * Called once per loop pass; does nothing until a window is complete.
+ */
+void serviceEventCapture(void);
+
+/**
+ * @brief Events written this session
+ */
+uint32_t eventCaptureCount(void);
+
+/**
+ * @brief Samples not stored because a window waited longer than the slack
+ */
+uint32_t eventDroppedSamples(void);
+
+#endif // EVENT_CAPTURE_H
@@ -0,0 +1,88 @@
+/**
+ * @file fast_trig.h
+ * @brief Polynomial atan2/asin for the Euler conversion
+ *
+ * Single-precision replacements for atan2()/asin() built on an 11th-order
+ * odd minimax polynomial for atan on [-1, 1]. The worst-case error against
+ * the libm functions is below FAST_TRIG_MAX_ERROR_RAD; the benchmark report
+ * measures it on every run. Used by quaternionToEuler() when
+ * FUSION_FAST_TRIG_ENABLED is set.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef FAST_TRIG_H
+#define FAST_TRIG_H
+
+#include <math.h>
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+// Worst-case absolute error of fastAtan2f() and fastAsinf() (radians)
+#define FAST_TRIG_MAX_ERROR_RAD 4.0e-6f
+
+#define FAST_TRIG_PI 3.14159265358979323846f
+#define FAST_TRIG_HALF_PI 1.57079632679489661923f
+
+// ============================================================================
+// FAST TRIG FUNCTIONS
+// ============================================================================
+
+/**
+ * @brief atan(x) for |x| <= 1
+ */
+static inline float fastAtanUnit(float x)
+{
+    float x2 = x * x;
+    return x * (0.99997726f + x2 * (-0.33262347f + x2 * (0.19354346f +
+           x2 * (-0.11643287f + x2 * (0.05265332f + x2 * -0.01172120f)))));
+}
+
+/**
+ * @brief atan2(y, x); returns 0 for (0, 0)
+ */
+static inline float fastAtan2f(float y, float x)
+{
+    float absX = fabsf(x);
+    float absY = fabsf(y);
+    float larger = (absX > absY) ? absX : absY;
+    float smaller = (absX > absY) ? absY : absX;
+
+    if (larger == 0.0f)
+    {
+        return 0.0f;
+    }
+
+    float angle = fastAtanUnit(smaller / larger);
+    if (absY > absX)
+    {
+        angle = FAST_TRIG_HALF_PI - angle;
+    }
+    if (x < 0.0f)
+    {
+        angle = FAST_TRIG_PI - angle;
+    }
+    return (y < 0.0f) ? -angle : angle;
+}
+
+/**
+ * @brief asin(x), with @p x clamped to [-1, 1]
+ */
+static inline float fastAsinf(float x)
+{
+    if (x > 1.0f)
+    {
+        x = 1.0f;
+    }
+    else if (x < -1.0f)
+    {
+        x = -1.0f;
+    }
+    return fastAtan2f(x, sqrtf((1.0f - x) * (1.0f + x)));
+}
+
+#endif // FAST_TRIG_H
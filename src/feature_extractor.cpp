@@ -0,0 +1,136 @@
+/**
+ * @file feature_extractor.cpp
+ * @brief Windowed motion features implementation
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "feature_extractor.h"
+#include "real_fft.h"
+#include <math.h>
+#include <stdio.h>
+
+// ============================================================================
+// TABLES
+// ============================================================================
+
+/**
+ * @brief FFT tables, Hann window and spectrum scale for one window length
+ */
+struct FeatureTables
+{
+    RealFft<FEATURE_WINDOW_SAMPLES> fft;
+    float hann[FEATURE_WINDOW_SAMPLES];
+    float powerScale;                   ///< One-sided bins: 2 / (N * sum of w^2)
+
+    FeatureTables(void)
+    {
+        double windowPower = 0.0;
+        for (int n = 0; n < FEATURE_WINDOW_SAMPLES; n++)
+        {
+            // Periodic Hann, so the spectrum of a window is exact at bin centers
+            double w = 0.5 - 0.5 * cos(2.0 * M_PI * n / FEATURE_WINDOW_SAMPLES);
+            hann[n] = (float)w;
+            windowPower += w * w;
+        }
+        powerScale = (float)(2.0 / (FEATURE_WINDOW_SAMPLES * windowPower));
+    }
+};
+
+static const FeatureTables tables;
+
+// ============================================================================
+// FEATURE FUNCTIONS
+// ============================================================================
+
+int featureBandFirstBin(int band)
+{
+    return 1 + band * (FEATURE_WINDOW_SAMPLES / 2) / FEATURE_BAND_COUNT;
+}
+
+void computeWindowFeatures(float* window, WindowFeatures& features)
+{
+    const int half = FEATURE_WINDOW_SAMPLES / 2;
+    float sum = 0.0f;
+    float sumSq = 0.0f;
+    float peak = 0.0f;
+
+    for (int n = 0; n < FEATURE_WINDOW_SAMPLES; n++)
+    {
+        float x = window[n];
+        float magnitude = fabsf(x);
+        sum += x;
+        sumSq += x * x;
+        peak = (magnitude > peak) ? magnitude : peak;
+    }
+
+    float mean = sum / FEATURE_WINDOW_SAMPLES;
+    features.mean = mean;
+    features.rms = sqrtf(sumSq / FEATURE_WINDOW_SAMPLES);
+    features.peak = peak;
+
+    // Remove the mean so gravity and bias stay out of the lowest band
+    for (int n = 0; n < FEATURE_WINDOW_SAMPLES; n++)
+    {
+        window[n] = (window[n] - mean) * tables.hann[n];
+    }
+
+    tables.fft.transform(window);
+
+    for (int band = 0; band < FEATURE_BAND_COUNT; band++)
+    {
+        int last = featureBandFirstBin(band + 1);
+        float energy = 0.0f;
+        for (int k = featureBandFirstBin(band); k < last; k++)
+        {
+            // Nyquist has no mirror bin
+            float power = RealFft<FEATURE_WINDOW_SAMPLES>::power(window, k);
+            energy += (k == half) ? 0.5f * power : power;
+        }
+        features.bands[band] = energy * tables.powerScale;
+    }
+}
+
+size_t formatFeatureRecord(char* out, uint32_t timestampMs, const char* channel, const WindowFeatures& features)
+{
+    char* p = out;
+
+    *p++ = '\r';
+    *p++ = '\n';
+    p = appendUnsigned(p, timestampMs);
+    *p++ = ',';
+    for (int i = 0; i < FEATURE_CHANNEL_NAME_SIZE && channel[i] != '\0'; i++)
+    {
+        *p++ = channel[i];
+    }
+
+    *p++ = ',';
+    p = appendFixed(p, features.mean, RECORD_DECIMALS);
+    *p++ = ',';
+    p = appendFixed(p, features.rms, RECORD_DECIMALS);
+    *p++ = ',';
+    p = appendFixed(p, features.peak, RECORD_DECIMALS);
+    for (int band = 0; band < FEATURE_BAND_COUNT; band++)
+    {
+        *p++ = ',';
+        p = appendFixed(p, features.bands[band], RECORD_DECIMALS);
+    }
+    return (size_t)(p - out);
+}
+
+const char* featureLogHeader(void)
+{
+    static char header[32 + FEATURE_BAND_COUNT * 12];
+
+    if (header[0] == '\0')
+    {
+        size_t length = (size_t)snprintf(header, sizeof(header), "millis,channel,mean,rms,peak");
+        for (int band = 0; band < FEATURE_BAND_COUNT && length < sizeof(header); band++)
+        {
+            length += (size_t)snprintf(header + length, sizeof(header) - length, ",band%d", band);
+        }
+    }
+    return header;
+}
@@ -0,0 +1,98 @@
+/**
+ * @file feature_extractor.h
+ * @brief Windowed motion features: mean, RMS, peak and FFT band energies
+ *
+ * A full window of FEATURE_WINDOW_SAMPLES values of one channel is reduced
+ * in place to one WindowFeatures:
+ *
+ * - mean, RMS and peak (largest absolute value) of the samples
+ * - FEATURE_BAND_COUNT band energies of the mean-removed, Hann-windowed
+ *   signal (real_fft.h). Band b holds bins first(b) .. first(b + 1) - 1
+ *   of the one-sided spectrum, with first(b) = 1 + b * N/2 / bands, so
+ *   band b covers about b .. b + 1 times IMU_SAMPLE_RATE_HZ / 2 / bands.
+ *
+ * Band energies are one-sided power normalized by the window's power, in
+ * squared channel units. For a broadband signal they add up to about the
+ * variance of the window (RMS^2 - mean^2); a sine in the middle of a band
+ * of amplitude A puts A^2 / 2 into it.
+ *
+ * The FFT tables and the Hann window are built once at startup. This file
+ * has no Arduino dependencies so the host checks can share it.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef FEATURE_EXTRACTOR_H
+#define FEATURE_EXTRACTOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+#include "record_format.h"
+
+// ============================================================================
+// FEATURE CONSTANTS
+// ============================================================================
+
+static_assert(FEATURE_WINDOW_SAMPLES >= 8 && (FEATURE_WINDOW_SAMPLES & (FEATURE_WINDOW_SAMPLES - 1)) == 0,
+              "FEATURE_WINDOW_SAMPLES must be a power of two");
+static_assert(FEATURE_BAND_COUNT >= 1 && FEATURE_BAND_COUNT <= FEATURE_WINDOW_SAMPLES / 2,
+              "FEATURE_BAND_COUNT must be between 1 and half the window");
+
+// Mean, RMS, peak and the band energies
+#define FEATURE_VALUES (3 + FEATURE_BAND_COUNT)
+
+// Longest channel name written to the record
+#define FEATURE_CHANNEL_NAME_SIZE 8
+
+// "\r\n", a 10-digit timestamp, ",<channel>" and ",<value>" per feature
+#define FEATURE_RECORD_MAX_SIZE (2 + 10 + 1 + FEATURE_CHANNEL_NAME_SIZE + FEATURE_VALUES * (1 + RECORD_VALUE_MAX_SIZE))
+
+// ============================================================================
+// TYPES
+// ============================================================================
+
+/**
+ * @brief Features of one window of one channel
+ */
+struct WindowFeatures
+{
+    float mean;
+    float rms;
+    float peak;                             ///< Largest absolute sample
+    float bands[FEATURE_BAND_COUNT];        ///< Band energies, squared channel units
+};
+
+// ============================================================================
+// FEATURE FUNCTIONS
+// ============================================================================
+
+/**
+ * @brief Reduce one full window to its features
+ *
+ * @param window FEATURE_WINDOW_SAMPLES samples; overwritten by the spectrum
+ * @param features Destination
+ */
+void computeWindowFeatures(float* window, WindowFeatures& features);
+
+/**
+ * @brief First spectrum bin of @p band (band FEATURE_BAND_COUNT = N/2 + 1)
+ */
+int featureBandFirstBin(int band);
+
+/**
+ * @brief Format one "\r\n<millis>,<channel>,<mean>,<rms>,<peak>,<band>..." line
+ *
+ * @param out Destination, at least FEATURE_RECORD_MAX_SIZE bytes
+ * @return Characters written (not terminated)
+ */
+size_t formatFeatureRecord(char* out, uint32_t timestampMs, const char* channel, const WindowFeatures& features);
+
+/**
+ * @brief Column header of FILE_FEATURES
+ */
+const char* featureLogHeader(void);
+
+#endif // FEATURE_EXTRACTOR_H
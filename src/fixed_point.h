@@ -0,0 +1,121 @@
+/**
+ * @file fixed_point.h
+ * @brief Q-format fixed-point scalar for the fusion kernel
+ *
+ * A signed 32-bit value with FracBits fraction bits and the arithmetic
+ * operators the fusion kernel uses, so the same kernel code compiles for
+ * float and for targets without an FPU. Products and square roots go
+ * through 64-bit intermediates; nothing saturates, so callers keep values
+ * inside the format's range (+/- 2^(31 - FracBits)).
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+
+// ============================================================================
+// FIXED-POINT SCALAR
+// ============================================================================
+
+/**
+ * @brief Signed Q(31 - FracBits).FracBits fixed-point number
+ *
+ * @tparam FracBits Fraction bits (1..30)
+ */
+template <int FracBits>
+class FixedPoint
+{
+    static_assert(FracBits > 0 && FracBits < 31, "FixedPoint needs 1..30 fraction bits");
+
+public:
+    static const int32_t ONE = (int32_t)1 << FracBits;
+
+    constexpr FixedPoint(void) : raw(0) {}
+
+    /**
+     * @brief Convert from float, rounding to nearest (folds for constants)
+     */
+    constexpr FixedPoint(float value)
+        : raw((int32_t)(value * (float)ONE + (value >= 0.0f ? 0.5f : -0.5f)))
+    {
+    }
+
+    static FixedPoint fromRaw(int32_t value)
+    {
+        FixedPoint result;
+        result.raw = value;
+        return result;
+    }
+
+    float toFloat(void) const { return (float)raw / (float)ONE; }
+
+    FixedPoint operator+(FixedPoint other) const { return fromRaw(raw + other.raw); }
+    FixedPoint operator-(FixedPoint other) const { return fromRaw(raw - other.raw); }
+    FixedPoint operator-(void) const { return fromRaw(-raw); }
+
+    FixedPoint operator*(FixedPoint other) const
+    {
+        return fromRaw((int32_t)(((int64_t)raw * other.raw) >> FracBits));
+    }
+
+    FixedPoint& operator+=(FixedPoint other) { raw += other.raw; return *this; }
+    FixedPoint& operator*=(FixedPoint other) { return *this = *this * other; }
+
+    bool operator>(FixedPoint other) const { return raw > other.raw; }
+    bool operator==(FixedPoint other) const { return raw == other.raw; }
+
+    int32_t raw;
+};
+
+// ============================================================================
+// FIXED-POINT FUNCTIONS
+// ============================================================================
+
+/**
+ * @brief Integer square root, rounded down
+ */
+static inline uint64_t fixedIsqrt(uint64_t value)
+{
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+    while (bit != 0)
+    {
+        if (value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+/**
+ * @brief Sum of squares in Q(2 * FracBits), wide enough for any inputs
+ */
+template <int FracBits>
+static inline uint64_t fixedSumSquares(const FixedPoint<FracBits>* values, int count)
+{
+    uint64_t sum = 0;
+    for (int i = 0; i < count; i++)
+    {
+        sum += (uint64_t)((int64_t)values[i].raw * values[i].raw);
+    }
+    return sum;
+}
+
+#endif // FIXED_POINT_H
@@ -0,0 +1,43 @@
+/**
+ * @file fusion_engine.h
+ * @brief Compile-time selection of the firmware's fusion engine
+ *
+ * FUSION_ENGINE picks the filter and FUSION_FIXED_POINT_ENABLED the scalar;
+ * FusionEngine is the resulting concrete type, so every call on the sample
+ * path is resolved (and inlined) at compile time.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef FUSION_ENGINE_H
+#define FUSION_ENGINE_H
+
+#include "config.h"
+#include "mahony_kernel.h"
+#include "madgwick_kernel.h"
+#include "complementary_kernel.h"
+
+// ============================================================================
+// FIRMWARE ENGINE
+// ============================================================================
+
+#if (FUSION_FIXED_POINT_ENABLED)
+typedef FixedPoint<FUSION_FIXED_FRAC_BITS> FusionScalar;
+#else
+typedef float FusionScalar;
+#endif
+
+#if (FUSION_ENGINE == FUSION_ENGINE_MADGWICK)
+typedef MadgwickKernel<FusionScalar> FusionEngine;
+#define FUSION_ENGINE_NAME "madgwick"
+#elif (FUSION_ENGINE == FUSION_ENGINE_COMPLEMENTARY)
+typedef ComplementaryKernel<FusionScalar> FusionEngine;
+#define FUSION_ENGINE_NAME "complementary"
+#else
+typedef MahonyKernel<FusionScalar> FusionEngine;
+#define FUSION_ENGINE_NAME "mahony"
+#endif
+
+#endif // FUSION_ENGINE_H
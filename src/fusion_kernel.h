@@ -0,0 +1,296 @@
+/**
+ * @file fusion_kernel.h
+ * @brief Allocation-free fusion kernel framework, templated on the scalar type
+ *
+ * Shared pieces of the fusion engines: scalar operations for float and
+ * FixedPoint, the FusionBatch sample container and the FusionKernel base
+ * class. Each engine (mahony_kernel.h, madgwick_kernel.h,
+ * complementary_kernel.h) derives from FusionKernel<Engine, T> and supplies
+ * integrate(); the base calls it through the derived type, so there is no
+ * virtual dispatch on the hot path. fusion_engine.h picks the firmware's
+ * engine and scalar at compile time.
+ *
+ * updateBatch() takes a FusionBatch: inputs and per-sample output
+ * quaternions held as one array per component. It does not pay off: the
+ * quaternion recurrence is sequential and dominates the cost, and a
+ * separate normalisation pass over the batch (vectorised or not) cost
+ * more in copies than it saved, so each sample is normalised in
+ * registers as in update(). Staging the batch still makes it slower than
+ * update() per sample (fusion_batch against fusion_update in the
+ * benchmark), so the replay tool calls update().
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef FUSION_KERNEL_H
+#define FUSION_KERNEL_H
+
+#include <math.h>
+#include "config.h"
+#include "fixed_point.h"
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+// Magnetometer inputs (milliGauss) are scaled by this before conversion to
+// the kernel scalar so they fit the fixed-point range. Only the direction
+// is used and the scale is a power of two, so float results are unchanged.
+#define FUSION_MAG_INPUT_SCALE (1.0f / 1024.0f)
+
+// ============================================================================
+// SCALAR OPERATIONS
+// ============================================================================
+
+static inline float fusionToFloat(float value)
+{
+    return value;
+}
+
+/**
+ * @brief Normalise (x, y, z) in place
+ *
+ * @return false for a zero vector, which is left unchanged
+ */
+static inline bool fusionNormalize3(float& x, float& y, float& z)
+{
+    float norm = sqrtf(x * x + y * y + z * z);
+    bool nonZero = (norm != 0.0f);
+    norm = 1.0f / (nonZero ? norm : 1.0f);
+    x *= norm;
+    y *= norm;
+    z *= norm;
+    return nonZero;
+}
+
+/**
+ * @brief Normalise (a, b, c, d) in place; a zero vector is left unchanged
+ */
+static inline void fusionNormalize4(float& a, float& b, float& c, float& d)
+{
+    float norm = sqrtf(a * a + b * b + c * c + d * d);
+    norm = 1.0f / ((norm != 0.0f) ? norm : 1.0f);
+    a *= norm;
+    b *= norm;
+    c *= norm;
+    d *= norm;
+}
+
+static inline float fusionHypot(float a, float b)
+{
+    return sqrtf((a * a) + (b * b));
+}
+
+template <int F>
+static inline float fusionToFloat(FixedPoint<F> value)
+{
+    return value.toFloat();
+}
+
+template <int F>
+static inline bool fusionNormalize3(FixedPoint<F>& x, FixedPoint<F>& y, FixedPoint<F>& z)
+{
+    FixedPoint<F> v[3] = {x, y, z};
+    int64_t norm = (int64_t)fixedIsqrt(fixedSumSquares(v, 3));
+    if (norm == 0)
+    {
+        return false;
+    }
+    x.raw = (int32_t)(((int64_t)x.raw << F) / norm);
+    y.raw = (int32_t)(((int64_t)y.raw << F) / norm);
+    z.raw = (int32_t)(((int64_t)z.raw << F) / norm);
+    return true;
+}
+
+template <int F>
+static inline void fusionNormalize4(FixedPoint<F>& a, FixedPoint<F>& b, FixedPoint<F>& c, FixedPoint<F>& d)
+{
+    FixedPoint<F> v[4] = {a, b, c, d};
+    int64_t norm = (int64_t)fixedIsqrt(fixedSumSquares(v, 4));
+    if (norm == 0)
+    {
+        return;
+    }
+    a.raw = (int32_t)(((int64_t)a.raw << F) / norm);
+    b.raw = (int32_t)(((int64_t)b.raw << F) / norm);
+    c.raw = (int32_t)(((int64_t)c.raw << F) / norm);
+    d.raw = (int32_t)(((int64_t)d.raw << F) / norm);
+}
+
+template <int F>
+static inline FixedPoint<F> fusionHypot(FixedPoint<F> a, FixedPoint<F> b)
+{
+    FixedPoint<F> v[2] = {a, b};
+    return FixedPoint<F>::fromRaw((int32_t)fixedIsqrt(fixedSumSquares(v, 2)));
+}
+
+// ============================================================================
+// BATCH
+// ============================================================================
+
+/**
+ * @brief Up to N samples in struct-of-arrays layout
+ *
+ * Filled with push(), consumed by FusionKernel::updateBatch(), which
+ * writes the quaternion after each sample to q0..q3.
+ */
+template <typename T, int N>
+struct FusionBatch
+{
+    T ax[N], ay[N], az[N];
+    T gx[N], gy[N], gz[N];
+    T mx[N], my[N], mz[N];
+    T dt[N];
+    T q0[N], q1[N], q2[N], q3[N];
+    int count;
+
+    FusionBatch(void) : count(0) {}
+
+    void clear(void) { count = 0; }
+    bool full(void) const { return count == N; }
+
+    /**
+     * @brief Append one sample (same units as MahonyFilter::update())
+     *
+     * @return false if the batch is full
+     */
+    bool push(float accelX, float accelY, float accelZ, float gyroX, float gyroY, float gyroZ,
+              float magX, float magY, float magZ, float deltat)
+    {
+        if (count == N)
+        {
+            return false;
+        }
+        ax[count] = T(accelX);
+        ay[count] = T(accelY);
+        az[count] = T(accelZ);
+        gx[count] = T(gyroX);
+        gy[count] = T(gyroY);
+        gz[count] = T(gyroZ);
+        mx[count] = T(magX * FUSION_MAG_INPUT_SCALE);
+        my[count] = T(magY * FUSION_MAG_INPUT_SCALE);
+        mz[count] = T(magZ * FUSION_MAG_INPUT_SCALE);
+        dt[count] = T(deltat);
+        count++;
+        return true;
+    }
+
+    /**
+     * @brief Quaternion after sample @p index, as float
+     */
+    void quaternion(int index, float* q) const
+    {
+        q[0] = fusionToFloat(q0[index]);
+        q[1] = fusionToFloat(q1[index]);
+        q[2] = fusionToFloat(q2[index]);
+        q[3] = fusionToFloat(q3[index]);
+    }
+};
+
+// ============================================================================
+// FUSION KERNEL
+// ============================================================================
+
+/**
+ * @brief Quaternion state and update loops shared by every engine
+ *
+ * @tparam Engine Derived engine; provides
+ *         integrate(ax, ay, az, gx, gy, gz, mx, my, mz, deltat) taking
+ *         normalised accel and mag vectors and updating q0..q3
+ * @tparam T Scalar type (float or FixedPoint)
+ */
+template <typename Engine, typename T>
+class FusionKernel
+{
+public:
+    /**
+     * @brief Return to the identity quaternion (engines also clear their own state)
+     */
+    void resetQuaternion(void)
+    {
+        q0 = T(1.0f);
+        q1 = T(0.0f);
+        q2 = T(0.0f);
+        q3 = T(0.0f);
+        publish();
+    }
+
+    /**
+     * @brief Integrate one sample
+     *
+     * @param ax, ay, az Acceleration (any unit, normalised internally)
+     * @param gx, gy, gz Angular rate (rad/s)
+     * @param mx, my, mz Magnetic field (milliGauss, normalised internally)
+     * @param deltat Integration interval in seconds
+     */
+    void update(float ax, float ay, float az, float gx, float gy, float gz,
+                float mx, float my, float mz, float deltat)
+    {
+        T a[3] = {T(ax), T(ay), T(az)};
+        T m[3] = {T(mx * FUSION_MAG_INPUT_SCALE), T(my * FUSION_MAG_INPUT_SCALE), T(mz * FUSION_MAG_INPUT_SCALE)};
+
+        if (fusionNormalize3(a[0], a[1], a[2]) && fusionNormalize3(m[0], m[1], m[2]))
+        {
+            engine().integrate(a[0], a[1], a[2], T(gx), T(gy), T(gz), m[0], m[1], m[2], T(deltat));
+            publish();
+        }
+    }
+
+    /**
+     * @brief Integrate every sample in @p batch, in order
+     *
+     * Samples with a zero accel or mag vector are skipped, as in update().
+     */
+    template <int N>
+    void updateBatch(FusionBatch<T, N>& batch)
+    {
+        const int count = batch.count;
+
+        for (int i = 0; i < count; i++)
+        {
+            T ax = batch.ax[i], ay = batch.ay[i], az = batch.az[i];
+            T mx = batch.mx[i], my = batch.my[i], mz = batch.mz[i];
+
+            if (fusionNormalize3(ax, ay, az) && fusionNormalize3(mx, my, mz))
+            {
+                engine().integrate(ax, ay, az, batch.gx[i], batch.gy[i], batch.gz[i], mx, my, mz, batch.dt[i]);
+            }
+            batch.q0[i] = q0;
+            batch.q1[i] = q1;
+            batch.q2[i] = q2;
+            batch.q3[i] = q3;
+        }
+
+        publish();
+    }
+
+    /**
+     * @brief Current orientation quaternion (q0, qx, qy, qz) as float
+     */
+    const float* quaternion(void) const { return q; }
+
+protected:
+    FusionKernel(void)
+    {
+        resetQuaternion();
+    }
+
+    T q0, q1, q2, q3;
+
+private:
+    Engine& engine(void) { return *static_cast<Engine*>(this); }
+
+    void publish(void)
+    {
+        q[0] = fusionToFloat(q0);
+        q[1] = fusionToFloat(q1);
+        q[2] = fusionToFloat(q2);
+        q[3] = fusionToFloat(q3);
+    }
+
+    float q[4];
+};
+
+#endif // FUSION_KERNEL_H
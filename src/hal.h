@@ -0,0 +1,152 @@
+/**
+ * @file hal.h
+ * @brief Hardware abstraction layer
+ * 
+ * Thin layer between the application modules and the platform: time,
+ * status display, storage and bring-up. On the M5Stack it forwards to
+ * millis()/micros(), M5.Lcd and SD (hal_esp32.cpp); in the native host
+ * simulator build it is backed by a virtual clock, an LCD stand-in and a
+ * directory-backed file system (host/hal_host.cpp).
+ * 
+ * Serial and the MPU9250 driver keep their Arduino/M5Stack interfaces;
+ * the host build provides register-compatible stand-ins for both.
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+// Interrupt handlers must be placed in IRAM on the ESP32
+#ifdef ARDUINO
+#define HAL_ISR_ATTR IRAM_ATTR
+#else
+#define HAL_ISR_ATTR
+#endif
+
+// Static buffers allowed to live in external PSRAM (needs
+// CONFIG_SPIRAM_ALLOW_BSS_EXT_MEM, otherwise they stay in internal RAM)
+#if defined(ARDUINO) && defined(EXT_RAM_ATTR)
+#define HAL_EXT_RAM_ATTR EXT_RAM_ATTR
+#else
+#define HAL_EXT_RAM_ATTR
+#endif
+
+// Display size in pixels (landscape)
+#define HAL_LCD_WIDTH 320
+#define HAL_LCD_HEIGHT 240
+
+// RGB565 colours
+#define HAL_COLOR_BLACK 0x0000
+#define HAL_COLOR_WHITE 0xFFFF
+#define HAL_COLOR_BLUE 0x001F
+#define HAL_COLOR_GREEN 0x07E0
+#define HAL_COLOR_RED 0xF800
+#define HAL_COLOR_YELLOW 0xFFE0
+#define HAL_COLOR_GREY 0x8410
+
+// ============================================================================
+// TYPES
+// ============================================================================
+
+/**
+ * @brief System states shown on the display
+ */
+enum StatusColor
+{
+    STATUS_WAITING,     ///< Blue: waiting for startup stabilization
+    STATUS_RECORDING,   ///< Green: recording
+    STATUS_ERROR        ///< Red: error occurred
+};
+
+// ============================================================================
+// PLATFORM FUNCTIONS
+// ============================================================================
+
+/**
+ * @brief Bring up serial, I2C, display and storage
+ * 
+ * @param baudRate Serial console baud rate
+ */
+void halBegin(uint32_t baudRate);
+
+/**
+ * @brief Milliseconds since boot
+ */
+uint32_t halMillis(void);
+
+/**
+ * @brief Microseconds since boot
+ */
+uint32_t halMicros(void);
+
+/**
+ * @brief Free-running CPU clock in microseconds, for profiling
+ * 
+ * Same as halMicros() on the device. In the host simulator halMicros() is
+ * virtual time and only moves on modeled I/O, so this returns the host
+ * wall clock instead.
+ */
+uint32_t halProfileMicros(void);
+
+/**
+ * @brief CPU cycle counter (wraps), for timing short code sections
+ */
+uint32_t halCycleCount(void);
+
+/**
+ * @brief halCycleCount() ticks per microsecond
+ */
+uint32_t halCyclesPerMicrosecond(void);
+
+/**
+ * @brief Block for @p ms milliseconds
+ */
+void halDelay(uint32_t ms);
+
+/**
+ * @brief Set the display backlight brightness
+ */
+void halSetBrightness(uint8_t brightness);
+
+/**
+ * @brief Show a system state on the display
+ */
+void halShowStatus(StatusColor status);
+
+/**
+ * @brief Copy a block of RGB565 pixels to the display
+ * 
+ * Blocks until the block is on the SPI bus (about 0.4 us per pixel at
+ * 40 MHz), so callers keep blocks small.
+ * 
+ * @param pixels @p width x @p height pixels, row by row, in CPU byte order
+ */
+void halDisplayPush(int16_t x, int16_t y, int16_t width, int16_t height, const uint16_t* pixels);
+
+/**
+ * @brief Call @p handler on each rising edge of the IMU INT line
+ * 
+ * @param handler Interrupt handler (declare with HAL_ISR_ATTR)
+ * @return true if the interrupt was attached
+ */
+bool halAttachDataReadyInterrupt(void (*handler)(void));
+
+/**
+ * @brief File system used for data logging
+ */
+fs::FS& halStorage(void);
+
+/**
+ * @brief Free space on the log storage in bytes
+ * 
+ * Can take long on the device the first time (the FAT free-cluster count).
+ */
+uint64_t halStorageFreeBytes(void);
+
+#endif // HAL_H
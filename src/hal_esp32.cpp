@@ -0,0 +1,105 @@
+/**
+ * @file hal_esp32.cpp
+ * @brief Hardware abstraction layer for the M5Stack Core
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifdef ARDUINO
+
+#include "hal.h"
+#include "config.h"
+#include <M5Stack.h>
+#include <Wire.h>
+
+// ============================================================================
+// PLATFORM FUNCTIONS
+// ============================================================================
+
+void halBegin(uint32_t baudRate)
+{
+    Wire.begin();
+    Serial.begin(baudRate);
+    M5.begin();
+
+    // Dashboard sprites are RGB565 in CPU byte order
+    M5.Lcd.setSwapBytes(true);
+}
+
+uint32_t halMillis(void)
+{
+    return millis();
+}
+
+uint32_t halMicros(void)
+{
+    return micros();
+}
+
+uint32_t halProfileMicros(void)
+{
+    return micros();
+}
+
+uint32_t halCycleCount(void)
+{
+    return ESP.getCycleCount();
+}
+
+uint32_t halCyclesPerMicrosecond(void)
+{
+    return ESP.getCpuFreqMHz();
+}
+
+void halDelay(uint32_t ms)
+{
+    delay(ms);
+}
+
+void halSetBrightness(uint8_t brightness)
+{
+    M5.Lcd.setBrightness(brightness);
+}
+
+void halShowStatus(StatusColor status)
+{
+    switch (status)
+    {
+    case STATUS_WAITING:
+        M5.Lcd.fillScreen(BLUE);
+        break;
+    case STATUS_RECORDING:
+        M5.Lcd.fillScreen(GREEN);
+        break;
+    case STATUS_ERROR:
+    default:
+        M5.Lcd.fillScreen(RED);
+        break;
+    }
+}
+
+void halDisplayPush(int16_t x, int16_t y, int16_t width, int16_t height, const uint16_t* pixels)
+{
+    M5.Lcd.pushImage(x, y, width, height, (uint16_t*)pixels);
+}
+
+bool halAttachDataReadyInterrupt(void (*handler)(void))
+{
+    pinMode(IMU_INT_PIN, INPUT);
+    attachInterrupt(digitalPinToInterrupt(IMU_INT_PIN), handler, RISING);
+    return true;
+}
+
+fs::FS& halStorage(void)
+{
+    return SD;
+}
+
+uint64_t halStorageFreeBytes(void)
+{
+    return SD.totalBytes() - SD.usedBytes();
+}
+
+#endif // ARDUINO
@@ -0,0 +1,45 @@
+/**
+ * @file imu_sample.h
+ * @brief Snapshot of one fused IMU sample
+ * 
+ * Plain value type carrying everything the output stages need about one
+ * sample, so acquisition and logging do not have to share the global
+ * MPU9250 instance or the quaternion filter state. That includes the scale
+ * factors and calibration the raw counts were converted with, which the
+ * sampling task may update while the logging task still has older samples
+ * queued.
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef IMU_SAMPLE_H
+#define IMU_SAMPLE_H
+
+#include <stdint.h>
+#include "log_record.h"
+
+// ============================================================================
+// SAMPLE STRUCTURE
+// ============================================================================
+
+struct ImuSample
+{
+    uint32_t timestampMs;       ///< millis() when the sample was fused
+    float deltat;               ///< Filter integration interval (seconds)
+
+    int16_t accelCount[3];      ///< Raw accelerometer ADC counts
+    int16_t gyroCount[3];       ///< Raw gyroscope ADC counts
+    int16_t magCount[3];        ///< Raw magnetometer ADC counts
+
+    float ax, ay, az;           ///< Acceleration (g)
+    float gx, gy, gz;           ///< Angular rate (deg/s)
+    float mx, my, mz;           ///< Magnetic field (mG), body frame
+
+    float q[4];                 ///< Orientation quaternion after fusion
+
+    FrameScale scale;           ///< Conversion of the raw counts above
+};
+
+#endif // IMU_SAMPLE_H
@@ -8,16 +8,30 @@
  */
 
 #include "imu_sensor.h"
+#include "calibration.h"
+#include "sensor_scaling.h"
 #include "sd_logger.h"
+#include "record_format.h"
+#include "instrumentation.h"
 #include "config.h"
-#include <M5Stack.h>
+#include "hal.h"
+#include <string.h>
 
 // ============================================================================
 // GLOBAL VARIABLES
 // ============================================================================
 
 MPU9250 imuSensor;
-extern char msg[MSG_BUFFER_SIZE];
+
+static uint32_t fifoOverflows = 0;
+static uint32_t lastFifoTimestampUs = 0;
+static bool auxBurstActive = false;
+
+static ScalingTable scaling;
+static FrameScale frameScale;       ///< The same conversion, unfolded for the binary log
+static bool gyroScalingPending = false;
+static bool magScalingPending = false;
+static float magFieldScale[3];      ///< mG per count before correction (AK8963 axes)
 
 // ============================================================================
 // IMU INITIALIZATION FUNCTIONS
@@ -55,8 +69,28 @@ void performIMUSelfTest(void)
 
 void initializeIMU(void)
 {
-    imuSensor.calibrateMPU9250(imuSensor.gyroBias, imuSensor.accelBias);
+    if (calibrationRestored())
+    {
+        // Stored bias is removed in software; clear offsets left by an
+        // earlier calibration without a power cycle
+        for (uint8_t reg = XG_OFFSET_H; reg <= ZG_OFFSET_L; reg++)
+        {
+            imuSensor.writeByte(MPU9250_ADDRESS, reg, 0x00);
+        }
+
+        // Diagnostics report the stored values
+        memcpy(imuSensor.gyroBias, gyroBiasCorrection(), sizeof(imuSensor.gyroBias));
+        memcpy(imuSensor.accelBias, accelBiasEstimate(), sizeof(imuSensor.accelBias));
+        memcpy(imuSensor.SelfTest, selfTestTrims(), sizeof(imuSensor.SelfTest));
+        Serial.println("INFO: Using stored gyro bias, skipping MPU9250 calibration");
+    }
+    else
+    {
+        imuSensor.calibrateMPU9250(imuSensor.gyroBias, imuSensor.accelBias);
+        setStartupCalibration(imuSensor.gyroBias, imuSensor.accelBias, imuSensor.SelfTest);
+    }
     imuSensor.initMPU9250();
+    refreshScaling();
     Serial.println("INFO: MPU9250 initialized for active data mode");
 }
 
@@ -72,6 +106,8 @@ void initializeMagnetometer(void)
     imuSensor.initAK8963(imuSensor.magCalibration);
     Serial.println("INFO: AK8963 initialized for active data mode");
 
+    refreshScaling();
+
     Serial.println("INFO: Magnetometer calibration values:");
     Serial.print("  X-Axis sensitivity: ");
     Serial.println(imuSensor.magCalibration[0], 2);
@@ -81,44 +117,360 @@ void initializeMagnetometer(void)
     Serial.println(imuSensor.magCalibration[2], 2);
 }
 
+void enableFifoAcquisition(void)
+{
+    uint8_t userCtrl = imuSensor.readByte(MPU9250_ADDRESS, USER_CTRL);
+
+    // Stop capture, reset, then enable accel + gyro frames
+    imuSensor.writeByte(MPU9250_ADDRESS, FIFO_EN, 0x00);
+    imuSensor.writeByte(MPU9250_ADDRESS, USER_CTRL, userCtrl | MPU9250_USER_CTRL_FIFO_RST);
+    imuSensor.writeByte(MPU9250_ADDRESS, USER_CTRL, userCtrl | MPU9250_USER_CTRL_FIFO_EN);
+    imuSensor.writeByte(MPU9250_ADDRESS, FIFO_EN, MPU9250_FIFO_EN_ACCEL_GYRO);
+
+    refreshScaling();
+    lastFifoTimestampUs = halMicros();
+    Serial.println("INFO: MPU9250 FIFO acquisition enabled");
+}
+
+void enableAuxBurstAcquisition(void)
+{
+    uint8_t pinConfig = imuSensor.readByte(MPU9250_ADDRESS, INT_PIN_CFG);
+    uint8_t userCtrl = imuSensor.readByte(MPU9250_ADDRESS, USER_CTRL);
+
+    // The master and the bypass switch must not both drive the auxiliary bus
+    imuSensor.writeByte(MPU9250_ADDRESS, INT_PIN_CFG, pinConfig & (uint8_t)~MPU9250_INT_PIN_CFG_BYPASS_EN);
+    imuSensor.writeByte(MPU9250_ADDRESS, I2C_MST_CTRL, MPU9250_I2C_MST_WAIT_FOR_ES | MPU9250_I2C_MST_CLK_400KHZ);
+    imuSensor.writeByte(MPU9250_ADDRESS, I2C_MST_DELAY_CTRL, MPU9250_DELAY_ES_SHADOW);
+
+    // Slave 0: read ST1 through ST2 every sample; reading ST2 releases the AK8963 data lock
+    imuSensor.writeByte(MPU9250_ADDRESS, I2C_SLV0_ADDR, MPU9250_I2C_SLV_READ | AK8963_ADDRESS);
+    imuSensor.writeByte(MPU9250_ADDRESS, I2C_SLV0_REG, AK8963_ST1);
+    imuSensor.writeByte(MPU9250_ADDRESS, I2C_SLV0_CTRL, MPU9250_I2C_SLV_EN | IMU_AUX_MAG_BYTES);
+    imuSensor.writeByte(MPU9250_ADDRESS, USER_CTRL, userCtrl | MPU9250_USER_CTRL_I2C_MST_EN);
+
+    auxBurstActive = true;
+    Serial.println("INFO: AK8963 mirrored by the MPU9250 I2C master, 9-axis burst reads enabled");
+}
+
+void setImuRate(uint8_t sampleRateDivider, uint8_t dlpf)
+{
+    // DLPF settings 1..6 keep the 1 kHz internal rate SMPLRT_DIV divides
+    imuSensor.writeByte(MPU9250_ADDRESS, SMPLRT_DIV, sampleRateDivider);
+    imuSensor.writeByte(MPU9250_ADDRESS, CONFIG, dlpf & 0x07);
+    imuSensor.writeByte(MPU9250_ADDRESS, ACCEL_CONFIG2, dlpf & 0x07);
+}
+
 // ============================================================================
 // DATA ACQUISITION FUNCTIONS
 // ============================================================================
 
-void readIMUData(void)
+/**
+ * @brief Fold the current gyro bias into the scaling table
+ */
+static void rebuildGyroScaling(void)
 {
-    // Read acceleration data
-    imuSensor.readAccelData(imuSensor.accelCount);
-    imuSensor.getAres();
-    imuSensor.ax = (float)imuSensor.accelCount[0] * imuSensor.aRes;
-    imuSensor.ay = (float)imuSensor.accelCount[1] * imuSensor.aRes;
-    imuSensor.az = (float)imuSensor.accelCount[2] * imuSensor.aRes;
+    buildGyroTransform(scaling.sensor[SCALING_GYRO], imuSensor.gRes, gyroBiasCorrection());
+    memcpy(frameScale.gyroBias, gyroBiasCorrection(), sizeof(frameScale.gyroBias));
+    gyroScalingPending = false;
+}
 
-    // Read gyroscope data
-    imuSensor.readGyroData(imuSensor.gyroCount);
-    imuSensor.getGres();
-    imuSensor.gx = (float)imuSensor.gyroCount[0] * imuSensor.gRes;
-    imuSensor.gy = (float)imuSensor.gyroCount[1] * imuSensor.gRes;
-    imuSensor.gz = (float)imuSensor.gyroCount[2] * imuSensor.gRes;
+/**
+ * @brief Fold the current magnetometer correction into the scaling table
+ */
+static void rebuildMagScaling(void)
+{
+    buildMagTransform(scaling.sensor[SCALING_MAG], imuSensor.mRes, imuSensor.magCalibration, magCorrection());
+    magSensitivity(imuSensor.mRes, imuSensor.magCalibration, magFieldScale);
+
+    frameScale.mRes = imuSensor.mRes;
+    for (int i = 0; i < 3; i++)
+    {
+        imuSensor.magbias[i] = magCorrection().offset[i];
+        frameScale.magCalibration[i] = imuSensor.magCalibration[i];
+        frameScale.magbias[i] = magCorrection().offset[i];
+    }
+    memcpy(frameScale.magMatrix, magCorrection().matrix, sizeof(frameScale.magMatrix));
+    magScalingPending = false;
+}
 
-    // Read magnetometer data
-    imuSensor.readMagData(imuSensor.magCount);
+void refreshScaling(void)
+{
+    imuSensor.getAres();
+    imuSensor.getGres();
     imuSensor.getMres();
-    
-    // Apply magnetometer bias corrections
-    imuSensor.magbias[0] = MAG_BIAS_X;
-    imuSensor.magbias[1] = MAG_BIAS_Y;
-    imuSensor.magbias[2] = MAG_BIAS_Z;
 
-    // Calculate magnetometer values with calibration
-    imuSensor.mx = (float)imuSensor.magCount[0] * imuSensor.mRes * imuSensor.magCalibration[0] - imuSensor.magbias[0];
-    imuSensor.my = (float)imuSensor.magCount[1] * imuSensor.mRes * imuSensor.magCalibration[1] - imuSensor.magbias[1];
-    imuSensor.mz = (float)imuSensor.magCount[2] * imuSensor.mRes * imuSensor.magCalibration[2] - imuSensor.magbias[2];
+    buildAccelTransform(scaling.sensor[SCALING_ACCEL], imuSensor.aRes);
+    frameScale.aRes = imuSensor.aRes;
+    frameScale.gRes = imuSensor.gRes;
+    rebuildGyroScaling();
+    rebuildMagScaling();
+}
+
+const FrameScale& sensorScale(void)
+{
+    return frameScale;
+}
+
+/**
+ * @brief Feed the scaled accel/gyro sample to the streaming calibrator
+ * 
+ * A new bias applies from the next sample on, so the current one keeps
+ * matching sensorScale().
+ */
+static void observeMotion(void)
+{
+    const float accel[3] = {imuSensor.ax, imuSensor.ay, imuSensor.az};
+    const float gyro[3] = {imuSensor.gx, imuSensor.gy, imuSensor.gz};
+
+    if (calibrationObserveMotion(accel, gyro))
+    {
+        gyroScalingPending = true;
+        memcpy(imuSensor.accelBias, accelBiasEstimate(), sizeof(imuSensor.accelBias));
+    }
+}
+
+/**
+ * @brief Feed the uncorrected magnetometer reading to the streaming calibrator
+ * 
+ * Like observeMotion(), an adopted correction applies from the next reading.
+ */
+static void observeMag(void)
+{
+    float field[3];
+    for (int i = 0; i < 3; i++)
+    {
+        field[i] = (float)imuSensor.magCount[i] * magFieldScale[i];
+    }
+
+    if (calibrationObserveMag(field))
+    {
+        magScalingPending = true;
+    }
+}
+
+static int16_t bigEndian(const uint8_t* p)
+{
+    return (int16_t)(((int16_t)p[0] << 8) | p[1]);
+}
+
+/**
+ * @brief Take the mirrored AK8963 counts unless they overflowed
+ * 
+ * The master copies the data registers every sample, so they always hold
+ * the latest measurement. ST1 DRDY only marks the first copy after a new
+ * one and is lost when a read misses that sample, so it is not checked.
+ * 
+ * @param mirror EXT_SENS_DATA_00..07 (ST1, HXL..HZH, ST2)
+ */
+static void decodeAuxMag(const uint8_t* mirror)
+{
+    if (!(mirror[7] & AK8963_ST2_HOFL))
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            imuSensor.magCount[i] = (int16_t)(((int16_t)mirror[2 + 2 * i] << 8) | mirror[1 + 2 * i]);
+        }
+    }
+}
+
+/**
+ * @brief Read accel, temperature, gyro and the mirrored AK8963 in one transfer
+ */
+static void readImuBurst(void)
+{
+    uint8_t raw[IMU_BURST_SIZE];
+
+    imuSensor.readBytes(MPU9250_ADDRESS, ACCEL_XOUT_H, IMU_BURST_SIZE, raw);
+    for (int i = 0; i < 3; i++)
+    {
+        imuSensor.accelCount[i] = bigEndian(&raw[2 * i]);
+        imuSensor.gyroCount[i] = bigEndian(&raw[GYRO_XOUT_H - ACCEL_XOUT_H + 2 * i]);
+    }
+    imuSensor.tempCount = bigEndian(&raw[TEMP_OUT_H - ACCEL_XOUT_H]);
+    decodeAuxMag(&raw[EXT_SENS_DATA_00 - ACCEL_XOUT_H]);
+}
+
+void readIMUData(void)
+{
+    INSTRUMENT_BEGIN(STAGE_I2C_READ);
+
+    if (gyroScalingPending)
+    {
+        rebuildGyroScaling();
+    }
+    if (magScalingPending)
+    {
+        rebuildMagScaling();
+    }
+
+    if (auxBurstActive)
+    {
+        readImuBurst();
+    }
+    else
+    {
+        imuSensor.readAccelData(imuSensor.accelCount);
+        imuSensor.readGyroData(imuSensor.gyroCount);
+        imuSensor.readMagData(imuSensor.magCount);
+    }
+
+    // One pass over the whole sample
+    const int16_t* counts[SCALING_SENSOR_COUNT] = {imuSensor.accelCount, imuSensor.gyroCount, imuSensor.magCount};
+    float scaled[SCALING_SENSOR_COUNT][3];
+    scaleImuSample(scaling, counts, scaled);
+
+    imuSensor.ax = scaled[SCALING_ACCEL][0];
+    imuSensor.ay = scaled[SCALING_ACCEL][1];
+    imuSensor.az = scaled[SCALING_ACCEL][2];
+    imuSensor.gx = scaled[SCALING_GYRO][0];
+    imuSensor.gy = scaled[SCALING_GYRO][1];
+    imuSensor.gz = scaled[SCALING_GYRO][2];
+    imuSensor.mx = scaled[SCALING_MAG][0];
+    imuSensor.my = scaled[SCALING_MAG][1];
+    imuSensor.mz = scaled[SCALING_MAG][2];
+
+    if (CALIBRATION_STORE_ENABLED)
+    {
+        observeMotion();
+    }
+    if (CALIBRATION_ENGINE_ENABLED)
+    {
+        observeMag();
+    }
+
+    INSTRUMENT_END(STAGE_I2C_READ);
+}
+
+void readMagnetometerData(void)
+{
+    float mag[3];
+
+    if (magScalingPending)
+    {
+        rebuildMagScaling();
+    }
+
+    if (auxBurstActive)
+    {
+        uint8_t mirror[IMU_AUX_MAG_BYTES];
+        imuSensor.readBytes(MPU9250_ADDRESS, EXT_SENS_DATA_00, IMU_AUX_MAG_BYTES, mirror);
+        decodeAuxMag(mirror);
+    }
+    else
+    {
+        imuSensor.readMagData(imuSensor.magCount);
+    }
+    applyTransform(scaling.sensor[SCALING_MAG], imuSensor.magCount, mag);
+    imuSensor.mx = mag[0];
+    imuSensor.my = mag[1];
+    imuSensor.mz = mag[2];
+
+    if (CALIBRATION_ENGINE_ENABLED)
+    {
+        observeMag();
+    }
+}
+
+int readFifoBatch(FifoBatch& batch)
+{
+    uint8_t countBytes[2];
+    uint8_t data[IMU_FIFO_MAX_BURST_FRAMES * IMU_FIFO_FRAME_SIZE];
+
+    batch.frames = 0;
+    imuSensor.readBytes(MPU9250_ADDRESS, FIFO_COUNTH, 2, countBytes);
+    uint32_t now = halMicros();
+    uint16_t queued = ((uint16_t)(countBytes[0] & 0x1F) << 8) | countBytes[1];
+
+    // A full or misaligned FIFO means frames were lost; start over
+    if (queued > IMU_FIFO_CAPACITY - IMU_FIFO_FRAME_SIZE || (queued % IMU_FIFO_FRAME_SIZE) != 0)
+    {
+        uint8_t userCtrl = imuSensor.readByte(MPU9250_ADDRESS, USER_CTRL);
+        imuSensor.writeByte(MPU9250_ADDRESS, USER_CTRL, userCtrl | MPU9250_USER_CTRL_FIFO_RST);
+        fifoOverflows++;
+        lastFifoTimestampUs = halMicros();
+        return 0;
+    }
+
+    int queuedFrames = queued / IMU_FIFO_FRAME_SIZE;
+    int frames = queuedFrames;
+    if (frames > IMU_FIFO_MAX_BURST_FRAMES)
+    {
+        frames = IMU_FIFO_MAX_BURST_FRAMES;
+    }
+    if (frames == 0)
+    {
+        return 0;
+    }
+
+    imuSensor.readBytes(MPU9250_ADDRESS, FIFO_R_W, frames * IMU_FIFO_FRAME_SIZE, data);
+
+    // Frames are evenly spaced at the ODR; only re-anchor to the wall clock
+    // when the reconstructed time drifts by more than one period. The newest
+    // queued frame, not the newest one read, was taken when the count was
+    // read: a burst may leave frames behind.
+    const uint32_t periodUs = 1000000UL / IMU_SAMPLE_RATE_HZ;
+    uint32_t newest = lastFifoTimestampUs + queuedFrames * periodUs;
+    int32_t drift = (int32_t)(now - newest);
+    if (drift > (int32_t)periodUs || drift < -(int32_t)periodUs)
+    {
+        lastFifoTimestampUs = now - queuedFrames * periodUs;
+    }
+
+    for (int i = 0; i < frames; i++)
+    {
+        const uint8_t* frame = &data[i * IMU_FIFO_FRAME_SIZE];
+        for (int axis = 0; axis < 3; axis++)
+        {
+            batch.accelCount[i][axis] = (int16_t)(((int16_t)frame[2 * axis] << 8) | frame[2 * axis + 1]);
+            batch.gyroCount[i][axis] = (int16_t)(((int16_t)frame[6 + 2 * axis] << 8) | frame[6 + 2 * axis + 1]);
+        }
+        lastFifoTimestampUs += periodUs;
+        batch.timestampUs[i] = lastFifoTimestampUs;
+    }
+
+    batch.frames = frames;
+    return frames;
+}
+
+void applyFifoFrame(const FifoBatch& batch, int index)
+{
+    float accel[3];
+    float gyro[3];
+
+    if (gyroScalingPending)
+    {
+        rebuildGyroScaling();
+    }
+    for (int axis = 0; axis < 3; axis++)
+    {
+        imuSensor.accelCount[axis] = batch.accelCount[index][axis];
+        imuSensor.gyroCount[axis] = batch.gyroCount[index][axis];
+    }
+
+    applyTransform(scaling.sensor[SCALING_ACCEL], imuSensor.accelCount, accel);
+    applyTransform(scaling.sensor[SCALING_GYRO], imuSensor.gyroCount, gyro);
+    imuSensor.ax = accel[0];
+    imuSensor.ay = accel[1];
+    imuSensor.az = accel[2];
+    imuSensor.gx = gyro[0];
+    imuSensor.gy = gyro[1];
+    imuSensor.gz = gyro[2];
+
+    if (CALIBRATION_STORE_ENABLED)
+    {
+        observeMotion();
+    }
+}
+
+uint32_t fifoOverflowCount(void)
+{
+    return fifoOverflows;
 }
 
 void logDiagnostics(void)
 {
-    snprintf(msg, MSG_BUFFER_SIZE, "\r\n%d,%lf,%lf,%lf",
-        imuSensor.SelfTest[0], imuSensor.gyroBias[0], imuSensor.accelBias[0], imuSensor.magCalibration[0]);
-    appendFile(SD, FILE_DIAGNOSTICS, msg);
+    char line[CSV_RECORD_MAX_SIZE];
+    const float values[4] = {imuSensor.SelfTest[0], imuSensor.gyroBias[0],
+                             imuSensor.accelBias[0], imuSensor.magCalibration[0]};
+    diagnosticsLog.write(line, formatCsvValues(line, values, 4));
 }
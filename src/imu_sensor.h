@@ -14,6 +14,50 @@
 #define IMU_SENSOR_H
 
 #include "utility/MPU9250.h"
+#include "config.h"
+#include "log_record.h"
+
+// ============================================================================
+// MPU9250 FIFO REGISTERS
+// ============================================================================
+
+#define MPU9250_FIFO_EN_ACCEL_GYRO 0x78
+#define MPU9250_USER_CTRL_FIFO_EN 0x40
+#define MPU9250_USER_CTRL_FIFO_RST 0x04
+
+// ============================================================================
+// MPU9250 AUXILIARY I2C MASTER
+// ============================================================================
+
+#define MPU9250_USER_CTRL_I2C_MST_EN 0x20
+#define MPU9250_INT_PIN_CFG_BYPASS_EN 0x02
+#define MPU9250_I2C_MST_WAIT_FOR_ES 0x40        // Data-ready waits for the slave read
+#define MPU9250_I2C_MST_CLK_400KHZ 0x0D
+#define MPU9250_I2C_SLV_READ 0x80
+#define MPU9250_I2C_SLV_EN 0x80
+#define MPU9250_DELAY_ES_SHADOW 0x80            // EXT_SENS_DATA updates only as a whole
+
+// AK8963 ST1, HXL..HZH, ST2 mirrored into EXT_SENS_DATA_00..07
+#define AK8963_ST2_HOFL 0x08
+#define IMU_AUX_MAG_BYTES 8
+
+// ACCEL_XOUT_H .. EXT_SENS_DATA_07: accel, temperature, gyro and the mirrored AK8963
+#define IMU_BURST_SIZE (EXT_SENS_DATA_00 + IMU_AUX_MAG_BYTES - ACCEL_XOUT_H)
+
+// ============================================================================
+// FIFO BATCH
+// ============================================================================
+
+/**
+ * @brief Accel/gyro frames drained from the FIFO in one burst
+ */
+struct FifoBatch
+{
+    int16_t accelCount[IMU_FIFO_MAX_BURST_FRAMES][3];
+    int16_t gyroCount[IMU_FIFO_MAX_BURST_FRAMES][3];
+    uint32_t timestampUs[IMU_FIFO_MAX_BURST_FRAMES];   ///< Reconstructed from the ODR
+    int frames;
+};
 
 // ============================================================================
 // GLOBAL IMU INSTANCE
@@ -50,18 +94,111 @@ void initializeIMU(void);
  */
 void initializeMagnetometer(void);
 
+/**
+ * @brief Route accel and gyro samples into the MPU9250 FIFO
+ * 
+ * Resets the FIFO and enables accel + gyro capture at IMU_SAMPLE_RATE_HZ.
+ * Must be called after initializeIMU().
+ */
+void enableFifoAcquisition(void);
+
+/**
+ * @brief Hand the AK8963 to the MPU9250's auxiliary I2C master
+ * 
+ * Turns the I2C bypass off and sets up slave 0 to read the AK8963 ST1..ST2
+ * into EXT_SENS_DATA at every sample, so readIMUData() fetches all nine
+ * axes, temperature included, in one IMU_BURST_SIZE read. The AK8963 is
+ * then no longer reachable on the main bus. Must be called after
+ * initializeMagnetometer().
+ */
+void enableAuxBurstAcquisition(void);
+
+/**
+ * @brief Rebuild the scaling table (sensor_scaling.h)
+ * 
+ * Re-reads the accel/gyro/mag resolutions and folds them together with
+ * the AK8963 factory sensitivity and the current calibration. Called by
+ * the init functions above and whenever the calibration changes; call it
+ * after changing the full-scale settings.
+ */
+void refreshScaling(void);
+
+/**
+ * @brief The scaling table's conversion in the form binary logs record
+ * 
+ * Describes the conversion of the latest sample: calibration updates are
+ * folded into the table when the next sample is read, so applying this to
+ * the current raw counts gives the current ax..mz (mag in AK8963 axis
+ * order). Owned by the task that reads the sensor; captureSample() copies
+ * it into each ImuSample for the output stages.
+ */
+const FrameScale& sensorScale(void);
+
 // ============================================================================
 // DATA ACQUISITION FUNCTIONS
 // ============================================================================
 
+/**
+ * @brief Reprogram the output data rate and the digital low-pass filters
+ * 
+ * @param sampleRateDivider SMPLRT_DIV; ODR = 1 kHz / (1 + divider)
+ * @param dlpf DLPF setting written to CONFIG (gyro) and ACCEL_CONFIG2 (accel)
+ */
+void setImuRate(uint8_t sampleRateDivider, uint8_t dlpf);
+
 /**
  * @brief Read and process IMU sensor data
  * 
- * Reads acceleration, gyroscope, and magnetometer data from the IMU.
- * Applies calibration and converts raw ADC values to engineering units.
+ * Reads acceleration, gyroscope, and magnetometer data from the IMU and
+ * converts the whole sample through the scaling table in one pass.
+ * mx/my/mz are in the body (accel/gyro) frame. After
+ * enableAuxBurstAcquisition() this is a single burst; the magnetometer
+ * counts keep their last value while the mirrored AK8963 reports an
+ * overflow.
  */
 void readIMUData(void);
 
+/**
+ * @brief Read and calibrate the magnetometer only
+ * 
+ * Updates magCount and mx/my/mz (body frame); used by FIFO mode,
+ * where the AK8963 is not part of the FIFO stream. Reads the
+ * EXT_SENS_DATA mirror after enableAuxBurstAcquisition().
+ */
+void readMagnetometerData(void);
+
+/**
+ * @brief Drain queued accel/gyro frames from the FIFO
+ * 
+ * Reads FIFO_COUNT, then burst-reads up to IMU_FIFO_MAX_BURST_FRAMES whole
+ * frames in a single I2C transaction. Frame timestamps are reconstructed
+ * from IMU_SAMPLE_RATE_HZ. When they drift by more than one sample period
+ * they are re-anchored so the newest queued frame, read now or in a later
+ * batch, falls at the micros() of the count read. A full FIFO, or a count
+ * that is not a whole number of frames, resets the FIFO and counts an
+ * overflow.
+ * 
+ * @param batch Destination for the frames
+ * @return Number of frames read
+ */
+int readFifoBatch(FifoBatch& batch);
+
+/**
+ * @brief Load one FIFO frame into the IMU instance
+ * 
+ * Copies the frame's raw counts into accelCount/gyroCount and converts
+ * them to ax/ay/az (g) and gx/gy/gz (deg/s).
+ * 
+ * @param batch Batch returned by readFifoBatch()
+ * @param index Frame index
+ */
+void applyFifoFrame(const FifoBatch& batch, int index);
+
+/**
+ * @brief Number of FIFO overflows (lost samples) since boot
+ */
+uint32_t fifoOverflowCount(void);
+
 /**
  * @brief Log diagnostic information to SD card
  * 
@@ -0,0 +1,199 @@
+/**
+ * @file instrumentation.cpp
+ * @brief Runtime stage timing and drop counters
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "instrumentation.h"
+
+#if (INSTRUMENTATION_ENABLED)
+
+#include "sd_logger.h"
+#include "imu_sensor.h"
+#include "pipeline.h"
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+// Four buckets per power of two of microseconds, up to 2^24 us
+#define HISTOGRAM_SUB_BUCKETS 4
+#define HISTOGRAM_BUCKETS (HISTOGRAM_SUB_BUCKETS * 24)
+
+// ============================================================================
+// STATE
+// ============================================================================
+
+/**
+ * @brief Duration statistics for one stage over one dump interval
+ */
+struct StageHistogram
+{
+    uint32_t buckets[HISTOGRAM_BUCKETS];
+    uint32_t count;
+    uint32_t minUs;
+    uint32_t maxUs;
+};
+
+static const char* const stageNames[STAGE_COUNT] =
+{
+    "i2c_read", "fusion", "format", "sd_write", "serial", "loop"
+};
+
+static StageHistogram histograms[STAGE_COUNT];
+static uint32_t counters[COUNTER_COUNT];
+static uint32_t cyclesPerMicrosecond = 0;
+static uint32_t lastSampleUs = 0;
+static bool haveLastSample = false;
+static uint32_t lastDumpMs = 0;
+
+// ============================================================================
+// HISTOGRAM HELPERS
+// ============================================================================
+
+static int bucketFor(uint32_t us)
+{
+    if (us < HISTOGRAM_SUB_BUCKETS)
+    {
+        return (int)us;
+    }
+
+    int msb = 31 - __builtin_clz(us);
+    int sub = (us >> (msb - 2)) & (HISTOGRAM_SUB_BUCKETS - 1);
+    int index = (msb - 1) * HISTOGRAM_SUB_BUCKETS + sub;
+    return (index < HISTOGRAM_BUCKETS) ? index : HISTOGRAM_BUCKETS - 1;
+}
+
+static uint32_t bucketUpperBound(int index)
+{
+    if (index < HISTOGRAM_SUB_BUCKETS)
+    {
+        return (uint32_t)index;
+    }
+
+    int msb = index / HISTOGRAM_SUB_BUCKETS + 1;
+    int sub = index % HISTOGRAM_SUB_BUCKETS;
+    return ((uint32_t)(HISTOGRAM_SUB_BUCKETS + sub + 1) << (msb - 2)) - 1;
+}
+
+static uint32_t percentile(const StageHistogram& h, uint32_t perMille)
+{
+    uint32_t target = (uint32_t)(((uint64_t)h.count * perMille + 999) / 1000);
+    uint32_t seen = 0;
+
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+    {
+        seen += h.buckets[i];
+        if (seen >= target)
+        {
+            uint32_t bound = bucketUpperBound(i);
+            return (bound < h.maxUs) ? bound : h.maxUs;
+        }
+    }
+    return h.maxUs;
+}
+
+static void resetHistograms(void)
+{
+    memset(histograms, 0, sizeof(histograms));
+    for (int s = 0; s < STAGE_COUNT; s++)
+    {
+        histograms[s].minUs = UINT32_MAX;
+    }
+}
+
+// ============================================================================
+// INSTRUMENTATION FUNCTIONS
+// ============================================================================
+
+void instrumentRecord(InstrumentStage stage, uint32_t cycles)
+{
+    if (cyclesPerMicrosecond == 0)
+    {
+        cyclesPerMicrosecond = halCyclesPerMicrosecond();
+        resetHistograms();
+    }
+
+    uint32_t us = cycles / cyclesPerMicrosecond;
+    StageHistogram& h = histograms[stage];
+
+    h.buckets[bucketFor(us)]++;
+    h.count++;
+    if (us < h.minUs)
+    {
+        h.minUs = us;
+    }
+    if (us > h.maxUs)
+    {
+        h.maxUs = us;
+    }
+}
+
+void instrumentCount(InstrumentCounter counter)
+{
+    counters[counter]++;
+}
+
+void instrumentSampleArrival(uint32_t nowUs)
+{
+    const uint32_t periodUs = 1000000UL / IMU_SAMPLE_RATE_HZ;
+
+    // Gaps longer than 1.5 periods mean the data registers were overwritten
+    if (haveLastSample)
+    {
+        uint32_t gap = nowUs - lastSampleUs;
+        if (gap > periodUs + periodUs / 2)
+        {
+            counters[COUNTER_MISSED_SAMPLES] += (gap + periodUs / 2) / periodUs - 1;
+        }
+    }
+
+    lastSampleUs = nowUs;
+    haveLastSample = true;
+}
+
+void instrumentService(uint32_t nowMs)
+{
+    char line[MSG_BUFFER_SIZE];
+
+    if (nowMs - lastDumpMs < INSTRUMENTATION_DUMP_INTERVAL_MS)
+    {
+        return;
+    }
+    lastDumpMs = nowMs;
+
+    for (int s = 0; s < STAGE_COUNT; s++)
+    {
+        const StageHistogram& h = histograms[s];
+        if (h.count == 0)
+        {
+            continue;
+        }
+
+        snprintf(line, MSG_BUFFER_SIZE, "\r\n#perf,%lu,%s,%lu,%lu,%lu,%lu,%lu,%lu",
+                 (unsigned long)nowMs, stageNames[s], (unsigned long)h.count,
+                 (unsigned long)h.minUs, (unsigned long)percentile(h, 500),
+                 (unsigned long)percentile(h, 900), (unsigned long)percentile(h, 990),
+                 (unsigned long)h.maxUs);
+        diagnosticsLog.print(line);
+    }
+
+    uint32_t logErrors = accelLog.errorCount() + gyroLog.errorCount() + magLog.errorCount()
+                       + quaternionLog.errorCount() + yprLog.errorCount()
+                       + diagnosticsLog.errorCount() + binaryLog.errorCount()
+                       + packedIndexLog.errorCount();
+
+    snprintf(line, MSG_BUFFER_SIZE, "\r\n#perf,%lu,counters,%lu,%lu,%lu,%lu,%lu,%lu",
+             (unsigned long)nowMs, (unsigned long)counters[COUNTER_MISSED_SAMPLES],
+             (unsigned long)fifoOverflowCount(), (unsigned long)pipelineDroppedCount(),
+             (unsigned long)pipelineBacklog(), (unsigned long)counters[COUNTER_INLINE_BLOCKS],
+             (unsigned long)logErrors);
+    diagnosticsLog.print(line);
+
+    resetHistograms();
+}
+
+#endif // INSTRUMENTATION_ENABLED
@@ -0,0 +1,117 @@
+/**
+ * @file instrumentation.h
+ * @brief Runtime stage timing and drop counters
+ * 
+ * Times the stages of the sample path with the CPU cycle counter, keeps
+ * a log-scale histogram per stage (min, max and percentiles), counts lost
+ * samples and logger backpressure, and periodically appends a summary to
+ * the diagnostics stream. Everything goes through the INSTRUMENT_* macros,
+ * which expand to nothing unless INSTRUMENTATION_ENABLED is set.
+ * 
+ * Diagnostics lines (one per stage, then one for the counters):
+ *   #perf,<ms>,<stage>,<count>,<min_us>,<p50_us>,<p90_us>,<p99_us>,<max_us>
+ *   #perf,<ms>,counters,<missed>,<fifo_overflows>,<ring_drops>,<ring_backlog>,<inline_blocks>,<log_errors>
+ * Percentiles are bucket upper bounds (within 25%). Histograms are reset
+ * after every dump so each line covers one INSTRUMENTATION_DUMP_INTERVAL_MS;
+ * counters are cumulative since boot.
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include "hal.h"
+#include "config.h"
+
+// ============================================================================
+// TYPES
+// ============================================================================
+
+/**
+ * @brief Timed stages of the sample path
+ */
+enum InstrumentStage
+{
+    STAGE_I2C_READ,     ///< Sensor readout (data registers or FIFO burst)
+    STAGE_FUSION,       ///< One filter update
+    STAGE_FORMAT,       ///< One CSV record snprintf
+    STAGE_SD_WRITE,     ///< One block written to the card
+    STAGE_SERIAL,       ///< Serial output and log staging for one AHRS update (includes STAGE_FORMAT)
+    STAGE_LOOP,         ///< One loop() iteration
+    STAGE_COUNT
+};
+
+/**
+ * @brief Event counters
+ */
+enum InstrumentCounter
+{
+    COUNTER_MISSED_SAMPLES,     ///< Data-ready samples overwritten before they were read
+    COUNTER_INLINE_BLOCKS,      ///< Block writes forced by a full LogStream buffer
+    COUNTER_COUNT
+};
+
+// ============================================================================
+// INSTRUMENTATION MACROS
+// ============================================================================
+
+#if (INSTRUMENTATION_ENABLED)
+
+#define INSTRUMENT_BEGIN(stage) uint32_t instrumentStart_##stage = halCycleCount()
+#define INSTRUMENT_END(stage) instrumentRecord(stage, halCycleCount() - instrumentStart_##stage)
+#define INSTRUMENT_COUNT(counter) instrumentCount(counter)
+#define INSTRUMENT_SAMPLE(nowUs) instrumentSampleArrival(nowUs)
+#define INSTRUMENT_SERVICE(nowMs) instrumentService(nowMs)
+
+#else
+
+#define INSTRUMENT_BEGIN(stage) ((void)0)
+#define INSTRUMENT_END(stage) ((void)0)
+#define INSTRUMENT_COUNT(counter) ((void)0)
+#define INSTRUMENT_SAMPLE(nowUs) ((void)0)
+#define INSTRUMENT_SERVICE(nowMs) ((void)0)
+
+#endif
+
+// ============================================================================
+// INSTRUMENTATION FUNCTIONS
+// ============================================================================
+
+#if (INSTRUMENTATION_ENABLED)
+
+/**
+ * @brief Add one stage duration to its histogram
+ * 
+ * @param stage Stage that was timed
+ * @param cycles Duration in halCycleCount() ticks
+ */
+void instrumentRecord(InstrumentStage stage, uint32_t cycles);
+
+/**
+ * @brief Increment an event counter
+ */
+void instrumentCount(InstrumentCounter counter);
+
+/**
+ * @brief Note a fresh data-ready sample
+ * 
+ * Counts the samples the sensor produced since the previous one at
+ * IMU_SAMPLE_RATE_HZ but the firmware never read.
+ * 
+ * @param nowUs Current time in microseconds
+ */
+void instrumentSampleArrival(uint32_t nowUs);
+
+/**
+ * @brief Dump and reset the histograms every INSTRUMENTATION_DUMP_INTERVAL_MS
+ * 
+ * @param nowMs Current time in milliseconds
+ */
+void instrumentService(uint32_t nowMs);
+
+#endif
+
+#endif // INSTRUMENTATION_H
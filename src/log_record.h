@@ -0,0 +1,272 @@
+/**
+ * @file log_record.h
+ * @brief Binary IMU log frame format
+ * 
+ * Defines the fixed-layout, versioned, CRC-protected records written when
+ * LOG_FORMAT_BINARY is enabled. Every sample becomes one frame holding its
+ * raw sensor counts and quaternion. The scale factors and calibration
+ * needed to reproduce the CSV columns off-device (frameSensors()) change
+ * rarely, so they go into a separate scale record, written at the start of
+ * every segment and whenever sensorScale() changes. Scale records are
+ * numbered, and each frame carries the number of the record it was
+ * written under, so a reader that lost a scale record to damage reports
+ * the frames after it instead of converting them with stale factors.
+ * Version 1 and 2 frames, which repeated the scale in every frame, are no
+ * longer accepted.
+ * This file has no Arduino dependencies so the host decoder can share it.
+ * 
+ * Both records start with the same header; the size byte tells them apart.
+ * 
+ * Sample frame (little-endian, LOG_FRAME_SIZE bytes):
+ * 
+ * | Offset | Size | Field                          |
+ * |--------|------|--------------------------------|
+ * | 0      | 2    | Sync word (LOG_FRAME_MAGIC)    |
+ * | 2      | 1    | Format version                 |
+ * | 3      | 1    | Record size in bytes           |
+ * | 4      | 4    | Timestamp (millis)             |
+ * | 8      | 6    | accelCount[3] (int16)          |
+ * | 14     | 6    | gyroCount[3] (int16)           |
+ * | 20     | 6    | magCount[3] (int16)            |
+ * | 26     | 16   | Quaternion q0,qx,qy,qz (float) |
+ * | 42     | 1    | Scale record number            |
+ * | 43     | 2    | CRC-16/CCITT of bytes 0..42    |
+ * 
+ * Scale record (little-endian, LOG_SCALE_RECORD_SIZE bytes):
+ * 
+ * | Offset | Size | Field                          |
+ * |--------|------|--------------------------------|
+ * | 0      | 4    | Header, as above               |
+ * | 4      | 1    | Scale record number            |
+ * | 5      | 12   | aRes, gRes, mRes (float)       |
+ * | 17     | 12   | magCalibration[3] (float)      |
+ * | 29     | 12   | magbias[3] (float)             |
+ * | 41     | 36   | magMatrix[3][3] (float)        |
+ * | 77     | 12   | gyroBias[3] (float)            |
+ * | 89     | 2    | CRC-16/CCITT of bytes 0..88    |
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef LOG_RECORD_H
+#define LOG_RECORD_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// ============================================================================
+// FRAME CONSTANTS
+// ============================================================================
+
+#define LOG_FRAME_MAGIC 0xA55A
+#define LOG_FRAME_VERSION 3
+#define LOG_RECORD_HEADER_SIZE 4
+#define LOG_FRAME_SIZE 45
+#define LOG_SCALE_RECORD_SIZE 91
+#define LOG_RECORD_MAX_SIZE LOG_SCALE_RECORD_SIZE
+
+// ============================================================================
+// FRAME CONTENTS
+// ============================================================================
+
+// Floats of a FrameScale, in on-card order
+#define FRAME_SCALE_FLOATS 21
+
+/**
+ * @brief Conversion from raw counts to the CSV columns
+ *
+ * Mirrors the scaling table (sensor_scaling.h) in its unfolded form:
+ * - accel (g) = counts * aRes
+ * - gyro (deg/s) = counts * gRes - gyroBias
+ * - mag (mG, AK8963 axes) = magMatrix * (counts * mRes * magCalibration - magbias)
+ */
+struct FrameScale
+{
+    float aRes;
+    float gRes;
+    float mRes;
+    float magCalibration[3];        ///< AK8963 factory sensitivity
+    float magbias[3];               ///< Hard-iron offset (mG)
+    float magMatrix[3][3];          ///< Soft-iron correction
+    float gyroBias[3];              ///< Removed in software (deg/s)
+};
+
+/**
+ * @brief One decoded IMU sample
+ */
+struct ImuFrame
+{
+    uint32_t timestampMs;
+    int16_t accelCount[3];
+    int16_t gyroCount[3];
+    int16_t magCount[3];
+    float q[4];
+    FrameScale scale;               ///< From the scale record in force, not stored per frame
+};
+
+/**
+ * @brief The scale record in force on one side of a frame log
+ *
+ * Writer and reader each keep one per segment, starting from
+ * resetFrameScaleState().
+ */
+struct FrameScaleState
+{
+    FrameScale scale;
+    uint8_t number;                 ///< Of the last scale record, counting modulo 256
+    bool valid;                     ///< A scale record has been written or read
+};
+
+/**
+ * @brief Result of decoding a record
+ */
+enum FrameStatus
+{
+    FRAME_OK = 0,                   ///< A frame, converted with the scale in force
+    FRAME_SCALE,                    ///< A scale record, now in force
+    FRAME_NO_SCALE,                 ///< An intact frame whose scale record was not read
+    FRAME_BAD_MAGIC,
+    FRAME_BAD_VERSION,
+    FRAME_BAD_CRC,
+    FRAME_TRUNCATED                 ///< Fewer bytes available than the header announces
+};
+
+// ============================================================================
+// LITTLE-ENDIAN FIELD HELPERS
+// ============================================================================
+
+// Shared by every on-card record format (frames, packed blocks)
+
+static inline uint8_t* putU16(uint8_t* p, uint16_t v)
+{
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static inline uint8_t* putU32(uint8_t* p, uint32_t v)
+{
+    p[0] = (uint8_t)(v & 0xFF);
+    p[1] = (uint8_t)((v >> 8) & 0xFF);
+    p[2] = (uint8_t)((v >> 16) & 0xFF);
+    p[3] = (uint8_t)(v >> 24);
+    return p + 4;
+}
+
+static inline uint8_t* putFloat(uint8_t* p, float v)
+{
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return putU32(p, bits);
+}
+
+static inline const uint8_t* getU16(const uint8_t* p, uint16_t& v)
+{
+    v = (uint16_t)(p[0] | (p[1] << 8));
+    return p + 2;
+}
+
+static inline const uint8_t* getU32(const uint8_t* p, uint32_t& v)
+{
+    v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    return p + 4;
+}
+
+static inline const uint8_t* getFloat(const uint8_t* p, float& v)
+{
+    uint32_t bits;
+    p = getU32(p, bits);
+    memcpy(&v, &bits, sizeof(v));
+    return p;
+}
+
+// ============================================================================
+// SCALE FUNCTIONS
+// ============================================================================
+
+/**
+ * @brief Flatten @p scale into FRAME_SCALE_FLOATS values, in on-card order
+ */
+void gatherFrameScale(const FrameScale& scale, float* values);
+
+/**
+ * @brief Inverse of gatherFrameScale()
+ */
+void scatterFrameScale(const float* values, FrameScale& scale);
+
+/**
+ * @brief Unit scales, no factory adjustment and no calibration
+ */
+void identityFrameScale(FrameScale& scale);
+
+/**
+ * @brief Sensor values of @p frame as the text logger writes them
+ *
+ * @param accel Acceleration (g)
+ * @param gyro Angular rate (deg/s)
+ * @param mag Magnetic field (mG), AK8963 axis order like mag.txt
+ */
+void frameSensors(const ImuFrame& frame, float* accel, float* gyro, float* mag);
+
+// ============================================================================
+// FRAME ENCODING FUNCTIONS
+// ============================================================================
+
+/**
+ * @brief Compute CRC-16/CCITT-FALSE (poly 0x1021)
+ * 
+ * @param data Bytes to checksum
+ * @param length Number of bytes
+ * @param crc Initial value, or the result of a previous call to continue
+ * @return Updated CRC
+ */
+uint16_t crc16Ccitt(const uint8_t* data, size_t length, uint16_t crc = 0xFFFF);
+
+/**
+ * @brief Forget the scale record in force, as at the start of a segment
+ */
+void resetFrameScaleState(FrameScaleState& state);
+
+/**
+ * @brief Whether a frame with @p scale needs a new scale record first
+ */
+bool frameScaleChanged(const FrameScaleState& state, const FrameScale& scale);
+
+/**
+ * @brief Serialize a scale record and put it in force
+ * 
+ * @param scale Scale factors and calibration of the frames that follow
+ * @param state Writer state; gets the next record number
+ * @param out Destination, at least LOG_SCALE_RECORD_SIZE bytes
+ */
+void encodeScaleRecord(const FrameScale& scale, FrameScaleState& state, uint8_t* out);
+
+/**
+ * @brief Serialize a frame under the scale record in force
+ * 
+ * @param frame Sample to encode; frame.scale is not stored
+ * @param state Writer state
+ * @param out Destination, at least LOG_FRAME_SIZE bytes
+ */
+void encodeImuFrame(const ImuFrame& frame, const FrameScaleState& state, uint8_t* out);
+
+/**
+ * @brief Validate and deserialize one record
+ * 
+ * A scale record updates @p state. A frame fills @p frame, and its scale
+ * from @p state if the frame was written under the record in force.
+ * 
+ * @param in Start of a candidate record
+ * @param available Bytes readable at @p in
+ * @param state Reader state, carried from record to record
+ * @param frame Decoded sample (complete only when FRAME_OK is returned)
+ * @param recordBytes Size the header announces (set unless the header was rejected)
+ * @return Decode status; FRAME_OK, FRAME_SCALE and FRAME_NO_SCALE are intact records
+ */
+FrameStatus decodeLogRecord(const uint8_t* in, size_t available, FrameScaleState& state,
+                            ImuFrame& frame, size_t& recordBytes);
+
+#endif // LOG_RECORD_H
@@ -0,0 +1,145 @@
+/**
+ * @file madgwick_kernel.h
+ * @brief Madgwick engine for the fusion kernel
+ *
+ * Port of MadgwickQuaternionUpdate() from the M5Stack library: one
+ * normalised gradient-descent step on the accel/mag objective per sample,
+ * weighted by beta. Costs more than Mahony per sample but has a single
+ * gain tied to the gyro noise, which makes it the better choice on rigs
+ * with a well-characterised sensor.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef MADGWICK_KERNEL_H
+#define MADGWICK_KERNEL_H
+
+#include "fusion_kernel.h"
+
+// ============================================================================
+// MADGWICK KERNEL
+// ============================================================================
+
+/**
+ * @brief Madgwick filter: gyro integration corrected by a gradient step
+ */
+template <typename T>
+class MadgwickKernel : public FusionKernel<MadgwickKernel<T>, T>
+{
+    friend class FusionKernel<MadgwickKernel<T>, T>;
+
+public:
+    /**
+     * @param beta Gradient step weight (rad/s)
+     */
+    MadgwickKernel(float beta = MADGWICK_BETA)
+        : beta(beta)
+    {
+        reset();
+    }
+
+    /**
+     * @brief Return to the identity quaternion
+     */
+    void reset(void)
+    {
+        this->resetQuaternion();
+    }
+
+    void setBeta(float gain)
+    {
+        beta = T(gain);
+    }
+
+private:
+    using FusionKernel<MadgwickKernel<T>, T>::q0;
+    using FusionKernel<MadgwickKernel<T>, T>::q1;
+    using FusionKernel<MadgwickKernel<T>, T>::q2;
+    using FusionKernel<MadgwickKernel<T>, T>::q3;
+
+    /**
+     * @brief One filter step on normalised accel and mag vectors
+     */
+    void integrate(T ax, T ay, T az, T gx, T gy, T gz, T mx, T my, T mz, T deltat)
+    {
+        const T two(2.0f);
+        const T four(4.0f);
+        const T half(0.5f);
+        const T one(1.0f);
+        T qa = q0, qb = q1, qc = q2, qd = q3;
+
+        // Auxiliary variables to avoid repeated arithmetic
+        T _2qa = two * qa;
+        T _2qb = two * qb;
+        T _2qc = two * qc;
+        T _2qd = two * qd;
+        T _2qaqc = two * qa * qc;
+        T _2qcqd = two * qc * qd;
+        T qaqa = qa * qa;
+        T qaqb = qa * qb;
+        T qaqc = qa * qc;
+        T qaqd = qa * qd;
+        T qbqb = qb * qb;
+        T qbqc = qb * qc;
+        T qbqd = qb * qd;
+        T qcqc = qc * qc;
+        T qcqd = qc * qd;
+        T qdqd = qd * qd;
+
+        // Reference direction of Earth's magnetic field
+        T _2qamx = two * qa * mx;
+        T _2qamy = two * qa * my;
+        T _2qamz = two * qa * mz;
+        T _2qbmx = two * qb * mx;
+        T hx = mx * qaqa - _2qamy * qd + _2qamz * qc + mx * qbqb + _2qb * my * qc + _2qb * mz * qd
+             - mx * qcqc - mx * qdqd;
+        T hy = _2qamx * qd + my * qaqa - _2qamz * qb + _2qbmx * qc - my * qbqb + my * qcqc + _2qc * mz * qd
+             - my * qdqd;
+        T _2bx = fusionHypot(hx, hy);
+        T _2bz = -_2qamx * qc + _2qamy * qb + mz * qaqa + _2qbmx * qd - mz * qbqb + _2qc * my * qd
+               - mz * qcqc + mz * qdqd;
+        T _4bx = two * _2bx;
+        T _4bz = two * _2bz;
+
+        // Objective function residuals
+        T fAx = two * qbqd - _2qaqc - ax;
+        T fAy = two * qaqb + _2qcqd - ay;
+        T fAz = one - two * qbqb - two * qcqc - az;
+        T fMx = _2bx * (half - qcqc - qdqd) + _2bz * (qbqd - qaqc) - mx;
+        T fMy = _2bx * (qbqc - qaqd) + _2bz * (qaqb + qcqd) - my;
+        T fMz = _2bx * (qaqc + qbqd) + _2bz * (half - qbqb - qcqc) - mz;
+
+        // Gradient (Jacobian transpose times residuals)
+        T s1 = -_2qc * fAx + _2qb * fAy - _2bz * qc * fMx + (-_2bx * qd + _2bz * qb) * fMy + _2bx * qc * fMz;
+        T s2 = _2qd * fAx + _2qa * fAy - four * qb * fAz + _2bz * qd * fMx + (_2bx * qc + _2bz * qa) * fMy
+             + (_2bx * qd - _4bz * qb) * fMz;
+        T s3 = -_2qa * fAx + _2qd * fAy - four * qc * fAz + (-_4bx * qc - _2bz * qa) * fMx
+             + (_2bx * qb + _2bz * qd) * fMy + (_2bx * qa - _4bz * qc) * fMz;
+        T s4 = _2qb * fAx + _2qc * fAy + (-_4bx * qd + _2bz * qb) * fMx + (-_2bx * qa + _2bz * qc) * fMy
+             + _2bx * qb * fMz;
+        fusionNormalize4(s1, s2, s3, s4);
+
+        // Rate of change of quaternion, less the gradient step
+        T qDot1 = half * (-qb * gx - qc * gy - qd * gz) - beta * s1;
+        T qDot2 = half * (qa * gx + qc * gz - qd * gy) - beta * s2;
+        T qDot3 = half * (qa * gy - qb * gz + qd * gx) - beta * s3;
+        T qDot4 = half * (qa * gz + qb * gy - qc * gx) - beta * s4;
+
+        qa = qa + qDot1 * deltat;
+        qb = qb + qDot2 * deltat;
+        qc = qc + qDot3 * deltat;
+        qd = qd + qDot4 * deltat;
+
+        fusionNormalize4(qa, qb, qc, qd);
+        q0 = qa;
+        q1 = qb;
+        q2 = qc;
+        q3 = qd;
+    }
+
+    T beta;
+};
+
+#endif // MADGWICK_KERNEL_H
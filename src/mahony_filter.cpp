@@ -0,0 +1,175 @@
+/**
+ * @file mahony_filter.cpp
+ * @brief Mahony AHRS filter implementation
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "mahony_filter.h"
+#include "fast_trig.h"
+#include <math.h>
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+#define RADIANS_TO_DEGREES 57.295779513082320876798154814105f
+
+// ============================================================================
+// MAHONY FILTER
+// ============================================================================
+
+MahonyFilter::MahonyFilter(float kp, float ki)
+    : kp(kp), ki(ki)
+{
+    reset();
+}
+
+void MahonyFilter::reset(void)
+{
+    q[0] = 1.0f;
+    q[1] = 0.0f;
+    q[2] = 0.0f;
+    q[3] = 0.0f;
+    eInt[0] = 0.0f;
+    eInt[1] = 0.0f;
+    eInt[2] = 0.0f;
+}
+
+void MahonyFilter::setGains(float proportional, float integral)
+{
+    kp = proportional;
+    ki = integral;
+}
+
+void MahonyFilter::update(float ax, float ay, float az, float gx, float gy, float gz,
+                          float mx, float my, float mz, float deltat)
+{
+    float q1 = q[0], q2 = q[1], q3 = q[2], q4 = q[3];
+    float norm;
+    float hx, hy, bx, bz;
+    float vx, vy, vz, wx, wy, wz;
+    float ex, ey, ez;
+    float pa, pb, pc;
+
+    // Auxiliary variables to avoid repeated arithmetic
+    float q1q1 = q1 * q1;
+    float q1q2 = q1 * q2;
+    float q1q3 = q1 * q3;
+    float q1q4 = q1 * q4;
+    float q2q2 = q2 * q2;
+    float q2q3 = q2 * q3;
+    float q2q4 = q2 * q4;
+    float q3q3 = q3 * q3;
+    float q3q4 = q3 * q4;
+    float q4q4 = q4 * q4;
+
+    // Normalise accelerometer measurement
+    norm = sqrtf(ax * ax + ay * ay + az * az);
+    if (norm == 0.0f)
+    {
+        return;
+    }
+    norm = 1.0f / norm;
+    ax *= norm;
+    ay *= norm;
+    az *= norm;
+
+    // Normalise magnetometer measurement
+    norm = sqrtf(mx * mx + my * my + mz * mz);
+    if (norm == 0.0f)
+    {
+        return;
+    }
+    norm = 1.0f / norm;
+    mx *= norm;
+    my *= norm;
+    mz *= norm;
+
+    // Reference direction of Earth's magnetic field
+    hx = 2.0f * mx * (0.5f - q3q3 - q4q4) + 2.0f * my * (q2q3 - q1q4) + 2.0f * mz * (q2q4 + q1q3);
+    hy = 2.0f * mx * (q2q3 + q1q4) + 2.0f * my * (0.5f - q2q2 - q4q4) + 2.0f * mz * (q3q4 - q1q2);
+    bx = sqrtf((hx * hx) + (hy * hy));
+    bz = 2.0f * mx * (q2q4 - q1q3) + 2.0f * my * (q3q4 + q1q2) + 2.0f * mz * (0.5f - q2q2 - q3q3);
+
+    // Estimated direction of gravity and magnetic field
+    vx = 2.0f * (q2q4 - q1q3);
+    vy = 2.0f * (q1q2 + q3q4);
+    vz = q1q1 - q2q2 - q3q3 + q4q4;
+    wx = 2.0f * bx * (0.5f - q3q3 - q4q4) + 2.0f * bz * (q2q4 - q1q3);
+    wy = 2.0f * bx * (q2q3 - q1q4) + 2.0f * bz * (q1q2 + q3q4);
+    wz = 2.0f * bx * (q1q3 + q2q4) + 2.0f * bz * (0.5f - q2q2 - q3q3);
+
+    // Error is cross product between estimated direction and measured direction
+    ex = (ay * vz - az * vy) + (my * wz - mz * wy);
+    ey = (az * vx - ax * vz) + (mz * wx - mx * wz);
+    ez = (ax * vy - ay * vx) + (mx * wy - my * wx);
+    if (ki > 0.0f)
+    {
+        eInt[0] += ex;
+        eInt[1] += ey;
+        eInt[2] += ez;
+    }
+    else
+    {
+        eInt[0] = 0.0f;
+        eInt[1] = 0.0f;
+        eInt[2] = 0.0f;
+    }
+
+    // Apply feedback terms
+    gx = gx + kp * ex + ki * eInt[0];
+    gy = gy + kp * ey + ki * eInt[1];
+    gz = gz + kp * ez + ki * eInt[2];
+
+    // Integrate rate of change of quaternion
+    pa = q2;
+    pb = q3;
+    pc = q4;
+    q1 = q1 + (-q2 * gx - q3 * gy - q4 * gz) * (0.5f * deltat);
+    q2 = pa + (q1 * gx + pb * gz - pc * gy) * (0.5f * deltat);
+    q3 = pb + (q1 * gy - pa * gz + pc * gx) * (0.5f * deltat);
+    q4 = pc + (q1 * gz + pa * gy - pb * gx) * (0.5f * deltat);
+
+    // Normalise quaternion
+    norm = sqrtf(q1 * q1 + q2 * q2 + q3 * q3 + q4 * q4);
+    norm = 1.0f / norm;
+    q[0] = q1 * norm;
+    q[1] = q2 * norm;
+    q[2] = q3 * norm;
+    q[3] = q4 * norm;
+}
+
+// ============================================================================
+// ORIENTATION FUNCTIONS
+// ============================================================================
+
+void quaternionToEuler(const float* q, float declinationDeg, float& yaw, float& pitch, float& roll)
+{
+    float yawY = 2.0f * (q[1] * q[2] + q[0] * q[3]);
+    float yawX = q[0] * q[0] + q[1] * q[1] - q[2] * q[2] - q[3] * q[3];
+    float pitchSin = 2.0f * (q[1] * q[3] - q[0] * q[2]);
+    float rollY = 2.0f * (q[0] * q[1] + q[2] * q[3]);
+    float rollX = q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3];
+
+    if (FUSION_FAST_TRIG_ENABLED)
+    {
+        yaw = fastAtan2f(yawY, yawX);
+        pitch = -fastAsinf(pitchSin);
+        roll = fastAtan2f(rollY, rollX);
+    }
+    else
+    {
+        yaw = atan2f(yawY, yawX);
+        pitch = -asinf(pitchSin);
+        roll = atan2f(rollY, rollX);
+    }
+    
+    // Convert to degrees
+    pitch *= RADIANS_TO_DEGREES;
+    yaw *= RADIANS_TO_DEGREES;
+    yaw -= declinationDeg;
+    roll *= RADIANS_TO_DEGREES;
+}
@@ -0,0 +1,85 @@
+/**
+ * @file mahony_filter.h
+ * @brief Mahony AHRS filter with per-instance state
+ * 
+ * Port of MahonyQuaternionUpdate() from the M5Stack library with the
+ * quaternion, integral error and gains held in an object instead of file
+ * statics. Kept as the reference implementation that MahonyKernel
+ * (mahony_kernel.h), which the firmware and replay tool run, is checked
+ * against in the benchmark report. Has no Arduino dependency.
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef MAHONY_FILTER_H
+#define MAHONY_FILTER_H
+
+#include "config.h"
+
+// ============================================================================
+// MAHONY FILTER
+// ============================================================================
+
+class MahonyFilter
+{
+public:
+    /**
+     * @param kp Proportional gain
+     * @param ki Integral gain (0 disables integral feedback)
+     */
+    MahonyFilter(float kp = MAHONY_KP, float ki = MAHONY_KI);
+
+    /**
+     * @brief Return to the identity quaternion and clear the integral term
+     */
+    void reset(void);
+
+    void setGains(float kp, float ki);
+
+    /**
+     * @brief Integrate one accel/gyro/mag sample
+     * 
+     * Identical arithmetic to the M5Stack MahonyQuaternionUpdate(),
+     * including its use of the already-updated q0 term.
+     * 
+     * @param ax, ay, az Acceleration (any unit, normalised internally)
+     * @param gx, gy, gz Angular rate (rad/s)
+     * @param mx, my, mz Magnetic field (any unit, normalised internally)
+     * @param deltat Integration interval in seconds
+     */
+    void update(float ax, float ay, float az, float gx, float gy, float gz,
+                float mx, float my, float mz, float deltat);
+
+    /**
+     * @brief Current orientation quaternion (q0, qx, qy, qz)
+     */
+    const float* quaternion(void) const { return q; }
+
+private:
+    float kp;
+    float ki;
+    float q[4];
+    float eInt[3];
+};
+
+// ============================================================================
+// ORIENTATION FUNCTIONS
+// ============================================================================
+
+/**
+ * @brief Compute Yaw, Pitch, and Roll from a quaternion
+ * 
+ * Single-precision throughout; uses fast_trig.h when
+ * FUSION_FAST_TRIG_ENABLED is set.
+ * 
+ * @param q Quaternion (q0, qx, qy, qz)
+ * @param declinationDeg Magnetic declination subtracted from yaw
+ * @param yaw Yaw in degrees
+ * @param pitch Pitch in degrees
+ * @param roll Roll in degrees
+ */
+void quaternionToEuler(const float* q, float declinationDeg, float& yaw, float& pitch, float& roll);
+
+#endif // MAHONY_FILTER_H
@@ -0,0 +1,145 @@
+/**
+ * @file mahony_kernel.h
+ * @brief Mahony engine for the fusion kernel
+ *
+ * MahonyKernel<float> performs exactly the arithmetic of MahonyFilter (the
+ * reference port of the M5Stack MahonyQuaternionUpdate());
+ * MahonyKernel<FixedPoint<F>> runs the same code without an FPU.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef MAHONY_KERNEL_H
+#define MAHONY_KERNEL_H
+
+#include "fusion_kernel.h"
+
+// ============================================================================
+// MAHONY KERNEL
+// ============================================================================
+
+/**
+ * @brief Mahony filter: PI feedback of the accel and mag direction errors
+ */
+template <typename T>
+class MahonyKernel : public FusionKernel<MahonyKernel<T>, T>
+{
+    friend class FusionKernel<MahonyKernel<T>, T>;
+
+public:
+    /**
+     * @param kp Proportional gain
+     * @param ki Integral gain (0 disables integral feedback)
+     */
+    MahonyKernel(float kp = MAHONY_KP, float ki = MAHONY_KI)
+        : kp(kp), ki(ki)
+    {
+        reset();
+    }
+
+    /**
+     * @brief Return to the identity quaternion and clear the integral term
+     */
+    void reset(void)
+    {
+        this->resetQuaternion();
+        eIntX = T(0.0f);
+        eIntY = T(0.0f);
+        eIntZ = T(0.0f);
+    }
+
+    void setGains(float proportional, float integral)
+    {
+        kp = T(proportional);
+        ki = T(integral);
+    }
+
+private:
+    using FusionKernel<MahonyKernel<T>, T>::q0;
+    using FusionKernel<MahonyKernel<T>, T>::q1;
+    using FusionKernel<MahonyKernel<T>, T>::q2;
+    using FusionKernel<MahonyKernel<T>, T>::q3;
+
+    /**
+     * @brief One filter step on normalised accel and mag vectors
+     *
+     * Same expressions, in the same order, as MahonyFilter::update().
+     */
+    void integrate(T ax, T ay, T az, T gx, T gy, T gz, T mx, T my, T mz, T deltat)
+    {
+        const T two(2.0f);
+        const T half(0.5f);
+        T qa = q0, qb = q1, qc = q2, qd = q3;
+
+        // Auxiliary variables to avoid repeated arithmetic
+        T qaqa = qa * qa;
+        T qaqb = qa * qb;
+        T qaqc = qa * qc;
+        T qaqd = qa * qd;
+        T qbqb = qb * qb;
+        T qbqc = qb * qc;
+        T qbqd = qb * qd;
+        T qcqc = qc * qc;
+        T qcqd = qc * qd;
+        T qdqd = qd * qd;
+
+        // Reference direction of Earth's magnetic field
+        T hx = two * mx * (half - qcqc - qdqd) + two * my * (qbqc - qaqd) + two * mz * (qbqd + qaqc);
+        T hy = two * mx * (qbqc + qaqd) + two * my * (half - qbqb - qdqd) + two * mz * (qcqd - qaqb);
+        T bx = fusionHypot(hx, hy);
+        T bz = two * mx * (qbqd - qaqc) + two * my * (qcqd + qaqb) + two * mz * (half - qbqb - qcqc);
+
+        // Estimated direction of gravity and magnetic field
+        T vx = two * (qbqd - qaqc);
+        T vy = two * (qaqb + qcqd);
+        T vz = qaqa - qbqb - qcqc + qdqd;
+        T wx = two * bx * (half - qcqc - qdqd) + two * bz * (qbqd - qaqc);
+        T wy = two * bx * (qbqc - qaqd) + two * bz * (qaqb + qcqd);
+        T wz = two * bx * (qaqc + qbqd) + two * bz * (half - qbqb - qcqc);
+
+        // Error is cross product between estimated direction and measured direction
+        T ex = (ay * vz - az * vy) + (my * wz - mz * wy);
+        T ey = (az * vx - ax * vz) + (mz * wx - mx * wz);
+        T ez = (ax * vy - ay * vx) + (mx * wy - my * wx);
+        if (ki > T(0.0f))
+        {
+            eIntX += ex;
+            eIntY += ey;
+            eIntZ += ez;
+        }
+        else
+        {
+            eIntX = T(0.0f);
+            eIntY = T(0.0f);
+            eIntZ = T(0.0f);
+        }
+
+        // Apply feedback terms
+        gx = gx + kp * ex + ki * eIntX;
+        gy = gy + kp * ey + ki * eIntY;
+        gz = gz + kp * ez + ki * eIntZ;
+
+        // Integrate rate of change of quaternion (using the updated qa)
+        T pa = qb;
+        T pb = qc;
+        T pc = qd;
+        qa = qa + (-qb * gx - qc * gy - qd * gz) * (half * deltat);
+        qb = pa + (qa * gx + pb * gz - pc * gy) * (half * deltat);
+        qc = pb + (qa * gy - pa * gz + pc * gx) * (half * deltat);
+        qd = pc + (qa * gz + pa * gy - pb * gx) * (half * deltat);
+
+        fusionNormalize4(qa, qb, qc, qd);
+        q0 = qa;
+        q1 = qb;
+        q2 = qc;
+        q3 = qd;
+    }
+
+    T kp;
+    T ki;
+    T eIntX, eIntY, eIntZ;
+};
+
+#endif // MAHONY_KERNEL_H
@@ -11,21 +11,22 @@
  * @version 1.0
  */
 
-#include <M5Stack.h>
-#include <Wire.h>
+#include "hal.h"
 #include "config.h"
 #include "sd_logger.h"
 #include "imu_sensor.h"
 #include "data_processor.h"
-#include "utility/quaternionFilters.h"
+#include "pipeline.h"
+#include "benchmark.h"
+#include "instrumentation.h"
+#include "data_ready.h"
+#include "calibration.h"
+#include "telemetry.h"
+#include "event_capture.h"
+#include "rate_governor.h"
+#include "dashboard.h"
 #include "utility/MPU9250.h"
 
-// ============================================================================
-// GLOBAL VARIABLES
-// ============================================================================
-
-char msg[MSG_BUFFER_SIZE];
-
 // ============================================================================
 // SYSTEM INITIALIZATION
 // ============================================================================
@@ -34,7 +35,8 @@ char msg[MSG_BUFFER_SIZE];
  * @brief System initialization and setup
  * 
  * Initializes hardware peripherals, creates data files, and configures
- * all sensors for operation. The screen color indicates system status:
+ * all sensors for operation. The screen color indicates system status
+ * (or the dashboard's status bar, with DASHBOARD_ENABLED):
  * - Blue: Waiting for startup delay
  * - Green: Recording started successfully
  * - Red: Error occurred
@@ -42,19 +44,29 @@ char msg[MSG_BUFFER_SIZE];
 void setup(void)
 {
     // Initialize communication interfaces
-    Wire.begin();
-    Serial.begin(115200);
-    M5.begin();
+    halBegin(115200);
     
     // Configure display
-    M5.Lcd.setBrightness(SCREEN_BRIGHTNESS);
-    M5.Lcd.fillScreen(BLUE);
+    halSetBrightness(SCREEN_BRIGHTNESS);
+    showStatus(STATUS_WAITING);
+    if (DASHBOARD_ENABLED)
+    {
+        beginDashboard();
+    }
     
-    Serial.println("INFO: System starting - waiting for stabilization");
-    delay(STARTUP_DELAY_MS);
+    // A stored calibration replaces the stabilization wait and bias calibration
+    if (beginCalibration())
+    {
+        Serial.println("INFO: System starting with stored calibration");
+    }
+    else
+    {
+        Serial.println("INFO: System starting - waiting for stabilization");
+        halDelay(STARTUP_DELAY_MS);
+    }
     
     // Indicate recording has begun
-    M5.Lcd.fillScreen(GREEN);
+    showStatus(STATUS_RECORDING);
     Serial.println("INFO: Recording started");
 
     // Initialize data logging files
@@ -62,11 +74,52 @@ void setup(void)
     
     // Initialize IMU sensor
     Serial.println("INFO: MPU9250 is online");
-    performIMUSelfTest();
+    if (!calibrationRestored())
+    {
+        // A restored boot reports the trims stored with its calibration
+        performIMUSelfTest();
+    }
     initializeIMU();
     
     // Initialize magnetometer
     initializeMagnetometer();
+
+    // From here on the AK8963 is read through the MPU9250
+    if (IMU_AUX_BURST_ENABLED)
+    {
+        enableAuxBurstAcquisition();
+    }
+
+    if (RATE_GOVERNOR_ENABLED)
+    {
+        beginRateGovernor();
+    }
+
+    if (IMU_FIFO_MODE_ENABLED)
+    {
+        enableFifoAcquisition();
+    }
+    else if (DATA_READY_IRQ_ENABLED)
+    {
+        startDataReadyInterrupt();
+    }
+
+    // Calibration values do not change after setup; log them once
+    if (STREAM_SCHEDULER_ENABLED)
+    {
+        logDiagnostics();
+    }
+
+    if (BENCHMARK_MODE_ENABLED)
+    {
+        runBenchmarks(Serial, BENCHMARK_ITERATIONS);
+    }
+
+    // Hand acquisition and logging over to the core-pinned tasks
+    if (PIPELINE_MODE_ENABLED)
+    {
+        startPipeline();
+    }
 }
 
 // ============================================================================
@@ -84,30 +137,93 @@ void setup(void)
  */
 void loop(void)
 {
+    // Sampling and logging run in their own tasks in pipelined mode
+    if (PIPELINE_MODE_ENABLED)
+    {
+        halDelay(PIPELINE_DRAIN_INTERVAL_MS);
+        return;
+    }
+
+    INSTRUMENT_BEGIN(STAGE_LOOP);
+
     // Log diagnostic information
-    logDiagnostics();
+    if (!STREAM_SCHEDULER_ENABLED)
+    {
+        logDiagnostics();
+    }
 
-    // Check if new data is available (data ready interrupt)
-    if (imuSensor.readByte(MPU9250_ADDRESS, INT_STATUS) & 0x01)
+    if (IMU_FIFO_MODE_ENABLED)
+    {
+        // Fuse every frame queued in the FIFO since the last pass
+        acquireFifoSamples(SAMPLE_SINK_ENABLED ? recordSample : NULL);
+    }
+    else if (DATA_READY_IRQ_ENABLED)
     {
-        readIMUData();
+        // Fuse the samples the INT pin signalled since the last pass
+        acquireDataReadySamples(SAMPLE_SINK_ENABLED ? recordSample : NULL);
     }
+    else
+    {
+        // Check if new data is available (data ready interrupt)
+        bool newSample = false;
+        if (imuSensor.readByte(MPU9250_ADDRESS, INT_STATUS) & 0x01)
+        {
+            INSTRUMENT_SAMPLE(halMicros());
+            readIMUData();
+            newSample = true;
 
-    // Update quaternion filter timing
-    imuSensor.updateTime();
+            if (RATE_GOVERNOR_ENABLED)
+            {
+                rateGovernorObserveSample();
+            }
+        }
 
-    // Update orientation quaternion using Mahony filter
-    MahonyQuaternionUpdate(imuSensor.ax, imuSensor.ay, imuSensor.az, 
-                          imuSensor.gx * DEG_TO_RAD, imuSensor.gy * DEG_TO_RAD, imuSensor.gz * DEG_TO_RAD, 
-                          imuSensor.my, imuSensor.mx, imuSensor.mz, imuSensor.deltat);
+        // Update orientation quaternion
+        if (!STREAM_SCHEDULER_ENABLED && !RATE_GOVERNOR_ENABLED)
+        {
+            fuseCurrentSample();
+        }
+        else if (newSample)
+        {
+            // One fixed step per data-ready sample, independent of loop() timing
+            fuseFixedStep(rateGovernorSamplePeriod());
+        }
+
+        if (newSample && SAMPLE_SINK_ENABLED)
+        {
+            ImuSample sample;
+            captureSample(sample);
+            recordSample(sample);
+        }
+    }
 
-    // Process data based on selected mode
-    if (!AHRS_MODE_ENABLED)
+    // Print and log the output of the selected mode at its rate
+    processOutput();
+
+    // Write out log blocks that have reached their age threshold
+    INSTRUMENT_SERVICE(halMillis());
+    serviceDataFiles();
+    serviceCalibrationStore(halMillis());
+    if (SERIAL_TELEMETRY_ENABLED)
     {
-        processBasicMode();
+        serviceTelemetry();
     }
-    else
+    if (EVENT_CAPTURE_ENABLED)
+    {
+        serviceEventCapture();
+    }
+
+    INSTRUMENT_END(STAGE_LOOP);
+
+    // One pixel budget of the dashboard, after the sample is handled
+    if (DASHBOARD_ENABLED)
+    {
+        serviceDashboard(halMillis());
+    }
+
+    // Idle profile: nothing to do until the next sample
+    if (RATE_GOVERNOR_ENABLED)
     {
-        processAHRSMode();
+        rateGovernorYield();
     }
 }
@@ -0,0 +1,89 @@
+/**
+ * @file output_config.h
+ * @brief Compile-time selection of the firmware's output pipeline
+ *
+ * Maps the AHRS_MODE_ENABLED, SERIAL_DEBUG_ENABLED,
+ * PROCESSING_OUTPUT_ENABLED and DASHBOARD_ENABLED flags (and the modes that
+ * take over the serial port or the CSV streams) onto OutputPipeline stages. ConfiguredOutput is
+ * the resulting concrete type; nothing downstream tests the flags.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef OUTPUT_CONFIG_H
+#define OUTPUT_CONFIG_H
+
+#include "config.h"
+#include "fusion_engine.h"
+#include "output_pipeline.h"
+
+// ============================================================================
+// FIRMWARE PIPELINE
+// ============================================================================
+
+// The pipelined logging task always prints the AHRS output
+#define OUTPUT_AHRS (AHRS_MODE_ENABLED || PIPELINE_MODE_ENABLED)
+
+// Telemetry owns the serial port when enabled
+#define OUTPUT_CONSOLE (SERIAL_DEBUG_ENABLED && !SERIAL_TELEMETRY_ENABLED)
+
+// The binary log, scheduler and feature windows write the CSV streams themselves
+#define OUTPUT_CSV (SERIAL_DEBUG_ENABLED && !LOG_FORMAT_BINARY && !STREAM_SCHEDULER_ENABLED \
+                    && !FEATURE_EXTRACTION_ENABLED)
+
+#if (OUTPUT_AHRS)
+
+typedef FusionEngine OutputFusion;
+
+#if (RATE_GOVERNOR_ENABLED)
+typedef GovernedRate OutputRate;
+#else
+typedef IntervalRate<AHRS_UPDATE_INTERVAL_MS> OutputRate;
+#endif
+
+#if (OUTPUT_CONSOLE)
+typedef TextFormatter OutputText;
+#else
+typedef NullFormatter OutputText;
+#endif
+
+#if (PROCESSING_OUTPUT_ENABLED && !SERIAL_TELEMETRY_ENABLED)
+typedef ProcessingFormatter OutputProcessing;
+#else
+typedef NullFormatter OutputProcessing;
+#endif
+
+typedef FormatterPair<OutputText, OutputProcessing> OutputFormatter;
+
+#if (OUTPUT_CSV)
+typedef CsvSink OutputLog;
+#else
+typedef NullSink OutputLog;
+#endif
+
+#else
+
+typedef PassthroughFusion OutputFusion;
+typedef IntervalRate<BASIC_UPDATE_INTERVAL_MS> OutputRate;
+
+#if (OUTPUT_CONSOLE)
+typedef ReadoutFormatter OutputFormatter;
+#else
+typedef NullFormatter OutputFormatter;
+#endif
+
+typedef NullSink OutputLog;
+
+#endif
+
+#if (DASHBOARD_ENABLED)
+typedef SinkPair<OutputLog, DashboardSink> OutputSink;
+#else
+typedef OutputLog OutputSink;
+#endif
+
+typedef OutputPipeline<OutputFusion, OutputRate, OutputFormatter, OutputSink> ConfiguredOutput;
+
+#endif // OUTPUT_CONFIG_H
@@ -0,0 +1,451 @@
+/**
+ * @file output_pipeline.h
+ * @brief Compile-time fusion and output pipeline built from policy stages
+ *
+ * OutputPipeline<Fusion, Rate, Formatter, Sink> is the fusion -> output
+ * chain of the firmware: the fusion engine integrates every sample, and
+ * once per Rate interval the latest sample is turned into one OutputTick
+ * that the Formatter prints to the console and the Sink logs to the card.
+ * Each stage is a policy type fixed at compile time:
+ *
+ * - Fusion: any fusion engine (fusion_engine.h), or PassthroughFusion,
+ *   which keeps the identity quaternion.
+ * - Rate: IntervalRate<ms> or GovernedRate (the rate governor's interval).
+ * - Formatter: TextFormatter, ProcessingFormatter, ReadoutFormatter,
+ *   NullFormatter, or two of them in a FormatterPair.
+ * - Sink: CsvSink (the five CSV streams), DashboardSink (the LCD
+ *   dashboard's orientation), NullSink, or two of them in a SinkPair.
+ *
+ * Calls go straight to the policy types, so an unused stage (the null
+ * policies, empty classes) compiles to nothing, and the orientation is
+ * only computed when a stage reads it. output_config.h picks the
+ * firmware's stages from the config.h flags; the host check
+ * (--pipeline-check) instantiates the other combinations.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef OUTPUT_PIPELINE_H
+#define OUTPUT_PIPELINE_H
+
+#include "hal.h"
+#include "config.h"
+#include "imu_sample.h"
+#include "imu_sensor.h"
+#include "sd_logger.h"
+#include "mahony_filter.h"
+#include "rate_governor.h"
+#include "instrumentation.h"
+#include "dashboard.h"
+
+// ============================================================================
+// TICK
+// ============================================================================
+
+/**
+ * @brief One output tick, as every formatter and sink sees it
+ */
+struct OutputTick
+{
+    ImuSample sample;
+    float rateHz;               ///< Filter update rate since the previous tick
+    float yaw, pitch, roll;     ///< Degrees; only set when a stage uses them
+};
+
+// ============================================================================
+// FUSION STAGES
+// ============================================================================
+
+/**
+ * @brief Fusion stage that does not fuse: the quaternion stays the identity
+ *
+ * For the basic readout, which only prints the sensor values.
+ */
+class PassthroughFusion
+{
+public:
+    void update(float ax, float ay, float az, float gx, float gy, float gz,
+                float mx, float my, float mz, float deltat)
+    {
+        (void)ax, (void)ay, (void)az, (void)gx, (void)gy, (void)gz;
+        (void)mx, (void)my, (void)mz, (void)deltat;
+    }
+
+    const float* quaternion(void) const
+    {
+        static const float identity[4] = {1.0f, 0.0f, 0.0f, 0.0f};
+        return identity;
+    }
+};
+
+// ============================================================================
+// RATE STAGES
+// ============================================================================
+
+/**
+ * @brief A tick every @p IntervalMs milliseconds
+ */
+template <uint32_t IntervalMs>
+struct IntervalRate
+{
+    static uint32_t intervalMs(void) { return IntervalMs; }
+};
+
+/**
+ * @brief A tick every log interval of the rate governor's active profile
+ */
+struct GovernedRate
+{
+    static uint32_t intervalMs(void) { return activeRateProfile().logIntervalMs; }
+};
+
+// ============================================================================
+// FORMATTER STAGES
+// ============================================================================
+
+/**
+ * @brief No console output
+ */
+struct NullFormatter
+{
+    static const bool usesOrientation = false;
+
+    void format(Print& out, const OutputTick& tick) { (void)out, (void)tick; }
+};
+
+/**
+ * @brief Human-readable sensor values, quaternion, YPR and update rate
+ */
+struct TextFormatter
+{
+    static const bool usesOrientation = true;
+
+    void format(Print& out, const OutputTick& tick)
+    {
+        const ImuSample& sample = tick.sample;
+
+        out.print("ax = ");
+        out.print((int)(1000 * sample.ax));
+        out.print(" ay = ");
+        out.print((int)(1000 * sample.ay));
+        out.print(" az = ");
+        out.print((int)(1000 * sample.az));
+        out.println(" mg");
+
+        out.print("gx = ");
+        out.print(sample.gx, 2);
+        out.print(" gy = ");
+        out.print(sample.gy, 2);
+        out.print(" gz = ");
+        out.print(sample.gz, 2);
+        out.println(" deg/s");
+
+        // AK8963 axis order, as in mag.txt
+        out.print("mx = ");
+        out.print((int)sample.my);
+        out.print(" my = ");
+        out.print((int)sample.mx);
+        out.print(" mz = ");
+        out.print((int)sample.mz);
+        out.println(" mG");
+
+        out.print("q0 = ");
+        out.print(sample.q[0]);
+        out.print(" qx = ");
+        out.print(sample.q[1]);
+        out.print(" qy = ");
+        out.print(sample.q[2]);
+        out.print(" qz = ");
+        out.println(sample.q[3]);
+
+        out.print("Yaw, Pitch, Roll: ");
+        out.print(tick.yaw, 2);
+        out.print(", ");
+        out.print(tick.pitch, 2);
+        out.print(", ");
+        out.println(tick.roll, 2);
+
+        out.print("Update rate = ");
+        out.print(tick.rateHz, 2);
+        out.println(" Hz");
+        out.println();
+    }
+};
+
+/**
+ * @brief "yaw;pitch;roll;..." lines for the Processing visualization
+ */
+struct ProcessingFormatter
+{
+    static const bool usesOrientation = true;
+
+    void format(Print& out, const OutputTick& tick)
+    {
+        out.print(tick.yaw);
+        out.print(";");
+        out.print(tick.pitch);
+        out.print(";");
+        out.print(tick.roll);
+        out.print(";");
+        out.print(26.5);
+        out.print(";");
+        out.print(0.01);
+        out.print(";");
+        out.print(0.02);
+        out.println();
+    }
+};
+
+/**
+ * @brief Basic-mode readout: accel, gyro, mag and die temperature
+ *
+ * Reads the temperature register itself, so it must run on the task that
+ * owns the I2C bus.
+ */
+struct ReadoutFormatter
+{
+    static const bool usesOrientation = false;
+
+    void format(Print& out, const OutputTick& tick)
+    {
+        const ImuSample& sample = tick.sample;
+
+        out.print("X-acceleration: ");
+        out.print(1000 * sample.ax);
+        out.print(" mg  Y-acceleration: ");
+        out.print(1000 * sample.ay);
+        out.print(" mg  Z-acceleration: ");
+        out.print(1000 * sample.az);
+        out.println(" mg");
+
+        out.print("X-gyro rate: ");
+        out.print(sample.gx, 3);
+        out.print(" deg/s  Y-gyro rate: ");
+        out.print(sample.gy, 3);
+        out.print(" deg/s  Z-gyro rate: ");
+        out.print(sample.gz, 3);
+        out.println(" deg/s");
+
+        // AK8963 axis order
+        out.print("X-mag field: ");
+        out.print(sample.my);
+        out.print(" mG  Y-mag field: ");
+        out.print(sample.mx);
+        out.print(" mG  Z-mag field: ");
+        out.print(sample.mz);
+        out.println(" mG");
+
+        imuSensor.tempCount = imuSensor.readTempData();
+        imuSensor.temperature = ((float)imuSensor.tempCount) / TEMP_CONVERSION_FACTOR + TEMP_OFFSET;
+        out.print("Temperature: ");
+        out.print(imuSensor.temperature, 1);
+        out.println(" °C");
+        out.println();
+    }
+};
+
+/**
+ * @brief Two formatters, one after the other
+ */
+template <typename First, typename Second>
+struct FormatterPair
+{
+    static const bool usesOrientation = First::usesOrientation || Second::usesOrientation;
+
+    void format(Print& out, const OutputTick& tick)
+    {
+        first.format(out, tick);
+        second.format(out, tick);
+    }
+
+    First first;
+    Second second;
+};
+
+// ============================================================================
+// SINK STAGES
+// ============================================================================
+
+/**
+ * @brief No file output
+ */
+struct NullSink
+{
+    static const bool usesOrientation = false;
+
+    void write(const OutputTick& tick) { (void)tick; }
+};
+
+/**
+ * @brief One record per tick on each of the five CSV streams
+ *
+ * Accel in mg, gyro in deg/s, mag in the AK8963 axis order, quaternion,
+ * and update rate with YPR.
+ */
+class CsvSink
+{
+public:
+    static const bool usesOrientation = true;
+
+    /**
+     * @brief Log to the session's streams (sd_logger.h)
+     */
+    CsvSink(void) : accel(accelLog), gyro(gyroLog), mag(magLog), quaternion(quaternionLog), ypr(yprLog) {}
+
+    CsvSink(LogStream& accelStream, LogStream& gyroStream, LogStream& magStream,
+            LogStream& quaternionStream, LogStream& yprStream)
+        : accel(accelStream), gyro(gyroStream), mag(magStream), quaternion(quaternionStream), ypr(yprStream)
+    {
+    }
+
+    void write(const OutputTick& tick)
+    {
+        const ImuSample& sample = tick.sample;
+        const uint32_t timestamp = sample.timestampMs;
+
+        const float accelValues[3] = {1000 * sample.ax, 1000 * sample.ay, 1000 * sample.az};
+        record(accel, timestamp, accelValues, 3);
+
+        const float gyroValues[3] = {sample.gx, sample.gy, sample.gz};
+        record(gyro, timestamp, gyroValues, 3);
+
+        const float magValues[3] = {sample.my, sample.mx, sample.mz};
+        record(mag, timestamp, magValues, 3);
+
+        record(quaternion, timestamp, sample.q, 4);
+
+        const float yprValues[4] = {tick.rateHz, tick.yaw, tick.pitch, tick.roll};
+        record(ypr, timestamp, yprValues, 4);
+    }
+
+private:
+    static void record(LogStream& stream, uint32_t timestampMs, const float* values, uint8_t count)
+    {
+        INSTRUMENT_BEGIN(STAGE_FORMAT);
+        stream.printRecord(timestampMs, values, count);
+        INSTRUMENT_END(STAGE_FORMAT);
+    }
+
+    LogStream& accel;
+    LogStream& gyro;
+    LogStream& mag;
+    LogStream& quaternion;
+    LogStream& ypr;
+};
+
+/**
+ * @brief Orientation and update rate for the LCD dashboard (dashboard.h)
+ */
+struct DashboardSink
+{
+    static const bool usesOrientation = true;
+
+    void write(const OutputTick& tick)
+    {
+        dashboardObserveOutput(tick.yaw, tick.pitch, tick.roll, tick.rateHz);
+    }
+};
+
+/**
+ * @brief Two sinks, one after the other
+ */
+template <typename First, typename Second>
+struct SinkPair
+{
+    static const bool usesOrientation = First::usesOrientation || Second::usesOrientation;
+
+    SinkPair(const First& first = First(), const Second& second = Second()) : first(first), second(second) {}
+
+    void write(const OutputTick& tick)
+    {
+        first.write(tick);
+        second.write(tick);
+    }
+
+    First first;
+    Second second;
+};
+
+// ============================================================================
+// PIPELINE
+// ============================================================================
+
+/**
+ * @brief Fusion engine plus the rate-limited output of its samples
+ *
+ * @tparam Fusion update(ax, ay, az, gx, gy, gz, mx, my, mz, dt) and quaternion()
+ * @tparam Rate Static intervalMs()
+ * @tparam Formatter format(Print&, const OutputTick&) and usesOrientation
+ * @tparam Sink write(const OutputTick&) and usesOrientation
+ */
+template <typename Fusion, typename Rate, typename Formatter, typename Sink>
+class OutputPipeline
+{
+public:
+    explicit OutputPipeline(Print& console, const Sink& sink = Sink())
+        : console(console), sink(sink), lastTickMs(0)
+    {
+    }
+
+    /**
+     * @brief Integrate one sample
+     *
+     * @param gx, gy, gz Angular rate (rad/s); other units as FusionKernel::update()
+     */
+    void fuse(float ax, float ay, float az, float gx, float gy, float gz,
+              float mx, float my, float mz, float dt)
+    {
+        INSTRUMENT_BEGIN(STAGE_FUSION);
+        engine.update(ax, ay, az, gx, gy, gz, mx, my, mz, dt);
+        INSTRUMENT_END(STAGE_FUSION);
+    }
+
+    const float* quaternion(void) const { return engine.quaternion(); }
+
+    /**
+     * @brief Whether the rate interval has passed since the last restart()
+     */
+    bool due(uint32_t nowMs) const
+    {
+        return nowMs - lastTickMs > Rate::intervalMs();
+    }
+
+    /**
+     * @brief Format and log one tick
+     *
+     * @param sample Latest fused sample
+     * @param rateHz Filter update rate to report
+     */
+    void emit(const ImuSample& sample, float rateHz)
+    {
+        OutputTick tick;
+        tick.sample = sample;
+        tick.rateHz = rateHz;
+
+        if (Formatter::usesOrientation || Sink::usesOrientation)
+        {
+            quaternionToEuler(sample.q, MAGNETIC_DECLINATION_DEG, tick.yaw, tick.pitch, tick.roll);
+        }
+
+        INSTRUMENT_BEGIN(STAGE_SERIAL);
+        formatter.format(console, tick);
+        sink.write(tick);
+        INSTRUMENT_END(STAGE_SERIAL);
+    }
+
+    /**
+     * @brief Start the next rate interval at @p nowMs
+     */
+    void restart(uint32_t nowMs) { lastTickMs = nowMs; }
+
+private:
+    Print& console;
+    Fusion engine;
+    Formatter formatter;
+    Sink sink;
+    uint32_t lastTickMs;
+};
+
+#endif // OUTPUT_PIPELINE_H
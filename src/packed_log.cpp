@@ -0,0 +1,295 @@
+/**
+ * @file packed_log.cpp
+ * @brief Compressed IMU log block implementation
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "packed_log.h"
+
+// ============================================================================
+// VARINT HELPERS
+// ============================================================================
+
+static inline uint32_t zigzagEncode(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t zigzagDecode(uint32_t v)
+{
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static inline uint8_t* putVarint(uint8_t* p, uint32_t v)
+{
+    while (v >= 0x80)
+    {
+        *p++ = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+/**
+ * @return Position after the varint, or NULL if it runs past @p end
+ */
+static inline const uint8_t* getVarint(const uint8_t* p, const uint8_t* end, uint32_t& v)
+{
+    v = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7)
+    {
+        uint8_t byte = *p++;
+        v |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return p;
+        }
+    }
+    return NULL;
+}
+
+// Accel, gyro and mag counts of a frame in payload order
+static inline void gatherCounts(const ImuFrame& frame, int16_t* counts)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        counts[i] = frame.accelCount[i];
+        counts[3 + i] = frame.gyroCount[i];
+        counts[6 + i] = frame.magCount[i];
+    }
+}
+
+// ============================================================================
+// BLOCK ENCODER
+// ============================================================================
+
+PackedBlockEncoder::PackedBlockEncoder(uint16_t maxSamples)
+    : maxSamples(maxSamples > PACKED_MAX_BLOCK_SAMPLES ? PACKED_MAX_BLOCK_SAMPLES : maxSamples),
+      count(0),
+      payloadFill(0),
+      firstTimestampMs(0),
+      previousTimestampMs(0)
+{
+}
+
+void PackedBlockEncoder::reset(void)
+{
+    count = 0;
+    payloadFill = 0;
+}
+
+bool PackedBlockEncoder::add(const ImuFrame& frame)
+{
+    int16_t counts[9];
+    gatherCounts(frame, counts);
+
+    uint8_t* start = block + PACKED_HEADER_SIZE + payloadFill;
+    uint8_t* p = start;
+
+    if (count == 0)
+    {
+        gatherFrameScale(frame.scale, scales);
+        firstTimestampMs = frame.timestampMs;
+        for (int i = 0; i < 9; i++)
+        {
+            p = putVarint(p, zigzagEncode(counts[i]));
+        }
+    }
+    else
+    {
+        float frameScales[FRAME_SCALE_FLOATS];
+        gatherFrameScale(frame.scale, frameScales);
+        if (count >= maxSamples || payloadFill + PACKED_MAX_SAMPLE_BYTES > PACKED_MAX_PAYLOAD_SIZE
+            || memcmp(frameScales, scales, sizeof(scales)) != 0)
+        {
+            return false;
+        }
+
+        p = putVarint(p, zigzagEncode((int32_t)(frame.timestampMs - previousTimestampMs)));
+        for (int i = 0; i < 9; i++)
+        {
+            p = putVarint(p, zigzagEncode((int32_t)counts[i] - (int32_t)previous[i]));
+        }
+    }
+
+    memcpy(previous, counts, sizeof(previous));
+    previousTimestampMs = frame.timestampMs;
+    payloadFill += (size_t)(p - start);
+    count++;
+    return true;
+}
+
+size_t PackedBlockEncoder::finish(const uint8_t*& out)
+{
+    if (count == 0)
+    {
+        out = block;
+        return 0;
+    }
+
+    uint8_t* p = block;
+    p = putU16(p, PACKED_BLOCK_MAGIC);
+    *p++ = PACKED_BLOCK_VERSION;
+    *p++ = PACKED_HEADER_SIZE;
+    p = putU16(p, count);
+    p = putU16(p, (uint16_t)payloadFill);
+    p = putU32(p, firstTimestampMs);
+    p = putU32(p, previousTimestampMs);
+    for (int i = 0; i < FRAME_SCALE_FLOATS; i++)
+    {
+        p = putFloat(p, scales[i]);
+    }
+
+    size_t length = PACKED_HEADER_SIZE + payloadFill;
+    putU16(block + length, crc16Ccitt(block, length));
+
+    out = block;
+    reset();
+    return length + 2;
+}
+
+// ============================================================================
+// BLOCK DECODING FUNCTIONS
+// ============================================================================
+
+PackedStatus readPackedHeader(const uint8_t* in, size_t available, PackedBlockInfo& info, size_t& blockBytes)
+{
+    uint16_t magic;
+
+    if (available < PACKED_HEADER_SIZE)
+    {
+        return PACKED_TRUNCATED;
+    }
+
+    const uint8_t* p = getU16(in, magic);
+    if (magic != PACKED_BLOCK_MAGIC)
+    {
+        return PACKED_BAD_MAGIC;
+    }
+    if (p[0] != PACKED_BLOCK_VERSION || p[1] != PACKED_HEADER_SIZE)
+    {
+        return PACKED_BAD_VERSION;
+    }
+
+    p += 2;
+    p = getU16(p, info.samples);
+    p = getU16(p, info.payloadBytes);
+    p = getU32(p, info.firstTimestampMs);
+    getU32(p, info.lastTimestampMs);
+
+    // A corrupt header must not make the caller skip a valid block
+    if (info.samples == 0 || info.samples > PACKED_MAX_BLOCK_SAMPLES || info.payloadBytes > PACKED_MAX_PAYLOAD_SIZE)
+    {
+        return PACKED_BAD_VERSION;
+    }
+
+    blockBytes = PACKED_HEADER_SIZE + info.payloadBytes + 2;
+    return (available < blockBytes) ? PACKED_TRUNCATED : PACKED_OK;
+}
+
+PackedStatus checkPackedBlock(const uint8_t* in, size_t available, PackedBlockInfo& info, size_t& blockBytes)
+{
+    PackedStatus status = readPackedHeader(in, available, info, blockBytes);
+    if (status != PACKED_OK)
+    {
+        return status;
+    }
+
+    uint16_t crc;
+    getU16(in + blockBytes - 2, crc);
+    return (crc == crc16Ccitt(in, blockBytes - 2)) ? PACKED_OK : PACKED_BAD_CRC;
+}
+
+PackedStatus decodePackedBlock(const uint8_t* in, size_t available, ImuFrame* frames,
+                               PackedBlockInfo& info, size_t& blockBytes)
+{
+    PackedStatus status = checkPackedBlock(in, available, info, blockBytes);
+    if (status != PACKED_OK)
+    {
+        return status;
+    }
+
+    float values[FRAME_SCALE_FLOATS];
+    FrameScale scale;
+    const uint8_t* p = in + 16;
+    for (int i = 0; i < FRAME_SCALE_FLOATS; i++)
+    {
+        p = getFloat(p, values[i]);
+    }
+    scatterFrameScale(values, scale);
+
+    const uint8_t* end = in + PACKED_HEADER_SIZE + info.payloadBytes;
+    int32_t counts[9] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+    uint32_t timestamp = info.firstTimestampMs;
+    uint32_t value;
+
+    for (uint16_t s = 0; s < info.samples; s++)
+    {
+        if (s > 0)
+        {
+            p = getVarint(p, end, value);
+            if (p == NULL)
+            {
+                return PACKED_BAD_PAYLOAD;
+            }
+            timestamp += (uint32_t)zigzagDecode(value);
+        }
+        for (int i = 0; i < 9; i++)
+        {
+            p = getVarint(p, end, value);
+            if (p == NULL)
+            {
+                return PACKED_BAD_PAYLOAD;
+            }
+            counts[i] += zigzagDecode(value);
+        }
+
+        ImuFrame& frame = frames[s];
+        frame.timestampMs = timestamp;
+        for (int i = 0; i < 3; i++)
+        {
+            frame.accelCount[i] = (int16_t)counts[i];
+            frame.gyroCount[i] = (int16_t)counts[3 + i];
+            frame.magCount[i] = (int16_t)counts[6 + i];
+        }
+        frame.scale = scale;
+        frame.q[0] = 1.0f;
+        frame.q[1] = 0.0f;
+        frame.q[2] = 0.0f;
+        frame.q[3] = 0.0f;
+    }
+
+    return (p == end && timestamp == info.lastTimestampMs) ? PACKED_OK : PACKED_BAD_PAYLOAD;
+}
+
+void encodePackedIndexEntry(const PackedBlockInfo& info, uint8_t* out)
+{
+    uint8_t* p = out;
+    p = putU32(p, info.offset);
+    p = putU32(p, info.firstTimestampMs);
+    p = putU32(p, info.lastTimestampMs);
+    p = putU16(p, info.samples);
+    putU16(p, crc16Ccitt(out, PACKED_INDEX_ENTRY_SIZE - 2));
+}
+
+bool decodePackedIndexEntry(const uint8_t* in, PackedBlockInfo& info)
+{
+    uint16_t crc;
+    getU16(in + PACKED_INDEX_ENTRY_SIZE - 2, crc);
+    if (crc != crc16Ccitt(in, PACKED_INDEX_ENTRY_SIZE - 2))
+    {
+        return false;
+    }
+
+    const uint8_t* p = in;
+    p = getU32(p, info.offset);
+    p = getU32(p, info.firstTimestampMs);
+    p = getU32(p, info.lastTimestampMs);
+    getU16(p, info.samples);
+    info.payloadBytes = 0;
+    return true;
+}
@@ -0,0 +1,220 @@
+/**
+ * @file packed_log.h
+ * @brief Compressed IMU log block format
+ *
+ * Written instead of the fixed frames of log_record.h when
+ * LOG_FORMAT_COMPRESSED is enabled. Samples are grouped into blocks that
+ * decode on their own: the first sample of a block is stored in full and
+ * every later one as the difference from its predecessor, each value
+ * zigzag-mapped and varint-packed. Raw counts of a slowly moving device
+ * change by a few LSB per sample, so most fields take one byte.
+ *
+ * Block layout (little-endian, PACKED_HEADER_SIZE + payload + 2 bytes):
+ *
+ * | Offset | Size | Field                                   |
+ * |--------|------|-----------------------------------------|
+ * | 0      | 2    | Sync word (PACKED_BLOCK_MAGIC)          |
+ * | 2      | 1    | Format version                          |
+ * | 3      | 1    | Header size in bytes                    |
+ * | 4      | 2    | Sample count                            |
+ * | 6      | 2    | Payload size in bytes                   |
+ * | 8      | 4    | Timestamp of the first sample (millis)  |
+ * | 12     | 4    | Timestamp of the last sample (millis)   |
+ * | 16     | 12   | aRes, gRes, mRes (float)                |
+ * | 28     | 12   | magCalibration[3] (float)               |
+ * | 40     | 12   | magbias[3] (float)                      |
+ * | 52     | 36   | magMatrix[3][3] (float)                 |
+ * | 88     | 12   | gyroBias[3] (float)                     |
+ * | 100    | n    | Payload                                 |
+ * | 100 + n | 2   | CRC-16/CCITT of every byte before it    |
+ *
+ * Payload, per sample: zigzag varint timestamp delta (omitted for the
+ * first sample), then accelCount[3], gyroCount[3] and magCount[3] as
+ * zigzag varint deltas (the first sample against zero). The quaternion is
+ * not stored; imu_replay recomputes attitude from the decoded streams.
+ *
+ * Every block written also appends a PACKED_INDEX_ENTRY_SIZE entry to the
+ * index file, so the host can seek to a time without scanning the log.
+ * The log alone is still decodable: blocks start with a sync word and a
+ * damaged one is skipped by resynchronizing on the next.
+ *
+ * This file has no Arduino dependencies so the host tools can share it.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef PACKED_LOG_H
+#define PACKED_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "log_record.h"
+
+// ============================================================================
+// BLOCK CONSTANTS
+// ============================================================================
+
+#define PACKED_BLOCK_MAGIC 0xC35A
+#define PACKED_BLOCK_VERSION 2
+#define PACKED_HEADER_SIZE 100
+
+// Format limits; a decoder accepts any block within them
+#define PACKED_MAX_BLOCK_SAMPLES 1024
+#define PACKED_MAX_PAYLOAD_SIZE 2048
+
+// Worst case for one sample: 5-byte timestamp delta plus nine 3-byte deltas
+#define PACKED_MAX_SAMPLE_BYTES 32
+
+#define PACKED_MAX_BLOCK_SIZE (PACKED_HEADER_SIZE + PACKED_MAX_PAYLOAD_SIZE + 2)
+
+#define PACKED_INDEX_ENTRY_SIZE 16
+
+// ============================================================================
+// BLOCK CONTENTS
+// ============================================================================
+
+/**
+ * @brief Summary of one block, as stored in the index
+ *
+ * Index entry layout: offset (4), first and last timestamp (4 + 4),
+ * sample count (2), CRC-16/CCITT of the first 14 bytes (2).
+ */
+struct PackedBlockInfo
+{
+    uint32_t offset;            ///< Byte offset of the block in the log file
+    uint32_t firstTimestampMs;
+    uint32_t lastTimestampMs;
+    uint16_t samples;
+    uint16_t payloadBytes;      ///< Not part of the index entry
+};
+
+/**
+ * @brief Result of decoding a block
+ */
+enum PackedStatus
+{
+    PACKED_OK = 0,
+    PACKED_BAD_MAGIC,
+    PACKED_BAD_VERSION,
+    PACKED_TRUNCATED,           ///< Fewer bytes available than the block needs
+    PACKED_BAD_CRC,
+    PACKED_BAD_PAYLOAD          ///< CRC matched but the payload does not parse
+};
+
+// ============================================================================
+// BLOCK ENCODER
+// ============================================================================
+
+/**
+ * @brief Accumulates samples into one block
+ *
+ * The block is built in place behind room for its header, so finish()
+ * hands out the finished bytes without copying them. A block also ends
+ * when the scale factors change (e.g. the calibrator adopted a new mag
+ * correction or gyro bias), so every block carries the factors valid for
+ * all its samples.
+ */
+class PackedBlockEncoder
+{
+public:
+    /**
+     * @param maxSamples Samples per block, at most PACKED_MAX_BLOCK_SAMPLES
+     */
+    explicit PackedBlockEncoder(uint16_t maxSamples = PACKED_MAX_BLOCK_SAMPLES);
+
+    /**
+     * @brief Drop the samples of the current block
+     */
+    void reset(void);
+
+    /**
+     * @brief Append one sample (quaternion ignored)
+     *
+     * @return false if it does not belong in this block: the block is full
+     *         or the scale factors differ. finish() the block and add again.
+     */
+    bool add(const ImuFrame& frame);
+
+    /**
+     * @brief Complete the block and start a new one
+     *
+     * @param block Set to the encoded block, valid until the next add()
+     * @return Block size in bytes (0 if the block was empty)
+     */
+    size_t finish(const uint8_t*& block);
+
+    bool empty(void) const { return count == 0; }
+    uint16_t samples(void) const { return count; }
+    uint32_t firstTimestamp(void) const { return firstTimestampMs; }
+    uint32_t lastTimestamp(void) const { return previousTimestampMs; }
+
+private:
+    uint16_t maxSamples;
+    uint16_t count;
+    size_t payloadFill;
+    uint32_t firstTimestampMs;
+    uint32_t previousTimestampMs;
+    int16_t previous[9];
+    float scales[FRAME_SCALE_FLOATS];
+    uint8_t block[PACKED_MAX_BLOCK_SIZE];
+};
+
+// ============================================================================
+// BLOCK DECODING FUNCTIONS
+// ============================================================================
+
+/**
+ * @brief Validate the header at @p in and report the block size
+ *
+ * @param in Start of a candidate block
+ * @param available Bytes readable at @p in (at least PACKED_HEADER_SIZE)
+ * @param info Header fields (offset is left untouched)
+ * @param blockBytes Full size of the block, header and CRC included
+ * @return PACKED_OK, or why the header was rejected
+ */
+PackedStatus readPackedHeader(const uint8_t* in, size_t available, PackedBlockInfo& info, size_t& blockBytes);
+
+/**
+ * @brief Validate the header and CRC of one block without expanding it
+ *
+ * @param in Start of a candidate block
+ * @param available Bytes readable at @p in
+ * @param info Header fields (offset is left untouched)
+ * @param blockBytes Full size of the block, header and CRC included
+ * @return PACKED_OK, or why the block was rejected
+ */
+PackedStatus checkPackedBlock(const uint8_t* in, size_t available, PackedBlockInfo& info, size_t& blockBytes);
+
+/**
+ * @brief Validate and expand one block
+ *
+ * Decoded frames carry the block's scale factors and an identity
+ * quaternion.
+ *
+ * @param in Start of the block
+ * @param available Bytes readable at @p in
+ * @param frames Destination, room for PACKED_MAX_BLOCK_SAMPLES frames
+ * @param info Header fields of the block
+ * @param blockBytes Bytes consumed by the block
+ * @return Decode status; frames are valid only when PACKED_OK is returned
+ */
+PackedStatus decodePackedBlock(const uint8_t* in, size_t available, ImuFrame* frames,
+                               PackedBlockInfo& info, size_t& blockBytes);
+
+/**
+ * @brief Serialize an index entry
+ *
+ * @param out Destination, at least PACKED_INDEX_ENTRY_SIZE bytes
+ */
+void encodePackedIndexEntry(const PackedBlockInfo& info, uint8_t* out);
+
+/**
+ * @brief Validate and deserialize an index entry
+ *
+ * @return false if the entry CRC does not match
+ */
+bool decodePackedIndexEntry(const uint8_t* in, PackedBlockInfo& info);
+
+#endif // PACKED_LOG_H
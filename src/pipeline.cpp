@@ -0,0 +1,170 @@
+/**
+ * @file pipeline.cpp
+ * @brief Dual-core sampling/logging pipeline implementation
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "pipeline.h"
+#include "data_processor.h"
+#include "imu_sensor.h"
+#include "imu_sample.h"
+#include "sd_logger.h"
+#include "dashboard.h"
+#include "calibration.h"
+#include "telemetry.h"
+#include "event_capture.h"
+#include "spsc_ring.h"
+#include "task_shim.h"
+#include "instrumentation.h"
+#include "config.h"
+#include "hal.h"
+
+// ============================================================================
+// GLOBAL VARIABLES
+// ============================================================================
+
+static SpscRing<ImuSample, PIPELINE_RING_SIZE> sampleRing;
+
+static void publishSample(const ImuSample& sample)
+{
+    sampleRing.push(sample);
+}
+
+// ============================================================================
+// PIPELINE TASKS
+// ============================================================================
+
+/**
+ * @brief Acquisition and fusion task (producer)
+ * 
+ * Fuses each new data-ready sample exactly once and publishes it to the
+ * ring buffer. Never blocks on I/O.
+ */
+static void samplingTask(void* argument)
+{
+    (void)argument;
+
+    for (;;)
+    {
+        if (IMU_FIFO_MODE_ENABLED)
+        {
+            acquireFifoSamples(publishSample);
+        }
+        else if (DATA_READY_IRQ_ENABLED)
+        {
+            acquireDataReadySamples(publishSample);
+        }
+        else if (imuSensor.readByte(MPU9250_ADDRESS, INT_STATUS) & 0x01)
+        {
+            INSTRUMENT_SAMPLE(halMicros());
+            readIMUData();
+            if (STREAM_SCHEDULER_ENABLED)
+            {
+                fuseFixedStep(1.0f / IMU_SAMPLE_RATE_HZ);
+            }
+            else
+            {
+                fuseCurrentSample();
+            }
+
+            ImuSample sample;
+            captureSample(sample);
+            publishSample(sample);
+        }
+
+        taskSleep(0);
+    }
+}
+
+/**
+ * @brief SD and serial output task (consumer)
+ * 
+ * Drains the ring buffer, logs every sample in binary mode, and prints and
+ * logs one sample per output rate interval (output_config.h) in text mode.
+ */
+static void loggingTask(void* argument)
+{
+    (void)argument;
+
+    ImuSample sample;
+    uint32_t rateCount = 0;
+    float rateSum = 0.0f;
+
+    for (;;)
+    {
+        while (sampleRing.pop(sample))
+        {
+            rateCount++;
+            rateSum += sample.deltat;
+
+            if (SAMPLE_SINK_ENABLED)
+            {
+                recordSample(sample);
+            }
+
+            if (logSample(sample, (float)rateCount / rateSum))
+            {
+                rateCount = 0;
+                rateSum = 0.0f;
+            }
+        }
+
+        if (!STREAM_SCHEDULER_ENABLED)
+        {
+            logDiagnostics();
+        }
+        INSTRUMENT_SERVICE(halMillis());
+        serviceDataFiles();
+        serviceCalibrationStore(halMillis());
+        if (SERIAL_TELEMETRY_ENABLED)
+        {
+            serviceTelemetry();
+        }
+        if (EVENT_CAPTURE_ENABLED)
+        {
+            serviceEventCapture();
+        }
+        if (DASHBOARD_ENABLED)
+        {
+            // The LCD shares the SPI bus with the SD card this task writes
+            serviceDashboard(halMillis());
+        }
+        taskSleep(PIPELINE_DRAIN_INTERVAL_MS);
+    }
+}
+
+// ============================================================================
+// PIPELINE FUNCTIONS
+// ============================================================================
+
+bool startPipeline(void)
+{
+    bool started = startTask(loggingTask, "imu_logging", PIPELINE_TASK_STACK_SIZE,
+                             NULL, LOGGING_TASK_PRIORITY, LOGGING_TASK_CORE);
+
+    started = started && startTask(samplingTask, "imu_sampling", PIPELINE_TASK_STACK_SIZE,
+                                   NULL, SAMPLING_TASK_PRIORITY, SAMPLING_TASK_CORE);
+
+    if (!started)
+    {
+        Serial.println("ERROR: Failed to start pipeline tasks");
+        showStatus(STATUS_ERROR);
+        return false;
+    }
+
+    Serial.println("INFO: Pipelined sampling/logging started");
+    return true;
+}
+
+size_t pipelineBacklog(void)
+{
+    return sampleRing.size();
+}
+
+uint32_t pipelineDroppedCount(void)
+{
+    return sampleRing.droppedCount();
+}
@@ -0,0 +1,48 @@
+/**
+ * @file pipeline.h
+ * @brief Dual-core sampling/logging pipeline
+ * 
+ * Optional execution mode (PIPELINE_MODE_ENABLED) that splits the main loop
+ * into two tasks: a high-priority sampling task that reads the IMU and runs
+ * the quaternion filter, and a low-priority logging task that drains fused
+ * samples from a lock-free ring buffer and does all SD and serial output.
+ * SD card and serial stalls then no longer delay acquisition or distort the
+ * filter's deltat.
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================================
+// PIPELINE FUNCTIONS
+// ============================================================================
+
+/**
+ * @brief Start the sampling and logging tasks
+ * 
+ * The sampling task is pinned to SAMPLING_TASK_CORE and the logging task
+ * to LOGGING_TASK_CORE. Must be called after the IMU and data files have
+ * been initialized; loop() must not touch the IMU afterwards.
+ * 
+ * @return true if both tasks were created
+ */
+bool startPipeline(void);
+
+/**
+ * @brief Number of fused samples waiting for the logging task
+ */
+size_t pipelineBacklog(void);
+
+/**
+ * @brief Number of samples dropped because the ring buffer was full
+ */
+uint32_t pipelineDroppedCount(void);
+
+#endif // PIPELINE_H
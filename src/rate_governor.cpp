@@ -0,0 +1,193 @@
+/**
+ * @file rate_governor.cpp
+ * @brief Motion-adaptive sample-rate governor implementation
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "rate_governor.h"
+#include "imu_sensor.h"
+#include "sd_logger.h"
+#include "hal.h"
+#include <math.h>
+#include <stdio.h>
+
+// ============================================================================
+// PROFILES
+// ============================================================================
+
+static const RateProfile profiles[RATE_PROFILE_COUNT] = {
+    {"idle", GOV_IDLE_SMPLRT_DIV, GOV_IDLE_DLPF, GOV_IDLE_LOG_INTERVAL_MS, GOV_IDLE_LOOP_SLEEP_MS},
+    {"normal", GOV_NORMAL_SMPLRT_DIV, GOV_NORMAL_DLPF, GOV_NORMAL_LOG_INTERVAL_MS, GOV_NORMAL_LOOP_SLEEP_MS},
+    {"high", GOV_HIGH_SMPLRT_DIV, GOV_HIGH_DLPF, GOV_HIGH_LOG_INTERVAL_MS, GOV_HIGH_LOOP_SLEEP_MS},
+};
+
+const RateProfile& rateProfile(RateProfileId id)
+{
+    return profiles[id];
+}
+
+// ============================================================================
+// GOVERNOR
+// ============================================================================
+
+RateGovernor::RateGovernor(void)
+{
+    reset(RATE_PROFILE_NORMAL, 0);
+}
+
+void RateGovernor::reset(RateProfileId profile, uint32_t nowMs)
+{
+    gyroLevel = 0.0f;
+    accelLevel = 0.0f;
+    accelBaseline = 1.0f;
+    primed = false;
+    select(profile, nowMs);
+}
+
+void RateGovernor::select(RateProfileId next, uint32_t nowMs)
+{
+    current = next;
+    belowActive = false;
+    belowSinceMs = nowMs;
+
+    // First-order smoothing with the same time constant at every ODR
+    float periodMs = 1000.0f / profiles[next].rateHz();
+    gain = 1.0f - expf(-periodMs / GOV_SMOOTHING_MS);
+    baselineGain = 1.0f - expf(-periodMs / GOV_ACCEL_BASELINE_MS);
+}
+
+bool RateGovernor::heldBelow(bool below, uint32_t holdMs, uint32_t nowMs)
+{
+    if (!below)
+    {
+        belowActive = false;
+        return false;
+    }
+    if (!belowActive)
+    {
+        belowActive = true;
+        belowSinceMs = nowMs;
+    }
+    return nowMs - belowSinceMs >= holdMs;
+}
+
+bool RateGovernor::update(const float* accelG, const float* gyroDps, uint32_t nowMs)
+{
+    float rate = sqrtf(gyroDps[0] * gyroDps[0] + gyroDps[1] * gyroDps[1] + gyroDps[2] * gyroDps[2]);
+    float magnitude = sqrtf(accelG[0] * accelG[0] + accelG[1] * accelG[1] + accelG[2] * accelG[2]);
+
+    // Against a slow baseline rather than 1 g, so accel scale errors do not read as motion
+    if (!primed)
+    {
+        accelBaseline = magnitude;
+        primed = true;
+    }
+    accelBaseline += baselineGain * (magnitude - accelBaseline);
+    gyroLevel += gain * (rate - gyroLevel);
+    accelLevel += gain * (fabsf(magnitude - accelBaseline) - accelLevel);
+
+    RateProfileId next = current;
+    bool high = gyroLevel > GOV_HIGH_DPS || accelLevel > GOV_HIGH_G;
+
+    switch (current)
+    {
+    case RATE_PROFILE_IDLE:
+        if (high)
+        {
+            next = RATE_PROFILE_HIGH;
+        }
+        else if (gyroLevel > GOV_WAKE_DPS || accelLevel > GOV_WAKE_G)
+        {
+            next = RATE_PROFILE_NORMAL;
+        }
+        break;
+
+    case RATE_PROFILE_NORMAL:
+        if (high)
+        {
+            next = RATE_PROFILE_HIGH;
+        }
+        else if (heldBelow(gyroLevel < GOV_REST_DPS && accelLevel < GOV_REST_G, GOV_REST_HOLD_MS, nowMs))
+        {
+            next = RATE_PROFILE_IDLE;
+        }
+        break;
+
+    default:
+        if (heldBelow(gyroLevel < GOV_CALM_DPS && accelLevel < GOV_CALM_G, GOV_CALM_HOLD_MS, nowMs))
+        {
+            next = RATE_PROFILE_NORMAL;
+        }
+        break;
+    }
+
+    if (next == current)
+    {
+        return false;
+    }
+    select(next, nowMs);
+    return true;
+}
+
+// ============================================================================
+// FIRMWARE FUNCTIONS
+// ============================================================================
+
+static RateGovernor governor;
+
+/**
+ * @brief Program the sensor for the active profile and mark the switch
+ */
+static void applyProfile(void)
+{
+    const RateProfile& profile = profiles[governor.profile()];
+    setImuRate(profile.sampleRateDivider, profile.dlpf);
+
+    char line[64];
+    snprintf(line, sizeof(line), "\r\n#rate,%lu,%s,%u,%u,%u", (unsigned long)halMillis(), profile.name,
+             (unsigned)profile.rateHz(), (unsigned)profile.dlpf, (unsigned)profile.logIntervalMs);
+    logAnnotation(line);
+}
+
+void beginRateGovernor(void)
+{
+    governor.reset(RATE_PROFILE_NORMAL, halMillis());
+    applyProfile();
+}
+
+void rateGovernorObserveSample(void)
+{
+    const float accel[3] = {imuSensor.ax, imuSensor.ay, imuSensor.az};
+    const float gyro[3] = {imuSensor.gx, imuSensor.gy, imuSensor.gz};
+
+    if (governor.update(accel, gyro, halMillis()))
+    {
+        applyProfile();
+    }
+}
+
+void rateGovernorYield(void)
+{
+    uint16_t sleepMs = profiles[governor.profile()].loopSleepMs;
+    if (sleepMs > 0)
+    {
+        halDelay(sleepMs);
+    }
+}
+
+const RateProfile& activeRateProfile(void)
+{
+    return profiles[governor.profile()];
+}
+
+float rateGovernorSamplePeriod(void)
+{
+    if (!RATE_GOVERNOR_ENABLED)
+    {
+        return 1.0f / IMU_SAMPLE_RATE_HZ;
+    }
+    return 1.0f / profiles[governor.profile()].rateHz();
+}
@@ -0,0 +1,164 @@
+/**
+ * @file rate_governor.h
+ * @brief Motion-adaptive sample-rate governor
+ *
+ * Watches two streaming activity levels, the gyro rate and the deviation
+ * of the accel magnitude from its slow baseline, each smoothed over
+ * GOV_SMOOTHING_MS, and picks one of three profiles:
+ *
+ * - IDLE: low ODR and bandwidth, slow logging, the loop pauses between
+ *   passes. Entered after GOV_REST_HOLD_MS below the rest levels.
+ * - NORMAL: the configuration initMPU9250() sets.
+ * - HIGH: high ODR and bandwidth, fast logging. Entered as soon as either
+ *   level exceeds the high level, left after GOV_CALM_HOLD_MS below the
+ *   calm level.
+ *
+ * Switching up is immediate and switching down needs a hold time below a
+ * lower level, so a signal hovering at a threshold does not make the
+ * profile chatter. The smoothing gain follows the ODR, so the time
+ * constants hold in every profile.
+ *
+ * The firmware side fuses one fixed step per sample at the active ODR,
+ * logs at the profile's interval and marks every switch with a
+ *
+ *   #rate,<millis>,<profile>,<odr_hz>,<dlpf>,<log_interval_ms>
+ *
+ * line in the CSV streams and diagnostics.txt. It needs the polling loop:
+ * the FIFO, interrupt, pipeline, scheduler, feature and event modes size
+ * their timing from the fixed IMU_SAMPLE_RATE_HZ. It also needs the CSV
+ * log: the binary frame and packed formats have no record for the marker,
+ * so a decoder could not tell where the rate and bandwidth changed.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef RATE_GOVERNOR_H
+#define RATE_GOVERNOR_H
+
+#include <stdint.h>
+#include "config.h"
+
+static_assert(!RATE_GOVERNOR_ENABLED
+                  || !(IMU_FIFO_MODE_ENABLED || DATA_READY_IRQ_ENABLED || PIPELINE_MODE_ENABLED
+                       || STREAM_SCHEDULER_ENABLED || FEATURE_EXTRACTION_ENABLED || EVENT_CAPTURE_ENABLED),
+              "RATE_GOVERNOR_ENABLED needs the polling loop; the other modes assume IMU_SAMPLE_RATE_HZ");
+static_assert(!RATE_GOVERNOR_ENABLED || !LOG_FORMAT_BINARY,
+              "RATE_GOVERNOR_ENABLED needs the CSV log; binary streams cannot carry the #rate marker");
+static_assert(GOV_IDLE_LOOP_SLEEP_MS < 1000 / (1 + GOV_IDLE_SMPLRT_DIV),
+              "GOV_IDLE_LOOP_SLEEP_MS must be shorter than an idle sample period");
+
+// ============================================================================
+// PROFILES
+// ============================================================================
+
+enum RateProfileId
+{
+    RATE_PROFILE_IDLE = 0,
+    RATE_PROFILE_NORMAL,
+    RATE_PROFILE_HIGH,
+    RATE_PROFILE_COUNT
+};
+
+/**
+ * @brief Sensor, fusion and logging settings of one profile
+ */
+struct RateProfile
+{
+    const char* name;
+    uint8_t sampleRateDivider;      ///< SMPLRT_DIV, ODR = 1 kHz / (1 + this)
+    uint8_t dlpf;                   ///< CONFIG and ACCEL_CONFIG2 DLPF setting
+    uint16_t logIntervalMs;         ///< AHRS-mode CSV interval
+    uint16_t loopSleepMs;           ///< Pause per loop pass
+
+    uint16_t rateHz(void) const { return (uint16_t)(1000 / (1 + sampleRateDivider)); }
+};
+
+/**
+ * @brief Settings of profile @p id
+ */
+const RateProfile& rateProfile(RateProfileId id);
+
+// ============================================================================
+// GOVERNOR
+// ============================================================================
+
+/**
+ * @brief Profile selection from streaming activity levels
+ *
+ * Pure logic with no hardware access, so the host check can drive it.
+ */
+class RateGovernor
+{
+public:
+    RateGovernor(void);
+
+    /**
+     * @brief Start over in @p profile with the activity levels at rest
+     */
+    void reset(RateProfileId profile, uint32_t nowMs);
+
+    /**
+     * @brief Feed one sample taken at the current profile's ODR
+     *
+     * @param accelG Acceleration (g)
+     * @param gyroDps Bias-corrected angular rate (deg/s)
+     * @param nowMs Sample time
+     * @return true if the profile changed
+     */
+    bool update(const float* accelG, const float* gyroDps, uint32_t nowMs);
+
+    RateProfileId profile(void) const { return current; }
+    float gyroActivity(void) const { return gyroLevel; }
+    float accelActivity(void) const { return accelLevel; }
+
+private:
+    void select(RateProfileId next, uint32_t nowMs);
+    bool heldBelow(bool below, uint32_t holdMs, uint32_t nowMs);
+
+    RateProfileId current;
+    float gain;                     ///< Activity smoothing per sample at the current ODR
+    float baselineGain;
+    float gyroLevel;
+    float accelLevel;
+    float accelBaseline;
+    bool primed;
+    bool belowActive;               ///< The levels are below the step-down levels...
+    uint32_t belowSinceMs;          ///< ...since this time
+};
+
+// ============================================================================
+// FIRMWARE FUNCTIONS
+// ============================================================================
+
+/**
+ * @brief Start in the NORMAL profile and log it
+ *
+ * Call after initializeIMU(), which leaves the sensor in that profile.
+ */
+void beginRateGovernor(void);
+
+/**
+ * @brief Feed the sample just read into imuSensor; switch profiles if due
+ *
+ * A switch reprograms the ODR and DLPF right away and logs a #rate line.
+ */
+void rateGovernorObserveSample(void);
+
+/**
+ * @brief Pause the loop pass for the active profile's sleep time
+ */
+void rateGovernorYield(void);
+
+/**
+ * @brief Settings of the active profile
+ */
+const RateProfile& activeRateProfile(void);
+
+/**
+ * @brief Fusion step of one sample at the active ODR (seconds)
+ */
+float rateGovernorSamplePeriod(void);
+
+#endif // RATE_GOVERNOR_H
@@ -0,0 +1,195 @@
+/**
+ * @file real_fft.h
+ * @brief In-place radix-2 FFT of a real signal
+ *
+ * An N-point real sequence is transformed as an N/2-point complex one
+ * (even samples as the real part, odd samples as the imaginary part) with
+ * an iterative decimation-in-time FFT, then split into the spectrum of the
+ * real signal. That halves the work and the memory of a complex FFT of
+ * the same length. The bit-reversal permutation and both twiddle tables
+ * are built once in the constructor; transform() allocates nothing and
+ * works in the caller's buffer.
+ *
+ * Output layout (N floats, in place):
+ * - data[0] = Re X[0], data[1] = Re X[N/2] (both bins are real)
+ * - data[2k] = Re X[k], data[2k + 1] = Im X[k] for 0 < k < N/2
+ *
+ * X[k] = sum over n of x[n] * exp(-2 pi i k n / N), unscaled.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef REAL_FFT_H
+#define REAL_FFT_H
+
+#include <stdint.h>
+#include <math.h>
+
+// ============================================================================
+// REAL FFT
+// ============================================================================
+
+/**
+ * @brief Real FFT of a fixed power-of-two length
+ *
+ * @tparam N Transform length, a power of two from 8 to 65536
+ */
+template <int N>
+class RealFft
+{
+    static_assert(N >= 8 && N <= 65536 && (N & (N - 1)) == 0, "RealFft length must be a power of two");
+
+public:
+    static const int SIZE = N;
+    static const int BINS = N / 2 + 1;      ///< Bins 0..N/2 of the one-sided spectrum
+
+    RealFft(void)
+    {
+        int bits = 0;
+        while ((1 << bits) < HALF)
+        {
+            bits++;
+        }
+
+        for (int i = 0; i < HALF; i++)
+        {
+            int reversed = 0;
+            for (int b = 0; b < bits; b++)
+            {
+                reversed |= ((i >> b) & 1) << (bits - 1 - b);
+            }
+            bitReverse[i] = (uint16_t)reversed;
+        }
+
+        // Twiddles exp(-2 pi i k / N); the complex stages use every other one
+        for (int k = 0; k < HALF; k++)
+        {
+            double angle = -2.0 * M_PI * k / N;
+            twiddleRe[k] = (float)cos(angle);
+            twiddleIm[k] = (float)sin(angle);
+        }
+    }
+
+    /**
+     * @brief Replace N real samples with their spectrum (layout above)
+     */
+    void transform(float* data) const
+    {
+        complexTransform(data);
+
+        // X[0] and X[N/2] from Z[0]
+        float re = data[0];
+        float im = data[1];
+        data[0] = re + im;
+        data[1] = re - im;
+
+        // X[k] = E + W^k O and X[N/2 - k] = conj(E - W^k O), where
+        // E = (Z[k] + conj Z[N/2-k]) / 2 and O = -i (Z[k] - conj Z[N/2-k]) / 2
+        for (int k = 1; k <= HALF / 2; k++)
+        {
+            int m = HALF - k;
+            float aRe = data[2 * k];
+            float aIm = data[2 * k + 1];
+            float bRe = data[2 * m];
+            float bIm = -data[2 * m + 1];
+
+            float eRe = 0.5f * (aRe + bRe);
+            float eIm = 0.5f * (aIm + bIm);
+            float oRe = 0.5f * (aIm - bIm);
+            float oIm = -0.5f * (aRe - bRe);
+
+            float tRe = twiddleRe[k] * oRe - twiddleIm[k] * oIm;
+            float tIm = twiddleRe[k] * oIm + twiddleIm[k] * oRe;
+
+            data[2 * k] = eRe + tRe;
+            data[2 * k + 1] = eIm + tIm;
+            if (m != k)
+            {
+                data[2 * m] = eRe - tRe;
+                data[2 * m + 1] = -(eIm - tIm);
+            }
+        }
+    }
+
+    /**
+     * @brief Squared magnitude of bin k (0..N/2) after transform()
+     */
+    static float power(const float* spectrum, int k)
+    {
+        if (k == 0)
+        {
+            return spectrum[0] * spectrum[0];
+        }
+        if (k == HALF)
+        {
+            return spectrum[1] * spectrum[1];
+        }
+        return spectrum[2 * k] * spectrum[2 * k] + spectrum[2 * k + 1] * spectrum[2 * k + 1];
+    }
+
+private:
+    static const int HALF = N / 2;
+
+    uint16_t bitReverse[HALF];
+    float twiddleRe[HALF];
+    float twiddleIm[HALF];
+
+    /**
+     * @brief In-place N/2-point complex FFT of interleaved re/im pairs
+     */
+    void complexTransform(float* data) const
+    {
+        for (int i = 0; i < HALF; i++)
+        {
+            int j = bitReverse[i];
+            if (j > i)
+            {
+                float re = data[2 * i];
+                float im = data[2 * i + 1];
+                data[2 * i] = data[2 * j];
+                data[2 * i + 1] = data[2 * j + 1];
+                data[2 * j] = re;
+                data[2 * j + 1] = im;
+            }
+        }
+
+        // First stage: twiddle 1, no multiplies
+        for (int i = 0; i < HALF; i += 2)
+        {
+            float* a = data + 2 * i;
+            float* b = a + 2;
+            float re = b[0];
+            float im = b[1];
+            b[0] = a[0] - re;
+            b[1] = a[1] - im;
+            a[0] += re;
+            a[1] += im;
+        }
+
+        for (int span = 2; span < HALF; span <<= 1)
+        {
+            // exp(-2 pi i j / (2 span)) = table entry j * N / (2 span)
+            int step = HALF / span;
+            for (int start = 0; start < HALF; start += 2 * span)
+            {
+                float* a = data + 2 * start;
+                float* b = a + 2 * span;
+                for (int j = 0; j < span; j++)
+                {
+                    float wRe = twiddleRe[j * step];
+                    float wIm = twiddleIm[j * step];
+                    float re = wRe * b[2 * j] - wIm * b[2 * j + 1];
+                    float im = wRe * b[2 * j + 1] + wIm * b[2 * j];
+                    b[2 * j] = a[2 * j] - re;
+                    b[2 * j + 1] = a[2 * j + 1] - im;
+                    a[2 * j] += re;
+                    a[2 * j + 1] += im;
+                }
+            }
+        }
+    }
+};
+
+#endif // REAL_FFT_H
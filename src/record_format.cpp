@@ -0,0 +1,175 @@
+/**
+ * @file record_format.cpp
+ * @brief Reentrant text formatting of CSV log records implementation
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "record_format.h"
+#include <stdio.h>
+#include <string.h>
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+static const uint32_t powersOf10[RECORD_MAX_DECIMALS + 1] =
+{
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u
+};
+
+// Largest binary exponent the integer path takes: a 24-bit mantissa times
+// 10^RECORD_MAX_DECIMALS (< 2^54) still fits 64 bits shifted left by 10
+#define FIXED_MAX_SHIFT 10
+
+// ============================================================================
+// FIELD FORMATTING
+// ============================================================================
+
+/**
+ * @brief Append a 64-bit unsigned value in decimal
+ */
+static char* appendUnsigned64(char* out, uint64_t value)
+{
+    char digits[20];
+    int count = 0;
+
+    do
+    {
+        digits[count++] = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value != 0);
+
+    while (count > 0)
+    {
+        *out++ = digits[--count];
+    }
+    return out;
+}
+
+char* appendUnsigned(char* out, uint32_t value)
+{
+    char digits[10];
+    int count = 0;
+
+    do
+    {
+        digits[count++] = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value != 0);
+
+    while (count > 0)
+    {
+        *out++ = digits[--count];
+    }
+    return out;
+}
+
+char* appendFixed(char* out, float value, uint8_t decimals)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    bool negative = (bits >> 31) != 0;
+    int exponent = (int)((bits >> 23) & 0xFF);
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    // value = mantissa * 2^shift exactly
+    if (exponent == 0)
+    {
+        exponent = 1;
+    }
+    else
+    {
+        mantissa |= 0x800000;
+    }
+    int shift = exponent - 150;
+
+    if (exponent == 0xFF || shift > FIXED_MAX_SHIFT || decimals > RECORD_MAX_DECIMALS)
+    {
+        int length = snprintf(out, RECORD_VALUE_MAX_SIZE, "%.*f", (int)decimals, (double)value);
+        return out + ((length > 0) ? length : 0);
+    }
+
+    // The value in units of 10^-decimals, rounded half to even like printf
+    uint64_t scaled = (uint64_t)mantissa * powersOf10[decimals];
+    uint64_t units;
+    if (shift >= 0)
+    {
+        units = scaled << shift;
+    }
+    else if (shift <= -64)
+    {
+        units = 0;
+    }
+    else
+    {
+        int right = -shift;
+        uint64_t remainder = scaled & ((1ull << right) - 1);
+        uint64_t half = 1ull << (right - 1);
+        units = scaled >> right;
+        if (remainder > half || (remainder == half && (units & 1) != 0))
+        {
+            units++;
+        }
+    }
+
+    // printf keeps the sign of values that round to zero ("-0.000000")
+    if (negative)
+    {
+        *out++ = '-';
+    }
+
+    uint32_t divisor = powersOf10[decimals];
+    out = appendUnsigned64(out, units / divisor);
+    if (decimals > 0)
+    {
+        uint32_t fraction = (uint32_t)(units % divisor);
+        *out++ = '.';
+        for (int i = decimals - 1; i >= 0; i--)
+        {
+            out[i] = (char)('0' + (fraction % 10));
+            fraction /= 10;
+        }
+        out += decimals;
+    }
+    return out;
+}
+
+// ============================================================================
+// RECORD FORMATTING
+// ============================================================================
+
+size_t formatCsvRecord(char* out, uint32_t timestampMs, const float* values, uint8_t count)
+{
+    char* p = out;
+
+    *p++ = '\r';
+    *p++ = '\n';
+    p = appendUnsigned(p, timestampMs);
+    for (uint8_t i = 0; i < count && i < CSV_RECORD_MAX_VALUES; i++)
+    {
+        *p++ = ',';
+        p = appendFixed(p, values[i], RECORD_DECIMALS);
+    }
+    return (size_t)(p - out);
+}
+
+size_t formatCsvValues(char* out, const float* values, uint8_t count)
+{
+    char* p = out;
+
+    *p++ = '\r';
+    *p++ = '\n';
+    for (uint8_t i = 0; i < count && i < CSV_RECORD_MAX_VALUES; i++)
+    {
+        if (i > 0)
+        {
+            *p++ = ',';
+        }
+        p = appendFixed(p, values[i], RECORD_DECIMALS);
+    }
+    return (size_t)(p - out);
+}
@@ -0,0 +1,92 @@
+/**
+ * @file record_format.h
+ * @brief Reentrant text formatting of CSV log records
+ *
+ * Writes the "\r\n<millis>,<value>,..." lines of the text log without
+ * snprintf. Integers are converted by repeated division and floats by
+ * scaling the exact binary value by a power of ten in 64-bit integer
+ * arithmetic, rounding half to even, so the output is byte-identical to
+ * printf's "%lu" and "%.<n>f" (the logger has always used "%lf", i.e. six
+ * decimals). Values too large for the integer path (2^34 and above), NaN
+ * and infinity fall back to snprintf.
+ *
+ * Every function writes only to the caller's buffer and keeps no state,
+ * so any task can format into its own stream at any time. This file has
+ * no Arduino dependencies so the host checks can share it.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef RECORD_FORMAT_H
+#define RECORD_FORMAT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================================
+// FORMAT CONSTANTS
+// ============================================================================
+
+// Decimals of the CSV columns ("%lf")
+#define RECORD_DECIMALS 6
+#define RECORD_MAX_DECIMALS 9
+
+// Longest formatted float: sign, 39 integer digits of FLT_MAX, point,
+// RECORD_MAX_DECIMALS digits and the terminator snprintf adds on fallback
+#define RECORD_VALUE_MAX_SIZE (1 + 39 + 1 + RECORD_MAX_DECIMALS + 1)
+
+#define CSV_RECORD_MAX_VALUES 4
+
+// "\r\n", a 10-digit timestamp and ",<value>" per column
+#define CSV_RECORD_MAX_SIZE (2 + 10 + CSV_RECORD_MAX_VALUES * (1 + RECORD_VALUE_MAX_SIZE))
+
+// ============================================================================
+// FIELD FORMATTING
+// ============================================================================
+
+/**
+ * @brief Append @p value in decimal ("%lu")
+ *
+ * @param out Destination, at least 10 bytes
+ * @return Pointer past the last character written (not terminated)
+ */
+char* appendUnsigned(char* out, uint32_t value);
+
+/**
+ * @brief Append @p value with @p decimals fixed decimals ("%.<decimals>f")
+ *
+ * @param out Destination, at least RECORD_VALUE_MAX_SIZE bytes
+ * @param value Value to format
+ * @param decimals Digits after the point, at most RECORD_MAX_DECIMALS
+ * @return Pointer past the last character written (not terminated)
+ */
+char* appendFixed(char* out, float value, uint8_t decimals);
+
+// ============================================================================
+// RECORD FORMATTING
+// ============================================================================
+
+/**
+ * @brief Format one timestamped CSV line, "\r\n<millis>,<v0>,..."
+ *
+ * @param out Destination, at least CSV_RECORD_MAX_SIZE bytes
+ * @param timestampMs First column
+ * @param values Remaining columns, RECORD_DECIMALS decimals each
+ * @param count Number of values, at most CSV_RECORD_MAX_VALUES
+ * @return Characters written (not terminated)
+ */
+size_t formatCsvRecord(char* out, uint32_t timestampMs, const float* values, uint8_t count);
+
+/**
+ * @brief Format one CSV line without a timestamp, "\r\n<v0>,<v1>,..."
+ *
+ * @param out Destination, at least CSV_RECORD_MAX_SIZE bytes
+ * @param values Columns, RECORD_DECIMALS decimals each
+ * @param count Number of values, 1 to CSV_RECORD_MAX_VALUES
+ * @return Characters written (not terminated)
+ */
+size_t formatCsvValues(char* out, const float* values, uint8_t count);
+
+#endif // RECORD_FORMAT_H
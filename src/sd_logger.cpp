@@ -8,7 +8,814 @@
  */
 
 #include "sd_logger.h"
+#include "dashboard.h"
 #include "config.h"
+#include "instrumentation.h"
+#include "log_record.h"
+#include "packed_log.h"
+#include "record_format.h"
+#include "feature_extractor.h"
+
+// ============================================================================
+// SYNC MARKERS
+// ============================================================================
+
+static const char MARKER_PREFIX[] = "\r\n#sync,";
+#define MARKER_PREFIX_SIZE (sizeof(MARKER_PREFIX) - 1)
+
+// "\r\n#sync," + two 10-digit numbers, a comma and ",XXXX"
+#define MARKER_MAX_SIZE 40
+
+#if LOG_RECOVERY_WINDOW_SIZE < PACKED_MAX_BLOCK_SIZE || LOG_RECOVERY_WINDOW_SIZE < LOG_RECOVERY_CHUNK_SIZE + MARKER_MAX_SIZE
+#error "LOG_RECOVERY_WINDOW_SIZE must hold a packed block and a read chunk plus a marker"
+#endif
+
+#if LOG_BLOCK_SIZE <= CSV_RECORD_MAX_SIZE
+#error "LOG_BLOCK_SIZE must be larger than a CSV record"
+#endif
+
+// ============================================================================
+// DATA LOG STREAMS
+// ============================================================================
+
+LogStream accelLog;
+LogStream gyroLog;
+LogStream magLog;
+LogStream quaternionLog;
+LogStream yprLog;
+LogStream diagnosticsLog;
+LogStream binaryLog;
+LogStream packedIndexLog;
+LogStream featureLog;
+
+// ============================================================================
+// BUFFERED LOG STREAM
+// ============================================================================
+
+LogStream::LogStream(void)
+    : isOpenFlag(false),
+      framed(false),
+      markerDue(false),
+      fileBytes(0),
+      bufferFill(0),
+      lastFlushMs(0),
+      lastSyncMs(0),
+      dirty(false),
+      flushes(0),
+      syncs(0),
+      totalBytes(0),
+      errors(0)
+{
+    filePath[0] = '\0';
+}
+
+bool LogStream::begin(fs::FS& fs, const char* path, const char* header)
+{
+    // The serial port carries binary frames when telemetry is on, and
+    // segment rotation reopens streams mid-recording
+    if (!SERIAL_TELEMETRY_ENABLED)
+    {
+        Serial.printf("Opening log stream: %s\n", path);
+    }
+
+    close();
+    snprintf(filePath, sizeof(filePath), "%s", path);
+    file = fs.open(path, FILE_WRITE);
+    if (!file)
+    {
+        Serial.println("ERROR: Failed to open log stream");
+        showStatus(STATUS_ERROR);
+        errors++;
+        return false;
+    }
+
+    isOpenFlag = true;
+    framed = false;
+    fileBytes = 0;
+    bufferFill = 0;
+    lastFlushMs = halMillis();
+    lastSyncMs = lastFlushMs;
+    return print(header);
+}
+
+bool LogStream::beginSegment(fs::FS& fs, const char* path, const char* segmentLine, const char* header)
+{
+    if (!begin(fs, path, segmentLine))
+    {
+        return false;
+    }
+
+    framed = true;
+    if (header[0] != '\0' && !(print("\r\n") && print(header)))
+    {
+        return false;
+    }
+    return stageMarker();
+}
+
+bool LogStream::write(const char* data, size_t length)
+{
+    if (!isOpenFlag)
+    {
+        return false;
+    }
+
+    markerDue = true;
+    while (length > 0)
+    {
+        size_t space = LOG_BLOCK_SIZE - bufferFill;
+        size_t chunk = (length < space) ? length : space;
+
+        memcpy(buffer + bufferFill, data, chunk);
+        bufferFill += chunk;
+        data += chunk;
+        length -= chunk;
+
+        if (bufferFill == LOG_BLOCK_SIZE)
+        {
+            INSTRUMENT_COUNT(COUNTER_INLINE_BLOCKS);
+            if (!writeBlock())
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool LogStream::print(const char* message)
+{
+    return write(message, strlen(message));
+}
+
+bool LogStream::printRecord(uint32_t timestampMs, const float* values, uint8_t count)
+{
+    if (!isOpenFlag)
+    {
+        return false;
+    }
+
+    if (LOG_BLOCK_SIZE - bufferFill < CSV_RECORD_MAX_SIZE)
+    {
+        char line[CSV_RECORD_MAX_SIZE];
+        return write(line, formatCsvRecord(line, timestampMs, values, count));
+    }
+
+    // Shorter than the free space, so the block cannot fill here
+    markerDue = true;
+    bufferFill += formatCsvRecord(buffer + bufferFill, timestampMs, values, count);
+    return true;
+}
+
+void LogStream::service(uint32_t nowMs)
+{
+    if (!isOpenFlag)
+    {
+        return;
+    }
+
+    if (bufferFill > 0 && (nowMs - lastFlushMs) >= LOG_FLUSH_INTERVAL_MS)
+    {
+        writeBlock();
+    }
+
+    if (dirty && (nowMs - lastSyncMs) >= LOG_SYNC_INTERVAL_MS)
+    {
+        sync();
+    }
+}
+
+bool LogStream::flush(void)
+{
+    if (!isOpenFlag)
+    {
+        return false;
+    }
+
+    return (bufferFill == 0) || writeBlock();
+}
+
+bool LogStream::sync(void)
+{
+    if (framed && markerDue && isOpenFlag && !stageMarker())
+    {
+        return false;
+    }
+    if (!flush())
+    {
+        return false;
+    }
+
+    if (dirty)
+    {
+        file.flush();
+        dirty = false;
+        syncs++;
+    }
+    lastSyncMs = halMillis();
+    return true;
+}
+
+void LogStream::close(void)
+{
+    if (!isOpenFlag)
+    {
+        return;
+    }
+
+    sync();
+    file.close();
+    isOpenFlag = false;
+}
+
+bool LogStream::writeBlock(void)
+{
+    INSTRUMENT_BEGIN(STAGE_SD_WRITE);
+    size_t written = file.write((const uint8_t*)buffer, bufferFill);
+    INSTRUMENT_END(STAGE_SD_WRITE);
+
+    lastFlushMs = halMillis();
+    flushes++;
+    totalBytes += written;
+    fileBytes += written;
+
+    if (written != bufferFill)
+    {
+        Serial.print("ERROR: Block write failed on ");
+        Serial.println(filePath);
+        errors++;
+        bufferFill = 0;
+        return false;
+    }
+
+    bufferFill = 0;
+    dirty = true;
+    return true;
+}
+
+bool LogStream::stageMarker(void)
+{
+    char marker[MARKER_MAX_SIZE + 1];
+    unsigned long offset = segmentBytes();
+
+    // The CRC covers "#sync,<millis>,<offset>" and is appended after it
+    int length = snprintf(marker, sizeof(marker), "\r\n#sync,%lu,%lu", (unsigned long)halMillis(), offset);
+    uint16_t crc = crc16Ccitt((const uint8_t*)marker + 2, length - 2);
+    snprintf(marker + length, sizeof(marker) - length, ",%04X", (unsigned)crc);
+
+    bool ok = print(marker);
+    markerDue = false;
+    return ok;
+}
+
+// ============================================================================
+// RECOVERY
+// ============================================================================
+
+/**
+ * @brief Forward reader over the part of a file after the last marker
+ */
+struct RecoveryReader
+{
+    File& file;
+    uint8_t* window;            ///< LOG_RECOVERY_WINDOW_SIZE bytes
+    uint32_t base;              ///< File offset of window[0]
+    size_t fill;
+    size_t pos;
+    bool eof;
+    uint32_t scanned;
+};
+
+/**
+ * @brief Read ahead until @p need bytes are available at the read position
+ * 
+ * @return Bytes available (fewer than @p need only at the end of the file)
+ */
+static size_t recoveryAvailable(RecoveryReader& reader, size_t need)
+{
+    if (reader.fill - reader.pos >= need || reader.eof)
+    {
+        return reader.fill - reader.pos;
+    }
+
+    memmove(reader.window, reader.window + reader.pos, reader.fill - reader.pos);
+    reader.base += reader.pos;
+    reader.fill -= reader.pos;
+    reader.pos = 0;
+
+    while (reader.fill < need && !reader.eof)
+    {
+        size_t space = LOG_RECOVERY_WINDOW_SIZE - reader.fill;
+        size_t chunk = (space < LOG_RECOVERY_CHUNK_SIZE) ? space : LOG_RECOVERY_CHUNK_SIZE;
+        size_t got = reader.file.read(reader.window + reader.fill, chunk);
+        reader.fill += got;
+        reader.scanned += got;
+        reader.eof = (got == 0);
+    }
+    return reader.fill - reader.pos;
+}
+
+/**
+ * @brief Check for a valid sync marker at @p in
+ * 
+ * @param position File offset of @p in
+ * @return Marker size in bytes, or 0 if there is none
+ */
+static size_t parseMarker(const uint8_t* in, size_t available, uint32_t position)
+{
+    if (available < MARKER_PREFIX_SIZE || memcmp(in, MARKER_PREFIX, MARKER_PREFIX_SIZE) != 0)
+    {
+        return 0;
+    }
+
+    // millis, then offset, each terminated by a comma
+    size_t i = MARKER_PREFIX_SIZE;
+    uint64_t value = 0;
+    for (int field = 0; field < 2; field++)
+    {
+        size_t start = i;
+        value = 0;
+        while (i < available && i - start < 10 && in[i] >= '0' && in[i] <= '9')
+        {
+            value = value * 10 + (in[i] - '0');
+            i++;
+        }
+        if (i == start || i >= available || in[i] != ',')
+        {
+            return 0;
+        }
+        i++;
+    }
+
+    size_t textEnd = i - 1;
+    if (available < i + 4 || value != position)
+    {
+        return 0;
+    }
+
+    uint16_t crc = 0;
+    for (size_t d = i; d < i + 4; d++)
+    {
+        uint8_t c = in[d];
+        uint8_t digit;
+        if (c >= '0' && c <= '9')
+        {
+            digit = c - '0';
+        }
+        else if (c >= 'A' && c <= 'F')
+        {
+            digit = c - 'A' + 10;
+        }
+        else
+        {
+            return 0;
+        }
+        crc = (uint16_t)((crc << 4) | digit);
+    }
+
+    return (crc == crc16Ccitt(in + 2, textEnd - 2)) ? i + 4 : 0;
+}
+
+/**
+ * @brief Length of the text line at the read position
+ * 
+ * A line counts only once the next line has started, so one cut off in
+ * the middle of its text is not mistaken for a complete one.
+ * 
+ * @return Line size in bytes, or 0 if it is damaged or not confirmed
+ */
+static size_t textRecordLength(RecoveryReader& reader)
+{
+    size_t available = recoveryAvailable(reader, LOG_RECOVERY_CHUNK_SIZE + 2);
+    const uint8_t* p = reader.window + reader.pos;
+
+    if (available < 2 || p[0] != '\r' || p[1] != '\n')
+    {
+        return 0;
+    }
+
+    for (size_t i = 2; i + 1 < available; i++)
+    {
+        if (p[i] == '\r' && p[i + 1] == '\n')
+        {
+            return (i > 2) ? i : 0;
+        }
+        if (p[i] < 0x20 || p[i] > 0x7E)
+        {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Length of the frame, scale record or packed block at the read position
+ * 
+ * @return Record size in bytes, or 0 if it is damaged or incomplete
+ */
+static size_t binaryRecordLength(RecoveryReader& reader, LogRecordKind kind)
+{
+    if (kind == LOG_RECORDS_FRAMES)
+    {
+        // Frames need no scale to be complete, so the scan keeps none
+        FrameScaleState state;
+        ImuFrame frame;
+        size_t recordBytes;
+        size_t available = recoveryAvailable(reader, LOG_RECORD_MAX_SIZE);
+        resetFrameScaleState(state);
+        FrameStatus status = decodeLogRecord(reader.window + reader.pos, available, state, frame, recordBytes);
+        return (status == FRAME_OK || status == FRAME_SCALE || status == FRAME_NO_SCALE) ? recordBytes : 0;
+    }
+
+    PackedBlockInfo info;
+    size_t blockBytes;
+    size_t available = recoveryAvailable(reader, PACKED_HEADER_SIZE);
+    PackedStatus status = readPackedHeader(reader.window + reader.pos, available, info, blockBytes);
+    if (status == PACKED_TRUNCATED && available >= PACKED_HEADER_SIZE)
+    {
+        available = recoveryAvailable(reader, blockBytes);
+    }
+    else if (status != PACKED_OK)
+    {
+        return 0;
+    }
+
+    status = checkPackedBlock(reader.window + reader.pos, available, info, blockBytes);
+    return (status == PACKED_OK) ? blockBytes : 0;
+}
+
+/**
+ * @brief Search backwards, one aligned chunk at a time, for the last marker
+ * 
+ * @param markerEnd File offset just past the marker
+ */
+static bool findLastMarker(File& file, uint32_t fileBytes, uint8_t* buffer, uint32_t& markerEnd, uint32_t& scanned)
+{
+    uint32_t chunkEnd = fileBytes;
+
+    while (chunkEnd > 0)
+    {
+        uint32_t chunkStart = ((chunkEnd - 1) / LOG_RECOVERY_CHUNK_SIZE) * LOG_RECOVERY_CHUNK_SIZE;
+
+        // Also read the start of the next chunk: a marker may straddle the boundary
+        uint32_t readEnd = chunkEnd + MARKER_MAX_SIZE;
+        if (readEnd > fileBytes)
+        {
+            readEnd = fileBytes;
+        }
+
+        file.seek(chunkStart);
+        size_t got = file.read(buffer, readEnd - chunkStart);
+        scanned += got;
+
+        for (size_t i = chunkEnd - chunkStart; i-- > 0;)
+        {
+            if (buffer[i] != '\r' || i >= got)
+            {
+                continue;
+            }
+            size_t length = parseMarker(buffer + i, got - i, chunkStart + i);
+            if (length > 0)
+            {
+                markerEnd = chunkStart + i + length;
+                return true;
+            }
+        }
+        chunkEnd = chunkStart;
+    }
+    return false;
+}
+
+/**
+ * @brief Find the last entry of an index file whose CRC matches
+ */
+static void recoverIndex(File& file, uint8_t* buffer, LogRecovery& result)
+{
+    uint32_t chunkEnd = result.fileBytes - result.fileBytes % PACKED_INDEX_ENTRY_SIZE;
+
+    while (chunkEnd > 0)
+    {
+        uint32_t chunkStart = ((chunkEnd - 1) / LOG_RECOVERY_CHUNK_SIZE) * LOG_RECOVERY_CHUNK_SIZE;
+
+        file.seek(chunkStart);
+        size_t got = file.read(buffer, chunkEnd - chunkStart);
+        result.scannedBytes += got;
+
+        for (size_t end = got - got % PACKED_INDEX_ENTRY_SIZE; end > 0; end -= PACKED_INDEX_ENTRY_SIZE)
+        {
+            PackedBlockInfo info;
+            if (decodePackedIndexEntry(buffer + end - PACKED_INDEX_ENTRY_SIZE, info))
+            {
+                result.validBytes = chunkStart + end;
+                result.records = result.validBytes / PACKED_INDEX_ENTRY_SIZE;
+                return;
+            }
+        }
+        chunkEnd = chunkStart;
+    }
+}
+
+bool recoverLogSegment(fs::FS& fs, const char* path, LogRecordKind kind, LogRecovery& result)
+{
+    static uint8_t window[LOG_RECOVERY_WINDOW_SIZE];
+
+    memset(&result, 0, sizeof(result));
+    File file = fs.open(path, FILE_READ);
+    if (!file)
+    {
+        return false;
+    }
+    result.fileBytes = file.size();
+
+    if (kind == LOG_RECORDS_INDEX)
+    {
+        recoverIndex(file, window, result);
+        file.close();
+        return true;
+    }
+
+    uint32_t markerEnd;
+    if (findLastMarker(file, result.fileBytes, window, markerEnd, result.scannedBytes))
+    {
+        result.markerFound = true;
+        result.validBytes = markerEnd;
+
+        RecoveryReader reader = {file, window, markerEnd, 0, 0, false, 0};
+        file.seek(markerEnd);
+        for (;;)
+        {
+            size_t available = recoveryAvailable(reader, MARKER_MAX_SIZE);
+            if (available == 0)
+            {
+                break;
+            }
+
+            size_t length = parseMarker(reader.window + reader.pos, available, reader.base + reader.pos);
+            if (length == 0)
+            {
+                length = (kind == LOG_RECORDS_TEXT) ? textRecordLength(reader) : binaryRecordLength(reader, kind);
+                if (length == 0)
+                {
+                    break;
+                }
+                result.records++;
+            }
+            reader.pos += length;
+            result.validBytes = reader.base + reader.pos;
+        }
+        result.scannedBytes += reader.scanned;
+    }
+
+    file.close();
+    return true;
+}
+
+// ============================================================================
+// SESSIONS AND SEGMENTS
+// ============================================================================
+
+/**
+ * @brief One data file of a segment
+ */
+struct LogFileSpec
+{
+    LogStream* stream;
+    const char* file;
+    const char* header;
+    LogRecordKind kind;
+    bool enabled;               ///< Written by this build
+};
+
+// Feature records replace the five raw CSV streams
+#define CSV_STREAMS_ENABLED (!LOG_FORMAT_BINARY && !FEATURE_EXTRACTION_ENABLED)
+
+static const LogFileSpec logFiles[] = {
+    {&accelLog, FILE_ACCELERATION, "millis,aX,aY,aZ", LOG_RECORDS_TEXT, CSV_STREAMS_ENABLED},
+    {&gyroLog, FILE_GYROSCOPE, "millis,gX,gY,gZ", LOG_RECORDS_TEXT, CSV_STREAMS_ENABLED},
+    {&magLog, FILE_MAGNETOMETER, "millis,mX,mY,mZ", LOG_RECORDS_TEXT, CSV_STREAMS_ENABLED},
+    {&quaternionLog, FILE_QUATERNION, "millis,q0,qX,qY,qZ", LOG_RECORDS_TEXT, CSV_STREAMS_ENABLED},
+    {&yprLog, FILE_YPR, "millis,rate_hz,Yaw,Pitch,Roll", LOG_RECORDS_TEXT, CSV_STREAMS_ENABLED},
+    {&binaryLog, FILE_BINARY_LOG, "", LOG_RECORDS_FRAMES, LOG_FORMAT_BINARY && !LOG_FORMAT_COMPRESSED},
+    {&binaryLog, FILE_PACKED_LOG, "", LOG_RECORDS_PACKED, LOG_FORMAT_BINARY && LOG_FORMAT_COMPRESSED},
+    {&packedIndexLog, FILE_PACKED_INDEX, "", LOG_RECORDS_INDEX, LOG_FORMAT_BINARY && LOG_FORMAT_COMPRESSED},
+    {&featureLog, FILE_FEATURES, featureLogHeader(), LOG_RECORDS_TEXT, FEATURE_EXTRACTION_ENABLED},
+    {&diagnosticsLog, FILE_DIAGNOSTICS, "SelfTest,GyroBias,AccelBias,MagCalibration", LOG_RECORDS_TEXT, true},
+};
+
+#define LOG_FILE_COUNT (sizeof(logFiles) / sizeof(logFiles[0]))
+
+static uint16_t sessionNumber = 0;
+static uint16_t segmentNumber = 0;
+static uint32_t segmentLimit = LOG_SEGMENT_MAX_BYTES;
+
+/**
+ * @brief Segment directory, or a file inside it when @p file is given
+ */
+static void segmentPath(char* out, size_t size, uint16_t session, uint16_t segment, const char* file)
+{
+    int length = snprintf(out, size, LOG_SEGMENT_DIR_FORMAT, (unsigned)session, (unsigned)segment);
+    if (file != NULL && length > 0 && (size_t)length < size)
+    {
+        snprintf(out + length, size - length, "%s", file);
+    }
+}
+
+/**
+ * @brief Pick the next unused session number and create its directory
+ */
+static void startSession(fs::FS& fs)
+{
+    char path[LOG_PATH_SIZE];
+    char text[16];
+    unsigned long last = 0;
+
+    File counter = fs.open(FILE_SESSION_COUNTER, FILE_READ);
+    if (counter)
+    {
+        size_t length = counter.read((uint8_t*)text, sizeof(text) - 1);
+        text[length] = '\0';
+        last = strtoul(text, NULL, 10);
+        counter.close();
+    }
+
+    // The counter lags behind the directories if power failed in between
+    sessionNumber = (uint16_t)(last + 1);
+    snprintf(path, sizeof(path), LOG_SESSION_DIR_FORMAT, (unsigned)sessionNumber);
+    while (fs.exists(path))
+    {
+        sessionNumber++;
+        snprintf(path, sizeof(path), LOG_SESSION_DIR_FORMAT, (unsigned)sessionNumber);
+    }
+    fs.mkdir(path);
+
+    counter = fs.open(FILE_SESSION_COUNTER, FILE_WRITE);
+    if (counter)
+    {
+        snprintf(text, sizeof(text), "%u", (unsigned)sessionNumber);
+        counter.print(text);
+        counter.close();
+    }
+    Serial.printf("INFO: Logging session %u\n", (unsigned)sessionNumber);
+}
+
+/**
+ * @brief Highest segment number of @p session (segment 0 must exist)
+ * 
+ * Segments are numbered without gaps, so an exponential search followed
+ * by bisection needs O(log n) directory lookups.
+ */
+static uint16_t lastSegment(fs::FS& fs, uint16_t session)
+{
+    char path[LOG_PATH_SIZE];
+    uint32_t present = 0;
+    uint32_t absent = 1;
+
+    for (;;)
+    {
+        segmentPath(path, sizeof(path), session, (uint16_t)absent, NULL);
+        if (absent > 0xFFFF || !fs.exists(path))
+        {
+            break;
+        }
+        present = absent;
+        absent *= 2;
+    }
+
+    while (absent - present > 1)
+    {
+        uint32_t middle = (present + absent) / 2;
+        segmentPath(path, sizeof(path), session, (uint16_t)middle, NULL);
+        if (fs.exists(path))
+        {
+            present = middle;
+        }
+        else
+        {
+            absent = middle;
+        }
+    }
+    return (uint16_t)present;
+}
+
+/**
+ * @brief Report the valid length of every file in the previous session's last segment
+ * 
+ * Earlier segments were closed cleanly and end in a sync marker. The
+ * Arduino FS API cannot truncate a file, so a damaged tail is reported
+ * (and skipped by the readers) rather than cut off.
+ */
+static void recoverPreviousSession(fs::FS& fs)
+{
+    char path[LOG_PATH_SIZE];
+    char line[LOG_PATH_SIZE + 64];
+
+    if (sessionNumber <= 1)
+    {
+        return;
+    }
+
+    uint16_t previous = sessionNumber - 1;
+    segmentPath(path, sizeof(path), previous, 0, NULL);
+    if (!fs.exists(path))
+    {
+        return;
+    }
+    uint16_t segment = lastSegment(fs, previous);
+
+    for (size_t i = 0; i < LOG_FILE_COUNT; i++)
+    {
+        LogRecovery recovery;
+        segmentPath(path, sizeof(path), previous, segment, logFiles[i].file);
+        if (!fs.exists(path) || !recoverLogSegment(fs, path, logFiles[i].kind, recovery))
+        {
+            continue;
+        }
+
+        snprintf(line, sizeof(line), "\r\n#recover,%s,%lu,%lu,%lu,%lu", path,
+                 (unsigned long)recovery.fileBytes, (unsigned long)recovery.validBytes,
+                 (unsigned long)recovery.scannedBytes, (unsigned long)recovery.records);
+        diagnosticsLog.print(line);
+        Serial.printf("INFO: Recovered %s: %lu of %lu bytes valid (%lu read)\n", path,
+                      (unsigned long)recovery.validBytes, (unsigned long)recovery.fileBytes,
+                      (unsigned long)recovery.scannedBytes);
+    }
+}
+
+/**
+ * @brief Create the current segment directory and open its files
+ */
+static void openSegment(fs::FS& fs)
+{
+    char path[LOG_PATH_SIZE];
+    char segmentLine[48];
+
+    segmentPath(path, sizeof(path), sessionNumber, segmentNumber, NULL);
+    fs.mkdir(path);
+    snprintf(segmentLine, sizeof(segmentLine), "#segment,%u,%u,%lu",
+             (unsigned)sessionNumber, (unsigned)segmentNumber, (unsigned long)halMillis());
+
+    for (size_t i = 0; i < LOG_FILE_COUNT; i++)
+    {
+        const LogFileSpec& spec = logFiles[i];
+        if (!spec.enabled)
+        {
+            continue;
+        }
+
+        segmentPath(path, sizeof(path), sessionNumber, segmentNumber, spec.file);
+        if (spec.kind == LOG_RECORDS_INDEX)
+        {
+            // Fixed-size entries; offsets in it are relative to this segment
+            spec.stream->begin(fs, path, "");
+        }
+        else
+        {
+            spec.stream->beginSegment(fs, path, segmentLine, spec.header);
+        }
+    }
+}
+
+/**
+ * @brief Close every stream and continue in the next segment
+ */
+static void rotateSegment(void)
+{
+    for (size_t i = 0; i < LOG_FILE_COUNT; i++)
+    {
+        if (logFiles[i].enabled)
+        {
+            logFiles[i].stream->close();
+        }
+    }
+
+    segmentNumber++;
+    openSegment(halStorage());
+}
+
+uint16_t logSessionNumber(void)
+{
+    return sessionNumber;
+}
+
+uint16_t logSegmentNumber(void)
+{
+    return segmentNumber;
+}
+
+void logSegmentFilePath(char* out, size_t size, const char* file)
+{
+    segmentPath(out, size, sessionNumber, segmentNumber, file);
+}
+
+void setLogSegmentLimit(uint32_t bytes)
+{
+    segmentLimit = bytes;
+}
+
+// ============================================================================
+// SD CARD FILE OPERATIONS
+// ============================================================================
 
 void appendFile(fs::FS& fs, const char* path, const char* message)
 {
@@ -16,7 +823,7 @@ void appendFile(fs::FS& fs, const char* path, const char* message)
     if (!file)
     {
         Serial.println("ERROR: Failed to open file for appending");
-        M5.Lcd.fillScreen(RED);
+        showStatus(STATUS_ERROR);
         return;
     }
     
@@ -36,7 +843,7 @@ void writeFile(fs::FS& fs, const char* path, const char* message)
     if (!file)
     {
         Serial.println("ERROR: Failed to open file for writing");
-        M5.Lcd.fillScreen(RED);
+        showStatus(STATUS_ERROR);
         return;
     }
     
@@ -47,7 +854,7 @@ void writeFile(fs::FS& fs, const char* path, const char* message)
     else
     {
         Serial.println("ERROR: Write operation failed");
-        M5.Lcd.fillScreen(RED);
+        showStatus(STATUS_ERROR);
     }
     
     file.close();
@@ -55,10 +862,86 @@ void writeFile(fs::FS& fs, const char* path, const char* message)
 
 void initializeDataFiles(void)
 {
-    writeFile(SD, FILE_ACCELERATION, "millis,aX,aY,aZ");
-    writeFile(SD, FILE_GYROSCOPE, "millis,gX,gY,gZ");
-    writeFile(SD, FILE_MAGNETOMETER, "millis,mX,mY,mZ");
-    writeFile(SD, FILE_QUATERNION, "millis,q0,qX,qY,qZ");
-    writeFile(SD, FILE_YPR, "millis,rate_hz,Yaw,Pitch,Roll");
-    writeFile(SD, FILE_DIAGNOSTICS, "SelfTest,GyroBias,AccelBias,MagCalibration");
+    fs::FS& fs = halStorage();
+
+    startSession(fs);
+    segmentNumber = 0;
+    openSegment(fs);
+    recoverPreviousSession(fs);
+}
+
+void serviceDataFiles(void)
+{
+    uint32_t now = halMillis();
+
+    accelLog.service(now);
+    gyroLog.service(now);
+    magLog.service(now);
+    quaternionLog.service(now);
+    yprLog.service(now);
+    diagnosticsLog.service(now);
+    binaryLog.service(now);
+    packedIndexLog.service(now);
+    featureLog.service(now);
+
+    // Records are staged whole, so a segment never ends inside one
+    for (size_t i = 0; i < LOG_FILE_COUNT; i++)
+    {
+        if (logFiles[i].enabled && logFiles[i].stream->segmentBytes() >= segmentLimit)
+        {
+            rotateSegment();
+            break;
+        }
+    }
+}
+
+void syncDataFiles(void)
+{
+    accelLog.sync();
+    gyroLog.sync();
+    magLog.sync();
+    quaternionLog.sync();
+    yprLog.sync();
+    diagnosticsLog.sync();
+    binaryLog.sync();
+    packedIndexLog.sync();
+    featureLog.sync();
+}
+
+void logAnnotation(const char* line)
+{
+    for (size_t i = 0; i < LOG_FILE_COUNT; i++)
+    {
+        const LogFileSpec& spec = logFiles[i];
+        if (spec.enabled && spec.kind == LOG_RECORDS_TEXT)
+        {
+            spec.stream->print(line);
+        }
+    }
+}
+
+uint8_t logBufferPercent(void)
+{
+    size_t fullest = 0;
+    for (size_t i = 0; i < LOG_FILE_COUNT; i++)
+    {
+        if (logFiles[i].enabled && logFiles[i].stream->buffered() > fullest)
+        {
+            fullest = logFiles[i].stream->buffered();
+        }
+    }
+    return (uint8_t)(fullest * 100 / LOG_BLOCK_SIZE);
+}
+
+uint32_t logErrorCount(void)
+{
+    uint32_t errors = 0;
+    for (size_t i = 0; i < LOG_FILE_COUNT; i++)
+    {
+        if (logFiles[i].enabled)
+        {
+            errors += logFiles[i].stream->errorCount();
+        }
+    }
+    return errors;
 }
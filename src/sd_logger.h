@@ -5,6 +5,25 @@
  * Provides functions for writing and appending data to files on the SD card.
  * Handles file creation, error reporting, and CSV header initialization.
  * 
+ * Every boot records into a new session directory (LOG_SESSION_DIR_FORMAT)
+ * instead of truncating the previous session. A session is a sequence of
+ * segment directories (LOG_SEGMENT_DIR_FORMAT), each holding the usual set
+ * of files; all streams move to the next segment together once one of them
+ * reaches LOG_SEGMENT_MAX_BYTES, so every segment can be decoded and
+ * replayed on its own.
+ * 
+ * Framed streams start with a segment line and carry a sync marker at
+ * every sync():
+ * 
+ *   #segment,<session>,<segment>,<millis>\r\n<header>
+ *   \r\n#sync,<millis>,<offset>,<crc>
+ * 
+ * offset is the marker's own byte position in the file and crc the
+ * CRC-16/CCITT (hex) of the text before it, so a marker cannot be faked by
+ * stale or torn data. Readers treat both lines like any other non-data
+ * line: CSV parsers skip rows that do not start with a digit, binary
+ * decoders resynchronize over them.
+ * 
  * @author pankace
  * @date 2026-02-05
  * @version 1.0
@@ -13,7 +32,212 @@
 #ifndef SD_LOGGER_H
 #define SD_LOGGER_H
 
-#include <M5Stack.h>
+#include "hal.h"
+#include "config.h"
+
+// ============================================================================
+// RECORD FRAMING
+// ============================================================================
+
+/**
+ * @brief What a stream's records look like, for the recovery scan
+ */
+enum LogRecordKind
+{
+    LOG_RECORDS_TEXT = 0,       ///< "\r\n"-prefixed text lines
+    LOG_RECORDS_FRAMES,         ///< log_record.h frames
+    LOG_RECORDS_PACKED,         ///< packed_log.h blocks
+    LOG_RECORDS_INDEX           ///< packed_log.h index entries, unframed
+};
+
+/**
+ * @brief Outcome of scanning one segment file
+ */
+struct LogRecovery
+{
+    uint32_t fileBytes;
+    uint32_t validBytes;        ///< End of the last record known to be complete
+    uint32_t scannedBytes;      ///< Bytes read to find it
+    uint32_t records;           ///< Records validated after the last sync marker
+    bool markerFound;
+};
+
+// ============================================================================
+// BUFFERED LOG STREAM
+// ============================================================================
+
+/**
+ * @brief Buffered log stream with a persistent file handle
+ * 
+ * Keeps one file open for the whole session and stages records in a
+ * LOG_BLOCK_SIZE RAM block. The block is written to the card when it is
+ * full, when it is older than LOG_FLUSH_INTERVAL_MS, or on an explicit
+ * flush()/sync(). sync() additionally commits the FAT directory entry so
+ * the data survives a power loss.
+ */
+class LogStream
+{
+public:
+    LogStream(void);
+
+    /**
+     * @brief Create (truncate) the file and stage its header line
+     * 
+     * @param fs File system reference
+     * @param path Path to the file
+     * @param header Header text written at the start of the file
+     * @return true if the file was opened
+     */
+    bool begin(fs::FS& fs, const char* path, const char* header);
+
+    /**
+     * @brief Create a framed segment file
+     * 
+     * Stages the segment line, @p header and a first sync marker, so a
+     * segment cut off right after it was opened still recovers to a valid
+     * (empty) file.
+     * 
+     * @param segmentLine "#segment,..." identification without line break
+     */
+    bool beginSegment(fs::FS& fs, const char* path, const char* segmentLine, const char* header);
+
+    /**
+     * @brief Stage raw bytes, writing out each block as it fills
+     * 
+     * @param data Bytes to log
+     * @param length Number of bytes
+     * @return false if the stream is closed or a block write failed
+     */
+    bool write(const char* data, size_t length);
+
+    /**
+     * @brief Stage a null-terminated string
+     */
+    bool print(const char* message);
+
+    /**
+     * @brief Stage one CSV record (formatCsvRecord()) without a copy
+     * 
+     * Formats straight into the staging block when the longest possible
+     * record fits, otherwise through a stack buffer so it can continue in
+     * the next block. The bytes are the same either way.
+     * 
+     * @param timestampMs First column
+     * @param values Remaining columns
+     * @param count Number of values, at most CSV_RECORD_MAX_VALUES
+     * @return false if the stream is closed or a block write failed
+     */
+    bool printRecord(uint32_t timestampMs, const float* values, uint8_t count);
+
+    /**
+     * @brief Apply the time-based flush and sync thresholds
+     * 
+     * @param nowMs Current time in milliseconds
+     */
+    void service(uint32_t nowMs);
+
+    /**
+     * @brief Write any staged bytes to the file
+     */
+    bool flush(void);
+
+    /**
+     * @brief Flush staged bytes and commit them to the card
+     * 
+     * Framed streams first stage a sync marker if anything was logged
+     * since the last one.
+     */
+    bool sync(void);
+
+    /**
+     * @brief Sync and close the file handle
+     */
+    void close(void);
+
+    bool isOpen(void) const { return isOpenFlag; }
+    size_t buffered(void) const { return bufferFill; }
+    uint32_t flushCount(void) const { return flushes; }
+    uint32_t syncCount(void) const { return syncs; }
+    uint32_t bytesWritten(void) const { return totalBytes; }
+    uint32_t segmentBytes(void) const { return fileBytes + bufferFill; }   ///< Including staged bytes
+    uint32_t errorCount(void) const { return errors; }
+
+private:
+    bool writeBlock(void);
+    bool stageMarker(void);
+
+    File file;
+    char filePath[LOG_PATH_SIZE];
+    bool isOpenFlag;
+    bool framed;
+    bool markerDue;             ///< Records staged since the last marker
+    uint32_t fileBytes;
+    char buffer[LOG_BLOCK_SIZE];
+    size_t bufferFill;
+    uint32_t lastFlushMs;
+    uint32_t lastSyncMs;
+    bool dirty;
+
+    uint32_t flushes;
+    uint32_t syncs;
+    uint32_t totalBytes;
+    uint32_t errors;
+};
+
+// ============================================================================
+// DATA LOG STREAMS
+// ============================================================================
+
+extern LogStream accelLog;
+extern LogStream gyroLog;
+extern LogStream magLog;
+extern LogStream quaternionLog;
+extern LogStream yprLog;
+extern LogStream diagnosticsLog;
+extern LogStream binaryLog;
+extern LogStream packedIndexLog;
+extern LogStream featureLog;
+
+// ============================================================================
+// RECOVERY
+// ============================================================================
+
+/**
+ * @brief Find the last complete record of a segment file
+ * 
+ * Reads backwards from the end in LOG_RECOVERY_CHUNK_SIZE steps to the
+ * last valid sync marker, then validates records forward from it: frames
+ * and packed blocks by their CRC, text lines by being followed by the
+ * next line. Only the data logged since the last sync is read, never the
+ * whole file. Index files are checked entry by entry from the end.
+ * 
+ * @param fs File system reference
+ * @param path Segment file
+ * @param kind Record type of the stream that wrote it
+ * @param result Filled with what was found
+ * @return false if the file could not be opened
+ */
+bool recoverLogSegment(fs::FS& fs, const char* path, LogRecordKind kind, LogRecovery& result);
+
+/**
+ * @brief Session number the data files are being written to
+ */
+uint16_t logSessionNumber(void);
+
+/**
+ * @brief Segment number within the session
+ */
+uint16_t logSegmentNumber(void);
+
+/**
+ * @brief Path of @p file (e.g. "/event000.pak") in the current segment directory
+ */
+void logSegmentFilePath(char* out, size_t size, const char* file);
+
+/**
+ * @brief Override LOG_SEGMENT_MAX_BYTES (host checks use small segments)
+ */
+void setLogSegmentLimit(uint32_t bytes);
 
 // ============================================================================
 // SD CARD FILE OPERATIONS
@@ -22,11 +246,14 @@
 /**
  * @brief Append data to a file on the SD card
  * 
+ * Opens, writes and closes the file on every call. Use a LogStream for
+ * anything logged from the main loop.
+ * 
  * @param fs File system reference
  * @param path Path to the file
  * @param message Message to append
  * 
- * @note On failure, the LCD screen will turn red to indicate an error
+ * @note On failure, the system status is set to STATUS_ERROR (showStatus())
  */
 void appendFile(fs::FS& fs, const char* path, const char* message);
 
@@ -37,21 +264,59 @@ void appendFile(fs::FS& fs, const char* path, const char* message);
  * @param path Path to the file
  * @param message Message to write
  * 
- * @note On failure, the LCD screen will turn red to indicate an error
+ * @note On failure, the system status is set to STATUS_ERROR (showStatus())
  */
 void writeFile(fs::FS& fs, const char* path, const char* message);
 
 /**
  * @brief Initialize data logging files on SD card
  * 
- * Creates CSV files with headers for all sensor data types:
+ * Starts the next session: scans the last segment of the previous session
+ * for its last complete record (one "#recover" line per file in the new
+ * diagnostics log), then opens segment 0 of a new session directory.
+ * Opens a LogStream with a CSV header for all sensor data types:
  * - Acceleration data
  * - Gyroscope data
  * - Magnetometer data
  * - Quaternion orientation data
  * - Yaw/Pitch/Roll data
  * - Diagnostic information
+ * 
+ * When LOG_FORMAT_BINARY is enabled the five sensor CSV files are replaced
+ * by a single binary frame log, or with LOG_FORMAT_COMPRESSED by the
+ * packed block log and its block index (packed_log.h).
  */
 void initializeDataFiles(void);
 
+/**
+ * @brief Apply time-based flush/sync thresholds to all data streams
+ * 
+ * Called once per loop pass. Moves every stream to the next segment once
+ * one of them has reached the segment limit.
+ */
+void serviceDataFiles(void);
+
+/**
+ * @brief Flush and commit all data streams to the card
+ */
+void syncDataFiles(void);
+
+/**
+ * @brief Stage a "\r\n#..." line in every open text stream
+ * 
+ * For events that change how the records around them read, e.g. a new
+ * sample rate. Binary streams are left alone.
+ */
+void logAnnotation(const char* line);
+
+/**
+ * @brief Fill of the fullest staging block among the open streams (percent)
+ */
+uint8_t logBufferPercent(void);
+
+/**
+ * @brief Failed opens and writes of all data streams
+ */
+uint32_t logErrorCount(void);
+
 #endif // SD_LOGGER_H
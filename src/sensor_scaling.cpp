@@ -0,0 +1,93 @@
+/**
+ * @file sensor_scaling.cpp
+ * @brief Scaling table construction
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "sensor_scaling.h"
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+// Body axis i is AK8963 axis kMagBodyAxis[i]; AK8963 X and Y are swapped relative to the MPU9250
+static const int kMagBodyAxis[3] = {1, 0, 2};
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+static void setDiagonal(AffineTransform3& transform, float scale)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            transform.matrix[i][j] = (i == j) ? scale : 0.0f;
+        }
+        transform.offset[i] = 0.0f;
+    }
+    transform.diagonal = true;
+}
+
+// ============================================================================
+// TABLE CONSTRUCTION
+// ============================================================================
+
+void buildAccelTransform(AffineTransform3& transform, float aRes)
+{
+    setDiagonal(transform, aRes);
+}
+
+void buildGyroTransform(AffineTransform3& transform, float gRes, const float* biasDps)
+{
+    setDiagonal(transform, gRes);
+    for (int i = 0; i < 3; i++)
+    {
+        transform.offset[i] = -biasDps[i];
+    }
+}
+
+void magSensitivity(float mRes, const float* factory, float* sensitivity)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        sensitivity[i] = mRes * factory[i];
+    }
+}
+
+void buildMagTransform(AffineTransform3& transform, float mRes, const float* factory,
+                       const MagCorrection& correction)
+{
+    float sensitivity[3];
+    magSensitivity(mRes, factory, sensitivity);
+
+    // Row i of the body-frame output is row kMagBodyAxis[i] of the sensor-frame correction
+    for (int i = 0; i < 3; i++)
+    {
+        const float* row = correction.matrix[kMagBodyAxis[i]];
+        float offset = 0.0f;
+        for (int j = 0; j < 3; j++)
+        {
+            transform.matrix[i][j] = row[j] * sensitivity[j];
+            offset -= row[j] * correction.offset[j];
+        }
+        transform.offset[i] = offset;
+    }
+
+    // Never true with the axis swap; kept so the kernel stays correct for any remap
+    transform.diagonal = true;
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            if (i != j && transform.matrix[i][j] != 0.0f)
+            {
+                transform.diagonal = false;
+            }
+        }
+    }
+}
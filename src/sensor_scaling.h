@@ -0,0 +1,133 @@
+/**
+ * @file sensor_scaling.h
+ * @brief Precomputed raw-count to engineering-unit conversion
+ *
+ * Everything that turns an ADC count into a value the filter can use is
+ * folded into one affine transform per sensor, built when the sensor is
+ * configured or its calibration changes:
+ *
+ * - accel: aRes (g per count)
+ * - gyro: gRes (deg/s per count) and the software gyro bias
+ * - mag: mRes, the AK8963 factory sensitivity, the hard/soft-iron
+ *   correction and the AK8963 to body axis remap (its X and Y are swapped
+ *   relative to the accel/gyro axes)
+ *
+ * scaleImuSample() then converts a whole 9-axis sample with the same
+ * 3x3-plus-offset step per sensor, and every output is in the body frame.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef SENSOR_SCALING_H
+#define SENSOR_SCALING_H
+
+#include <stdint.h>
+#include "calibration.h"
+
+// ============================================================================
+// TRANSFORMS
+// ============================================================================
+
+/**
+ * @brief out = matrix * counts + offset
+ */
+struct AffineTransform3
+{
+    float matrix[3][3];
+    float offset[3];
+    bool diagonal;              ///< Only matrix[i][i] is non-zero (accel, gyro)
+};
+
+enum ScalingSensor
+{
+    SCALING_ACCEL = 0,
+    SCALING_GYRO = 1,
+    SCALING_MAG = 2,
+    SCALING_SENSOR_COUNT = 3
+};
+
+/**
+ * @brief One transform per sensor, indexed by ScalingSensor
+ */
+struct ScalingTable
+{
+    AffineTransform3 sensor[SCALING_SENSOR_COUNT];
+};
+
+// ============================================================================
+// KERNEL
+// ============================================================================
+
+/**
+ * @brief Apply @p transform to one raw 3-axis reading
+ */
+static inline void applyTransform(const AffineTransform3& transform, const int16_t* counts, float* out)
+{
+    const float x = (float)counts[0];
+    const float y = (float)counts[1];
+    const float z = (float)counts[2];
+
+    // Per-axis scale and offset: a third of the multiply-adds
+    if (transform.diagonal)
+    {
+        out[0] = transform.matrix[0][0] * x + transform.offset[0];
+        out[1] = transform.matrix[1][1] * y + transform.offset[1];
+        out[2] = transform.matrix[2][2] * z + transform.offset[2];
+        return;
+    }
+
+    for (int row = 0; row < 3; row++)
+    {
+        out[row] = transform.matrix[row][0] * x + transform.matrix[row][1] * y
+                 + transform.matrix[row][2] * z + transform.offset[row];
+    }
+}
+
+/**
+ * @brief Convert one 9-axis sample
+ *
+ * @param table Current scaling table
+ * @param counts Raw accel, gyro and mag counts, in ScalingSensor order
+ * @param out Accel (g), gyro (deg/s) and mag (mG), body frame, in the same order
+ */
+static inline void scaleImuSample(const ScalingTable& table, const int16_t* const counts[SCALING_SENSOR_COUNT],
+                                  float out[SCALING_SENSOR_COUNT][3])
+{
+    for (int s = 0; s < SCALING_SENSOR_COUNT; s++)
+    {
+        applyTransform(table.sensor[s], counts[s], out[s]);
+    }
+}
+
+// ============================================================================
+// TABLE CONSTRUCTION
+// ============================================================================
+
+/**
+ * @brief counts * aRes
+ */
+void buildAccelTransform(AffineTransform3& transform, float aRes);
+
+/**
+ * @brief counts * gRes - bias
+ */
+void buildGyroTransform(AffineTransform3& transform, float gRes, const float* biasDps);
+
+/**
+ * @brief remap * correction.matrix * (counts * mRes * factory - correction.offset)
+ *
+ * @param factory AK8963 factory sensitivity adjustment (magCalibration)
+ */
+void buildMagTransform(AffineTransform3& transform, float mRes, const float* factory,
+                       const MagCorrection& correction);
+
+/**
+ * @brief Per-axis mG per count before any correction (AK8963 axes)
+ *
+ * What the streaming calibrator fits: counts * mRes * factory.
+ */
+void magSensitivity(float mRes, const float* factory, float* sensitivity);
+
+#endif // SENSOR_SCALING_H
@@ -0,0 +1,99 @@
+/**
+ * @file spsc_ring.h
+ * @brief Lock-free single-producer/single-consumer ring buffer
+ * 
+ * Fixed-capacity queue for passing samples between exactly one producer
+ * task and one consumer task without locks. Indices are free-running and
+ * published with acquire/release ordering, so the same code works across
+ * the two ESP32 cores and under POSIX threads on the host.
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+// ============================================================================
+// SPSC RING BUFFER
+// ============================================================================
+
+/**
+ * @brief Lock-free SPSC ring buffer
+ * 
+ * @tparam T Element type (copied in and out)
+ * @tparam N Capacity; must be a power of two
+ */
+template <typename T, size_t N>
+class SpscRing
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+    SpscRing(void) : head(0), tail(0), dropped(0) {}
+
+    /**
+     * @brief Enqueue one element (producer side only)
+     * 
+     * @return false if the ring is full; the element is dropped and counted
+     */
+    bool push(const T& item)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        slots[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Dequeue one element (consumer side only)
+     * 
+     * @return false if the ring is empty
+     */
+    bool pop(T& item)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        item = slots[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Number of queued elements (approximate while both sides run)
+     */
+    size_t size(void) const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity(void) { return N; }
+
+    /**
+     * @brief Number of elements rejected because the ring was full
+     */
+    uint32_t droppedCount(void) const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    T slots[N];
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+    std::atomic<uint32_t> dropped;
+};
+
+#endif // SPSC_RING_H
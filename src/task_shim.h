@@ -0,0 +1,80 @@
+/**
+ * @file task_shim.h
+ * @brief Minimal task API over FreeRTOS or POSIX threads
+ * 
+ * Lets the pipelined acquisition/logging split build unchanged on the
+ * ESP32 (FreeRTOS tasks pinned to cores) and on a Linux host (std::thread,
+ * with priority and core affinity ignored).
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef TASK_SHIM_H
+#define TASK_SHIM_H
+
+#include <stdint.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+// ============================================================================
+// TASK FUNCTIONS
+// ============================================================================
+
+typedef void (*TaskEntry)(void* argument);
+
+/**
+ * @brief Start a task running @p entry
+ * 
+ * @param entry Task function; must never return on FreeRTOS
+ * @param name Task name for debugging
+ * @param stackBytes Stack size in bytes
+ * @param argument Value passed to @p entry
+ * @param priority FreeRTOS priority (higher runs first)
+ * @param core Core to pin the task to
+ * @return true if the task was created
+ */
+inline bool startTask(TaskEntry entry, const char* name, uint32_t stackBytes,
+                      void* argument, int priority, int core)
+{
+#ifdef ARDUINO
+    return xTaskCreatePinnedToCore(entry, name, stackBytes, argument, priority, NULL, core) == pdPASS;
+#else
+    (void)name;
+    (void)stackBytes;
+    (void)priority;
+    (void)core;
+    std::thread(entry, argument).detach();
+    return true;
+#endif
+}
+
+/**
+ * @brief Block the calling task for at least @p ms milliseconds
+ * 
+ * A value of 0 gives up the rest of the current tick. On FreeRTOS that is a
+ * one-tick delay so lower-priority tasks and the idle watchdog still run.
+ */
+inline void taskSleep(uint32_t ms)
+{
+#ifdef ARDUINO
+    vTaskDelay(ms > 0 ? pdMS_TO_TICKS(ms) : 1);
+#else
+    if (ms > 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+    else
+    {
+        std::this_thread::yield();
+    }
+#endif
+}
+
+#endif // TASK_SHIM_H
@@ -0,0 +1,210 @@
+/**
+ * @file telemetry.cpp
+ * @brief Non-blocking binary serial telemetry implementation
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "telemetry.h"
+#include "telemetry_protocol.h"
+#include "data_processor.h"
+#include "config.h"
+#include "hal.h"
+
+#if (TELEMETRY_TX_BUFFER_SIZE & (TELEMETRY_TX_BUFFER_SIZE - 1)) != 0
+#error "TELEMETRY_TX_BUFFER_SIZE must be a power of two"
+#endif
+
+// ============================================================================
+// CHANNEL SCHEDULE
+// ============================================================================
+
+/**
+ * @brief Period and sequence state of one channel
+ */
+struct ChannelSchedule
+{
+    uint32_t periodMs;          ///< 0 = channel off
+    uint32_t nextDueMs;
+    uint8_t sequence;
+    bool started;
+};
+
+static uint32_t channelPeriod(uint32_t rateHz)
+{
+    if (rateHz == 0)
+    {
+        return 0;
+    }
+    return (rateHz >= 1000) ? 1 : 1000 / rateHz;
+}
+
+static ChannelSchedule channels[TELEMETRY_CHANNEL_COUNT] = {
+    {channelPeriod(TELEMETRY_RATE_ACCEL_HZ), 0, 0, false},
+    {channelPeriod(TELEMETRY_RATE_GYRO_HZ), 0, 0, false},
+    {channelPeriod(TELEMETRY_RATE_MAG_HZ), 0, 0, false},
+    {channelPeriod(TELEMETRY_RATE_QUATERNION_HZ), 0, 0, false},
+    {channelPeriod(TELEMETRY_RATE_YPR_HZ), 0, 0, false},
+};
+
+// ============================================================================
+// TX RING
+// ============================================================================
+
+static uint8_t txBuffer[TELEMETRY_TX_BUFFER_SIZE];
+static uint32_t txHead = 0;         ///< Free-running write index
+static uint32_t txTail = 0;         ///< Free-running read index
+static bool delimiterSent = false;
+
+static uint32_t framesStaged = 0;
+static uint32_t framesDropped = 0;
+
+/**
+ * @brief Copy @p length bytes into the ring if all of them fit
+ */
+static bool stageBytes(const uint8_t* data, size_t length)
+{
+    if (TELEMETRY_TX_BUFFER_SIZE - (txHead - txTail) < length)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < length; i++)
+    {
+        txBuffer[(txHead + i) & (TELEMETRY_TX_BUFFER_SIZE - 1)] = data[i];
+    }
+    txHead += length;
+    return true;
+}
+
+/**
+ * @brief Whether @p channel is due at @p nowMs; advances its schedule
+ */
+static bool channelDue(ChannelSchedule& channel, uint32_t nowMs)
+{
+    if (channel.periodMs == 0)
+    {
+        return false;
+    }
+    if (channel.started && (int32_t)(nowMs - channel.nextDueMs) < 0)
+    {
+        return false;
+    }
+
+    // Keep the cadence, but do not burst to catch up after a stall
+    channel.nextDueMs = (channel.started && (nowMs - channel.nextDueMs) < channel.periodMs)
+                            ? channel.nextDueMs + channel.periodMs
+                            : nowMs + channel.periodMs;
+    channel.started = true;
+    return true;
+}
+
+static void stageFrame(uint8_t id, uint32_t timestampMs, const float* values)
+{
+    TelemetryFrame frame;
+    uint8_t encoded[TELEMETRY_MAX_FRAME_SIZE];
+    ChannelSchedule& channel = channels[id];
+
+    frame.channel = id;
+    frame.sequence = channel.sequence++;
+    frame.timestampMs = timestampMs;
+    for (uint8_t i = 0; i < telemetryChannelValues(id); i++)
+    {
+        frame.values[i] = values[i];
+    }
+
+    size_t length = encodeTelemetryFrame(frame, encoded);
+    if (stageBytes(encoded, length))
+    {
+        framesStaged++;
+    }
+    else
+    {
+        framesDropped++;
+    }
+}
+
+// ============================================================================
+// TELEMETRY FUNCTIONS
+// ============================================================================
+
+void publishTelemetry(const ImuSample& sample)
+{
+    uint32_t now = sample.timestampMs;
+
+    // Terminate whatever text was printed before the first frame
+    if (!delimiterSent)
+    {
+        const uint8_t delimiter = TELEMETRY_DELIMITER;
+        delimiterSent = stageBytes(&delimiter, 1);
+    }
+
+    if (channelDue(channels[TELEMETRY_ACCEL], now))
+    {
+        const float accel[3] = {1000 * sample.ax, 1000 * sample.ay, 1000 * sample.az};
+        stageFrame(TELEMETRY_ACCEL, now, accel);
+    }
+
+    if (channelDue(channels[TELEMETRY_GYRO], now))
+    {
+        const float gyro[3] = {sample.gx, sample.gy, sample.gz};
+        stageFrame(TELEMETRY_GYRO, now, gyro);
+    }
+
+    if (channelDue(channels[TELEMETRY_MAG], now))
+    {
+        const float mag[3] = {sample.my, sample.mx, sample.mz};   // AK8963 axis order
+        stageFrame(TELEMETRY_MAG, now, mag);
+    }
+
+    if (channelDue(channels[TELEMETRY_QUATERNION], now))
+    {
+        stageFrame(TELEMETRY_QUATERNION, now, sample.q);
+    }
+
+    if (channelDue(channels[TELEMETRY_YPR], now))
+    {
+        float ypr[4];
+        orientationFromQuaternion(sample.q, ypr[0], ypr[1], ypr[2]);
+        ypr[3] = (sample.deltat > 0.0f) ? 1.0f / sample.deltat : 0.0f;
+        stageFrame(TELEMETRY_YPR, now, ypr);
+    }
+}
+
+void serviceTelemetry(void)
+{
+    while (txHead != txTail)
+    {
+        int space = Serial.availableForWrite();
+        if (space <= 0)
+        {
+            return;
+        }
+
+        // Up to the end of the ring in one call, the rest on the next pass
+        uint32_t start = txTail & (TELEMETRY_TX_BUFFER_SIZE - 1);
+        uint32_t length = txHead - txTail;
+        if (length > TELEMETRY_TX_BUFFER_SIZE - start)
+        {
+            length = TELEMETRY_TX_BUFFER_SIZE - start;
+        }
+        if (length > (uint32_t)space)
+        {
+            length = (uint32_t)space;
+        }
+
+        txTail += Serial.write(txBuffer + start, length);
+    }
+}
+
+uint32_t telemetryDropCount(void)
+{
+    return framesDropped;
+}
+
+uint32_t telemetryFrameCount(void)
+{
+    return framesStaged;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file telemetry.h
+ * @brief Non-blocking binary serial telemetry
+ *
+ * Replaces the text serial output when SERIAL_TELEMETRY_ENABLED is set.
+ * Every fused sample is offered to each channel, and a channel with a
+ * nonzero TELEMETRY_RATE_*_HZ emits a frame (telemetry_protocol.h) when
+ * its period has elapsed. Frames are staged in a preallocated
+ * TELEMETRY_TX_BUFFER_SIZE ring. serviceTelemetry() hands the UART only
+ * as many bytes as its TX FIFO has room for, so the loop never waits on
+ * the baud rate. A frame that does not fit the ring is dropped whole,
+ * counted, and shows up as a sequence gap on the receiver.
+ *
+ * Call both functions from one task only (the logging task in pipelined
+ * mode).
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+#include "imu_sample.h"
+
+// ============================================================================
+// TELEMETRY FUNCTIONS
+// ============================================================================
+
+/**
+ * @brief Stage the frames due for one fused sample
+ *
+ * @param sample Fused sample
+ */
+void publishTelemetry(const ImuSample& sample);
+
+/**
+ * @brief Move staged bytes to the serial port without blocking
+ *
+ * Called once per loop pass.
+ */
+void serviceTelemetry(void);
+
+/**
+ * @brief Frames dropped because the TX ring was full
+ */
+uint32_t telemetryDropCount(void);
+
+/**
+ * @brief Frames staged for transmission
+ */
+uint32_t telemetryFrameCount(void);
+
+#endif // TELEMETRY_H
@@ -0,0 +1,189 @@
+/**
+ * @file telemetry_protocol.cpp
+ * @brief Framed binary serial telemetry implementation
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "telemetry_protocol.h"
+#include "log_record.h"
+
+// ============================================================================
+// CHANNELS
+// ============================================================================
+
+static const uint8_t channelValues[TELEMETRY_CHANNEL_COUNT] = {3, 3, 3, 4, 4};
+
+uint8_t telemetryChannelValues(uint8_t channel)
+{
+    return (channel < TELEMETRY_CHANNEL_COUNT) ? channelValues[channel] : 0;
+}
+
+// ============================================================================
+// ENCODING
+// ============================================================================
+
+size_t encodeTelemetryFrame(const TelemetryFrame& frame, uint8_t* out)
+{
+    uint8_t payload[TELEMETRY_MAX_PAYLOAD_SIZE];
+    uint8_t count = telemetryChannelValues(frame.channel);
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    uint8_t* p = payload;
+    *p++ = frame.channel;
+    *p++ = frame.sequence;
+    p = putU32(p, frame.timestampMs);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        p = putFloat(p, frame.values[i]);
+    }
+    size_t length = (size_t)(p - payload);
+    putU16(p, crc16Ccitt(payload, length));
+    length += 2;
+
+    // COBS: each code byte gives the distance to the next zero
+    uint8_t* code = out;
+    uint8_t* dst = out + 1;
+    uint8_t run = 1;
+    for (size_t i = 0; i < length; i++)
+    {
+        if (payload[i] == 0)
+        {
+            *code = run;
+            code = dst++;
+            run = 1;
+        }
+        else
+        {
+            *dst++ = payload[i];
+            if (++run == 0xFF)
+            {
+                *code = run;
+                code = dst++;
+                run = 1;
+            }
+        }
+    }
+    *code = run;
+    *dst++ = TELEMETRY_DELIMITER;
+    return (size_t)(dst - out);
+}
+
+// ============================================================================
+// PARSER
+// ============================================================================
+
+TelemetryParser::TelemetryParser(void)
+    : fill(0),
+      overflow(false),
+      frames(0),
+      crcErrors(0),
+      framingErrors(0),
+      lostFrames(0)
+{
+    for (int i = 0; i < TELEMETRY_CHANNEL_COUNT; i++)
+    {
+        seen[i] = false;
+        lastSequence[i] = 0;
+    }
+}
+
+bool TelemetryParser::feed(uint8_t byte)
+{
+    if (byte != TELEMETRY_DELIMITER)
+    {
+        if (fill < sizeof(buffer))
+        {
+            buffer[fill++] = byte;
+        }
+        else
+        {
+            overflow = true;
+        }
+        return false;
+    }
+
+    // Back-to-back delimiters are idle fill, not frames
+    bool valid = false;
+    if (overflow)
+    {
+        framingErrors++;
+    }
+    else if (fill > 0)
+    {
+        valid = decode();
+    }
+
+    fill = 0;
+    overflow = false;
+    return valid;
+}
+
+bool TelemetryParser::decode(void)
+{
+    uint8_t payload[TELEMETRY_MAX_FRAME_SIZE];
+    size_t length = 0;
+    size_t pos = 0;
+
+    // Undo COBS: every code byte except 0xFF stands for a zero
+    while (pos < fill)
+    {
+        uint8_t code = buffer[pos++];
+        if (code == 0 || pos + code - 1 > fill)
+        {
+            framingErrors++;
+            return false;
+        }
+        for (uint8_t i = 1; i < code; i++)
+        {
+            payload[length++] = buffer[pos++];
+        }
+        if (code != 0xFF && pos < fill)
+        {
+            payload[length++] = 0;
+        }
+    }
+
+    uint8_t count = (length > 0) ? telemetryChannelValues(payload[0]) : 0;
+    if (count == 0 || length != TELEMETRY_HEADER_SIZE + 4u * count + 2)
+    {
+        framingErrors++;
+        return false;
+    }
+
+    uint16_t crc;
+    getU16(payload + length - 2, crc);
+    if (crc != crc16Ccitt(payload, length - 2))
+    {
+        crcErrors++;
+        return false;
+    }
+
+    const uint8_t* p = payload;
+    current.channel = *p++;
+    current.sequence = *p++;
+    p = getU32(p, current.timestampMs);
+    for (uint8_t i = 0; i < TELEMETRY_MAX_VALUES; i++)
+    {
+        current.values[i] = 0.0f;
+        if (i < count)
+        {
+            p = getFloat(p, current.values[i]);
+        }
+    }
+
+    if (seen[current.channel])
+    {
+        lostFrames += (uint8_t)(current.sequence - lastSequence[current.channel] - 1);
+    }
+    seen[current.channel] = true;
+    lastSequence[current.channel] = current.sequence;
+
+    frames++;
+    return true;
+}
@@ -0,0 +1,140 @@
+/**
+ * @file telemetry_protocol.h
+ * @brief Framed binary serial telemetry format
+ *
+ * Written to the serial port instead of the text output when
+ * SERIAL_TELEMETRY_ENABLED is set. Each frame carries one channel of one
+ * sample:
+ *
+ * | Offset | Size | Field                                    |
+ * |--------|------|------------------------------------------|
+ * | 0      | 1    | Channel (TelemetryChannel)               |
+ * | 1      | 1    | Sequence number, counted per channel     |
+ * | 2      | 4    | Timestamp (millis)                       |
+ * | 6      | 4n   | n float values, n fixed by the channel   |
+ * | 6 + 4n | 2    | CRC-16/CCITT of every byte before it     |
+ *
+ * All fields are little-endian. The frame is COBS-encoded, so it contains
+ * no zero byte, and a single 0x00 follows it as the delimiter. A receiver
+ * that starts mid-stream or loses bytes resynchronizes at the next
+ * delimiter. Sequence gaps show frames the sender dropped because its TX
+ * buffer was full.
+ *
+ * This file has no Arduino dependencies so the host tools can share it.
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#ifndef TELEMETRY_PROTOCOL_H
+#define TELEMETRY_PROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================================
+// FRAME CONSTANTS
+// ============================================================================
+
+#define TELEMETRY_HEADER_SIZE 6
+#define TELEMETRY_MAX_VALUES 4
+#define TELEMETRY_MAX_PAYLOAD_SIZE (TELEMETRY_HEADER_SIZE + 4 * TELEMETRY_MAX_VALUES + 2)
+
+// COBS adds one byte per 254 payload bytes; the delimiter is one more
+#define TELEMETRY_MAX_FRAME_SIZE (TELEMETRY_MAX_PAYLOAD_SIZE + 2)
+
+#define TELEMETRY_DELIMITER 0x00
+
+// ============================================================================
+// FRAME CONTENTS
+// ============================================================================
+
+/**
+ * @brief Telemetry channels and the values they carry
+ */
+enum TelemetryChannel
+{
+    TELEMETRY_ACCEL = 0,        ///< ax, ay, az (mg)
+    TELEMETRY_GYRO,             ///< gx, gy, gz (deg/s)
+    TELEMETRY_MAG,              ///< mx, my, mz (mG, AK8963 axis order as in mag.txt)
+    TELEMETRY_QUATERNION,       ///< q0, qx, qy, qz
+    TELEMETRY_YPR,              ///< yaw, pitch, roll (deg), filter rate (Hz)
+    TELEMETRY_CHANNEL_COUNT
+};
+
+/**
+ * @brief One decoded frame
+ */
+struct TelemetryFrame
+{
+    uint8_t channel;
+    uint8_t sequence;
+    uint32_t timestampMs;
+    float values[TELEMETRY_MAX_VALUES];
+};
+
+/**
+ * @brief Number of values a channel carries (0 for an unknown channel)
+ */
+uint8_t telemetryChannelValues(uint8_t channel);
+
+// ============================================================================
+// ENCODING
+// ============================================================================
+
+/**
+ * @brief Build, COBS-encode and delimit one frame
+ *
+ * @param frame Frame to send; values beyond the channel's count are ignored
+ * @param out Destination, at least TELEMETRY_MAX_FRAME_SIZE bytes
+ * @return Bytes written, delimiter included (0 for an unknown channel)
+ */
+size_t encodeTelemetryFrame(const TelemetryFrame& frame, uint8_t* out);
+
+// ============================================================================
+// PARSER
+// ============================================================================
+
+/**
+ * @brief Byte-at-a-time receiver for the telemetry stream
+ *
+ * Keeps no more than one frame of state and allocates nothing, so it can
+ * sit behind a serial port read loop of any size.
+ */
+class TelemetryParser
+{
+public:
+    TelemetryParser(void);
+
+    /**
+     * @brief Consume one received byte
+     *
+     * @return true if the byte completed a valid frame, now in frame()
+     */
+    bool feed(uint8_t byte);
+
+    const TelemetryFrame& frame(void) const { return current; }
+
+    uint32_t frameCount(void) const { return frames; }
+    uint32_t crcErrorCount(void) const { return crcErrors; }
+    uint32_t framingErrorCount(void) const { return framingErrors; }   ///< Bad COBS, length or channel
+    uint32_t lostFrameCount(void) const { return lostFrames; }         ///< From sequence gaps
+
+private:
+    bool decode(void);
+
+    uint8_t buffer[TELEMETRY_MAX_FRAME_SIZE];
+    size_t fill;
+    bool overflow;
+    bool seen[TELEMETRY_CHANNEL_COUNT];
+    uint8_t lastSequence[TELEMETRY_CHANNEL_COUNT];
+    TelemetryFrame current;
+
+    uint32_t frames;
+    uint32_t crcErrors;
+    uint32_t framingErrors;
+    uint32_t lostFrames;
+};
+
+#endif // TELEMETRY_PROTOCOL_H
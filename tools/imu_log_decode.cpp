@@ -0,0 +1,418 @@
+/**
+ * @file imu_log_decode.cpp
+ * @brief Host decoder for binary IMU logs
+ * 
+ * Expands the frames written by LOG_FORMAT_BINARY back into the CSV files
+ * produced by the text logger (acceleration.txt, gyro.txt, mag.txt,
+ * quaternion.txt and ypr.txt), converting each with the scale record in
+ * force. Records failing the magic, version or CRC check are skipped and
+ * the decoder resynchronizes on the next sync word; frames whose scale
+ * record was lost that way are counted and left out.
+ * 
+ * Compressed logs (LOG_FORMAT_COMPRESSED, imu.pak) are recognized by their
+ * first valid block and expand to acceleration.txt, gyro.txt and mag.txt;
+ * they carry no quaternion, so run imu_replay on the result for attitude.
+ * Damaged blocks are skipped the same way. With --index, --from-ms seeks
+ * straight to the first block that reaches that time.
+ * 
+ * Input is one segment file (e.g. /s0003/000/imu.pak). The segment line
+ * and sync markers the logger interleaves are skipped like damaged bytes.
+ * 
+ * Build:
+ *   g++ -std=c++11 -O2 -Isrc tools/imu_log_decode.cpp src/log_record.cpp src/packed_log.cpp src/mahony_filter.cpp -o imu_log_decode
+ * 
+ * Usage:
+ *   imu_log_decode <imu.bin|imu.pak> [output_dir] [--declination <deg>]
+ *                  [--index <imu.idx>] [--from-ms N] [--to-ms N]
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "log_record.h"
+#include "packed_log.h"
+#include "mahony_filter.h"
+#include "config.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+#define READ_CHUNK_SIZE 4096
+#define PATH_BUFFER_SIZE 512
+
+// ============================================================================
+// OUTPUT FILES
+// ============================================================================
+
+struct CsvOutputs
+{
+    FILE* accel;
+    FILE* gyro;
+    FILE* mag;
+    FILE* quaternion;
+    FILE* ypr;
+};
+
+static FILE* openCsv(const char* dir, const char* name, const char* header)
+{
+    char path[PATH_BUFFER_SIZE];
+    snprintf(path, sizeof(path), "%s%s", dir, name);
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "ERROR: Failed to open %s for writing\n", path);
+        exit(1);
+    }
+    fputs(header, file);
+    return file;
+}
+
+// ============================================================================
+// FRAME EXPANSION
+// ============================================================================
+
+/**
+ * @brief Sensor columns of one frame (everything a packed block stores)
+ */
+static void writeSensors(const CsvOutputs& out, const ImuFrame& f)
+{
+    unsigned long t = f.timestampMs;
+    float a[3], g[3], m[3];
+
+    frameSensors(f, a, g, m);
+    fprintf(out.accel, "\r\n%lu,%lf,%lf,%lf", t, 1000 * a[0], 1000 * a[1], 1000 * a[2]);
+    fprintf(out.gyro, "\r\n%lu,%lf,%lf,%lf", t, g[0], g[1], g[2]);
+    fprintf(out.mag, "\r\n%lu,%lf,%lf,%lf", t, m[0], m[1], m[2]);
+}
+
+static void writeFrame(const CsvOutputs& out, const ImuFrame& f, float rateHz, float declination)
+{
+    unsigned long t = f.timestampMs;
+
+    writeSensors(out, f);
+
+    const float* q = f.q;
+    fprintf(out.quaternion, "\r\n%lu,%lf,%lf,%lf,%lf", t, q[0], q[1], q[2], q[3]);
+
+    float yaw, pitch, roll;
+    quaternionToEuler(q, declination, yaw, pitch, roll);
+    fprintf(out.ypr, "\r\n%lu,%lf,%lf,%lf,%lf", t, rateHz, yaw, pitch, roll);
+}
+
+// ============================================================================
+// PACKED LOGS
+// ============================================================================
+
+/**
+ * @brief Offset of the first block that reaches @p fromMs, from the index
+ * 
+ * @return 0 (start of the log) if the index is missing or has no such block
+ */
+static long seekOffset(const char* indexPath, uint32_t fromMs)
+{
+    FILE* index = fopen(indexPath, "rb");
+    if (index == NULL)
+    {
+        fprintf(stderr, "WARNING: Failed to open %s, decoding from the start\n", indexPath);
+        return 0;
+    }
+
+    std::vector<PackedBlockInfo> blocks;
+    uint8_t entry[PACKED_INDEX_ENTRY_SIZE];
+    while (fread(entry, 1, PACKED_INDEX_ENTRY_SIZE, index) == PACKED_INDEX_ENTRY_SIZE)
+    {
+        PackedBlockInfo info;
+        if (decodePackedIndexEntry(entry, info))
+        {
+            blocks.push_back(info);
+        }
+    }
+    fclose(index);
+
+    // Blocks are written in time order; binary search on the last timestamp
+    size_t lo = 0;
+    size_t hi = blocks.size();
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (blocks[mid].lastTimestampMs < fromMs)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    fprintf(stderr, "INFO: Index has %lu blocks, starting at block %lu\n",
+            (unsigned long)blocks.size(), (unsigned long)lo);
+    return (lo < blocks.size()) ? (long)blocks[lo].offset : 0;
+}
+
+/**
+ * @brief Expand every block of a packed log within [fromMs, toMs]
+ */
+static void decodePackedLog(FILE* input, const CsvOutputs& out, uint32_t fromMs, uint32_t toMs)
+{
+    static uint8_t window[READ_CHUNK_SIZE + PACKED_MAX_BLOCK_SIZE];
+    static ImuFrame frames[PACKED_MAX_BLOCK_SAMPLES];
+    size_t fill = 0;
+    size_t readBytes;
+    unsigned long blocks = 0;
+    unsigned long samples = 0;
+    unsigned long rejected = 0;
+    bool done = false;
+
+    while (!done && ((readBytes = fread(window + fill, 1, READ_CHUNK_SIZE, input)) > 0 || fill >= PACKED_HEADER_SIZE))
+    {
+        fill += readBytes;
+        size_t pos = 0;
+
+        while (fill - pos >= PACKED_HEADER_SIZE)
+        {
+            PackedBlockInfo info;
+            size_t blockBytes;
+            PackedStatus status = decodePackedBlock(window + pos, fill - pos, frames, info, blockBytes);
+
+            // Wait for the rest of the block unless the file has ended
+            if (status == PACKED_TRUNCATED && readBytes > 0)
+            {
+                break;
+            }
+            if (status != PACKED_OK)
+            {
+                if (status != PACKED_BAD_MAGIC)
+                {
+                    rejected++;
+                }
+                pos++;
+                continue;
+            }
+
+            for (uint16_t i = 0; i < info.samples; i++)
+            {
+                if (frames[i].timestampMs >= fromMs && frames[i].timestampMs <= toMs)
+                {
+                    writeSensors(out, frames[i]);
+                    samples++;
+                }
+            }
+            blocks++;
+            pos += blockBytes;
+
+            if (info.lastTimestampMs > toMs)
+            {
+                done = true;
+                break;
+            }
+        }
+
+        memmove(window, window + pos, fill - pos);
+        fill -= pos;
+
+        if (readBytes == 0)
+        {
+            break;
+        }
+    }
+
+    fprintf(stderr, "INFO: Decoded %lu samples from %lu blocks, rejected %lu corrupt blocks\n",
+            samples, blocks, rejected);
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+/**
+ * @brief Whether the first record in @p input is a packed block rather than a frame
+ * 
+ * Segments start with a text line, so the first record is searched for.
+ */
+static bool isPackedLog(FILE* input)
+{
+    static uint8_t head[READ_CHUNK_SIZE];
+    size_t length = fread(head, 1, sizeof(head), input);
+
+    for (size_t pos = 0; pos + PACKED_HEADER_SIZE <= length; pos++)
+    {
+        PackedBlockInfo info;
+        FrameScaleState state;
+        ImuFrame frame;
+        size_t recordBytes;
+        PackedStatus status = readPackedHeader(head + pos, length - pos, info, recordBytes);
+        if (status == PACKED_OK || status == PACKED_TRUNCATED)
+        {
+            return true;
+        }
+        resetFrameScaleState(state);
+        FrameStatus frameStatus = decodeLogRecord(head + pos, length - pos, state, frame, recordBytes);
+        if (frameStatus == FRAME_OK || frameStatus == FRAME_SCALE || frameStatus == FRAME_NO_SCALE)
+        {
+            return false;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char** argv)
+{
+    const char* inputPath = NULL;
+    const char* outputDir = ".";
+    const char* indexPath = NULL;
+    float declination = MAGNETIC_DECLINATION_DEG;
+    uint32_t fromMs = 0;
+    uint32_t toMs = UINT32_MAX;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--declination") == 0 && i + 1 < argc)
+        {
+            declination = (float)atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--index") == 0 && i + 1 < argc)
+        {
+            indexPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--from-ms") == 0 && i + 1 < argc)
+        {
+            fromMs = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--to-ms") == 0 && i + 1 < argc)
+        {
+            toMs = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (inputPath == NULL)
+        {
+            inputPath = argv[i];
+        }
+        else
+        {
+            outputDir = argv[i];
+        }
+    }
+
+    if (inputPath == NULL)
+    {
+        fprintf(stderr, "Usage: %s <imu.bin|imu.pak> [output_dir] [--declination <deg>]\n"
+                        "          [--index <imu.idx>] [--from-ms N] [--to-ms N]\n", argv[0]);
+        return 2;
+    }
+
+    FILE* input = fopen(inputPath, "rb");
+    if (input == NULL)
+    {
+        fprintf(stderr, "ERROR: Failed to open %s\n", inputPath);
+        return 1;
+    }
+
+    CsvOutputs out;
+    out.accel = openCsv(outputDir, FILE_ACCELERATION, "millis,aX,aY,aZ");
+    out.gyro = openCsv(outputDir, FILE_GYROSCOPE, "millis,gX,gY,gZ");
+    out.mag = openCsv(outputDir, FILE_MAGNETOMETER, "millis,mX,mY,mZ");
+
+    if (isPackedLog(input))
+    {
+        fseek(input, (indexPath != NULL) ? seekOffset(indexPath, fromMs) : 0, SEEK_SET);
+        decodePackedLog(input, out, fromMs, toMs);
+
+        fclose(input);
+        fclose(out.accel);
+        fclose(out.gyro);
+        fclose(out.mag);
+        return 0;
+    }
+    fseek(input, 0, SEEK_SET);
+
+    out.quaternion = openCsv(outputDir, FILE_QUATERNION, "millis,q0,qX,qY,qZ");
+    out.ypr = openCsv(outputDir, FILE_YPR, "millis,rate_hz,Yaw,Pitch,Roll");
+
+    // Sliding window: records are decoded in place and the tail is carried
+    // over so a record straddling two reads is still seen whole
+    static uint8_t window[READ_CHUNK_SIZE + LOG_RECORD_MAX_SIZE];
+    FrameScaleState scale;
+    size_t fill = 0;
+    size_t readBytes;
+    unsigned long frames = 0;
+    unsigned long scaleRecords = 0;
+    unsigned long unscaled = 0;
+    unsigned long rejected = 0;
+    uint32_t lastTimestamp = 0;
+
+    resetFrameScaleState(scale);
+    while ((readBytes = fread(window + fill, 1, READ_CHUNK_SIZE, input)) > 0 || fill >= LOG_RECORD_HEADER_SIZE)
+    {
+        fill += readBytes;
+        size_t pos = 0;
+
+        while (fill - pos >= LOG_RECORD_HEADER_SIZE)
+        {
+            ImuFrame frame;
+            size_t recordBytes;
+            FrameStatus status = decodeLogRecord(window + pos, fill - pos, scale, frame, recordBytes);
+
+            // Wait for the rest of the record unless the file has ended
+            if (status == FRAME_TRUNCATED && readBytes > 0)
+            {
+                break;
+            }
+            if (status == FRAME_SCALE || status == FRAME_NO_SCALE)
+            {
+                scaleRecords += (status == FRAME_SCALE) ? 1 : 0;
+                unscaled += (status == FRAME_NO_SCALE) ? 1 : 0;
+                pos += recordBytes;
+                continue;
+            }
+            if (status != FRAME_OK)
+            {
+                // A record cut off by the end of the file is not counted
+                if (status != FRAME_BAD_MAGIC && status != FRAME_TRUNCATED)
+                {
+                    rejected++;
+                }
+                pos++;
+                continue;
+            }
+
+            uint32_t dt = frame.timestampMs - lastTimestamp;
+            float rateHz = (frames > 0 && dt > 0) ? 1000.0f / (float)dt : 0.0f;
+            writeFrame(out, frame, rateHz, declination);
+
+            lastTimestamp = frame.timestampMs;
+            frames++;
+            pos += recordBytes;
+        }
+
+        memmove(window, window + pos, fill - pos);
+        fill -= pos;
+
+        if (readBytes == 0)
+        {
+            break;
+        }
+    }
+
+    fclose(input);
+    fclose(out.accel);
+    fclose(out.gyro);
+    fclose(out.mag);
+    fclose(out.quaternion);
+    fclose(out.ypr);
+
+    fprintf(stderr, "INFO: Decoded %lu frames and %lu scale records, rejected %lu corrupt records\n",
+            frames, scaleRecords, rejected);
+    if (unscaled > 0)
+    {
+        fprintf(stderr, "WARNING: Skipped %lu frames whose scale record was lost\n", unscaled);
+    }
+    return 0;
+}
@@ -0,0 +1,306 @@
+/**
+ * @file imu_pack_bench.cpp
+ * @brief Compression ratio and encode cost of the packed log format
+ *
+ * Re-encodes a recorded binary frame log (LOG_FORMAT_BINARY, imu.bin) into
+ * packed blocks exactly as the logger would with LOG_FORMAT_COMPRESSED,
+ * checks that every sample decodes back bit-exact, and prints one JSON
+ * line comparing the packed size (blocks plus index) against the frame log
+ * (frames and scale records) and against the text the CSV logger writes for the same sensor
+ * columns. Encode and decode cost are host CPU time per sample; the
+ * on-device encode cost is the packed_encode stage of the hot-path
+ * benchmark.
+ *
+ * A trace recorded as CSV (acceleration.txt, gyro.txt, mag.txt) becomes a
+ * frame log by replaying it through the simulator with LOG_FORMAT_BINARY:
+ *   imu_sim --trace <dir> --sd-root <out>
+ *
+ * Build:
+ *   g++ -std=c++11 -O2 -Isrc tools/imu_pack_bench.cpp src/log_record.cpp src/packed_log.cpp -o imu_pack_bench
+ *
+ * Usage:
+ *   imu_pack_bench <imu.bin> [--block-samples N] [--write <imu.pak>]
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "log_record.h"
+#include "packed_log.h"
+#include "config.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+#define READ_CHUNK_SIZE 4096
+#define LINE_BUFFER_SIZE 128
+
+// Encode/decode passes are repeated until they take at least this long
+#define MIN_TIMED_SECONDS 0.2
+
+// ============================================================================
+// INPUT
+// ============================================================================
+
+/**
+ * @brief Read the frames of a binary log, converted with their scale records
+ *
+ * @param logBytes Bytes of the intact records read, scale records included
+ */
+static bool loadFrames(const char* path, std::vector<ImuFrame>& frames, size_t& logBytes)
+{
+    FILE* input = fopen(path, "rb");
+    if (input == NULL)
+    {
+        fprintf(stderr, "ERROR: Failed to open %s\n", path);
+        return false;
+    }
+
+    static uint8_t window[READ_CHUNK_SIZE + LOG_RECORD_MAX_SIZE];
+    FrameScaleState scale;
+    size_t fill = 0;
+    size_t readBytes;
+
+    logBytes = 0;
+    resetFrameScaleState(scale);
+    while ((readBytes = fread(window + fill, 1, READ_CHUNK_SIZE, input)) > 0 || fill >= LOG_RECORD_HEADER_SIZE)
+    {
+        fill += readBytes;
+        size_t pos = 0;
+
+        while (fill - pos >= LOG_RECORD_HEADER_SIZE)
+        {
+            ImuFrame frame;
+            size_t recordBytes;
+            FrameStatus status = decodeLogRecord(window + pos, fill - pos, scale, frame, recordBytes);
+            if (status == FRAME_TRUNCATED && readBytes > 0)
+            {
+                break;
+            }
+            if (status != FRAME_OK && status != FRAME_SCALE)
+            {
+                pos++;
+                continue;
+            }
+            if (status == FRAME_OK)
+            {
+                frames.push_back(frame);
+            }
+            logBytes += recordBytes;
+            pos += recordBytes;
+        }
+
+        memmove(window, window + pos, fill - pos);
+        fill -= pos;
+
+        if (readBytes == 0)
+        {
+            break;
+        }
+    }
+
+    fclose(input);
+    return true;
+}
+
+/**
+ * @brief Bytes the CSV logger writes for the sensor columns of @p frames
+ */
+static size_t csvBytes(const std::vector<ImuFrame>& frames)
+{
+    char line[LINE_BUFFER_SIZE];
+    size_t total = 0;
+
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        unsigned long t = frames[i].timestampMs;
+        float a[3], g[3], m[3];
+        frameSensors(frames[i], a, g, m);
+        total += snprintf(line, sizeof(line), "\r\n%lu,%lf,%lf,%lf", t, 1000 * a[0], 1000 * a[1], 1000 * a[2]);
+        total += snprintf(line, sizeof(line), "\r\n%lu,%lf,%lf,%lf", t, g[0], g[1], g[2]);
+        total += snprintf(line, sizeof(line), "\r\n%lu,%lf,%lf,%lf", t, m[0], m[1], m[2]);
+    }
+    return total;
+}
+
+// ============================================================================
+// ENCODE / DECODE
+// ============================================================================
+
+/**
+ * @brief Pack @p frames the way logPackedFrame() does
+ */
+static void encodeAll(const std::vector<ImuFrame>& frames, uint16_t blockSamples,
+                      std::vector<uint8_t>& log, size_t& blocks)
+{
+    static PackedBlockEncoder encoder;
+    encoder = PackedBlockEncoder(blockSamples);
+    const uint8_t* block;
+    size_t length;
+
+    log.clear();
+    blocks = 0;
+
+    for (size_t i = 0; i < frames.size(); i++)
+    {
+        const ImuFrame& frame = frames[i];
+        bool aged = !encoder.empty() && frame.timestampMs - encoder.firstTimestamp() >= LOG_FLUSH_INTERVAL_MS;
+        if (aged || !encoder.add(frame))
+        {
+            length = encoder.finish(block);
+            log.insert(log.end(), block, block + length);
+            blocks++;
+            encoder.add(frame);
+        }
+    }
+
+    length = encoder.finish(block);
+    if (length > 0)
+    {
+        log.insert(log.end(), block, block + length);
+        blocks++;
+    }
+}
+
+/**
+ * @return Number of decoded samples, or -1 on a corrupt block
+ */
+static long decodeAll(const std::vector<uint8_t>& log, std::vector<ImuFrame>& out)
+{
+    static ImuFrame frames[PACKED_MAX_BLOCK_SAMPLES];
+    size_t pos = 0;
+
+    out.clear();
+    while (pos < log.size())
+    {
+        PackedBlockInfo info;
+        size_t blockBytes;
+        if (decodePackedBlock(&log[pos], log.size() - pos, frames, info, blockBytes) != PACKED_OK)
+        {
+            return -1;
+        }
+        out.insert(out.end(), frames, frames + info.samples);
+        pos += blockBytes;
+    }
+    return (long)out.size();
+}
+
+static bool sameSample(const ImuFrame& a, const ImuFrame& b)
+{
+    return a.timestampMs == b.timestampMs
+        && memcmp(a.accelCount, b.accelCount, sizeof(a.accelCount)) == 0
+        && memcmp(a.gyroCount, b.gyroCount, sizeof(a.gyroCount)) == 0
+        && memcmp(a.magCount, b.magCount, sizeof(a.magCount)) == 0
+        && memcmp(&a.scale, &b.scale, sizeof(a.scale)) == 0;
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char** argv)
+{
+    const char* inputPath = NULL;
+    const char* writePath = NULL;
+    uint16_t blockSamples = LOG_PACKED_BLOCK_SAMPLES;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--block-samples") == 0 && i + 1 < argc)
+        {
+            blockSamples = (uint16_t)atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--write") == 0 && i + 1 < argc)
+        {
+            writePath = argv[++i];
+        }
+        else if (inputPath == NULL)
+        {
+            inputPath = argv[i];
+        }
+    }
+
+    if (inputPath == NULL || blockSamples == 0)
+    {
+        fprintf(stderr, "Usage: %s <imu.bin> [--block-samples N] [--write <imu.pak>]\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<ImuFrame> frames;
+    size_t frameBytes;
+    if (!loadFrames(inputPath, frames, frameBytes))
+    {
+        return 1;
+    }
+    if (frames.empty())
+    {
+        fprintf(stderr, "ERROR: No valid frames in %s\n", inputPath);
+        return 1;
+    }
+
+    std::vector<uint8_t> log;
+    std::vector<ImuFrame> decoded;
+    size_t blocks = 0;
+
+    unsigned long encodePasses = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    do
+    {
+        encodeAll(frames, blockSamples, log, blocks);
+        encodePasses++;
+    } while (secondsSince(start) < MIN_TIMED_SECONDS);
+    double encodeNs = 1.0e9 * secondsSince(start) / ((double)encodePasses * frames.size());
+
+    unsigned long decodePasses = 0;
+    long decodedCount = 0;
+    start = std::chrono::steady_clock::now();
+    do
+    {
+        decodedCount = decodeAll(log, decoded);
+        decodePasses++;
+    } while (secondsSince(start) < MIN_TIMED_SECONDS);
+    double decodeNs = 1.0e9 * secondsSince(start) / ((double)decodePasses * frames.size());
+
+    bool exact = (decodedCount == (long)frames.size());
+    for (size_t i = 0; exact && i < frames.size(); i++)
+    {
+        exact = sameSample(frames[i], decoded[i]);
+    }
+
+    if (writePath != NULL)
+    {
+        FILE* out = fopen(writePath, "wb");
+        if (out == NULL || fwrite(log.data(), 1, log.size(), out) != log.size())
+        {
+            fprintf(stderr, "ERROR: Failed to write %s\n", writePath);
+            return 1;
+        }
+        fclose(out);
+    }
+
+    size_t packedBytes = log.size() + blocks * PACKED_INDEX_ENTRY_SIZE;
+    size_t textBytes = csvBytes(frames);
+
+    printf("{\"benchmark\":\"packed_log\",\"samples\":%lu,\"blocks\":%lu,\"block_samples\":%u,"
+           "\"packed_bytes\":%lu,\"bytes_per_sample\":%.2f,\"frame_bytes\":%lu,\"csv_bytes\":%lu,"
+           "\"ratio_vs_frames\":%.2f,\"ratio_vs_csv\":%.2f,\"encode_ns_per_sample\":%.1f,"
+           "\"decode_ns_per_sample\":%.1f,\"roundtrip_exact\":%s}\n",
+           (unsigned long)frames.size(), (unsigned long)blocks, (unsigned)blockSamples,
+           (unsigned long)packedBytes, (double)packedBytes / frames.size(), (unsigned long)frameBytes,
+           (unsigned long)textBytes, (double)frameBytes / packedBytes, (double)textBytes / packedBytes,
+           encodeNs, decodeNs, exact ? "true" : "false");
+
+    return exact ? 0 : 1;
+}
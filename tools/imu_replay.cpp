@@ -0,0 +1,878 @@
+/**
+ * @file imu_replay.cpp
+ * @brief Host replay of recorded IMU logs through the AHRS filter
+ * 
+ * Re-runs the firmware's fusion kernel and orientation code over a recorded
+ * session and writes fresh quaternion.txt and ypr.txt files, so filter
+ * gains and magnetometer biases can be tuned without re-recording. The
+ * input is either a directory holding acceleration.txt, gyro.txt and
+ * mag.txt, or a binary log written with LOG_FORMAT_BINARY.
+ * 
+ * Inputs are streamed row by row (memory use does not grow with log
+ * length) and aligned by millis: each accelerometer row is fused with the
+ * latest gyro and magnetometer rows at or before its timestamp, with dt
+ * taken from consecutive timestamps.
+ * 
+ * Several parameter sets can be given with repeated --gains options; each
+ * set is replayed independently on its own worker thread and written to
+ * output_dir/set_<n>/.
+ * 
+ * Each replayed quaternion is compared with a reference log at the same
+ * millis: by default the quaternions recorded with the input (quaternion.txt
+ * in a log directory, or the frames of a binary log), or the quaternion.txt
+ * of an earlier replay given with --reference. The RMS and maximum angle
+ * between the two are reported per set, so engines and gains can be
+ * compared on the same recording.
+ * 
+ * Build:
+ *   g++ -std=c++11 -O2 -pthread -Isrc tools/imu_replay.cpp src/mahony_filter.cpp src/log_record.cpp -o imu_replay
+ * 
+ * Usage:
+ *   imu_replay <log_dir | imu.bin> [output_dir] [--gains kp,ki[,bx,by,bz]]...
+ *              [--declination <deg>] [--threads <n>] [--fixed-point]
+ *              [--engine mahony|madgwick|complementary] [--reference <dir>]
+ * 
+ * The two gains are the engine's: kp and ki for Mahony, beta for Madgwick
+ * and the time constant tau (seconds) for the complementary filter (the
+ * second value is ignored by those two). bx, by, bz are extra hard-iron
+ * offsets (milliGauss) subtracted from the logged magnetometer values, on
+ * top of the biases applied on the device.
+ * --fixed-point runs the Q-format fusion kernel instead of the float one,
+ * to check its accuracy on real data before using it on a target.
+ * 
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "mahony_filter.h"
+#include "fusion_engine.h"
+#include "log_record.h"
+#include "config.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <sys/stat.h>
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+#define READ_CHUNK_SIZE 4096
+#define PATH_BUFFER_SIZE 512
+#define LINE_BUFFER_SIZE 256
+#define STREAM_BUFFER_SIZE (1 << 20)
+#define DEGREES_TO_RADIANS 0.017453292519943295769236907684886
+#define RADIANS_TO_DEGREES 57.295779513082320876798154814105
+#define CSV_MAX_FIELDS 4
+
+// ============================================================================
+// TYPES
+// ============================================================================
+
+/**
+ * @brief One aligned sample in the units the firmware feeds the filter
+ */
+struct ReplaySample
+{
+    uint32_t timestampMs;
+    float ax, ay, az;       ///< g
+    float gx, gy, gz;       ///< deg/s
+    float mx, my, mz;       ///< milliGauss, device biases applied
+    float refQ[4];          ///< Reference quaternion (valid when hasRef)
+    bool hasRef;
+};
+
+/**
+ * @brief Filter parameters for one replay run
+ */
+struct ReplayParams
+{
+    float kp;
+    float ki;
+    float magOffset[3];
+};
+
+/**
+ * @brief Counters reported for one replay run
+ */
+struct ReplayResult
+{
+    unsigned long samples;
+    unsigned long rejected;     ///< Corrupt records, and frames whose scale record was lost
+    unsigned long compared;     ///< Samples with a reference quaternion
+    double sumSquaredDeg;       ///< Sum of squared angles to the reference
+    float maxDeg;               ///< Largest angle to the reference
+    double seconds;
+    bool ok;
+};
+
+// ============================================================================
+// CSV INPUT
+// ============================================================================
+
+/**
+ * @brief Streaming reader for one "millis,v1,...,vN" log file
+ */
+class CsvReader
+{
+public:
+    CsvReader(void) : file(NULL), fieldCount(3), hasRow(false) {}
+    ~CsvReader(void) { close(); }
+
+    /**
+     * @param fields Values per row after millis (3, or 4 for quaternions)
+     */
+    bool open(const char* dir, const char* name, int fields = 3)
+    {
+        fieldCount = fields;
+        char path[PATH_BUFFER_SIZE];
+        snprintf(path, sizeof(path), "%s%s", dir, name);
+        file = fopen(path, "rb");
+        if (file == NULL)
+        {
+            fprintf(stderr, "ERROR: Failed to open %s\n", path);
+            return false;
+        }
+        setvbuf(file, NULL, _IOFBF, STREAM_BUFFER_SIZE);
+        hasRow = readRow(row);
+        return true;
+    }
+
+    void close(void)
+    {
+        if (file != NULL)
+        {
+            fclose(file);
+            file = NULL;
+        }
+    }
+
+    /**
+     * @brief Timestamp of the row take() returns next (valid while available())
+     */
+    uint32_t peekTimestamp(void) const { return rowTimestamp; }
+    bool available(void) const { return hasRow; }
+
+    /**
+     * @brief Consume the pending row into @p values
+     */
+    void take(uint32_t& timestamp, float* values)
+    {
+        timestamp = rowTimestamp;
+        for (int i = 0; i < fieldCount; i++)
+        {
+            values[i] = row[i];
+        }
+        hasRow = readRow(row);
+    }
+
+private:
+    bool readRow(float* values)
+    {
+        char line[LINE_BUFFER_SIZE];
+
+        // Skip the header and the blank lines left by the "\r\n" row prefix
+        while (fgets(line, sizeof(line), file) != NULL)
+        {
+            if (line[0] < '0' || line[0] > '9')
+            {
+                continue;
+            }
+
+            char* cursor;
+            int fields = 0;
+            rowTimestamp = (uint32_t)strtoul(line, &cursor, 10);
+            while (fields < fieldCount && *cursor == ',')
+            {
+                values[fields++] = strtof(cursor + 1, &cursor);
+            }
+
+            // A row cut short by a power loss is dropped
+            if (fields == fieldCount)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    FILE* file;
+    int fieldCount;
+    float row[CSV_MAX_FIELDS];
+    uint32_t rowTimestamp;
+    bool hasRow;
+};
+
+static bool fileExists(const char* dir, const char* name)
+{
+    char path[PATH_BUFFER_SIZE];
+    struct stat info;
+    snprintf(path, sizeof(path), "%s%s", dir, name);
+    return stat(path, &info) == 0 && S_ISREG(info.st_mode);
+}
+
+/**
+ * @brief Quaternion log looked up by increasing millis
+ */
+class ReferenceLog
+{
+public:
+    ReferenceLog(void) : opened(false) {}
+
+    /**
+     * @brief Open dir/quaternion.txt; a missing file is not an error
+     */
+    bool open(const char* dir)
+    {
+        if (!fileExists(dir, FILE_QUATERNION))
+        {
+            return false;
+        }
+        opened = reader.open(dir, FILE_QUATERNION, 4);
+        return opened;
+    }
+
+    bool isOpen(void) const { return opened; }
+
+    /**
+     * @brief Reference quaternion logged at exactly @p timestamp
+     * 
+     * Timestamps must be queried in increasing order.
+     */
+    bool lookup(uint32_t timestamp, float* q)
+    {
+        uint32_t rowTimestamp;
+        bool found = false;
+
+        while (opened && reader.available() && (int32_t)(reader.peekTimestamp() - timestamp) <= 0)
+        {
+            found = (reader.peekTimestamp() == timestamp);
+            reader.take(rowTimestamp, q);
+        }
+        return found;
+    }
+
+private:
+    CsvReader reader;
+    bool opened;
+};
+
+// ============================================================================
+// SAMPLE SOURCES
+// ============================================================================
+
+class SampleSource
+{
+public:
+    virtual ~SampleSource(void) {}
+    virtual bool next(ReplaySample& sample) = 0;
+    virtual unsigned long rejected(void) const { return 0; }
+};
+
+/**
+ * @brief Aligns the three CSV logs by timestamp
+ */
+class CsvSource : public SampleSource
+{
+public:
+    CsvSource(void) : gyroValid(false), magValid(false) {}
+
+    bool open(const char* dir)
+    {
+        if (!accel.open(dir, FILE_ACCELERATION)
+            || !gyro.open(dir, FILE_GYROSCOPE)
+            || !mag.open(dir, FILE_MAGNETOMETER))
+        {
+            return false;
+        }
+
+        // Quaternions the device logged alongside, if any
+        reference.open(dir);
+        return true;
+    }
+
+    bool next(ReplaySample& sample) override
+    {
+        float a[3];
+        uint32_t timestamp;
+        uint32_t unused;
+
+        while (accel.available())
+        {
+            accel.take(timestamp, a);
+
+            // Latest gyro/mag rows at or before this accelerometer row
+            while (gyro.available() && (int32_t)(gyro.peekTimestamp() - timestamp) <= 0)
+            {
+                gyro.take(unused, g);
+                gyroValid = true;
+            }
+            while (mag.available() && (int32_t)(mag.peekTimestamp() - timestamp) <= 0)
+            {
+                mag.take(unused, m);
+                magValid = true;
+            }
+
+            if (!gyroValid || !magValid)
+            {
+                continue;
+            }
+
+            sample.timestampMs = timestamp;
+            sample.ax = a[0] / 1000.0f;
+            sample.ay = a[1] / 1000.0f;
+            sample.az = a[2] / 1000.0f;
+            sample.gx = g[0];
+            sample.gy = g[1];
+            sample.gz = g[2];
+            sample.mx = m[0];
+            sample.my = m[1];
+            sample.mz = m[2];
+            sample.hasRef = reference.lookup(timestamp, sample.refQ);
+            return true;
+        }
+        return false;
+    }
+
+private:
+    ReferenceLog reference;
+    CsvReader accel;
+    CsvReader gyro;
+    CsvReader mag;
+    float g[3];
+    float m[3];
+    bool gyroValid;
+    bool magValid;
+};
+
+/**
+ * @brief Reads frames from a binary log, resynchronizing after corruption
+ * 
+ * Scale records are carried forward to the frames written under them.
+ */
+class BinarySource : public SampleSource
+{
+public:
+    BinarySource(void) : file(NULL), fill(0), pos(0), corrupt(0)
+    {
+        resetFrameScaleState(scale);
+    }
+    ~BinarySource(void)
+    {
+        if (file != NULL)
+        {
+            fclose(file);
+        }
+    }
+
+    bool open(const char* path)
+    {
+        file = fopen(path, "rb");
+        if (file == NULL)
+        {
+            fprintf(stderr, "ERROR: Failed to open %s\n", path);
+            return false;
+        }
+        return true;
+    }
+
+    bool next(ReplaySample& sample) override
+    {
+        bool ended = false;
+
+        for (;;)
+        {
+            if (fill - pos < LOG_RECORD_MAX_SIZE && !ended)
+            {
+                memmove(window, window + pos, fill - pos);
+                fill -= pos;
+                pos = 0;
+                size_t readBytes = fread(window + fill, 1, READ_CHUNK_SIZE, file);
+                fill += readBytes;
+                ended = (readBytes == 0);
+            }
+            if (fill - pos < LOG_RECORD_HEADER_SIZE)
+            {
+                return false;
+            }
+
+            ImuFrame f;
+            size_t recordBytes;
+            FrameStatus status = decodeLogRecord(window + pos, fill - pos, scale, f, recordBytes);
+            if (status == FRAME_SCALE || status == FRAME_NO_SCALE)
+            {
+                corrupt += (status == FRAME_NO_SCALE) ? 1 : 0;
+                pos += recordBytes;
+                continue;
+            }
+            if (status != FRAME_OK)
+            {
+                // A record cut off by the end of the file is not counted
+                if (status != FRAME_BAD_MAGIC && status != FRAME_TRUNCATED)
+                {
+                    corrupt++;
+                }
+                pos++;
+                continue;
+            }
+            pos += recordBytes;
+
+            // Same conversions as readIMUData()/readMagnetometerData()
+            float a[3], g[3], m[3];
+            frameSensors(f, a, g, m);
+            sample.timestampMs = f.timestampMs;
+            sample.ax = a[0];
+            sample.ay = a[1];
+            sample.az = a[2];
+            sample.gx = g[0];
+            sample.gy = g[1];
+            sample.gz = g[2];
+            sample.mx = m[0];
+            sample.my = m[1];
+            sample.mz = m[2];
+            memcpy(sample.refQ, f.q, sizeof(sample.refQ));
+            sample.hasRef = true;
+            return true;
+        }
+    }
+
+    unsigned long rejected(void) const override { return corrupt; }
+
+private:
+    FILE* file;
+    FrameScaleState scale;
+    uint8_t window[READ_CHUNK_SIZE + LOG_RECORD_MAX_SIZE];
+    size_t fill;
+    size_t pos;
+    unsigned long corrupt;
+};
+
+// ============================================================================
+// REPLAY
+// ============================================================================
+
+static FILE* openCsv(const char* dir, const char* name, const char* header)
+{
+    char path[PATH_BUFFER_SIZE];
+    snprintf(path, sizeof(path), "%s%s", dir, name);
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "ERROR: Failed to open %s for writing\n", path);
+        return NULL;
+    }
+    setvbuf(file, NULL, _IOFBF, STREAM_BUFFER_SIZE);
+    fputs(header, file);
+    return file;
+}
+
+static bool isDirectory(const char* path)
+{
+    struct stat info;
+    return stat(path, &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+/**
+ * @brief Angle between two unit quaternions in degrees
+ */
+static float quaternionAngleDeg(const float* a, const float* b)
+{
+    float dot = fabsf(a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3]);
+    return 2.0f * acosf(dot < 1.0f ? dot : 1.0f) * (float)RADIANS_TO_DEGREES;
+}
+
+/**
+ * @brief Write the outputs of one fused sample and compare it with its reference
+ */
+static void writeSample(const ReplaySample& s, const float* q, uint32_t dtMs, float declination,
+                        FILE* quaternionOut, FILE* yprOut, ReplayResult& result)
+{
+    float yaw, pitch, roll;
+    quaternionToEuler(q, declination, yaw, pitch, roll);
+    float rateHz = (dtMs > 0) ? 1000.0f / (float)dtMs : 0.0f;
+
+    unsigned long t = s.timestampMs;
+    fprintf(quaternionOut, "\r\n%lu,%lf,%lf,%lf,%lf", t, q[0], q[1], q[2], q[3]);
+    fprintf(yprOut, "\r\n%lu,%lf,%lf,%lf,%lf", t, rateHz, yaw, pitch, roll);
+
+    if (s.hasRef)
+    {
+        float angle = quaternionAngleDeg(q, s.refQ);
+        result.compared++;
+        result.sumSquaredDeg += (double)angle * angle;
+        result.maxDeg = (angle > result.maxDeg) ? angle : result.maxDeg;
+    }
+}
+
+template <typename T>
+static void configureEngine(MahonyKernel<T>& engine, const ReplayParams& params)
+{
+    engine.setGains(params.kp, params.ki);
+}
+
+template <typename T>
+static void configureEngine(MadgwickKernel<T>& engine, const ReplayParams& params)
+{
+    engine.setBeta(params.kp);
+}
+
+template <typename T>
+static void configureEngine(ComplementaryKernel<T>& engine, const ReplayParams& params)
+{
+    engine.setTimeConstant(params.kp);
+}
+
+/**
+ * @brief Fuse every sample of @p source, one update() each
+ * 
+ * update() rather than updateBatch(): the recurrence dominates, and
+ * staging the batch costs more than the batched normalisation saves
+ * (fusion_update against fusion_batch in the benchmark).
+ * 
+ * @param reference Overrides the source's reference quaternions when open
+ */
+template <typename Engine, typename T>
+static void fuseStream(SampleSource& source, ReferenceLog& reference, const ReplayParams& params,
+                       float declination, FILE* quaternionOut, FILE* yprOut, ReplayResult& result)
+{
+    Engine filter;
+    ReplaySample s;
+    uint32_t lastTimestamp = 0;
+
+    configureEngine(filter, params);
+
+    while (source.next(s))
+    {
+        uint32_t dt = s.timestampMs - lastTimestamp;
+        bool first = (result.samples == 0);
+        lastTimestamp = s.timestampMs;
+        result.samples++;
+
+        if (first)
+        {
+            continue;
+        }
+
+        if (reference.isOpen())
+        {
+            s.hasRef = reference.lookup(s.timestampMs, s.refQ);
+        }
+
+        // Same axis mapping as runFilter() in data_processor.cpp
+        filter.update(s.ax, s.ay, s.az,
+                      s.gx * DEGREES_TO_RADIANS, s.gy * DEGREES_TO_RADIANS, s.gz * DEGREES_TO_RADIANS,
+                      s.my - params.magOffset[1], s.mx - params.magOffset[0], s.mz - params.magOffset[2],
+                      dt / 1000.0f);
+        writeSample(s, filter.quaternion(), dt, declination, quaternionOut, yprOut, result);
+    }
+}
+
+/**
+ * @brief Options shared by every parameter set
+ */
+struct ReplayOptions
+{
+    float declination;
+    int engine;                 ///< FUSION_ENGINE_* value
+    bool fixedPoint;
+    const char* referenceDir;   ///< NULL: use the input's own quaternions
+};
+
+template <typename T>
+static void fuseWithEngine(SampleSource& source, ReferenceLog& reference, const ReplayParams& params,
+                           const ReplayOptions& options, FILE* quaternionOut, FILE* yprOut,
+                           ReplayResult& result)
+{
+    if (options.engine == FUSION_ENGINE_MADGWICK)
+    {
+        fuseStream<MadgwickKernel<T>, T>(source, reference, params, options.declination,
+                                         quaternionOut, yprOut, result);
+    }
+    else if (options.engine == FUSION_ENGINE_COMPLEMENTARY)
+    {
+        fuseStream<ComplementaryKernel<T>, T>(source, reference, params, options.declination,
+                                              quaternionOut, yprOut, result);
+    }
+    else
+    {
+        fuseStream<MahonyKernel<T>, T>(source, reference, params, options.declination,
+                                       quaternionOut, yprOut, result);
+    }
+}
+
+/**
+ * @brief Replay the whole input once with @p params into @p outputDir
+ */
+static ReplayResult replay(const char* inputPath, const char* outputDir,
+                           const ReplayParams& params, const ReplayOptions& options)
+{
+    ReplayResult result = {0, 0, 0, 0.0, 0.0f, 0.0, false};
+    auto start = std::chrono::steady_clock::now();
+
+    CsvSource csv;
+    BinarySource binary;
+    SampleSource* source;
+    if (isDirectory(inputPath))
+    {
+        if (!csv.open(inputPath))
+        {
+            return result;
+        }
+        source = &csv;
+    }
+    else
+    {
+        if (!binary.open(inputPath))
+        {
+            return result;
+        }
+        source = &binary;
+    }
+
+    FILE* quaternionOut = openCsv(outputDir, FILE_QUATERNION, "millis,q0,qX,qY,qZ");
+    FILE* yprOut = openCsv(outputDir, FILE_YPR, "millis,rate_hz,Yaw,Pitch,Roll");
+    if (quaternionOut == NULL || yprOut == NULL)
+    {
+        if (quaternionOut != NULL)
+        {
+            fclose(quaternionOut);
+        }
+        if (yprOut != NULL)
+        {
+            fclose(yprOut);
+        }
+        return result;
+    }
+
+    ReferenceLog reference;
+    if (options.referenceDir != NULL && !reference.open(options.referenceDir))
+    {
+        fprintf(stderr, "ERROR: No %s in %s\n", FILE_QUATERNION, options.referenceDir);
+        fclose(quaternionOut);
+        fclose(yprOut);
+        return result;
+    }
+
+    if (options.fixedPoint)
+    {
+        fuseWithEngine<FixedPoint<FUSION_FIXED_FRAC_BITS> >(*source, reference, params, options,
+                                                           quaternionOut, yprOut, result);
+    }
+    else
+    {
+        fuseWithEngine<float>(*source, reference, params, options, quaternionOut, yprOut, result);
+    }
+
+    fclose(quaternionOut);
+    fclose(yprOut);
+
+    result.rejected = source->rejected();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.ok = true;
+    return result;
+}
+
+// ============================================================================
+// COMMAND LINE
+// ============================================================================
+
+static bool parseGains(const char* text, ReplayParams& params)
+{
+    float values[5] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    int count = sscanf(text, "%f,%f,%f,%f,%f", &values[0], &values[1], &values[2], &values[3], &values[4]);
+    if (count != 2 && count != 5)
+    {
+        return false;
+    }
+
+    params.kp = values[0];
+    params.ki = values[1];
+    params.magOffset[0] = values[2];
+    params.magOffset[1] = values[3];
+    params.magOffset[2] = values[4];
+    return true;
+}
+
+static bool parseEngine(const char* text, int& engine)
+{
+    if (strcmp(text, "mahony") == 0)
+    {
+        engine = FUSION_ENGINE_MAHONY;
+    }
+    else if (strcmp(text, "madgwick") == 0)
+    {
+        engine = FUSION_ENGINE_MADGWICK;
+    }
+    else if (strcmp(text, "complementary") == 0)
+    {
+        engine = FUSION_ENGINE_COMPLEMENTARY;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+static void printUsage(const char* program)
+{
+    fprintf(stderr, "Usage: %s <log_dir | imu.bin> [output_dir] [--gains kp,ki[,bx,by,bz]]...\n"
+                    "       [--declination <deg>] [--threads <n>] [--fixed-point]\n"
+                    "       [--engine mahony|madgwick|complementary] [--reference <dir>]\n", program);
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char** argv)
+{
+    const char* inputPath = NULL;
+    const char* outputDir = ".";
+    ReplayOptions options = {MAGNETIC_DECLINATION_DEG, FUSION_ENGINE, false, NULL};
+    unsigned threadCount = std::thread::hardware_concurrency();
+    std::vector<ReplayParams> sets;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--gains") == 0 && i + 1 < argc)
+        {
+            ReplayParams params;
+            if (!parseGains(argv[++i], params))
+            {
+                fprintf(stderr, "ERROR: Bad --gains value '%s'\n", argv[i]);
+                return 2;
+            }
+            sets.push_back(params);
+        }
+        else if (strcmp(argv[i], "--declination") == 0 && i + 1 < argc)
+        {
+            options.declination = (float)atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--fixed-point") == 0)
+        {
+            options.fixedPoint = true;
+        }
+        else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc)
+        {
+            if (!parseEngine(argv[++i], options.engine))
+            {
+                fprintf(stderr, "ERROR: Unknown engine '%s'\n", argv[i]);
+                return 2;
+            }
+        }
+        else if (strcmp(argv[i], "--reference") == 0 && i + 1 < argc)
+        {
+            options.referenceDir = argv[++i];
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            threadCount = (unsigned)atoi(argv[++i]);
+        }
+        else if (inputPath == NULL)
+        {
+            inputPath = argv[i];
+        }
+        else
+        {
+            outputDir = argv[i];
+        }
+    }
+
+    if (inputPath == NULL)
+    {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    if (sets.empty())
+    {
+        ReplayParams defaults = {MAHONY_KP, MAHONY_KI, {0.0f, 0.0f, 0.0f}};
+        if (options.engine == FUSION_ENGINE_MADGWICK)
+        {
+            defaults.kp = MADGWICK_BETA;
+        }
+        else if (options.engine == FUSION_ENGINE_COMPLEMENTARY)
+        {
+            defaults.kp = COMPLEMENTARY_TAU_S;
+        }
+        sets.push_back(defaults);
+    }
+
+    // A single set writes straight into output_dir, several get one subdirectory each
+    mkdir(outputDir, 0755);
+    std::vector<std::string> outputDirs;
+    for (size_t n = 0; n < sets.size(); n++)
+    {
+        if (sets.size() == 1)
+        {
+            outputDirs.push_back(outputDir);
+            continue;
+        }
+
+        char path[PATH_BUFFER_SIZE];
+        snprintf(path, sizeof(path), "%s/set_%zu", outputDir, n);
+        mkdir(path, 0755);
+        outputDirs.push_back(path);
+    }
+
+    if (threadCount == 0)
+    {
+        threadCount = 1;
+    }
+    if (threadCount > sets.size())
+    {
+        threadCount = (unsigned)sets.size();
+    }
+
+    std::vector<ReplayResult> results(sets.size());
+    std::atomic<size_t> nextSet(0);
+    std::vector<std::thread> workers;
+
+    for (unsigned w = 0; w < threadCount; w++)
+    {
+        workers.push_back(std::thread([&]()
+        {
+            size_t n;
+            while ((n = nextSet.fetch_add(1)) < sets.size())
+            {
+                results[n] = replay(inputPath, outputDirs[n].c_str(), sets[n], options);
+            }
+        }));
+    }
+    for (size_t w = 0; w < workers.size(); w++)
+    {
+        workers[w].join();
+    }
+
+    int exitCode = 0;
+    for (size_t n = 0; n < sets.size(); n++)
+    {
+        const ReplayParams& p = sets[n];
+        const ReplayResult& r = results[n];
+        if (!r.ok)
+        {
+            fprintf(stderr, "ERROR: Set %zu failed\n", n);
+            exitCode = 1;
+            continue;
+        }
+        fprintf(stderr, "INFO: Set %zu (gains %.3f %.3f, mag offset %.1f %.1f %.1f): "
+                        "%lu samples, %lu rejected, %.2f s -> %s\n",
+                n, p.kp, p.ki, p.magOffset[0], p.magOffset[1], p.magOffset[2],
+                r.samples, r.rejected, r.seconds, outputDirs[n].c_str());
+        if (r.compared > 0)
+        {
+            fprintf(stderr, "INFO: Set %zu vs reference: %lu samples, rms %.3f deg, max %.3f deg\n",
+                    n, r.compared, sqrt(r.sumSquaredDeg / r.compared), r.maxDeg);
+        }
+    }
+    return exitCode;
+}
@@ -0,0 +1,372 @@
+/**
+ * @file imu_telemetry.cpp
+ * @brief Host receiver for the binary serial telemetry stream
+ *
+ * Decodes the frames written when SERIAL_TELEMETRY_ENABLED is set
+ * (telemetry_protocol.h) from a serial port, a capture file or stdin and
+ * writes one CSV line per frame. Text or damaged bytes before a delimiter
+ * are counted and skipped. A summary with frame, error and loss counts is
+ * printed to stderr when the input ends.
+ *
+ * --pty-check runs the protocol end to end without hardware: a writer
+ * thread encodes N frames of known contents into a pseudo-terminal at a
+ * fixed frame rate while the parser reads the other side. Every frame has
+ * to arrive, in order and bit-exact. One JSON line reports the result and
+ * the exit code is nonzero on any mismatch.
+ *
+ * Build:
+ *   g++ -std=c++11 -O2 -Isrc tools/imu_telemetry.cpp src/telemetry_protocol.cpp src/log_record.cpp -pthread -o imu_telemetry
+ *
+ * Usage:
+ *   imu_telemetry <device | capture_file | -> [output.csv] [--baud N]
+ *   imu_telemetry --pty-check N [--rate frames_per_s]
+ *
+ * @author pankace
+ * @date 2026-02-05
+ * @version 1.0
+ */
+
+#include "telemetry_protocol.h"
+#include "config.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <thread>
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+#define READ_CHUNK_SIZE 4096
+#define PTY_IDLE_TIMEOUT_MS 2000
+
+// Sum of the firmware's configured channel rates
+#define CONFIGURED_FRAME_RATE (TELEMETRY_RATE_ACCEL_HZ + TELEMETRY_RATE_GYRO_HZ + \
+                               TELEMETRY_RATE_MAG_HZ + TELEMETRY_RATE_QUATERNION_HZ + \
+                               TELEMETRY_RATE_YPR_HZ)
+
+static const char* channelNames[TELEMETRY_CHANNEL_COUNT] = {
+    "accel", "gyro", "mag", "quaternion", "ypr"
+};
+
+// ============================================================================
+// HELPERS
+// ============================================================================
+
+static double nowSeconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static speed_t baudConstant(long baud)
+{
+    switch (baud)
+    {
+        case 9600:    return B9600;
+        case 19200:   return B19200;
+        case 38400:   return B38400;
+        case 57600:   return B57600;
+        case 115200:  return B115200;
+        case 230400:  return B230400;
+        case 460800:  return B460800;
+        case 921600:  return B921600;
+        default:      return 0;
+    }
+}
+
+/**
+ * @brief Switch a terminal to raw 8N1, optionally setting the baud rate
+ */
+static bool makeRaw(int fd, long baud)
+{
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0)
+    {
+        return false;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    if (baud > 0)
+    {
+        speed_t speed = baudConstant(baud);
+        if (speed == 0)
+        {
+            return false;
+        }
+        cfsetispeed(&tio, speed);
+        cfsetospeed(&tio, speed);
+    }
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+// ============================================================================
+// DECODE
+// ============================================================================
+
+static int decodeStream(const char* inputPath, const char* outputPath, long baud)
+{
+    int fd = (strcmp(inputPath, "-") == 0) ? STDIN_FILENO : open(inputPath, O_RDONLY | O_NOCTTY);
+    if (fd < 0)
+    {
+        fprintf(stderr, "ERROR: Failed to open %s: %s\n", inputPath, strerror(errno));
+        return 1;
+    }
+    if (isatty(fd) && !makeRaw(fd, baud))
+    {
+        fprintf(stderr, "ERROR: Failed to configure %s\n", inputPath);
+        return 1;
+    }
+
+    FILE* out = (outputPath != NULL) ? fopen(outputPath, "wb") : stdout;
+    if (out == NULL)
+    {
+        fprintf(stderr, "ERROR: Failed to open %s for writing\n", outputPath);
+        return 1;
+    }
+    fputs("channel,sequence,timestamp_ms,v0,v1,v2,v3\r\n", out);
+
+    TelemetryParser parser;
+    uint32_t perChannel[TELEMETRY_CHANNEL_COUNT] = {0};
+    uint8_t chunk[READ_CHUNK_SIZE];
+    ssize_t got;
+    while ((got = read(fd, chunk, sizeof(chunk))) > 0)
+    {
+        for (ssize_t i = 0; i < got; i++)
+        {
+            if (!parser.feed(chunk[i]))
+            {
+                continue;
+            }
+            const TelemetryFrame& frame = parser.frame();
+            perChannel[frame.channel]++;
+            fprintf(out, "%s,%u,%lu", channelNames[frame.channel], (unsigned)frame.sequence,
+                    (unsigned long)frame.timestampMs);
+            for (uint8_t v = 0; v < telemetryChannelValues(frame.channel); v++)
+            {
+                fprintf(out, ",%.4f", frame.values[v]);
+            }
+            fputs("\r\n", out);
+        }
+    }
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    if (fd != STDIN_FILENO)
+    {
+        close(fd);
+    }
+
+    fprintf(stderr, "frames=%lu crc_errors=%lu framing_errors=%lu lost=%lu",
+            (unsigned long)parser.frameCount(), (unsigned long)parser.crcErrorCount(),
+            (unsigned long)parser.framingErrorCount(), (unsigned long)parser.lostFrameCount());
+    for (int c = 0; c < TELEMETRY_CHANNEL_COUNT; c++)
+    {
+        fprintf(stderr, " %s=%lu", channelNames[c], (unsigned long)perChannel[c]);
+    }
+    fputs("\n", stderr);
+    return 0;
+}
+
+// ============================================================================
+// PTY CHECK
+// ============================================================================
+
+/**
+ * @brief Known contents of frame n of the check stream
+ *
+ * Values mix zeros, signs and magnitudes so that COBS sees both short and
+ * full-length runs.
+ */
+static void checkFrame(uint32_t n, TelemetryFrame& frame)
+{
+    frame.channel = (uint8_t)(n % TELEMETRY_CHANNEL_COUNT);
+    frame.sequence = (uint8_t)(n / TELEMETRY_CHANNEL_COUNT);
+    frame.timestampMs = n;
+    uint32_t state = n * 2654435761u + 1;
+    for (int v = 0; v < TELEMETRY_MAX_VALUES; v++)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        frame.values[v] = (v < telemetryChannelValues(frame.channel) && (state & 7) != 0)
+                        ? (float)((int32_t)state) / 65536.0f
+                        : 0.0f;
+    }
+}
+
+static void ptyWriter(int fd, uint32_t frames, double rate, uint64_t* bytesOut)
+{
+    uint8_t frame[TELEMETRY_MAX_FRAME_SIZE];
+    double start = nowSeconds();
+    uint64_t bytes = 0;
+
+    for (uint32_t n = 0; n < frames; n++)
+    {
+        // Pace against the start time so the rate holds without drift
+        double due = start + (double)n / rate;
+        double wait = due - nowSeconds();
+        if (wait > 0.0)
+        {
+            struct timespec ts;
+            ts.tv_sec = (time_t)wait;
+            ts.tv_nsec = (long)((wait - (double)ts.tv_sec) * 1e9);
+            nanosleep(&ts, NULL);
+        }
+
+        TelemetryFrame contents;
+        checkFrame(n, contents);
+        size_t length = encodeTelemetryFrame(contents, frame);
+        size_t sent = 0;
+        while (sent < length)
+        {
+            ssize_t w = write(fd, frame + sent, length - sent);
+            if (w < 0 && errno != EINTR)
+            {
+                *bytesOut = bytes;
+                return;
+            }
+            sent += (w > 0) ? (size_t)w : 0;
+        }
+        bytes += length;
+    }
+    *bytesOut = bytes;
+}
+
+static int runPtyCheck(uint32_t frames, double rate)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+    {
+        fprintf(stderr, "ERROR: No pseudo-terminal available\n");
+        return 1;
+    }
+    int slave = open(ptsname(master), O_RDONLY | O_NOCTTY);
+    if (slave < 0 || !makeRaw(slave, 0))
+    {
+        fprintf(stderr, "ERROR: Failed to open %s\n", ptsname(master));
+        return 1;
+    }
+
+    uint64_t bytesSent = 0;
+    double start = nowSeconds();
+    std::thread writer(ptyWriter, master, frames, rate, &bytesSent);
+
+    TelemetryParser parser;
+    uint32_t expected = 0;
+    uint32_t mismatches = 0;
+    uint64_t bytesReceived = 0;
+    uint8_t chunk[READ_CHUNK_SIZE];
+    struct pollfd pfd = {slave, POLLIN, 0};
+
+    while (expected < frames && poll(&pfd, 1, PTY_IDLE_TIMEOUT_MS) > 0)
+    {
+        ssize_t got = read(slave, chunk, sizeof(chunk));
+        if (got <= 0)
+        {
+            break;
+        }
+        bytesReceived += (uint64_t)got;
+        for (ssize_t i = 0; i < got; i++)
+        {
+            if (!parser.feed(chunk[i]))
+            {
+                continue;
+            }
+            TelemetryFrame want;
+            checkFrame(expected, want);
+            const TelemetryFrame& frame = parser.frame();
+            if (frame.channel != want.channel || frame.sequence != want.sequence ||
+                frame.timestampMs != want.timestampMs ||
+                memcmp(frame.values, want.values, sizeof(want.values)) != 0)
+            {
+                mismatches++;
+            }
+            expected = frame.timestampMs + 1;
+        }
+    }
+    double elapsed = nowSeconds() - start;
+
+    writer.join();
+    close(slave);
+    close(master);
+
+    bool pass = parser.frameCount() == frames && mismatches == 0 &&
+                parser.crcErrorCount() == 0 && parser.framingErrorCount() == 0 &&
+                parser.lostFrameCount() == 0 && bytesReceived == bytesSent;
+
+    printf("{\"frames\":%lu,\"received\":%lu,\"mismatches\":%lu,\"crc_errors\":%lu,"
+           "\"framing_errors\":%lu,\"lost\":%lu,\"bytes_sent\":%llu,\"bytes_received\":%llu,"
+           "\"seconds\":%.3f,\"target_frames_per_s\":%.0f,\"frames_per_s\":%.0f,"
+           "\"bytes_per_s\":%.0f,\"pass\":%s}\n",
+           (unsigned long)frames, (unsigned long)parser.frameCount(), (unsigned long)mismatches,
+           (unsigned long)parser.crcErrorCount(), (unsigned long)parser.framingErrorCount(),
+           (unsigned long)parser.lostFrameCount(), (unsigned long long)bytesSent,
+           (unsigned long long)bytesReceived, elapsed, rate,
+           (double)parser.frameCount() / elapsed, (double)bytesReceived / elapsed,
+           pass ? "true" : "false");
+    return pass ? 0 : 1;
+}
+
+static void printUsage(const char* program)
+{
+    fprintf(stderr, "Usage: %s <device | capture_file | -> [output.csv] [--baud N]\n"
+                    "       %s --pty-check N [--rate frames_per_s]\n", program, program);
+}
+
+// ============================================================================
+// MAIN
+// ============================================================================
+
+int main(int argc, char** argv)
+{
+    const char* inputPath = NULL;
+    const char* outputPath = NULL;
+    long baud = 115200;
+    uint32_t checkFrames = 0;
+    double rate = CONFIGURED_FRAME_RATE;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--baud") == 0 && i + 1 < argc)
+        {
+            baud = atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--pty-check") == 0 && i + 1 < argc)
+        {
+            checkFrames = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc)
+        {
+            rate = atof(argv[++i]);
+        }
+        else if (inputPath == NULL)
+        {
+            inputPath = argv[i];
+        }
+        else
+        {
+            outputPath = argv[i];
+        }
+    }
+
+    if (checkFrames > 0 && rate > 0.0)
+    {
+        return runPtyCheck(checkFrames, rate);
+    }
+    if (inputPath == NULL)
+    {
+        printUsage(argv[0]);
+        return 2;
+    }
+    return decodeStream(inputPath, outputPath, baud);
+}